@@ -0,0 +1,192 @@
+﻿
+// .\Release\x64\allocation_benchmarks.exe --benchmark_filter=SymplecticRungeKuttaNyströmIntegrator.*StepByStep                                                                                                                                                                // NOLINT(whitespace/line_length)
+
+// The benchmarks in this executable count the allocations made while they run.
+// They replace the global |operator new|, which is why they are not part of
+// the main benchmarks executable.
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#include "base/not_null.hpp"
+#include "benchmark/benchmark.h"
+#include "geometry/frame.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "integrators/ordinary_differential_equations.hpp"
+#include "integrators/symplectic_runge_kutta_nyström_integrator.hpp"
+#include "glog/logging.h"
+#include "quantities/named_quantities.hpp"
+#include "quantities/si.hpp"
+#include "serialization/physics.pb.h"
+
+namespace {
+
+// The allocation counter active on the current thread, if any.  The benchmarks
+// install one around the loop that they measure.
+thread_local std::int64_t* allocation_counter = nullptr;
+
+// Counts the calls to the global |operator new| made by the current thread for
+// the lifetime of this object.  Used to check that the integrator doesn't
+// allocate once its workspace has been set up.
+class ScopedAllocationCounter {
+ public:
+  ScopedAllocationCounter() : previous_counter_(allocation_counter) {
+    allocation_counter = &allocations_;
+  }
+
+  ~ScopedAllocationCounter() {
+    allocation_counter = previous_counter_;
+  }
+
+  std::int64_t allocations() const {
+    return allocations_;
+  }
+
+ private:
+  std::int64_t allocations_ = 0;
+  std::int64_t* const previous_counter_;
+};
+
+}  // namespace
+
+void* operator new(std::size_t const size) {
+  if (allocation_counter != nullptr) {
+    ++*allocation_counter;
+  }
+  void* const pointer = std::malloc(size == 0 ? 1 : size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete(void* const pointer) noexcept {
+  std::free(pointer);
+}
+
+namespace principia {
+
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Position;
+using geometry::Vector;
+using geometry::Velocity;
+using quantities::Acceleration;
+using quantities::Mass;
+using quantities::Stiffness;
+using quantities::si::Metre;
+using quantities::si::Second;
+using ::std::placeholders::_1;
+using ::std::placeholders::_2;
+using ::std::placeholders::_3;
+
+namespace integrators {
+
+namespace {
+
+using World = Frame<serialization::Frame::TestTag,
+                    serialization::Frame::TEST, true>;
+
+void ComputeHarmonicOscillatorAcceleration3D(
+    Instant const& t,
+    std::vector<Position<World>> const& q,
+    std::vector<Vector<Acceleration, World>>* const result) {
+  (*result)[0] =
+      (World::origin - q[0]) * (SIUnit<Stiffness>() / SIUnit<Mass>());
+}
+
+}  // namespace
+
+// Integrates the harmonic oscillator one step at a time, the way
+// |Ephemeris::Prolong| does, either by resuming an |Instance| or by calling
+// |Solve| afresh for each step.  The label gives the number of allocations per
+// step, which should be 0 when the |Instance| is resumed.
+template<typename Integrator>
+void SolveHarmonicOscillatorStepByStep3D(
+    not_null<benchmark::State*> const state,
+    Integrator const& integrator,
+    bool const resume) {
+  using ODE = SpecialSecondOrderDifferentialEquation<Position<World>>;
+
+  Displacement<World> const q_initial({1 * Metre, 0 * Metre, 0 * Metre});
+  Velocity<World> const v_initial;
+  Instant const t_initial;
+  Time const step = 3.0E-4 * Second;
+
+  ODE harmonic_oscillator;
+  harmonic_oscillator.compute_acceleration =
+      std::bind(ComputeHarmonicOscillatorAcceleration3D, _1, _2, _3);
+  IntegrationProblem<ODE> problem;
+  problem.equation = harmonic_oscillator;
+  ODE::SystemState last_state = {{World::origin + q_initial},
+                                 {v_initial},
+                                 t_initial};
+  problem.initial_state = &last_state;
+  std::int64_t steps = 0;
+  problem.append_state = [&last_state, &steps](ODE::SystemState const& state) {
+    last_state = state;
+    ++steps;
+  };
+  auto const instance = integrator.NewInstance(problem, step);
+
+  // Aiming half a step beyond the next step makes sure that exactly one step
+  // is taken by each call, irrespective of rounding.
+  std::int64_t allocations;
+  {
+    ScopedAllocationCounter const counter;
+    while (state->KeepRunning()) {
+      Instant const t_final = last_state.time.value + 1.5 * step;
+      if (resume) {
+        instance->Solve(t_final);
+      } else {
+        problem.t_final = t_final;
+        integrator.Solve(problem, step);
+      }
+    }
+    allocations = counter.allocations();
+  }
+
+  std::stringstream ss;
+  ss << static_cast<double>(allocations) / steps
+     << " allocations per step";
+  state->SetLabel(ss.str());
+}
+
+template<typename Integrator, Integrator const& (*integrator)()>
+void BM_SymplecticRungeKuttaNyströmIntegratorSolveStepByStep3D(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  SolveHarmonicOscillatorStepByStep3D(&state, integrator(), /*resume=*/false);
+}
+
+template<typename Integrator, Integrator const& (*integrator)()>
+void BM_SymplecticRungeKuttaNyströmIntegratorResumeStepByStep3D(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  SolveHarmonicOscillatorStepByStep3D(&state, integrator(), /*resume=*/true);
+}
+
+BENCHMARK_TEMPLATE2(
+    BM_SymplecticRungeKuttaNyströmIntegratorSolveStepByStep3D,
+    decltype(McLachlanAtela1992Order5Optimal<Position<World>>()),
+    &McLachlanAtela1992Order5Optimal<Position<World>>);
+BENCHMARK_TEMPLATE2(
+    BM_SymplecticRungeKuttaNyströmIntegratorResumeStepByStep3D,
+    decltype(McLachlanAtela1992Order5Optimal<Position<World>>()),
+    &McLachlanAtela1992Order5Optimal<Position<World>>);
+BENCHMARK_TEMPLATE2(
+    BM_SymplecticRungeKuttaNyströmIntegratorSolveStepByStep3D,
+    decltype(BlanesMoan2002SRKN14A<Position<World>>()),
+    &BlanesMoan2002SRKN14A<Position<World>>);
+BENCHMARK_TEMPLATE2(
+    BM_SymplecticRungeKuttaNyströmIntegratorResumeStepByStep3D,
+    decltype(BlanesMoan2002SRKN14A<Position<World>>()),
+    &BlanesMoan2002SRKN14A<Position<World>>);
+
+}  // namespace integrators
+}  // namespace principia
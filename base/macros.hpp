@@ -70,6 +70,13 @@ char const* const kArchitecture = "x86-64";
 #error "Have you tried a Cray-1?"
 #endif
 
+// SSE2 is part of x86-64.  On x86 it is the default for MSVC, and it is
+// enabled by -msse2 for Clang and GCC.
+#if ARCH_CPU_X86_64 || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PRINCIPIA_USE_SSE2_INTRINSICS 1
+#endif
+
 #if defined(CDECL)
 #  error "CDECL already defined"
 #else
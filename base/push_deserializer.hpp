@@ -80,6 +80,13 @@ class PushDeserializer {
   // associated with |bytes| in |done|.
   void Push(Bytes const bytes, std::function<void()> done);
 
+  // Same as |Push|, but copies |bytes| into an internal pool of
+  // |number_of_chunks| buffers of |chunk_size| bytes, which are reused once
+  // their contents have been deserialized.  The client may reclaim any memory
+  // associated with |bytes| as soon as this method returns.  The pool is
+  // allocated on the first call; no allocation takes place afterwards.
+  void PushCopy(Array<std::uint8_t const> const bytes);
+
  private:
   // Obtains the next chunk of data from the internal queue.  Blocks if no data
   // is available.  Used as a callback for the underlying
@@ -104,6 +111,12 @@ class PushDeserializer {
   // from |done_| (and executed) when |Pull| returns.
   std::queue<Bytes> queue_ GUARDED_BY(lock_);
   std::queue<std::function<void()>> done_ GUARDED_BY(lock_);
+
+  // The storage used by |PushCopy| and the buffers that are not currently in
+  // |queue_| or being deserialized.  The buffers are returned to |free_| by
+  // the callbacks in |done_|, which run under |lock_|.
+  std::unique_ptr<std::uint8_t[]> pool_ GUARDED_BY(lock_);
+  std::queue<std::uint8_t*> free_ GUARDED_BY(lock_);
 };
 
 }  // namespace base
@@ -4,6 +4,7 @@
 #include "base/push_deserializer.hpp"
 
 #include <algorithm>
+#include <cstring>
 
 #include "glog/logging.h"
 #include "google/protobuf/io/coded_stream_inl.h"
@@ -153,6 +154,41 @@ inline void PushDeserializer::Push(Bytes const bytes,
   } while (!is_last);
 }
 
+inline void PushDeserializer::PushCopy(
+    Array<std::uint8_t const> const bytes) {
+  CHECK_LE(0, bytes.size);
+  if (bytes.size == 0) {
+    Push(Bytes(), nullptr);
+    return;
+  }
+  Array<std::uint8_t const> current = bytes;
+  while (current.size > 0) {
+    std::int64_t const size =
+        std::min(current.size, static_cast<std::int64_t>(chunk_size_));
+    std::uint8_t* buffer;
+    {
+      std::unique_lock<std::mutex> l(lock_);
+      if (pool_ == nullptr) {
+        pool_ = std::make_unique<std::uint8_t[]>(
+            static_cast<std::size_t>(chunk_size_) * number_of_chunks_);
+        for (int i = 0; i < number_of_chunks_; ++i) {
+          free_.push(&pool_[static_cast<std::size_t>(chunk_size_) * i]);
+        }
+      }
+      // A buffer is freed when |Pull| runs its callback, after which
+      // |queue_has_room_| is notified.
+      queue_has_room_.wait(l, [this]() { return !free_.empty(); });
+      buffer = free_.front();
+      free_.pop();
+    }
+    std::memcpy(buffer, current.data, static_cast<std::size_t>(size));
+    // The callback is run by |Pull| with |lock_| held.
+    Push(Bytes(buffer, size), [this, buffer]() { free_.push(buffer); });
+    current.data = &current.data[size];
+    current.size -= size;
+  }
+}
+
 inline Bytes PushDeserializer::Pull() {
   Bytes result;
   {
@@ -206,6 +206,35 @@ TEST_F(PushDeserializerTest, SerializationDeserialization) {
   }
 }
 
+// Same as above, but the chunks are copied by the deserializer, so the client
+// may overwrite them as soon as they have been pushed.
+TEST_F(PushDeserializerTest, SerializationDeserializationCopy) {
+  for (int i = 0; i < kRunsPerTest; ++i) {
+    auto read_trajectory = make_not_null_unique<DiscreteTrajectory>();
+    auto written_trajectory = BuildTrajectory();
+
+    pull_serializer_ =
+        std::make_unique<PullSerializer>(kSerializerChunkSize, kNumberOfChunks);
+    push_deserializer_ = std::make_unique<PushDeserializer>(
+        kDeserializerChunkSize, kNumberOfChunks);
+
+    pull_serializer_->Start(std::move(written_trajectory));
+    push_deserializer_->Start(
+        std::move(read_trajectory), PushDeserializerTest::CheckSerialization);
+    for (;;) {
+      Bytes const bytes = pull_serializer_->Pull();
+      push_deserializer_->PushCopy(bytes);
+      Stomp(bytes);
+      if (bytes.size == 0) {
+        break;
+      }
+    }
+
+    pull_serializer_.reset();
+    push_deserializer_.reset();
+  }
+}
+
 // Check that deserialization fails if we stomp on one extra bytes.
 TEST_F(PushDeserializerDeathTest, Stomp) {
   EXPECT_DEATH({
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/macros.hpp"
+
+namespace principia {
+namespace base {
+
+// A pool of threads that execute the functions passed to |Add| in the order in
+// which they were added.  The functions must be independent from one another:
+// any synchronization between them is the responsibility of the client.  |T| is
+// the return type of the functions.
+template<typename T>
+class ThreadPool {
+ public:
+  // Constructs a pool with |pool_size| threads, which must be positive.
+  explicit ThreadPool(std::int64_t const pool_size);
+
+  // Waits for all the functions added so far to complete, and stops the
+  // threads.
+  ~ThreadPool();
+
+  // Adds |function| to the queue of functions to be executed.  Returns a future
+  // that becomes ready once |function| has completed and yields its result.
+  std::future<T> Add(std::function<T()> function);
+
+  // Returns the number of threads of this pool.
+  std::int64_t size() const;
+
+  // Returns a reasonable default for the number of threads of a pool: the
+  // number of concurrent threads supported by the hardware, or 1 if it cannot
+  // be determined.
+  static std::int64_t DefaultPoolSize();
+
+ private:
+  // The body of each thread: repeatedly dequeues a function and executes it,
+  // until the pool is shut down and the queue is empty.
+  void DequeueCallAndExecute();
+
+  std::mutex lock_;
+  std::condition_variable has_functions_or_shutdown_;
+  bool shutdown_ GUARDED_BY(lock_) = false;
+  std::deque<std::packaged_task<T()>> functions_ GUARDED_BY(lock_);
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace base
+}  // namespace principia
+
+#include "base/thread_pool_body.hpp"
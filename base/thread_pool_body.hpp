@@ -0,0 +1,77 @@
+#pragma once
+
+#include "base/thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace base {
+
+template<typename T>
+ThreadPool<T>::ThreadPool(std::int64_t const pool_size) {
+  CHECK_LT(0, pool_size);
+  for (std::int64_t i = 0; i < pool_size; ++i) {
+    threads_.emplace_back(&ThreadPool::DequeueCallAndExecute, this);
+  }
+}
+
+template<typename T>
+ThreadPool<T>::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> l(lock_);
+    shutdown_ = true;
+  }
+  has_functions_or_shutdown_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+template<typename T>
+std::future<T> ThreadPool<T>::Add(std::function<T()> function) {
+  std::future<T> result;
+  {
+    std::unique_lock<std::mutex> l(lock_);
+    CHECK(!shutdown_);
+    functions_.emplace_back(std::move(function));
+    result = functions_.back().get_future();
+  }
+  has_functions_or_shutdown_.notify_one();
+  return result;
+}
+
+template<typename T>
+std::int64_t ThreadPool<T>::size() const {
+  return threads_.size();
+}
+
+template<typename T>
+std::int64_t ThreadPool<T>::DefaultPoolSize() {
+  return std::max<std::int64_t>(1, std::thread::hardware_concurrency());
+}
+
+template<typename T>
+void ThreadPool<T>::DequeueCallAndExecute() {
+  for (;;) {
+    std::packaged_task<T()> function;
+    {
+      std::unique_lock<std::mutex> l(lock_);
+      has_functions_or_shutdown_.wait(l, [this]() {
+        return shutdown_ || !functions_.empty();
+      });
+      if (functions_.empty()) {
+        // Shutdown requested and nothing left to execute.
+        return;
+      }
+      function = std::move(functions_.front());
+      functions_.pop_front();
+    }
+    function();
+  }
+}
+
+}  // namespace base
+}  // namespace principia
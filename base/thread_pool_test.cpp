@@ -0,0 +1,89 @@
+#include "base/thread_pool.hpp"
+
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+
+using ::testing::ElementsAre;
+
+namespace base {
+
+class ThreadPoolTest : public ::testing::Test {
+ protected:
+  ThreadPoolTest() : pool_(7) {}
+
+  ThreadPool<void> pool_;
+};
+
+// Check that execution occurs in parallel.  If things were sequential, the
+// integers in |numbers| would be monotonically increasing.
+TEST_F(ThreadPoolTest, ParallelExecution) {
+  static constexpr int number_of_calls = 1000;
+
+  std::mutex lock;
+  std::vector<int> numbers;
+
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < number_of_calls; ++i) {
+    futures.push_back(pool_.Add([i, &lock, &numbers]() {
+      std::this_thread::sleep_for(std::chrono::microseconds(i % 7));
+      std::lock_guard<std::mutex> l(lock);
+      numbers.push_back(i);
+    }));
+  }
+
+  for (auto const& future : futures) {
+    future.wait();
+  }
+
+  EXPECT_EQ(number_of_calls, numbers.size());
+  bool monotonically_increasing = true;
+  for (int i = 1; i < numbers.size(); ++i) {
+    if (numbers[i] < numbers[i - 1]) {
+      monotonically_increasing = false;
+    }
+  }
+  EXPECT_FALSE(monotonically_increasing);
+}
+
+// Check that the results of the functions are returned through the futures.
+TEST_F(ThreadPoolTest, Results) {
+  ThreadPool<int> pool(3);
+  EXPECT_EQ(3, pool.size());
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 4; ++i) {
+    futures.push_back(pool.Add([i]() { return i * i; }));
+  }
+  std::vector<int> results;
+  for (auto& future : futures) {
+    results.push_back(future.get());
+  }
+  EXPECT_THAT(results, ElementsAre(0, 1, 4, 9));
+}
+
+// Check that the destructor waits for the functions already added.
+TEST_F(ThreadPoolTest, Destruction) {
+  std::mutex lock;
+  std::set<int> numbers;
+  {
+    ThreadPool<void> pool(2);
+    for (int i = 0; i < 10; ++i) {
+      pool.Add([i, &lock, &numbers]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> l(lock);
+        numbers.insert(i);
+      });
+    }
+  }
+  EXPECT_EQ(10, numbers.size());
+}
+
+}  // namespace base
+}  // namespace principia
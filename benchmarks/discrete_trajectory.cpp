@@ -0,0 +1,134 @@
+// .\Release\x64\benchmarks.exe --benchmark_filter=DiscreteTrajectory --benchmark_repetitions=5  // NOLINT(whitespace/line_length)
+
+#include "base/not_null.hpp"
+#include "geometry/frame.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "physics/discrete_trajectory.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+
+// This must come last because apparently it redefines CDECL.
+#include "benchmark/benchmark.h"
+
+namespace principia {
+
+using base::not_null;
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Velocity;
+using quantities::Time;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+namespace physics {
+
+namespace {
+
+using World = Frame<serialization::Frame::TestTag,
+                    serialization::Frame::TEST, true>;
+
+Time const Δt = 10 * Second;
+
+void FillTrajectory(int const steps,
+                    not_null<DiscreteTrajectory<World>*> const trajectory) {
+  Velocity<World> const velocity({1 * Metre / Second,
+                                  2 * Metre / Second,
+                                  3 * Metre / Second});
+  for (int i = 0; i < steps; ++i) {
+    Time const iΔt = i * Δt;
+    trajectory->Append(Instant() + iΔt,
+                       DegreesOfFreedom<World>(World::origin + velocity * iΔt,
+                                               velocity));
+  }
+}
+
+}  // namespace
+
+void BM_DiscreteTrajectoryAppend(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  int const steps = state.range_x();
+  while (state.KeepRunning()) {
+    DiscreteTrajectory<World> trajectory;
+    FillTrajectory(steps, &trajectory);
+  }
+  state.SetItemsProcessed(state.iterations() * steps);
+}
+
+void BM_DiscreteTrajectoryIterate(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  int const steps = state.range_x();
+  DiscreteTrajectory<World> trajectory;
+  FillTrajectory(steps, &trajectory);
+  while (state.KeepRunning()) {
+    Displacement<World> sum;
+    for (auto it = trajectory.Begin(); it != trajectory.End(); ++it) {
+      sum += it.degrees_of_freedom().position() - World::origin;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * steps);
+}
+
+void BM_DiscreteTrajectoryFind(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  int const steps = state.range_x();
+  DiscreteTrajectory<World> trajectory;
+  FillTrajectory(steps, &trajectory);
+  while (state.KeepRunning()) {
+    for (int i = 0; i < steps; i += 7) {
+      auto const it = trajectory.Find(Instant() + i * Δt);
+      benchmark::DoNotOptimize(it);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * ((steps + 6) / 7));
+}
+
+// The pattern of the predictions: a fork is created at the end of the
+// trajectory, extended, and deleted.
+void BM_DiscreteTrajectoryForkAppendDelete(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  int const steps = state.range_x();
+  DiscreteTrajectory<World> trajectory;
+  FillTrajectory(10, &trajectory);
+  Velocity<World> const velocity({1 * Metre / Second,
+                                  2 * Metre / Second,
+                                  3 * Metre / Second});
+  while (state.KeepRunning()) {
+    DiscreteTrajectory<World>* fork = trajectory.NewForkAtLast();
+    for (int i = 10; i < steps + 10; ++i) {
+      Time const iΔt = i * Δt;
+      fork->Append(Instant() + iΔt,
+                   DegreesOfFreedom<World>(World::origin + velocity * iΔt,
+                                           velocity));
+    }
+    trajectory.DeleteFork(&fork);
+  }
+  state.SetItemsProcessed(state.iterations() * steps);
+}
+
+void BM_DiscreteTrajectoryNewForkWithCopy(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  int const steps = state.range_x();
+  DiscreteTrajectory<World> trajectory;
+  FillTrajectory(steps, &trajectory);
+  Instant const fork_time = Instant() + (steps / 2) * Δt;
+  while (state.KeepRunning()) {
+    DiscreteTrajectory<World>* fork = trajectory.NewForkWithCopy(fork_time);
+    trajectory.DeleteFork(&fork);
+  }
+  state.SetItemsProcessed(state.iterations() * (steps - steps / 2));
+}
+
+BENCHMARK(BM_DiscreteTrajectoryAppend)->Arg(1 << 10)->Arg(1 << 17);
+BENCHMARK(BM_DiscreteTrajectoryIterate)->Arg(1 << 10)->Arg(1 << 17);
+BENCHMARK(BM_DiscreteTrajectoryFind)->Arg(1 << 10)->Arg(1 << 17);
+BENCHMARK(BM_DiscreteTrajectoryForkAppendDelete)
+    ->Arg(1 << 10)->Arg(1 << 17);
+BENCHMARK(BM_DiscreteTrajectoryNewForkWithCopy)->Arg(1 << 10)->Arg(1 << 17);
+
+}  // namespace physics
+}  // namespace principia
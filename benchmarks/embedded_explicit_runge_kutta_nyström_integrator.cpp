@@ -1,5 +1,6 @@
 ﻿
 // .\Release\x64\benchmarks.exe --benchmark_repetitions=5 --benchmark_min_time=5 --benchmark_filter=EmbeddedExplicitRungeKuttaNyströmIntegratorSolveHarmonicOscillator                                                                                                                 // NOLINT(whitespace/line_length)
+// .\Release\x64\benchmarks.exe --benchmark_repetitions=5 --benchmark_filter=EmbeddedExplicitRungeKuttaNyströmIntegratorSolveHarmonicOscillator1D(TypeErased|Inlined)                                                                                                                 // NOLINT(whitespace/line_length)
 
 #define GLOG_NO_ABBREVIATED_SEVERITIES
 
@@ -230,6 +231,87 @@ void BM_EmbeddedExplicitRungeKuttaNyströmIntegratorSolveHarmonicOscillator3D(
   state.SetLabel(ss.str());
 }
 
+// Integrates the 1D harmonic oscillator keeping only the final position,
+// either through the |std::function|s of the |IntegrationProblem| and of the
+// |AdaptiveStepSize| or by passing to |Solve| callables that the compiler can
+// inline.
+template<typename Integrator>
+void SolveHarmonicOscillator1D(Integrator const& integrator,
+                               bool const type_erased,
+                               not_null<Length*> const q_final) {
+  using ODE = SpecialSecondOrderDifferentialEquation<Length>;
+
+  Length const q_initial = 1 * Metre;
+  Speed const v_initial;
+  Instant const t_initial;
+  Instant const t_final = t_initial + 1000 * Second;
+  Length const length_tolerance = 1e-9 * Metre;
+  Speed const speed_tolerance = 1e-9 * Metre / Second;
+
+  auto const compute_acceleration =
+      [](Instant const& t,
+         std::vector<Length> const& q,
+         std::vector<Acceleration>* const result) {
+        ComputeHarmonicOscillatorAcceleration1D(t, q, result);
+      };
+  auto const append_state = [q_final](ODE::SystemState const& state) {
+    *q_final = state.positions[0].value;
+  };
+  auto const tolerance_to_error_ratio =
+      [length_tolerance, speed_tolerance](
+          Time const& h,
+          ODE::SystemStateError const& error) {
+        return HarmonicOscillatorToleranceRatio1D<ODE>(
+            h, error, length_tolerance, speed_tolerance);
+      };
+
+  IntegrationProblem<ODE> problem;
+  ODE::SystemState const initial_state = {{q_initial}, {v_initial}, t_initial};
+  problem.initial_state = &initial_state;
+  problem.t_final = t_final;
+
+  AdaptiveStepSize<ODE> adaptive_step_size;
+  adaptive_step_size.first_time_step = t_final - t_initial;
+  adaptive_step_size.safety_factor = 0.9;
+
+  if (type_erased) {
+    problem.equation.compute_acceleration = compute_acceleration;
+    problem.append_state = append_state;
+    adaptive_step_size.tolerance_to_error_ratio = tolerance_to_error_ratio;
+    integrator.Solve(problem, adaptive_step_size);
+  } else {
+    integrator.Solve(problem,
+                     adaptive_step_size,
+                     compute_acceleration,
+                     append_state,
+                     tolerance_to_error_ratio);
+  }
+}
+
+template<typename Integrator, Integrator const& (*integrator)()>
+void BM_EmbeddedExplicitRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DTypeErased(  // NOLINT(whitespace/line_length)
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  Length q_final;
+  while (state.KeepRunning()) {
+    SolveHarmonicOscillator1D(integrator(), /*type_erased=*/true, &q_final);
+  }
+  std::stringstream ss;
+  ss << q_final;
+  state.SetLabel(ss.str());
+}
+
+template<typename Integrator, Integrator const& (*integrator)()>
+void BM_EmbeddedExplicitRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DInlined(  // NOLINT(whitespace/line_length)
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  Length q_final;
+  while (state.KeepRunning()) {
+    SolveHarmonicOscillator1D(integrator(), /*type_erased=*/false, &q_final);
+  }
+  std::stringstream ss;
+  ss << q_final;
+  state.SetLabel(ss.str());
+}
+
 // Keep each argument on a single line below, lest it breaks benchmark parsing.
 
 BENCHMARK_TEMPLATE2(
@@ -242,5 +324,14 @@ BENCHMARK_TEMPLATE2(
     decltype(DormandElMikkawyPrince1986RKN434FM<Position<World>>()),
     &DormandElMikkawyPrince1986RKN434FM<Position<World>>);
 
+BENCHMARK_TEMPLATE2(
+    BM_EmbeddedExplicitRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DTypeErased,  // NOLINT(whitespace/line_length)
+    decltype(DormandElMikkawyPrince1986RKN434FM<Length>()),
+    &DormandElMikkawyPrince1986RKN434FM<Length>);
+BENCHMARK_TEMPLATE2(
+    BM_EmbeddedExplicitRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DInlined,  // NOLINT(whitespace/line_length)
+    decltype(DormandElMikkawyPrince1986RKN434FM<Length>()),
+    &DormandElMikkawyPrince1986RKN434FM<Length>);
+
 }  // namespace integrators
 }  // namespace principia
@@ -50,24 +50,32 @@
 // BM_EphemerisLEOProbeAllBodiesAndOblateness_mean      10180320715 10176465233          1                                 750001 steps, +9.99958277683878570e-01 ua, +9.99468831450655270e+01 nmi  // NOLINT(whitespace/line_length)
 // BM_EphemerisLEOProbeAllBodiesAndOblateness_stddev        4477703    14707915          0                                 750001 steps, +9.99958277683878570e-01 ua, +9.99468831450655270e+01 nmi  // NOLINT(whitespace/line_length)
 
+#include <experimental/filesystem>
 #include <limits>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "astronomy/frames.hpp"
 #include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/named_quantities.hpp"
 #include "geometry/quaternion.hpp"
+#include "geometry/r3_element.hpp"
 #include "geometry/rotation.hpp"
 #include "integrators/embedded_explicit_runge_kutta_nyström_integrator.hpp"
 #include "integrators/symplectic_runge_kutta_nyström_integrator.hpp"
 #include "physics/degrees_of_freedom.hpp"
 #include "physics/discrete_trajectory.hpp"
 #include "physics/ephemeris.hpp"
+#include "physics/ephemeris_cache.hpp"
 #include "physics/massless_body.hpp"
+#include "physics/solar_system.hpp"
 #include "quantities/astronomy.hpp"
 #include "quantities/bipm.hpp"
 #include "quantities/elementary_functions.hpp"
+#include "quantities/named_quantities.hpp"
 #include "quantities/numbers.hpp"
 #include "quantities/quantities.hpp"
 #include "quantities/si.hpp"
@@ -82,16 +90,22 @@ using astronomy::ICRFJ2000Ecliptic;
 using astronomy::ICRFJ2000Equator;
 using astronomy::kEquatorialToEcliptic;
 using base::not_null;
+using base::ThreadPool;
 using geometry::Position;
 using geometry::Quaternion;
+using geometry::R3Element;
 using geometry::Rotation;
 using integrators::DormandElMikkawyPrince1986RKN434FM;
 using integrators::McLachlanAtela1992Order5Optimal;
 using quantities::DebugString;
+using quantities::GravitationalParameter;
+using quantities::Length;
+using quantities::SIUnit;
 using quantities::Sqrt;
 using quantities::astronomy::JulianYear;
 using quantities::bipm::NauticalMile;
 using quantities::si::AstronomicalUnit;
+using quantities::si::Day;
 using quantities::si::Kilo;
 using quantities::si::Metre;
 using quantities::si::Milli;
@@ -102,6 +116,28 @@ namespace physics {
 
 namespace {
 
+// The ephemerides used by the probe benchmarks take much longer to compute than
+// the integrations being measured, so they are kept in an |EphemerisCache|, one
+// per |accuracy|.  The cache files are named
+// principia_benchmark_ephemeris_<accuracy>.cache and are created in the
+// temporary directory of the system; they may be deleted at any time.
+not_null<std::unique_ptr<Ephemeris<ICRFJ2000Equator>>> MakeCachedEphemeris(
+    SolarSystemFactory::Accuracy const accuracy,
+    not_null<SolarSystem<ICRFJ2000Equator>*> const solar_system,
+    Instant const& final_time) {
+  EphemerisCache<ICRFJ2000Equator> cache(
+      std::experimental::filesystem::temp_directory_path() /
+          ("principia_benchmark_ephemeris_" +
+           std::to_string(static_cast<int>(accuracy)) + ".cache"),
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/45 * Minute));
+  auto ephemeris = cache.MakeEphemeris(solar_system);
+  cache.Prolong(final_time, ephemeris.get());
+  return std::move(ephemeris);
+}
+
 void EphemerisSolarSystemBenchmark(SolarSystemFactory::Accuracy const accuracy,
                                    not_null<benchmark::State*> const state) {
   Length error;
@@ -135,6 +171,37 @@ void EphemerisSolarSystemBenchmark(SolarSystemFactory::Accuracy const accuracy,
   state->SetLabel(quantities::DebugString(error / AstronomicalUnit) + " ua");
 }
 
+// Measures the computation of the mutual accelerations of the spherical bodies
+// done at each evaluation by |Prolong|, for the bodies of the solar system at
+// the launch of Спутник 1.  The oblateness, if any, is ignored.  An item is a
+// pair of bodies.
+void EphemerisSphericalBodiesAccelerationsBenchmark(
+    SolarSystemFactory::Accuracy const accuracy,
+    not_null<benchmark::State*> const state) {
+  auto const at_спутник_1_launch =
+      SolarSystemFactory::AtСпутник1Launch(accuracy);
+  internal::SphericalBodiesArrays arrays;
+  for (auto const& name : at_спутник_1_launch->names()) {
+    R3Element<Length> const q =
+        (at_спутник_1_launch->initial_state(name).position() -
+         ICRFJ2000Equator::origin).coordinates();
+    arrays.μ.push_back(at_спутник_1_launch->gravitational_parameter(name) /
+                       SIUnit<GravitationalParameter>());
+    arrays.x.push_back(q.x / SIUnit<Length>());
+    arrays.y.push_back(q.y / SIUnit<Length>());
+    arrays.z.push_back(q.z / SIUnit<Length>());
+  }
+  std::int64_t const size = arrays.μ.size();
+  arrays.ax.resize(size);
+  arrays.ay.resize(size);
+  arrays.az.resize(size);
+
+  while (state->KeepRunning()) {
+    internal::ComputeGravitationalAccelerationsBetweenSphericalBodies(&arrays);
+  }
+  state->SetItemsProcessed(state->iterations() * size * (size - 1) / 2);
+}
+
 void EphemerisL4ProbeBenchmark(SolarSystemFactory::Accuracy const accuracy,
                                not_null<benchmark::State*> const state) {
   Length sun_error;
@@ -146,13 +213,7 @@ void EphemerisL4ProbeBenchmark(SolarSystemFactory::Accuracy const accuracy,
   Instant const final_time = at_спутник_1_launch->epoch() + 100 * JulianYear;
 
   auto const ephemeris =
-      at_спутник_1_launch->MakeEphemeris(
-          /*fitting_tolerance=*/5 * Milli(Metre),
-          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
-              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
-              /*step=*/45 * Minute));
-
-  ephemeris->Prolong(final_time);
+      MakeCachedEphemeris(accuracy, at_спутник_1_launch.get(), final_time);
 
   while (state->KeepRunning()) {
     state->PauseTiming();
@@ -234,13 +295,7 @@ void EphemerisLEOProbeBenchmark(SolarSystemFactory::Accuracy const accuracy,
   Instant const final_time = at_спутник_1_launch->epoch() + 1 * JulianYear;
 
   auto const ephemeris =
-      at_спутник_1_launch->MakeEphemeris(
-          /*fitting_tolerance=*/5 * Milli(Metre),
-          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
-              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
-              /*step=*/45 * Minute));
-
-  ephemeris->Prolong(final_time);
+      MakeCachedEphemeris(accuracy, at_спутник_1_launch.get(), final_time);
 
   while (state->KeepRunning()) {
     state->PauseTiming();
@@ -303,6 +358,93 @@ void EphemerisLEOProbeBenchmark(SolarSystemFactory::Accuracy const accuracy,
                   " nmi");
 }
 
+// Flows |state.range_x()| probes in low earth orbit for one day, in parallel.
+void EphemerisLEOProbesInParallelBenchmark(
+    SolarSystemFactory::Accuracy const accuracy,
+    not_null<benchmark::State*> const state) {
+  int const number_of_probes = state->range_x();
+  Length error;
+  int steps;
+
+  auto const at_спутник_1_launch =
+      SolarSystemFactory::AtСпутник1Launch(accuracy);
+  Instant const final_time = at_спутник_1_launch->epoch() + 1 * Day;
+
+  auto const ephemeris =
+      MakeCachedEphemeris(accuracy, at_спутник_1_launch.get(), final_time);
+
+  ThreadPool<bool> thread_pool(ThreadPool<bool>::DefaultPoolSize());
+  Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters const parameters(
+      DormandElMikkawyPrince1986RKN434FM<Position<ICRFJ2000Equator>>(),
+      /*max_steps=*/std::numeric_limits<std::int64_t>::max(),
+      /*length_integration_tolerance=*/1 * Metre,
+      /*speed_integration_tolerance=*/1 * Metre / Second);
+
+  while (state->KeepRunning()) {
+    state->PauseTiming();
+    // Probes in low earth orbit, at various longitudes.
+    DegreesOfFreedom<ICRFJ2000Equator> const earth_degrees_of_freedom =
+        at_спутник_1_launch->initial_state(
+            SolarSystemFactory::name(SolarSystemFactory::kEarth));
+    Length const earth_probe_distance = 6371 * Kilo(Metre) + 100 * NauticalMile;
+    Speed const earth_probe_speed =
+        Sqrt(at_спутник_1_launch->gravitational_parameter(
+                 SolarSystemFactory::name(SolarSystemFactory::kEarth)) /
+                     earth_probe_distance);
+    std::vector<DiscreteTrajectory<ICRFJ2000Equator>> probe_trajectories(
+        number_of_probes);
+    std::vector<not_null<DiscreteTrajectory<ICRFJ2000Equator>*>> trajectories;
+    for (int i = 0; i < number_of_probes; ++i) {
+      double const longitude = 2 * π * i / number_of_probes;
+      Displacement<ICRFJ2000Equator> const earth_probe_displacement(
+          {earth_probe_distance * cos(longitude),
+           earth_probe_distance * sin(longitude),
+           0 * Metre});
+      Velocity<ICRFJ2000Equator> const earth_probe_velocity(
+          {-earth_probe_speed * sin(longitude),
+           earth_probe_speed * cos(longitude),
+           0 * Metre / Second});
+      probe_trajectories[i].Append(
+          at_спутник_1_launch->epoch(),
+          DegreesOfFreedom<ICRFJ2000Equator>(
+              earth_degrees_of_freedom.position() + earth_probe_displacement,
+              earth_degrees_of_freedom.velocity() + earth_probe_velocity));
+      trajectories.push_back(&probe_trajectories[i]);
+    }
+
+    state->ResumeTiming();
+    ephemeris->FlowWithAdaptiveStepInParallel(
+        trajectories,
+        Ephemeris<ICRFJ2000Equator>::IntrinsicAccelerations(
+            number_of_probes,
+            Ephemeris<ICRFJ2000Equator>::kNoIntrinsicAcceleration),
+        final_time,
+        std::vector<Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters>(
+            number_of_probes, parameters),
+        Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps,
+        &thread_pool);
+    state->PauseTiming();
+
+    error = (at_спутник_1_launch->trajectory(
+                 *ephemeris,
+                 SolarSystemFactory::name(SolarSystemFactory::kEarth)).
+                     EvaluatePosition(final_time, nullptr) -
+             probe_trajectories[0].last().degrees_of_freedom().position()).
+                 Norm();
+    steps = 0;
+    for (auto const& trajectory : probe_trajectories) {
+      steps += trajectory.Size();
+    }
+    state->ResumeTiming();
+  }
+  std::stringstream ss;
+  ss << steps;
+  state->SetLabel(ss.str() + " steps, " +
+                  quantities::DebugString((error - 6371 * Kilo(Metre)) /
+                                          NauticalMile) +
+                  " nmi");
+}
+
 }  // namespace
 
 void BM_EphemerisSolarSystemMajorBodiesOnly(
@@ -325,6 +467,20 @@ void BM_EphemerisSolarSystemAllBodiesAndOblateness(
       &state);
 }
 
+void BM_EphemerisSphericalBodiesAccelerationsMajorBodiesOnly(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  EphemerisSphericalBodiesAccelerationsBenchmark(
+      SolarSystemFactory::Accuracy::kMajorBodiesOnly,
+      &state);
+}
+
+void BM_EphemerisSphericalBodiesAccelerationsMinorAndMajorBodies(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  EphemerisSphericalBodiesAccelerationsBenchmark(
+      SolarSystemFactory::Accuracy::kMinorAndMajorBodies,
+      &state);
+}
+
 void BM_EphemerisL4ProbeMajorBodiesOnly(
     benchmark::State& state) {  // NOLINT(runtime/references)
   EphemerisL4ProbeBenchmark(SolarSystemFactory::Accuracy::kMajorBodiesOnly,
@@ -363,15 +519,26 @@ void BM_EphemerisLEOProbeAllBodiesAndOblateness(
       &state);
 }
 
+void BM_EphemerisLEOProbesInParallelMajorBodiesOnly(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  EphemerisLEOProbesInParallelBenchmark(
+      SolarSystemFactory::Accuracy::kMajorBodiesOnly,
+      &state);
+}
+
 BENCHMARK(BM_EphemerisSolarSystemMajorBodiesOnly);
 BENCHMARK(BM_EphemerisSolarSystemMinorAndMajorBodies);
 BENCHMARK(BM_EphemerisSolarSystemAllBodiesAndOblateness);
+BENCHMARK(BM_EphemerisSphericalBodiesAccelerationsMajorBodiesOnly);
+BENCHMARK(BM_EphemerisSphericalBodiesAccelerationsMinorAndMajorBodies);
 BENCHMARK(BM_EphemerisL4ProbeMajorBodiesOnly);
 BENCHMARK(BM_EphemerisL4ProbeMinorAndMajorBodies);
 BENCHMARK(BM_EphemerisL4ProbeAllBodiesAndOblateness);
 BENCHMARK(BM_EphemerisLEOProbeMajorBodiesOnly);
 BENCHMARK(BM_EphemerisLEOProbeMinorAndMajorBodies);
 BENCHMARK(BM_EphemerisLEOProbeAllBodiesAndOblateness);
+BENCHMARK(BM_EphemerisLEOProbesInParallelMajorBodiesOnly)->
+    Arg(1)->Arg(8)->Arg(64)->Arg(512);
 
 }  // namespace physics
 }  // namespace principia
@@ -0,0 +1,153 @@
+// .\Release\x64\benchmarks.exe --benchmark_filter=Kepler --benchmark_repetitions=5  // NOLINT(whitespace/line_length)
+
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "geometry/named_quantities.hpp"
+#include "numerics/root_finders.hpp"
+#include "physics/kepler_orbit.hpp"
+#include "physics/massive_body.hpp"
+#include "physics/massless_body.hpp"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+
+// This must come last because apparently it redefines CDECL.
+#include "benchmark/benchmark.h"
+
+namespace principia {
+
+using geometry::Frame;
+using geometry::Instant;
+using numerics::Bisect;
+using quantities::Angle;
+using quantities::GravitationalParameter;
+using quantities::Sin;
+using quantities::si::Degree;
+using quantities::si::Metre;
+using quantities::si::Radian;
+using quantities::si::Second;
+
+namespace physics {
+
+namespace {
+
+using World = Frame<serialization::Frame::TestTag,
+                    serialization::Frame::TEST, true>;
+
+// The eccentricity for the argument of the benchmark, which is in thousandths.
+double Eccentricity(benchmark::State const& state) {
+  return state.range_x() / 1000.0;
+}
+
+std::vector<Angle> MeanAnomalies() {
+  int const count = 1000;
+  std::vector<Angle> mean_anomalies;
+  for (int i = 0; i < count; ++i) {
+    mean_anomalies.push_back((-π + 2 * π * (i + 0.5) / count) * Radian);
+  }
+  return mean_anomalies;
+}
+
+// The solution of Kepler's equation used by |KeplerOrbit| before the
+// introduction of |EllipticEccentricAnomaly|.
+Angle BisectionEccentricAnomaly(double const eccentricity,
+                                Angle const& mean_anomaly) {
+  auto const kepler_equation =
+      [eccentricity, mean_anomaly](Angle const& eccentric_anomaly) -> Angle {
+        return mean_anomaly -
+                   (eccentric_anomaly -
+                    eccentricity * Sin(eccentric_anomaly) * Radian);
+      };
+  return eccentricity == 0
+             ? mean_anomaly
+             : Bisect(kepler_equation,
+                      mean_anomaly - eccentricity * Radian,
+                      mean_anomaly + eccentricity * Radian);
+}
+
+KeplerOrbit<World> MakeOrbit(double const eccentricity) {
+  MassiveBody const primary(1 * SIUnit<GravitationalParameter>());
+  MasslessBody const secondary;
+  KeplerianElements<World> elements;
+  elements.eccentricity = eccentricity;
+  elements.semimajor_axis = 1 * Metre;
+  elements.inclination = 10 * Degree;
+  elements.longitude_of_ascending_node = 20 * Degree;
+  elements.argument_of_periapsis = 30 * Degree;
+  elements.mean_anomaly = 40 * Degree;
+  return KeplerOrbit<World>(primary, secondary, elements, Instant());
+}
+
+// Times spanning one period of the orbit made by |MakeOrbit|.
+std::vector<Instant> Times() {
+  int const count = 1000;
+  std::vector<Instant> times;
+  for (int i = 0; i < count; ++i) {
+    times.push_back(Instant() + 2 * π * i / count * Second);
+  }
+  return times;
+}
+
+}  // namespace
+
+void BM_KeplerEquationBisection(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  double const eccentricity = Eccentricity(state);
+  std::vector<Angle> const mean_anomalies = MeanAnomalies();
+  while (state.KeepRunning()) {
+    Angle sum;
+    for (Angle const& mean_anomaly : mean_anomalies) {
+      sum += BisectionEccentricAnomaly(eccentricity, mean_anomaly);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * mean_anomalies.size());
+}
+
+void BM_KeplerEquationHalley(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  double const eccentricity = Eccentricity(state);
+  std::vector<Angle> const mean_anomalies = MeanAnomalies();
+  while (state.KeepRunning()) {
+    Angle sum;
+    for (Angle const& mean_anomaly : mean_anomalies) {
+      sum += EllipticEccentricAnomaly(eccentricity, mean_anomaly);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * mean_anomalies.size());
+}
+
+void BM_KeplerOrbitStateVectors(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  KeplerOrbit<World> const orbit = MakeOrbit(Eccentricity(state));
+  std::vector<Instant> const times = Times();
+  while (state.KeepRunning()) {
+    for (Instant const& t : times) {
+      benchmark::DoNotOptimize(orbit.StateVectors(t));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+
+void BM_KeplerOrbitBatchedStateVectors(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  KeplerOrbit<World> const orbit = MakeOrbit(Eccentricity(state));
+  std::vector<Instant> const times = Times();
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(orbit.StateVectors(times));
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+
+BENCHMARK(BM_KeplerEquationBisection)
+    ->Arg(10)->Arg(100)->Arg(500)->Arg(900)->Arg(990)->Arg(999);
+BENCHMARK(BM_KeplerEquationHalley)
+    ->Arg(10)->Arg(100)->Arg(500)->Arg(900)->Arg(990)->Arg(999);
+BENCHMARK(BM_KeplerOrbitStateVectors)->Arg(100)->Arg(900);
+BENCHMARK(BM_KeplerOrbitBatchedStateVectors)->Arg(100)->Arg(900);
+
+}  // namespace physics
+}  // namespace principia
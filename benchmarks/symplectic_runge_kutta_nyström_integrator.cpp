@@ -1,5 +1,6 @@
 ﻿
 // .\Release\x64\benchmarks.exe --benchmark_repetitions=5 --benchmark_min_time=5 --benchmark_filter=SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator                                                                                                                 // NOLINT(whitespace/line_length)
+// .\Release\x64\benchmarks.exe --benchmark_repetitions=5 --benchmark_filter=SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator1D(TypeErased|Inlined)                                                                                                                     // NOLINT(whitespace/line_length)
 
 #define GLOG_NO_ABBREVIATED_SEVERITIES
 
@@ -179,6 +180,48 @@ void SolveHarmonicOscillatorAndComputeError3D(
   state->ResumeTiming();
 }
 
+// Integrates the 1D harmonic oscillator keeping only the final position,
+// either through the |std::function|s of the |IntegrationProblem| or by
+// passing to |Solve| callables that the compiler can inline.
+template<typename Integrator>
+void SolveHarmonicOscillator1D(Integrator const& integrator,
+                               bool const type_erased,
+                               not_null<Length*> const q_final) {
+  using ODE = SpecialSecondOrderDifferentialEquation<Length>;
+
+  Length const q_initial = 1 * Metre;
+  Speed const v_initial;
+  Instant const t_initial;
+#ifdef _DEBUG
+  Instant const t_final = t_initial + 100 * Second;
+#else
+  Instant const t_final = t_initial + 1000 * Second;
+#endif
+  Time const step = 3.0E-4 * Second;
+
+  auto const compute_acceleration =
+      [](Instant const& t,
+         std::vector<Length> const& q,
+         std::vector<Acceleration>* const result) {
+        ComputeHarmonicOscillatorAcceleration1D(t, q, result);
+      };
+  auto const append_state = [q_final](ODE::SystemState const& state) {
+    *q_final = state.positions[0].value;
+  };
+
+  IntegrationProblem<ODE> problem;
+  ODE::SystemState const initial_state = {{q_initial}, {v_initial}, t_initial};
+  problem.initial_state = &initial_state;
+  problem.t_final = t_final;
+  if (type_erased) {
+    problem.equation.compute_acceleration = compute_acceleration;
+    problem.append_state = append_state;
+    integrator.Solve(problem, step);
+  } else {
+    integrator.Solve(problem, step, compute_acceleration, append_state);
+  }
+}
+
 template<typename Integrator, Integrator const& (*integrator)()>
 void BM_SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator1D(
     benchmark::State& state) {  // NOLINT(runtime/references)
@@ -207,6 +250,30 @@ void BM_SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator3D(
   state.SetLabel(ss.str());
 }
 
+template<typename Integrator, Integrator const& (*integrator)()>
+void BM_SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DTypeErased(  // NOLINT(whitespace/line_length)
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  Length q_final;
+  while (state.KeepRunning()) {
+    SolveHarmonicOscillator1D(integrator(), /*type_erased=*/true, &q_final);
+  }
+  std::stringstream ss;
+  ss << q_final;
+  state.SetLabel(ss.str());
+}
+
+template<typename Integrator, Integrator const& (*integrator)()>
+void BM_SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DInlined(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  Length q_final;
+  while (state.KeepRunning()) {
+    SolveHarmonicOscillator1D(integrator(), /*type_erased=*/false, &q_final);
+  }
+  std::stringstream ss;
+  ss << q_final;
+  state.SetLabel(ss.str());
+}
+
 BENCHMARK_TEMPLATE2(
     BM_SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator1D,
     decltype(McLachlanAtela1992Order4Optimal<Length>()),
@@ -273,5 +340,22 @@ BENCHMARK_TEMPLATE2(
     decltype(BlanesMoan2002SRKN14A<Position<World>>()),
     &BlanesMoan2002SRKN14A<Position<World>>);
 
+BENCHMARK_TEMPLATE2(
+    BM_SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DTypeErased,
+    decltype(McLachlanAtela1992Order5Optimal<Length>()),
+    &McLachlanAtela1992Order5Optimal<Length>);
+BENCHMARK_TEMPLATE2(
+    BM_SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DInlined,
+    decltype(McLachlanAtela1992Order5Optimal<Length>()),
+    &McLachlanAtela1992Order5Optimal<Length>);
+BENCHMARK_TEMPLATE2(
+    BM_SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DTypeErased,
+    decltype(BlanesMoan2002SRKN14A<Length>()),
+    &BlanesMoan2002SRKN14A<Length>);
+BENCHMARK_TEMPLATE2(
+    BM_SymplecticRungeKuttaNyströmIntegratorSolveHarmonicOscillator1DInlined,
+    decltype(BlanesMoan2002SRKN14A<Length>()),
+    &BlanesMoan2002SRKN14A<Length>);
+
 }  // namespace integrators
 }  // namespace principia
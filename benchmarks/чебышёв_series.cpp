@@ -43,6 +43,7 @@ namespace principia {
 
 using astronomy::ICRFJ2000Ecliptic;
 using geometry::Displacement;
+using geometry::Velocity;
 using quantities::Length;
 using quantities::si::Metre;
 using quantities::si::Second;
@@ -217,6 +218,125 @@ void BM_EvaluateDisplacement(
   state.SetLabel(ss.str().substr(0, 0));
 }
 
+void BM_EvaluateManyDisplacement(
+  benchmark::State& state) {  // NOLINT(runtime/references)
+  int const degree = state.range_x();
+  std::mt19937_64 random(42);
+  std::vector<Displacement<ICRFJ2000Ecliptic>> coefficients;
+  for (int i = 0; i <= degree; ++i) {
+    coefficients.push_back(
+        Displacement<ICRFJ2000Ecliptic>(
+            {static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre}));
+  }
+  Instant const t0;
+  Instant const t_min = t0 + static_cast<double>(random()) * Second;
+  Instant const t_max = t_min + static_cast<double>(random()) * Second;
+  ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>> const series(
+    coefficients, t_min, t_max);
+
+  Instant t = t_min;
+  Time const Δt = (t_max - t_min) * 1E-9;
+  std::vector<Instant> times(kEvaluationsPerIteration);
+  std::vector<Displacement<ICRFJ2000Ecliptic>> values;
+  Displacement<ICRFJ2000Ecliptic> result{};
+
+  while (state.KeepRunning()) {
+    for (int i = 0; i < kEvaluationsPerIteration; ++i) {
+      times[i] = t;
+      t += Δt;
+    }
+    series.EvaluateMany(times, &values);
+    result += values.back();
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
+void BM_EvaluateDisplacementAndDerivative(
+  benchmark::State& state) {  // NOLINT(runtime/references)
+  int const degree = state.range_x();
+  std::mt19937_64 random(42);
+  std::vector<Displacement<ICRFJ2000Ecliptic>> coefficients;
+  for (int i = 0; i <= degree; ++i) {
+    coefficients.push_back(
+        Displacement<ICRFJ2000Ecliptic>(
+            {static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre}));
+  }
+  Instant const t0;
+  Instant const t_min = t0 + static_cast<double>(random()) * Second;
+  Instant const t_max = t_min + static_cast<double>(random()) * Second;
+  ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>> const series(
+    coefficients, t_min, t_max);
+
+  Instant t = t_min;
+  Time const Δt = (t_max - t_min) * 1E-9;
+  Displacement<ICRFJ2000Ecliptic> result{};
+  Velocity<ICRFJ2000Ecliptic> derivative_result{};
+
+  while (state.KeepRunning()) {
+    for (int i = 0; i < kEvaluationsPerIteration; ++i) {
+      result += series.Evaluate(t);
+      derivative_result += series.EvaluateDerivative(t);
+      t += Δt;
+    }
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result << derivative_result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
+void BM_EvaluateWithDerivativeDisplacement(
+  benchmark::State& state) {  // NOLINT(runtime/references)
+  int const degree = state.range_x();
+  std::mt19937_64 random(42);
+  std::vector<Displacement<ICRFJ2000Ecliptic>> coefficients;
+  for (int i = 0; i <= degree; ++i) {
+    coefficients.push_back(
+        Displacement<ICRFJ2000Ecliptic>(
+            {static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre}));
+  }
+  Instant const t0;
+  Instant const t_min = t0 + static_cast<double>(random()) * Second;
+  Instant const t_max = t_min + static_cast<double>(random()) * Second;
+  ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>> const series(
+    coefficients, t_min, t_max);
+
+  Instant t = t_min;
+  Time const Δt = (t_max - t_min) * 1E-9;
+  Displacement<ICRFJ2000Ecliptic> result{};
+  Velocity<ICRFJ2000Ecliptic> derivative_result{};
+
+  while (state.KeepRunning()) {
+    for (int i = 0; i < kEvaluationsPerIteration; ++i) {
+      Displacement<ICRFJ2000Ecliptic> value;
+      Velocity<ICRFJ2000Ecliptic> derivative;
+      series.EvaluateWithDerivative(t, &value, &derivative);
+      result += value;
+      derivative_result += derivative;
+      t += Δt;
+    }
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result << derivative_result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
 void BM_NewhallApproximation(
     benchmark::State& state) {  // NOLINT(runtime/references)
   int const degree = state.range_x();
@@ -251,6 +371,12 @@ BENCHMARK(BM_EvaluateVectorDouble)->
     Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
 BENCHMARK(BM_EvaluateDisplacement)->
     Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
+BENCHMARK(BM_EvaluateManyDisplacement)->
+    Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
+BENCHMARK(BM_EvaluateDisplacementAndDerivative)->
+    Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
+BENCHMARK(BM_EvaluateWithDerivativeDisplacement)->
+    Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
 BENCHMARK(BM_NewhallApproximation)->
     Arg(4)->Arg(8)->Arg(16);
 
@@ -82,6 +82,23 @@ class EmbeddedExplicitRungeKuttaNyströmIntegrator
       IntegrationProblem<ODE> const& problem,
       AdaptiveStepSize<ODE> const& adaptive_step_size) const override;
 
+  // Same as above, except that |compute_acceleration|, |append_state| and
+  // |tolerance_to_error_ratio| are called instead of
+  // |problem.equation.compute_acceleration|, |problem.append_state| and
+  // |adaptive_step_size.tolerance_to_error_ratio|.  They may be arbitrary
+  // callables, which the compiler can inline in the integration loop, as
+  // opposed to |std::function|s.  |compute_acceleration| is called with a
+  // plain pointer to the accelerations.
+  template<typename ComputeAcceleration,
+           typename AppendState,
+           typename ToleranceToErrorRatio>
+  TerminationCondition Solve(
+      IntegrationProblem<ODE> const& problem,
+      AdaptiveStepSize<ODE> const& adaptive_step_size,
+      ComputeAcceleration const& compute_acceleration,
+      AppendState const& append_state,
+      ToleranceToErrorRatio const& tolerance_to_error_ratio) const;
+
  protected:
   FixedVector<double, stages> const c_;
   FixedStrictlyLowerTriangularMatrix<double, stages> const a_;
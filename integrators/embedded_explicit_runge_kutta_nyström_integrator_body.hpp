@@ -89,6 +89,29 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
                                             first_same_as_last>::Solve(
     IntegrationProblem<ODE> const& problem,
     AdaptiveStepSize<ODE> const& adaptive_step_size) const {
+  return Solve(problem,
+               adaptive_step_size,
+               problem.equation.compute_acceleration,
+               problem.append_state,
+               adaptive_step_size.tolerance_to_error_ratio);
+}
+
+template<typename Position, int higher_order, int lower_order, int stages,
+         bool first_same_as_last>
+template<typename ComputeAcceleration,
+         typename AppendState,
+         typename ToleranceToErrorRatio>
+TerminationCondition
+EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
+                                            higher_order,
+                                            lower_order,
+                                            stages,
+                                            first_same_as_last>::Solve(
+    IntegrationProblem<ODE> const& problem,
+    AdaptiveStepSize<ODE> const& adaptive_step_size,
+    ComputeAcceleration const& compute_acceleration,
+    AppendState const& append_state,
+    ToleranceToErrorRatio const& tolerance_to_error_ratio) const {
   using Displacement = typename ODE::Displacement;
   using Velocity = typename ODE::Velocity;
   using Acceleration = typename ODE::Acceleration;
@@ -144,7 +167,7 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
   }
 
   bool at_end = false;
-  double tolerance_to_error_ratio;
+  double current_tolerance_to_error_ratio;
 
   // The first stage of the Runge-Kutta-Nyström iteration.  In the FSAL case,
   // |first_stage == 1| after the first step, since the first RHS evaluation has
@@ -166,7 +189,8 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
       // TODO(egg): find out whether there's a smarter way to compute that root,
       // especially since we make the order compile-time.
       h *= adaptive_step_size.safety_factor *
-               std::pow(tolerance_to_error_ratio, 1.0 / (lower_order + 1));
+               std::pow(current_tolerance_to_error_ratio,
+                        1.0 / (lower_order + 1));
       // TODO(egg): should we check whether it vanishes in double precision
       // instead?
       if (t.value + (t.error + h) == t.value) {
@@ -194,7 +218,7 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
           q_stage[k] = q_hat[k].value +
                            h * (c_[i] * v_hat[k].value + h * Σj_a_ij_g_jk);
         }
-        problem.equation.compute_acceleration(t_stage, q_stage, &g[i]);
+        compute_acceleration(t_stage, q_stage, &g[i]);
       }
 
       // Increment computation and step size control.
@@ -220,9 +244,9 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
         error_estimate.position_error[k] = Δq_k - Δq_hat[k];
         error_estimate.velocity_error[k] = Δv_k - Δv_hat[k];
       }
-      tolerance_to_error_ratio =
-          adaptive_step_size.tolerance_to_error_ratio(h, error_estimate);
-    } while (tolerance_to_error_ratio < 1.0);
+      current_tolerance_to_error_ratio =
+          tolerance_to_error_ratio(h, error_estimate);
+    } while (current_tolerance_to_error_ratio < 1.0);
 
     if (first_same_as_last) {
       using std::swap;
@@ -236,7 +260,7 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
       q_hat[k].Increment(Δq_hat[k]);
       v_hat[k].Increment(Δv_hat[k]);
     }
-    problem.append_state(current_state);
+    append_state(current_state);
     ++step_count;
     if (step_count == adaptive_step_size.max_steps && !at_end) {
       return TerminationCondition::ReachedMaximalStepCount;
@@ -5,6 +5,7 @@
 #include <experimental/optional>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <vector>
 
 #include "base/not_null.hpp"
@@ -111,6 +112,34 @@ template<typename DifferentialEquation>
 class FixedStepSizeIntegrator : public Integrator<DifferentialEquation> {
  public:
   using ODE = DifferentialEquation;
+
+  // An integration in progress.  It owns the current state of the system and
+  // the storage used by the integrator, so that the integration may be resumed
+  // by successive calls to |Solve| without allocating or copying the state.
+  class Instance {
+   public:
+    virtual ~Instance() = default;
+
+    // Integrates from |state().time| to |t_final|, with the same guarantees
+    // as |FixedStepSizeIntegrator::Solve|.  |append_state| is called with a
+    // reference to |state()|.  Does nothing if |t_final| is less than one step
+    // away from |state().time| in the direction of integration.
+    virtual void Solve(Instant const& t_final) = 0;
+
+    // The state reached at the end of the last call to |Solve|, or the
+    // initial state if |Solve| was never called.
+    typename ODE::SystemState const& state() const;
+
+   protected:
+    Instance(IntegrationProblem<ODE> const& problem, Time const& step);
+
+    ODE const equation_;
+    std::function<void(typename ODE::SystemState const& state)> const
+        append_state_;
+    Time const step_;
+    typename ODE::SystemState current_state_;
+  };
+
   // The last call to |problem.append_state| has a |state.time.value| equal to
   // the unique |Instant| of the form |problem.t_final + n * step| in
   // ]problem.t_final - step, problem.t_final].
@@ -119,6 +148,19 @@ class FixedStepSizeIntegrator : public Integrator<DifferentialEquation> {
   virtual void Solve(IntegrationProblem<ODE> const& problem,
                      Time const& step) const = 0;
 
+  // Returns an |Instance| for the given |problem|, which starts at
+  // |*problem.initial_state|.  |problem.t_final| is ignored.
+  virtual not_null<std::unique_ptr<Instance>> NewInstance(
+      IntegrationProblem<ODE> const& problem,
+      Time const& step) const = 0;
+
+  // Calls |visitor| with this integrator as its concrete type, one of the
+  // |SymplecticRungeKuttaNyströmIntegrator|s, and returns the result.  This
+  // lets the caller use the templated |Solve| of the concrete integrator, whose
+  // callables may be inlined in the integration loop.
+  template<typename Visitor>
+  auto Visit(Visitor const& visitor) const;
+
   void WriteToMessage(
       not_null<serialization::FixedStepSizeIntegrator*> const message) const;
   static FixedStepSizeIntegrator const& ReadFromMessage(
@@ -149,6 +191,11 @@ class AdaptiveStepSizeIntegrator : public Integrator<DifferentialEquation> {
       IntegrationProblem<ODE> const& problem,
       AdaptiveStepSize<ODE> const& adaptive_step_size) const = 0;
 
+  // Calls |visitor| with this integrator as its concrete type, one of the
+  // |EmbeddedExplicitRungeKuttaNyströmIntegrator|s, and returns the result.
+  template<typename Visitor>
+  auto Visit(Visitor const& visitor) const;
+
   void WriteToMessage(
       not_null<serialization::AdaptiveStepSizeIntegrator*> const message) const;
   static AdaptiveStepSizeIntegrator const& ReadFromMessage(
@@ -39,6 +39,21 @@ SpecialSecondOrderDifferentialEquation<Position>::SystemState::ReadFromMessage(
   return system_state;
 }
 
+template<typename DifferentialEquation>
+typename DifferentialEquation::SystemState const&
+FixedStepSizeIntegrator<DifferentialEquation>::Instance::state() const {
+  return current_state_;
+}
+
+template<typename DifferentialEquation>
+FixedStepSizeIntegrator<DifferentialEquation>::Instance::Instance(
+    IntegrationProblem<ODE> const& problem,
+    Time const& step)
+    : equation_(problem.equation),
+      append_state_(problem.append_state),
+      step_(step),
+      current_state_(*CHECK_NOTNULL(problem.initial_state)) {}
+
 template<typename DifferentialEquation>
 FixedStepSizeIntegrator<DifferentialEquation>::FixedStepSizeIntegrator(
     serialization::FixedStepSizeIntegrator::Kind const kind) : kind_(kind) {}
@@ -80,6 +95,36 @@ FixedStepSizeIntegrator<DifferentialEquation>::ReadFromMessage(
   }
 }
 
+template<typename DifferentialEquation>
+template<typename Visitor>
+auto FixedStepSizeIntegrator<DifferentialEquation>::Visit(
+    Visitor const& visitor) const {
+  using FSSI = serialization::FixedStepSizeIntegrator;
+  using Position = typename DifferentialEquation::Position;
+  // The integrators are singletons, so the one of the right kind is this one.
+  switch (kind_) {
+    case FSSI::BLANES_MOAN_2002_SRKN_6B:
+      return visitor(BlanesMoan2002SRKN6B<Position>());
+    case FSSI::BLANES_MOAN_2002_SRKN_11B:
+      return visitor(BlanesMoan2002SRKN11B<Position>());
+    case FSSI::BLANES_MOAN_2002_SRKN_14A:
+      return visitor(BlanesMoan2002SRKN14A<Position>());
+    case FSSI::MCLACHLAN_1995_SB3A_4:
+      return visitor(McLachlan1995SB3A4<Position>());
+    case FSSI::MCLACHLAN_1995_SB3A_5:
+      return visitor(McLachlan1995SB3A5<Position>());
+    case FSSI::MCLACHLAN_ATELA_1992_ORDER_4_OPTIMAL:
+      return visitor(McLachlanAtela1992Order4Optimal<Position>());
+    case FSSI::MCLACHLAN_ATELA_1992_ORDER_5_OPTIMAL:
+      return visitor(McLachlanAtela1992Order5Optimal<Position>());
+    case FSSI::OKUNBOR_SKEEL_1994_ORDER_6_METHOD_13:
+      return visitor(OkunborSkeel1994Order6Method13<Position>());
+    default:
+      LOG(FATAL) << kind_;
+      base::noreturn();
+  }
+}
+
 template<typename DifferentialEquation>
 AdaptiveStepSizeIntegrator<DifferentialEquation>::AdaptiveStepSizeIntegrator(
     serialization::AdaptiveStepSizeIntegrator::Kind const kind) : kind_(kind) {}
@@ -105,5 +150,21 @@ AdaptiveStepSizeIntegrator<DifferentialEquation>::ReadFromMessage(
   }
 }
 
+template<typename DifferentialEquation>
+template<typename Visitor>
+auto AdaptiveStepSizeIntegrator<DifferentialEquation>::Visit(
+    Visitor const& visitor) const {
+  using ASSI = serialization::AdaptiveStepSizeIntegrator;
+  using Position = typename DifferentialEquation::Position;
+  // The integrators are singletons, so the one of the right kind is this one.
+  switch (kind_) {
+    case ASSI::DORMAND_ELMIKKAWY_PRINCE_1986_RKN_434FM:
+      return visitor(DormandElMikkawyPrince1986RKN434FM<Position>());
+    default:
+      LOG(FATAL) << kind_;
+      base::noreturn();
+  }
+}
+
 }  // namespace integrators
 }  // namespace principia
@@ -9,6 +9,9 @@
 #ifndef PRINCIPIA_INTEGRATORS_SYMPLECTIC_RUNGE_KUTTA_NYSTRÖM_INTEGRATOR_HPP_
 #define PRINCIPIA_INTEGRATORS_SYMPLECTIC_RUNGE_KUTTA_NYSTRÖM_INTEGRATOR_HPP_
 
+#include <memory>
+#include <vector>
+
 #include "integrators/ordinary_differential_equations.hpp"
 #include "numerics/fixed_arrays.hpp"
 
@@ -84,12 +87,81 @@ class SymplecticRungeKuttaNyströmIntegrator
   void Solve(IntegrationProblem<ODE> const& problem,
              Time const& step) const override;
 
+  // Same as above, except that |compute_acceleration| and |append_state| are
+  // called instead of |problem.equation.compute_acceleration| and
+  // |problem.append_state|.  They may be arbitrary callables, which the
+  // compiler can inline in the integration loop, as opposed to the
+  // |std::function|s of the |problem|.  |compute_acceleration| is called with a
+  // plain pointer to the accelerations.
+  template<typename ComputeAcceleration, typename AppendState>
+  void Solve(IntegrationProblem<ODE> const& problem,
+             Time const& step,
+             ComputeAcceleration const& compute_acceleration,
+             AppendState const& append_state) const;
+
+  not_null<std::unique_ptr<typename FixedStepSizeIntegrator<ODE>::Instance>>
+  NewInstance(IntegrationProblem<ODE> const& problem,
+              Time const& step) const override;
+
+  // Same as |instance.Solve(t_final)|, except that |compute_acceleration| and
+  // |append_state| are called instead of the |std::function|s of the problem
+  // of the |instance|, which must have been returned by |NewInstance| on this
+  // integrator.
+  template<typename ComputeAcceleration, typename AppendState>
+  void Solve(typename FixedStepSizeIntegrator<ODE>::Instance& instance,
+             Instant const& t_final,
+             ComputeAcceleration const& compute_acceleration,
+             AppendState const& append_state) const;
+
   static int const order = order_;
   static bool const time_reversible = time_reversible_;
   static int const evaluations = evaluations_;
   static CompositionMethod const composition = composition_;
 
  private:
+  class Instance : public FixedStepSizeIntegrator<ODE>::Instance {
+   public:
+    Instance(IntegrationProblem<ODE> const& problem,
+             Time const& step,
+             SymplecticRungeKuttaNyströmIntegrator const& integrator);
+
+    void Solve(Instant const& t_final) override;
+
+    // Same as above, but calls the given callables instead of the
+    // |std::function|s of the problem.
+    template<typename ComputeAcceleration, typename AppendState>
+    void Solve(Instant const& t_final,
+               ComputeAcceleration const& compute_acceleration,
+               AppendState const& append_state);
+
+   private:
+    using Displacement = typename ODE::Displacement;
+    using Velocity = typename ODE::Velocity;
+    using Acceleration = typename ODE::Acceleration;
+
+    SymplecticRungeKuttaNyströmIntegrator const& integrator_;
+
+    // The workspace of the integrator, sized at construction.
+    // Position increment.
+    std::vector<Displacement> Δq_;
+    // Velocity increment.
+    std::vector<Velocity> Δv_;
+    // Current Runge-Kutta-Nyström stage.
+    std::vector<Position> q_stage_;
+    // Accelerations at the current stage.  In the kBAB case, this holds the
+    // accelerations at the end of the last step, which are reused by the next
+    // step, so this must persist across calls to |Solve|.
+    std::vector<Acceleration> g_;
+
+    // The first full stage of the step, i.e. the first stage where
+    // exp(bᵢ h B) exp(aᵢ h A) must be entirely computed.
+    // Always 0 in the non-FSAL kBA case, always 1 in the kABA case since b₀ = 0,
+    // means the first stage is only exp(a₀ h A), and 1 after the first step
+    // in the kBAB case, since the last right-hand-side evaluation can be used
+    // for exp(bᵢ h B).
+    int first_stage_;
+  };
+
   FixedVector<double, stages_> a_;
   FixedVector<double, stages_> b_;
   FixedVector<double, stages_> c_;
@@ -3,14 +3,18 @@
 
 #include "integrators/symplectic_runge_kutta_nyström_integrator.hpp"
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
+#include "base/not_null.hpp"
 #include "geometry/sign.hpp"
 #include "quantities/quantities.hpp"
 #include "testing_utilities/numerics.hpp"
 
 namespace principia {
 
+using base::make_not_null_unique;
 using geometry::Sign;
 using quantities::Abs;
 using testing_utilities::ULPDistance;
@@ -73,14 +77,23 @@ void SymplecticRungeKuttaNyströmIntegrator<Position, order, time_reversible,
                                            evaluations, composition>::Solve(
     IntegrationProblem<ODE> const& problem,
     Time const& step) const {
-  using Displacement = typename ODE::Displacement;
-  using Velocity = typename ODE::Velocity;
-  using Acceleration = typename ODE::Acceleration;
+  Solve(problem,
+        step,
+        problem.equation.compute_acceleration,
+        problem.append_state);
+}
 
+template<typename Position, int order, bool time_reversible, int evaluations,
+         CompositionMethod composition>
+template<typename ComputeAcceleration, typename AppendState>
+void SymplecticRungeKuttaNyströmIntegrator<Position, order, time_reversible,
+                                           evaluations, composition>::Solve(
+    IntegrationProblem<ODE> const& problem,
+    Time const& step,
+    ComputeAcceleration const& compute_acceleration,
+    AppendState const& append_state) const {
   // Argument checks.
   CHECK_NOTNULL(problem.initial_state);
-  int const dimension = problem.initial_state->positions.size();
-  CHECK_EQ(dimension, problem.initial_state->velocities.size());
   CHECK_NE(Time(), step);
   Sign const integration_direction = Sign(step);
   if (integration_direction.Positive()) {
@@ -91,69 +104,131 @@ void SymplecticRungeKuttaNyströmIntegrator<Position, order, time_reversible,
     CHECK_GT(problem.initial_state->time.value, problem.t_final);
   }
 
-  typename ODE::SystemState current_state = *problem.initial_state;
+  Instance instance(problem, step, *this);
+  instance.Solve(problem.t_final, compute_acceleration, append_state);
+}
+
+template<typename Position, int order, bool time_reversible, int evaluations,
+         CompositionMethod composition>
+not_null<std::unique_ptr<
+    typename FixedStepSizeIntegrator<
+        SpecialSecondOrderDifferentialEquation<Position>>::Instance>>
+SymplecticRungeKuttaNyströmIntegrator<Position, order, time_reversible,
+                                      evaluations, composition>::NewInstance(
+    IntegrationProblem<ODE> const& problem,
+    Time const& step) const {
+  return make_not_null_unique<Instance>(problem, step, *this);
+}
+
+template<typename Position, int order, bool time_reversible, int evaluations,
+         CompositionMethod composition>
+template<typename ComputeAcceleration, typename AppendState>
+void SymplecticRungeKuttaNyströmIntegrator<Position, order, time_reversible,
+                                           evaluations, composition>::Solve(
+    typename FixedStepSizeIntegrator<ODE>::Instance& instance,
+    Instant const& t_final,
+    ComputeAcceleration const& compute_acceleration,
+    AppendState const& append_state) const {
+  DCHECK(dynamic_cast<Instance*>(&instance) != nullptr);
+  static_cast<Instance&>(instance).Solve(
+      t_final, compute_acceleration, append_state);
+}
+
+template<typename Position, int order, bool time_reversible, int evaluations,
+         CompositionMethod composition>
+SymplecticRungeKuttaNyströmIntegrator<Position, order, time_reversible,
+                                      evaluations, composition>::Instance::
+Instance(IntegrationProblem<ODE> const& problem,
+         Time const& step,
+         SymplecticRungeKuttaNyströmIntegrator const& integrator)
+    : FixedStepSizeIntegrator<ODE>::Instance(problem, step),
+      integrator_(integrator),
+      Δq_(this->current_state_.positions.size()),
+      Δv_(this->current_state_.positions.size()),
+      q_stage_(this->current_state_.positions.size()),
+      g_(this->current_state_.positions.size()),
+      first_stage_(composition == kABA ? 1 : 0) {
+  CHECK_EQ(this->current_state_.positions.size(),
+           this->current_state_.velocities.size());
+  CHECK_NE(Time(), step);
+}
+
+template<typename Position, int order, bool time_reversible, int evaluations,
+         CompositionMethod composition>
+void SymplecticRungeKuttaNyströmIntegrator<Position, order, time_reversible,
+                                           evaluations, composition>::Instance::
+Solve(Instant const& t_final) {
+  Solve(t_final, this->equation_.compute_acceleration, this->append_state_);
+}
+
+template<typename Position, int order, bool time_reversible, int evaluations,
+         CompositionMethod composition>
+template<typename ComputeAcceleration, typename AppendState>
+void SymplecticRungeKuttaNyströmIntegrator<Position, order, time_reversible,
+                                           evaluations, composition>::Instance::
+Solve(Instant const& t_final,
+      ComputeAcceleration const& compute_acceleration,
+      AppendState const& append_state) {
+  auto const& a = integrator_.a_;
+  auto const& b = integrator_.b_;
+  auto const& c = integrator_.c_;
+
+  int const dimension = this->current_state_.positions.size();
 
   // Time step.
-  Time const& h = step;
+  Time const& h = this->step_;
+  Sign const integration_direction = Sign(h);
   Time const abs_h = integration_direction * h;
   // Current time.  This is a non-const reference whose purpose is to make the
   // equations more readable.
-  DoublePrecision<Instant>& t = current_state.time;
+  DoublePrecision<Instant>& t = this->current_state_.time;
 
-  // Position increment.
-  std::vector<Displacement> Δq(dimension);
-  // Velocity increment.
-  std::vector<Velocity> Δv(dimension);
   // Current position.  This is a non-const reference whose purpose is to make
   // the equations more readable.
-  std::vector<DoublePrecision<Position>>& q = current_state.positions;
+  std::vector<DoublePrecision<Position>>& q = this->current_state_.positions;
   // Current velocity.  This is a non-const reference whose purpose is to make
   // the equations more readable.
-  std::vector<DoublePrecision<Velocity>>& v = current_state.velocities;
-
-  // Current Runge-Kutta-Nyström stage.
-  std::vector<Position> q_stage(dimension);
-  // Accelerations at the current stage.
-  std::vector<Acceleration> g(dimension);
-
-  // The first full stage of the step, i.e. the first stage where
-  // exp(bᵢ h B) exp(aᵢ h A) must be entirely computed.
-  // Always 0 in the non-FSAL kBA case, always 1 in the kABA case since b₀ = 0,
-  // means the first stage is only exp(a₀ h A), and 1 after the first step
-  // in the kBAB case, since the last right-hand-side evaluation can be used for
-  // exp(bᵢ h B).
-  int first_stage = composition == kABA ? 1 : 0;
-
-  while (abs_h <= Abs((problem.t_final - t.value) - t.error)) {
+  std::vector<DoublePrecision<Velocity>>& v = this->current_state_.velocities;
+
+  // Short names for the workspace.
+  std::vector<Displacement>& Δq = Δq_;
+  std::vector<Velocity>& Δv = Δv_;
+  std::vector<Position>& q_stage = q_stage_;
+  std::vector<Acceleration>& g = g_;
+
+  // The signed remaining time is used rather than its absolute value so that
+  // nothing happens if |t_final| is behind |t|.
+  while (abs_h <=
+         integration_direction * ((t_final - t.value) - t.error)) {
     std::fill(Δq.begin(), Δq.end(), Displacement{});
     std::fill(Δv.begin(), Δv.end(), Velocity{});
 
-    if (first_stage == 1) {
+    if (first_stage_ == 1) {
       for (int k = 0; k < dimension; ++k) {
         if (composition == kBAB) {
           // exp(b₀ h B)
-          Δv[k] += h * b_[0] * g[k];
+          Δv[k] += h * b[0] * g[k];
         }
         // exp(a₀ h A)
-        Δq[k] += h * a_[0] * (v[k].value + Δv[k]);
+        Δq[k] += h * a[0] * (v[k].value + Δv[k]);
       }
     }
 
-    for (int i = first_stage; i < stages_; ++i) {
+    for (int i = first_stage_; i < stages_; ++i) {
       for (int k = 0; k < dimension; ++k) {
         q_stage[k] = q[k].value + Δq[k];
       }
-      problem.equation.compute_acceleration(t.value + c_[i] * h, q_stage, &g);
+      compute_acceleration(t.value + c[i] * h, q_stage, &g);
       for (int k = 0; k < dimension; ++k) {
         // exp(bᵢ h B)
-        Δv[k] += h * b_[i] * g[k];
+        Δv[k] += h * b[i] * g[k];
         // exp(aᵢ h A)
-        Δq[k] += h * a_[i] * (v[k].value + Δv[k]);
+        Δq[k] += h * a[i] * (v[k].value + Δv[k]);
       }
     }
 
     if (composition == kBAB) {
-      first_stage = 1;
+      first_stage_ = 1;
     }
 
     // Increment the solution.
@@ -162,7 +237,7 @@ void SymplecticRungeKuttaNyströmIntegrator<Position, order, time_reversible,
       q[k].Increment(Δq[k]);
       v[k].Increment(Δv[k]);
     }
-    problem.append_state(current_state);
+    append_state(this->current_state_);
   }
 }
 
@@ -130,6 +130,84 @@ void TestTermination(
   }
 }
 
+// Checks that resuming an |Instance| for several intervals yields exactly the
+// same states, with the same number of evaluations, as a single call to
+// |Solve|.
+template<typename Integrator>
+void TestResumption(Integrator const& integrator) {
+  Length const q_initial = 1 * Metre;
+  Speed const v_initial = 0 * Metre / Second;
+  Instant const t_initial;
+  Instant const t_final = t_initial + 100 * Second;
+  Time const step = 0.3 * Second;
+  Time const interval = 7 * Second;
+
+  int evaluations = 0;
+  std::vector<ODE::SystemState> solution;
+  ODE harmonic_oscillator;
+  harmonic_oscillator.compute_acceleration =
+      std::bind(ComputeHarmonicOscillatorAcceleration,
+                _1, _2, _3, &evaluations);
+  IntegrationProblem<ODE> problem;
+  problem.equation = harmonic_oscillator;
+  ODE::SystemState const initial_state = {{q_initial}, {v_initial}, t_initial};
+  problem.initial_state = &initial_state;
+  problem.t_final = t_final;
+  problem.append_state = [&solution](ODE::SystemState const& state) {
+    solution.push_back(state);
+  };
+
+  integrator.Solve(problem, step);
+  int const expected_evaluations = evaluations;
+  std::vector<ODE::SystemState> const expected_solution = solution;
+
+  auto const check_solution = [&evaluations,
+                                &expected_evaluations,
+                                &expected_solution,
+                                &solution]() {
+    EXPECT_EQ(expected_evaluations, evaluations);
+    ASSERT_EQ(expected_solution.size(), solution.size());
+    for (int i = 0; i < solution.size(); ++i) {
+      EXPECT_EQ(expected_solution[i].time.value, solution[i].time.value);
+      EXPECT_EQ(expected_solution[i].positions[0].value,
+                solution[i].positions[0].value);
+      EXPECT_EQ(expected_solution[i].velocities[0].value,
+                solution[i].velocities[0].value);
+    }
+  };
+
+  evaluations = 0;
+  solution.clear();
+  auto const instance = integrator.NewInstance(problem, step);
+  Instant t = t_initial;
+  do {
+    t = std::min(t + interval, t_final);
+    instance->Solve(t);
+    EXPECT_EQ(solution.back().time.value, instance->state().time.value);
+  } while (t < t_final);
+  check_solution();
+
+  // Same thing, through the concrete integrator obtained from the generic
+  // interface, with the callables passed explicitly.
+  evaluations = 0;
+  solution.clear();
+  FixedStepSizeIntegrator<ODE> const& generic_integrator = integrator;
+  auto const visited_instance = generic_integrator.NewInstance(problem, step);
+  generic_integrator.Visit(
+      [&problem, &interval, &t_final, &t_initial, &visited_instance](
+          auto const& concrete_integrator) {
+        Instant t = t_initial;
+        do {
+          t = std::min(t + interval, t_final);
+          concrete_integrator.Solve(*visited_instance,
+                                    t,
+                                    problem.equation.compute_acceleration,
+                                    problem.append_state);
+        } while (t < t_final);
+      });
+  check_solution();
+}
+
 // Long integration, change detector.  Also tests the number of steps, their
 // spacing, and the number of evaluations.
 template<typename Integrator>
@@ -398,6 +476,7 @@ struct SimpleHarmonicMotionTestInstance {
                                    Speed const& expected_velocity_error,
                                    Energy const& expected_energy_error)
       : test_termination_(std::bind(TestTermination<Integrator>, integrator)),
+        test_resumption_(std::bind(TestResumption<Integrator>, integrator)),
         test_1000_seconds_at_1_millisecond_(
             std::bind(Test1000SecondsAt1Millisecond<Integrator>,
                       integrator,
@@ -424,6 +503,10 @@ struct SimpleHarmonicMotionTestInstance {
     test_termination_();
   }
 
+  void RunResumption() const {
+    test_resumption_();
+  }
+
   void Run1000SecondsAt1Millisecond() const {
     test_1000_seconds_at_1_millisecond_();
   }
@@ -442,6 +525,7 @@ struct SimpleHarmonicMotionTestInstance {
 
  private:
   std::function<void()> test_termination_;
+  std::function<void()> test_resumption_;
   std::function<void()> test_1000_seconds_at_1_millisecond_;
   std::function<void()> test_convergence_;
   std::function<void()> test_symplecticity_;
@@ -534,6 +618,11 @@ TEST_P(SymplecticRungeKuttaNyströmIntegratorTest, Termination) {
   GetParam().RunTermination();
 }
 
+TEST_P(SymplecticRungeKuttaNyströmIntegratorTest, Resumption) {
+  LOG(INFO) << GetParam();
+  GetParam().RunResumption();
+}
+
 TEST_P(SymplecticRungeKuttaNyströmIntegratorTest, LongIntegration) {
   LOG(INFO) << GetParam();
   GetParam().Run1000SecondsAt1Millisecond();
@@ -1,13 +1,19 @@
 ﻿
 #include "journal/player.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <string>
 
 #include "base/array.hpp"
 #include "base/get_line.hpp"
 #include "base/hexadecimal.hpp"
 #include "journal/profiles.hpp"
+#include "journal/recorder.hpp"
 #include "glog/logging.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "ksp_plugin/plugin.hpp"
 
 namespace principia {
 
@@ -18,8 +24,22 @@ using base::UniqueBytes;
 namespace journal {
 
 Player::Player(std::experimental::filesystem::path const& path)
-    : stream_(path, std::ios::in) {
-  CHECK(!stream_.fail());
+    : stream_(path, std::ios::in | std::ios::binary) {
+  CHECK(!stream_.fail()) << path;
+  char magic[sizeof(Recorder::kBinaryMagic)];
+  stream_.read(magic, sizeof(magic));
+  if (stream_.gcount() == sizeof(magic) &&
+      std::equal(magic, magic + sizeof(magic), Recorder::kBinaryMagic)) {
+    binary_stream_ =
+        std::make_unique<google::protobuf::io::IstreamInputStream>(&stream_);
+    binary_stream_origin_ = sizeof(magic);
+  } else {
+    // A legacy journal.  Reopen it in text mode so that line terminators are
+    // handled properly.
+    stream_.close();
+    stream_.open(path, std::ios::in);
+    CHECK(!stream_.fail()) << path;
+  }
 }
 
 bool Player::Play() {
@@ -27,6 +47,7 @@ bool Player::Play() {
   if (method == nullptr) {
     return false;
   }
+  ++method_index_;
   // TODO(phl): We don't want to run this method, it directs the output to
   // stderr.log.  Remove it from the protocol buffer at some point.  This
   // will be incompatible with existing journals.
@@ -39,16 +60,130 @@ bool Player::Play() {
   return true;
 }
 
+void Player::WriteIndex(std::experimental::filesystem::path const& index_path,
+                        std::int64_t const checkpoint_interval) {
+  CHECK_EQ(0, method_index_);
+  CHECK_LT(0, checkpoint_interval);
+  std::ofstream index_stream(index_path, std::ios::binary | std::ios::trunc);
+  CHECK(index_stream.good()) << index_path;
+
+  serialization::JournalIndex index;
+  std::int64_t last_checkpoint_index = 0;
+  for (;;) {
+    index.add_method_offset(CurrentOffset());
+    if (!Play()) {
+      break;
+    }
+    serialization::JournalCheckpoint checkpoint;
+    if (method_index_ - last_checkpoint_index >= checkpoint_interval &&
+        MakeCheckpoint(&checkpoint)) {
+      std::string const bytes = checkpoint.SerializeAsString();
+      auto* const checkpoint_entry = index.add_checkpoint();
+      checkpoint_entry->set_method_index(method_index_);
+      checkpoint_entry->set_offset(index_stream.tellp());
+      checkpoint_entry->set_size(bytes.size());
+      index_stream.write(bytes.data(), bytes.size());
+      last_checkpoint_index = method_index_;
+    }
+  }
+
+  // The index is followed by its size so that it may be found from the end of
+  // the file.
+  std::string const bytes = index.SerializeAsString();
+  std::uint64_t const size = bytes.size();
+  index_stream.write(bytes.data(), bytes.size());
+  index_stream.write(reinterpret_cast<char const*>(&size), sizeof(size));
+  CHECK(index_stream.good()) << index_path;
+  LOG(INFO) << "Wrote index " << index_path << " for " << method_index_
+            << " methods with " << index.checkpoint_size() << " checkpoints";
+}
+
+std::int64_t Player::SeekTo(
+    std::experimental::filesystem::path const& index_path,
+    std::int64_t const index) {
+  CHECK_EQ(0, method_index_);
+  std::ifstream index_stream(index_path, std::ios::binary | std::ios::ate);
+  CHECK(index_stream.good()) << index_path;
+  std::streamoff const file_size = index_stream.tellg();
+  std::uint64_t size;
+  index_stream.seekg(file_size - sizeof(size));
+  index_stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+  std::string bytes(size, '\0');
+  index_stream.seekg(file_size - sizeof(size) - size);
+  index_stream.read(&bytes[0], size);
+  CHECK(index_stream.good()) << index_path;
+  serialization::JournalIndex journal_index;
+  {
+    // The index of a long journal may exceed the default limit of protobuf.
+    google::protobuf::io::ArrayInputStream array_stream(
+        bytes.data(), static_cast<int>(bytes.size()));
+    google::protobuf::io::CodedInputStream coded_stream(&array_stream);
+    coded_stream.SetTotalBytesLimit(std::numeric_limits<int>::max(),
+                                    std::numeric_limits<int>::max());
+    CHECK(journal_index.ParseFromCodedStream(&coded_stream)) << index_path;
+  }
+  CHECK_LE(0, index);
+  CHECK_LT(index, journal_index.method_offset_size()) << index_path;
+
+  // Find the last checkpoint at or before |index|.
+  auto const it = std::upper_bound(
+      journal_index.checkpoint().begin(),
+      journal_index.checkpoint().end(),
+      index,
+      [](std::int64_t const index,
+         serialization::JournalIndex::Checkpoint const& checkpoint) {
+        return index < checkpoint.method_index();
+      });
+  if (it != journal_index.checkpoint().begin()) {
+    auto const& checkpoint_entry = *std::prev(it);
+    bytes.resize(checkpoint_entry.size());
+    index_stream.seekg(checkpoint_entry.offset());
+    index_stream.read(&bytes[0], checkpoint_entry.size());
+    CHECK(index_stream.good()) << index_path;
+    google::protobuf::io::ArrayInputStream array_stream(
+        bytes.data(), static_cast<int>(bytes.size()));
+    google::protobuf::io::CodedInputStream coded_stream(&array_stream);
+    coded_stream.SetTotalBytesLimit(std::numeric_limits<int>::max(),
+                                    std::numeric_limits<int>::max());
+    serialization::JournalCheckpoint checkpoint;
+    CHECK(checkpoint.ParseFromCodedStream(&coded_stream)) << index_path;
+
+    pointer_map_.clear();
+    pointer_map_.emplace(
+        checkpoint.plugin_address(),
+        ksp_plugin::Plugin::ReadFromMessage(checkpoint.plugin()).release());
+    method_index_ = checkpoint_entry.method_index();
+    SeekToOffset(journal_index.method_offset(method_index_));
+  }
+
+  std::int64_t const start = method_index_;
+  while (method_index_ < index) {
+    CHECK(Play()) << index_path;
+  }
+  return start;
+}
+
 serialization::Method const & Player::last_method() const {
   return *last_method_;
 }
 
+std::int64_t Player::method_index() const {
+  return method_index_;
+}
+
 std::unique_ptr<serialization::Method> Player::Read() {
+  if (binary_stream_ == nullptr) {
+    return ReadHexadecimal();
+  } else {
+    return ReadBinary();
+  }
+}
+
+std::unique_ptr<serialization::Method> Player::ReadHexadecimal() {
   std::string const line = GetLine(&stream_);
   if (line.empty()) {
     return nullptr;
   }
-
   uint8_t const* const hexadecimal =
       reinterpret_cast<uint8_t const*>(line.c_str());
   int const hexadecimal_size = strlen(line.c_str());
@@ -56,11 +191,81 @@ std::unique_ptr<serialization::Method> Player::Read() {
   HexadecimalDecode({hexadecimal, hexadecimal_size},
                     {bytes.data.get(), bytes.size});
   auto method = std::make_unique<serialization::Method>();
-  CHECK(method->ParseFromArray(bytes.data.get(),
-                               static_cast<int>(bytes.size)));
+  bool const parsed =
+      method->ParseFromArray(bytes.data.get(), static_cast<int>(bytes.size));
+  // The recorder terminates each method with a newline, so a line that doesn't
+  // parse at end of file is the last method, cut short when the process died.
+  if (!parsed && stream_.eof()) {
+    LOG(WARNING) << "Ignoring a truncated method at end of journal";
+    return nullptr;
+  }
+  CHECK(parsed);
+
+  return method;
+}
+
+std::unique_ptr<serialization::Method> Player::ReadBinary() {
+  // A new coded stream is created for each method, so that the limit on the
+  // number of bytes read applies to a method, not to the entire journal.
+  google::protobuf::io::CodedInputStream coded_stream(binary_stream_.get());
+  std::uint32_t size;
+  if (!coded_stream.ReadVarint32(&size)) {
+    return nullptr;
+  }
+  // The size is written before the method, so if the process died while the
+  // method was being written, fewer than |size| bytes remain.
+  std::string bytes;
+  if (!coded_stream.ReadString(&bytes, size)) {
+    LOG(WARNING) << "Ignoring a truncated method at end of journal";
+    return nullptr;
+  }
+  auto method = std::make_unique<serialization::Method>();
+  CHECK(method->ParseFromString(bytes));
 
   return method;
 }
 
+std::streamoff Player::CurrentOffset() {
+  if (binary_stream_ == nullptr) {
+    return stream_.tellg();
+  } else {
+    return binary_stream_origin_ + binary_stream_->ByteCount();
+  }
+}
+
+void Player::SeekToOffset(std::streamoff const offset) {
+  bool const binary = binary_stream_ != nullptr;
+  // The input stream buffers ahead, so it must be recreated after seeking.
+  binary_stream_.reset();
+  stream_.clear();
+  stream_.seekg(offset);
+  CHECK(!stream_.fail()) << offset;
+  if (binary) {
+    binary_stream_ =
+        std::make_unique<google::protobuf::io::IstreamInputStream>(&stream_);
+    binary_stream_origin_ = offset;
+  }
+}
+
+bool Player::MakeCheckpoint(
+    serialization::JournalCheckpoint* const checkpoint) const {
+  if (last_method_ == nullptr ||
+      !last_method_->HasExtension(serialization::AdvanceTime::extension) ||
+      pointer_map_.size() != 1) {
+    return false;
+  }
+  auto const& in =
+      last_method_->GetExtension(serialization::AdvanceTime::extension).in();
+  auto const it = pointer_map_.find(in.plugin());
+  if (it == pointer_map_.end()) {
+    return false;
+  }
+  auto const* const plugin =
+      static_cast<ksp_plugin::Plugin const*>(it->second);
+  checkpoint->set_plugin_address(it->first);
+  plugin->WriteToMessage(checkpoint->mutable_plugin());
+  return true;
+}
+
 }  // namespace journal
 }  // namespace principia
@@ -1,12 +1,16 @@
 ﻿
 #pragma once
 
+#include <cstdint>
 #include <experimental/filesystem>
 #include <fstream>
+#include <ios>
 #include <map>
 #include <memory>
 
+#include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "serialization/journal.pb.h"
+#include "serialization/ksp_plugin.pb.h"
 
 namespace principia {
 namespace journal {
@@ -15,24 +19,62 @@ class Player {
  public:
   using PointerMap = std::map<std::uint64_t, void*>;
 
+  // Opens the journal at |path|, which may be in any of the formats of
+  // |Recorder::Format|.  The format is detected automatically.
   explicit Player(std::experimental::filesystem::path const& path);
 
   // Replays the next message in the journal.  Returns false at end of journal.
   bool Play();
 
+  // Replays the entire journal and writes at |index_path| an index of the
+  // offsets of its methods, together with checkpoints of the state of the
+  // plugin taken at least every |checkpoint_interval| methods.  A checkpoint is
+  // only taken after an |AdvanceTime| when the plugin is the only object known
+  // to the journal.  Must be called before any call to |Play|.
+  void WriteIndex(std::experimental::filesystem::path const& index_path,
+                  std::int64_t checkpoint_interval);
+
+  // Restores the last checkpoint of the index at |index_path| that precedes the
+  // method at |index|, and replays the methods from there, so that the next
+  // call to |Play| replays the method at |index|.  Returns the index of the
+  // method where the replay started, which is 0 if no checkpoint was usable.
+  // Must be called before any call to |Play|.
+  std::int64_t SeekTo(std::experimental::filesystem::path const& index_path,
+                      std::int64_t index);
+
   // Returns the last method that was replayed.
   serialization::Method const& last_method() const;
 
+  // Returns the index of the next method to be replayed.
+  std::int64_t method_index() const;
+
  private:
   // Reads one message from the stream.  Returns a |nullptr| at end of stream.
+  // A truncated last message, as written by a process that died while
+  // recording, is treated as the end of the stream.
   std::unique_ptr<serialization::Method> Read();
+  std::unique_ptr<serialization::Method> ReadHexadecimal();
+  std::unique_ptr<serialization::Method> ReadBinary();
 
   template<typename Profile>
   bool RunIfAppropriate(serialization::Method const& method);
 
+  // The offset in the journal of the next method to be read.
+  std::streamoff CurrentOffset();
+  void SeekToOffset(std::streamoff offset);
+
+  // If the state of the journal may be checkpointed after |last_method_|,
+  // returns true and fills |checkpoint|.
+  bool MakeCheckpoint(serialization::JournalCheckpoint* checkpoint) const;
+
   PointerMap pointer_map_;
   std::ifstream stream_;
+  // Null for a journal in hexadecimal format.
+  std::unique_ptr<google::protobuf::io::IstreamInputStream> binary_stream_;
+  // The offset in |stream_| where |binary_stream_| started reading.
+  std::streamoff binary_stream_origin_ = 0;
   std::unique_ptr<serialization::Method> last_method_;
+  std::int64_t method_index_ = 0;
 
   friend class PlayerTest;
   friend class RecorderTest;
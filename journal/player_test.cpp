@@ -1,6 +1,7 @@
 ﻿
 #include "journal/player.hpp"
 
+#include <experimental/filesystem>
 #include <list>
 #include <string>
 #include <vector>
@@ -38,12 +39,30 @@ class PlayerTest : public ::testing::Test {
         test_case_name_(test_info_->test_case_name()),
         test_name_(test_info_->name()),
         plugin_(interface::principia__NewPlugin(1, 2)),
-        recorder_(new Recorder(test_name_ + ".journal.hex",
-                               /*verbose=*/false)) {
+        recorder_(new Recorder(test_name_ + ".journal",
+                               /*verbose=*/false,
+                               Recorder::Format::kBinary)) {
     Recorder::Activate(recorder_);
   }
 
   ~PlayerTest() override {
+    if (Recorder::IsActivated()) {
+      Recorder::Deactivate();
+    }
+  }
+
+  // Records two methods using the active recorder and deactivates it.
+  void RecordTiny() {
+    {
+      Method<NewPlugin> m({1, 2});
+      m.Return(plugin_.get());
+    }
+    {
+      const ksp_plugin::Plugin* plugin = plugin_.get();
+      Method<DeletePlugin> m({&plugin}, {&plugin});
+      m.Return();
+    }
+    // Wait for the methods to be written.
     Recorder::Deactivate();
   }
 
@@ -60,21 +79,28 @@ class PlayerTest : public ::testing::Test {
 };
 
 TEST_F(PlayerTest, PlayTiny) {
-  {
-    Method<NewPlugin> m({1, 2});
-    m.Return(plugin_.get());
-  }
-  {
-    const ksp_plugin::Plugin* plugin = plugin_.get();
-    Method<DeletePlugin> m({&plugin}, {&plugin});
-    m.Return();
+  RecordTiny();
+  Player player(test_name_ + ".journal");
+
+  // Replay the journal.  Note that the journal doesn't grow as we replay
+  // because the recorder was deactivated.
+  int count = 0;
+  while (player.Play()) {
+    ++count;
   }
+  EXPECT_EQ(2, count);
+}
 
+// Legacy journals in hexadecimal format are recognized and replayed.
+TEST_F(PlayerTest, PlayTinyHexadecimal) {
+  Recorder::Deactivate();
+  recorder_ = new Recorder(test_name_ + ".journal.hex",
+                           /*verbose=*/false,
+                           Recorder::Format::kHexadecimal);
+  Recorder::Activate(recorder_);
+  RecordTiny();
   Player player(test_name_ + ".journal.hex");
 
-  // Replay the journal.  Note that the journal doesn't grow as we replay
-  // because we didn't call principia__ActivateRecorder so there is no active
-  // journal in the ksp_plugin assembly.
   int count = 0;
   while (player.Play()) {
     ++count;
@@ -82,6 +108,66 @@ TEST_F(PlayerTest, PlayTiny) {
   EXPECT_EQ(2, count);
 }
 
+// A journal whose last method was cut short is replayed up to that method.
+TEST_F(PlayerTest, PlayTruncated) {
+  RecordTiny();
+  std::string const path = test_name_ + ".journal";
+  std::experimental::filesystem::resize_file(
+      path, std::experimental::filesystem::file_size(path) - 3);
+  Player player(path);
+
+  int count = 0;
+  while (player.Play()) {
+    ++count;
+  }
+  EXPECT_EQ(1, count);
+}
+
+// Seeking restores a checkpoint and replays from there.
+TEST_F(PlayerTest, Seek) {
+  ksp_plugin::Plugin* plugin = interface::principia__NewPlugin(0, 0);
+  interface::principia__InsertSun(plugin,
+                                  /*celestial_index=*/0,
+                                  /*gravitational_parameter=*/1.0e20,
+                                  /*mean_radius=*/1.0e6);
+  interface::principia__EndInitialization(plugin);
+  for (int i = 1; i <= 20; ++i) {
+    interface::principia__AdvanceTime(plugin,
+                                      /*t=*/i * 10.0,
+                                      /*planetarium_rotation=*/0);
+  }
+  ksp_plugin::Plugin const* const_plugin = plugin;
+  interface::principia__DeletePlugin(&const_plugin);
+  Recorder::Deactivate();
+  // The 24 methods above.
+  int const method_count = 24;
+
+  std::string const index_path = test_name_ + ".journal.index";
+  {
+    Player player(test_name_ + ".journal");
+    player.WriteIndex(index_path, /*checkpoint_interval=*/5);
+    EXPECT_EQ(method_count, player.method_index());
+  }
+  {
+    Player player(test_name_ + ".journal");
+    std::int64_t const start = player.SeekTo(index_path, 17);
+    EXPECT_LT(0, start);
+    EXPECT_LE(start, 17);
+    EXPECT_EQ(17, player.method_index());
+    int count = 0;
+    while (player.Play()) {
+      ++count;
+    }
+    EXPECT_EQ(method_count - 17, count);
+  }
+  {
+    // Before the first checkpoint everything is replayed.
+    Player player(test_name_ + ".journal");
+    EXPECT_EQ(0, player.SeekTo(index_path, 2));
+    EXPECT_EQ(2, player.method_index());
+  }
+}
+
 // This test (a.k.a. benchmark) is only run if the --gtest_filter flag names it
 // explicitly.
 TEST_F(PlayerTest, Benchmarks) {
@@ -1,9 +1,15 @@
 ﻿
 #include "journal/recorder.hpp"
 
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <utility>
+
 #include "base/array.hpp"
 #include "base/hexadecimal.hpp"
 #include "glog/logging.h"
+#include "google/protobuf/io/coded_stream.h"
 
 namespace principia {
 
@@ -12,14 +18,60 @@ using base::UniqueBytes;
 
 namespace journal {
 
+char const Recorder::kBinaryMagic[8] = {'P', 'R', 'J', 'O', 'U', 'R', 'N', 1};
+
+std::chrono::seconds const Recorder::kFailureTimeout(10);
+
+class Recorder::FatalLogSink : public google::LogSink {
+ public:
+  void send(google::LogSeverity severity,
+            char const* full_filename,
+            char const* base_filename,
+            int line,
+            std::tm const* tm_time,
+            char const* message,
+            std::size_t message_len) override;
+};
+
+void Recorder::FatalLogSink::send(google::LogSeverity const severity,
+                                  char const* const full_filename,
+                                  char const* const base_filename,
+                                  int const line,
+                                  std::tm const* const tm_time,
+                                  char const* const message,
+                                  std::size_t const message_len) {
+  // glog holds its lock while calling the sinks, so waiting for |writer_| is
+  // only safe because it doesn't log unless it fails, in which case it is the
+  // calling thread and doesn't wait.
+  if (severity == google::FATAL) {
+    FlushActiveRecorder();
+  }
+}
+
 Recorder::Recorder(std::experimental::filesystem::path const& path,
-                   bool const verbose)
-    : stream_(path, std::ios::out),
-      verbose_(verbose) {
+                   bool const verbose,
+                   Format const format)
+    : stream_(path,
+              format == Format::kBinary ? std::ios::out | std::ios::binary
+                                        : std::ios::out),
+      verbose_(verbose),
+      format_(format),
+      writer_(&Recorder::WriteQueuedMethods, this) {
   CHECK(!stream_.fail()) << path;
+  // Written here rather than by |writer_| so that the file is well-formed if
+  // |WriteQueuedMethodsBeforeExit| is called before |writer_| has run.
+  if (format_ == Format::kBinary) {
+    stream_.write(kBinaryMagic, sizeof(kBinaryMagic));
+  }
 }
 
 Recorder::~Recorder() {
+  {
+    std::unique_lock<std::mutex> l(lock_);
+    shutdown_ = true;
+  }
+  has_methods_or_shutdown_.notify_all();
+  writer_.join();
   stream_.close();
 }
 
@@ -27,31 +79,153 @@ void Recorder::Write(serialization::Method const& method) {
   CHECK_LT(0, method.ByteSize()) << method.DebugString();
   UniqueBytes bytes(method.ByteSize());
   method.SerializeToArray(bytes.data.get(), static_cast<int>(bytes.size));
-
-  std::int64_t const hexadecimal_size = (bytes.size << 1) + 2;
-  UniqueBytes hexadecimal(hexadecimal_size);
-  HexadecimalEncode({bytes.data.get(), bytes.size}, hexadecimal.get());
-  hexadecimal.data.get()[hexadecimal_size - 2] = '\n';
-  hexadecimal.data.get()[hexadecimal_size - 1] = '\0';
-  stream_ << hexadecimal.data.get();
-  stream_.flush();
+  {
+    std::unique_lock<std::mutex> l(lock_);
+    has_room_.wait(l, [this]() {
+      return queued_methods_.size() < kMaxQueuedMethods;
+    });
+    queued_methods_.push_back(std::move(bytes));
+  }
+  has_methods_or_shutdown_.notify_one();
 }
 
+// The CHECKs below are outside of the lock because a failure calls
+// |FlushActiveRecorder| through |FatalLogSink|.
+
 void Recorder::Activate(base::not_null<Recorder*> const journal) {
-  CHECK(active_recorder_ == nullptr);
-  active_recorder_ = journal;
+  Recorder* previous;
+  {
+    std::lock_guard<std::mutex> l(active_recorder_lock_);
+    previous = active_recorder_;
+    if (previous == nullptr) {
+      active_recorder_ = journal;
+    }
+  }
+  CHECK(previous == nullptr);
+  InstallHandlers();
 }
 
 void Recorder::Deactivate() {
-  CHECK(active_recorder_ != nullptr);
-  delete active_recorder_;
-  active_recorder_ = nullptr;
+  Recorder* recorder = nullptr;
+  {
+    // Once the recorder is swapped out |FlushActiveRecorder| cannot reach it,
+    // and holding the lock ensures that it is not in the middle of flushing
+    // it.
+    std::lock_guard<std::mutex> l(active_recorder_lock_);
+    std::swap(recorder, active_recorder_);
+  }
+  CHECK(recorder != nullptr);
+  // Outside of the lock for the same reason as the CHECKs: the destructor may
+  // fail.
+  delete recorder;
 }
 
 bool Recorder::IsActivated() {
+  std::lock_guard<std::mutex> l(active_recorder_lock_);
   return active_recorder_ != nullptr;
 }
 
+void Recorder::WriteQueuedMethods() {
+  for (;;) {
+    std::deque<UniqueBytes> methods;
+    {
+      std::unique_lock<std::mutex> l(lock_);
+      has_methods_or_shutdown_.wait(l, [this]() {
+        return shutdown_ || !queued_methods_.empty();
+      });
+      if (queued_methods_.empty()) {
+        // Shutdown requested and nothing left to write.
+        return;
+      }
+      methods.swap(queued_methods_);
+      writing_ = true;
+    }
+    has_room_.notify_all();
+
+    for (auto const& bytes : methods) {
+      WriteBytes(bytes);
+    }
+    // Flushing only when the queue is empty saves system calls when the
+    // methods come in quick succession, while making sure that the journal is
+    // complete when the game crashes between two calls.
+    stream_.flush();
+    CHECK(!stream_.fail());
+    {
+      std::unique_lock<std::mutex> l(lock_);
+      writing_ = false;
+    }
+    is_idle_.notify_all();
+  }
+}
+
+void Recorder::WriteQueuedMethodsBeforeExit() {
+  // If the failure happened on |writer_|, the stream is unusable.
+  if (std::this_thread::get_id() == writer_.get_id()) {
+    return;
+  }
+  std::unique_lock<std::mutex> l(lock_);
+  // Writing while |writer_| is writing would corrupt the journal, so if it
+  // doesn't become idle we lose the queued methods.
+  if (!is_idle_.wait_for(l, kFailureTimeout, [this]() { return !writing_; })) {
+    return;
+  }
+  // |writer_| cannot remove methods from the queue as long as we hold the
+  // lock.
+  for (auto const& bytes : queued_methods_) {
+    WriteBytes(bytes);
+  }
+  queued_methods_.clear();
+  stream_.flush();
+}
+
+void Recorder::InstallHandlers() {
+  static std::once_flag handlers_installed;
+  std::call_once(handlers_installed, []() {
+    // glog doesn't take ownership of the sink, which lives as long as the
+    // process.
+    google::AddLogSink(new FatalLogSink);
+    std::atexit(&FlushActiveRecorder);
+  });
+}
+
+void Recorder::FlushActiveRecorder() {
+  std::lock_guard<std::mutex> l(active_recorder_lock_);
+  if (active_recorder_ != nullptr) {
+    active_recorder_->WriteQueuedMethodsBeforeExit();
+  }
+}
+
+void Recorder::WriteBytes(UniqueBytes const& bytes) {
+  switch (format_) {
+    case Format::kHexadecimal:
+      WriteHexadecimal(bytes);
+      break;
+    case Format::kBinary:
+      WriteBinary(bytes);
+      break;
+  }
+}
+
+void Recorder::WriteHexadecimal(UniqueBytes const& bytes) {
+  std::int64_t const hexadecimal_size = (bytes.size << 1) + 2;
+  UniqueBytes hexadecimal(hexadecimal_size);
+  HexadecimalEncode({bytes.data.get(), bytes.size}, hexadecimal.get());
+  hexadecimal.data.get()[hexadecimal_size - 2] = '\n';
+  hexadecimal.data.get()[hexadecimal_size - 1] = '\0';
+  stream_ << hexadecimal.data.get();
+}
+
+void Recorder::WriteBinary(UniqueBytes const& bytes) {
+  // A varint encoding of a 32-bit integer takes at most 5 bytes.
+  std::uint8_t size[5];
+  std::uint8_t const* const size_end =
+      google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(
+          static_cast<std::uint32_t>(bytes.size), size);
+  stream_.write(reinterpret_cast<char const*>(size), size_end - size);
+  stream_.write(reinterpret_cast<char const*>(bytes.data.get()), bytes.size);
+}
+
+std::mutex Recorder::active_recorder_lock_;
 Recorder* Recorder::active_recorder_ = nullptr;
 
 }  // namespace journal
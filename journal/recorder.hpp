@@ -1,19 +1,54 @@
 ﻿
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <experimental/filesystem>
 #include <fstream>
+#include <mutex>
+#include <thread>
 
+#include "base/array.hpp"
+#include "base/macros.hpp"
 #include "base/not_null.hpp"
 #include "serialization/journal.pb.h"
 
 namespace principia {
 namespace journal {
 
+// A |Recorder| writes the methods passed to |Write| to a journal file.  The
+// methods are serialized by the calling thread, and written by a background
+// thread which flushes the file whenever it has written all the methods that
+// were queued.  At most |kMaxQueuedMethods| methods may be waiting to be
+// written: if more are passed to |Write|, it blocks.  While a recorder is
+// active, a CHECK failure, a LOG(FATAL) or a call to |exit| writes the queued
+// methods before terminating the process, so that the journal may be used to
+// reproduce the crash.
 class Recorder {
  public:
+  enum class Format {
+    // One line of hexadecimal text per method.  This is the legacy format.
+    kHexadecimal,
+    // The bytes of |kBinaryMagic| followed by, for each method, its size as a
+    // varint and its serialized bytes.
+    kBinary,
+  };
+
+  // The first bytes of a journal in binary format.  They are not hexadecimal
+  // digits, so the format of a journal may be detected by looking at its
+  // first byte.
+  static char const kBinaryMagic[8];
+
+  static int const kMaxQueuedMethods = 1000;
+
+  // How long to wait for the background thread on the failure path.
+  static std::chrono::seconds const kFailureTimeout;
+
   Recorder(std::experimental::filesystem::path const& path,
-           bool const verbose);
+           bool const verbose,
+           Format const format);
+  // Waits for all the methods to be written and closes the file.
   ~Recorder();
 
   void Write(serialization::Method const& method);
@@ -23,9 +58,54 @@ class Recorder {
   static bool IsActivated();
 
  private:
+  // The body of |writer_|.
+  void WriteQueuedMethods();
+
+  // Waits for |writer_| to finish writing its current methods, then writes the
+  // queued methods on the calling thread and flushes the file.  Used on the
+  // failure path, where the destructor doesn't run.  Gives up if |writer_|
+  // doesn't become idle within |kFailureTimeout|, e.g., because the process
+  // has already terminated it.
+  void WriteQueuedMethodsBeforeExit();
+
+  // A glog sink which calls |FlushActiveRecorder| when a fatal message is
+  // logged, i.e., before glog dumps the stack trace and aborts.
+  class FatalLogSink;
+
+  // Installs |FatalLogSink| and the |atexit| handler, once per process.  They
+  // do nothing when there is no active recorder, so they are never
+  // uninstalled.
+  static void InstallHandlers();
+
+  // Installed as an |atexit| handler and called by |FatalLogSink|, possibly on
+  // another thread than the one that calls |Deactivate|.
+  static void FlushActiveRecorder();
+
+  void WriteBytes(base::UniqueBytes const& bytes);
+  void WriteHexadecimal(base::UniqueBytes const& bytes);
+  void WriteBinary(base::UniqueBytes const& bytes);
+
   std::ofstream stream_;
   bool const verbose_;
+  Format const format_;
+
+  std::mutex lock_;
+  std::condition_variable has_methods_or_shutdown_;
+  std::condition_variable has_room_;
+  std::condition_variable is_idle_;
+  bool shutdown_ GUARDED_BY(lock_) = false;
+  // True while |writer_| writes methods that it removed from the queue.
+  bool writing_ GUARDED_BY(lock_) = false;
+  std::deque<base::UniqueBytes> queued_methods_ GUARDED_BY(lock_);
+
+  // Must be last, so that it is started after all the other members have been
+  // initialized.
+  std::thread writer_;
 
+  // Guards the changes of |active_recorder_| against |FlushActiveRecorder|.
+  // The methods only read it on the thread that activates and deactivates the
+  // recorder, so they don't take the lock.
+  static std::mutex active_recorder_lock_;
   static Recorder* active_recorder_;
 
   template<typename>
@@ -7,6 +7,7 @@
 
 #include "base/array.hpp"
 #include "base/hexadecimal.hpp"
+#include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
 #include "journal/method.hpp"
 #include "journal/profiles.hpp"
@@ -17,19 +18,84 @@
 namespace principia {
 namespace journal {
 
+// The benchmark is only run if --gtest_filter=RecorderTest.Benchmarks
+void BM_RecordSetBufferedLogging(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  auto const format = static_cast<Recorder::Format>(state.range_x());
+  Recorder recorder("BM_RecordSetBufferedLogging.journal",
+                    /*verbose=*/false,
+                    format);
+  serialization::Method method;
+  method.MutableExtension(serialization::SetBufferedLogging::extension)->
+      mutable_in()->set_max_severity(1);
+  while (state.KeepRunning()) {
+    recorder.Write(method);
+  }
+}
+
+BENCHMARK(BM_RecordSetBufferedLogging)->
+    Arg(static_cast<int>(Recorder::Format::kHexadecimal))->
+    Arg(static_cast<int>(Recorder::Format::kBinary));
+
 class RecorderTest : public testing::Test {
  protected:
   RecorderTest()
-      : test_name_(
+      : test_case_name_(
+            testing::UnitTest::GetInstance()->current_test_case()->name()),
+        test_name_(
             testing::UnitTest::GetInstance()->current_test_info()->name()),
         plugin_(interface::principia__NewPlugin(1, 2)),
-        recorder_(new Recorder(test_name_ + ".journal.hex",
-                               /*verbose=*/false)) {
+        recorder_(new Recorder(test_name_ + ".journal",
+                               /*verbose=*/false,
+                               Recorder::Format::kBinary)) {
     Recorder::Activate(recorder_);
   }
 
   ~RecorderTest() override {
+    if (Recorder::IsActivated()) {
+      Recorder::Deactivate();
+    }
+  }
+
+  // Records two methods using the active recorder, deactivates it, and checks
+  // that the methods may be read back from |path|.
+  void RecordAndCheck(std::experimental::filesystem::path const& path) {
+    {
+      const ksp_plugin::Plugin* plugin = plugin_.get();
+      Method<DeletePlugin> m({&plugin}, {&plugin});
+      m.Return();
+    }
+    {
+      Method<NewPlugin> m({1, 2});
+      m.Return(plugin_.get());
+    }
+    // Wait for the methods to be written.
     Recorder::Deactivate();
+
+    std::vector<serialization::Method> const methods = ReadAll(path);
+    EXPECT_EQ(2, methods.size());
+    auto it = methods.begin();
+    {
+      EXPECT_TRUE(it->HasExtension(serialization::DeletePlugin::extension));
+      auto const& extension =
+          it->GetExtension(serialization::DeletePlugin::extension);
+      EXPECT_TRUE(extension.has_in());
+      EXPECT_NE(0, extension.in().plugin());
+      EXPECT_TRUE(extension.has_out());
+      EXPECT_NE(0, extension.out().plugin());
+      EXPECT_EQ(extension.in().plugin(), extension.out().plugin());
+    }
+    ++it;
+    {
+      EXPECT_TRUE(it->HasExtension(serialization::NewPlugin::extension));
+      auto const& extension =
+          it->GetExtension(serialization::NewPlugin::extension);
+      EXPECT_TRUE(extension.has_in());
+      EXPECT_EQ(1, extension.in().initial_time());
+      EXPECT_EQ(2, extension.in().planetarium_rotation_in_degrees());
+      EXPECT_TRUE(extension.has_return_());
+      EXPECT_NE(0, extension.return_().result());
+    }
   }
 
   static std::vector<serialization::Method> ReadAll(
@@ -45,6 +111,7 @@ class RecorderTest : public testing::Test {
   }
 
 
+  std::string const test_case_name_;
   std::string const test_name_;
   std::unique_ptr<ksp_plugin::Plugin> plugin_;
   Recorder* recorder_;
@@ -72,41 +139,72 @@ TEST_F(JournalDeathTest, Return) {
   "returned_");
 }
 
+TEST_F(JournalDeathTest, CheckFailure) {
+  // The methods written before a CHECK failure are in the journal, even though
+  // the recorder is never deactivated.
+  Recorder::Deactivate();
+  int const count = 2 * Recorder::kMaxQueuedMethods;
+  EXPECT_DEATH({
+    Recorder::Activate(new Recorder(test_name_ + ".journal",
+                                    /*verbose=*/false,
+                                    Recorder::Format::kBinary));
+    for (int i = 0; i < count; ++i) {
+      Method<SetBufferedLogging> m({i});
+      m.Return();
+    }
+    CHECK(false) << "Crashed after " << count << " methods";
+  },
+  "Crashed after");
+
+  std::vector<serialization::Method> const methods =
+      ReadAll(test_name_ + ".journal");
+  ASSERT_EQ(count, methods.size());
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(i,
+              methods[i].GetExtension(
+                  serialization::SetBufferedLogging::extension).in().
+                      max_severity());
+  }
+}
+
 TEST_F(RecorderTest, Recording) {
-  {
-    const ksp_plugin::Plugin* plugin = plugin_.get();
-    Method<DeletePlugin> m({&plugin}, {&plugin});
+  RecordAndCheck(test_name_ + ".journal");
+}
+
+TEST_F(RecorderTest, RecordingHexadecimal) {
+  Recorder::Deactivate();
+  recorder_ = new Recorder(test_name_ + ".journal.hex",
+                           /*verbose=*/false,
+                           Recorder::Format::kHexadecimal);
+  Recorder::Activate(recorder_);
+  RecordAndCheck(test_name_ + ".journal.hex");
+}
+
+TEST_F(RecorderTest, ManyMethods) {
+  // More methods than may be queued, to exercise the blocking of |Write|.
+  int const count = 3 * Recorder::kMaxQueuedMethods;
+  for (int i = 0; i < count; ++i) {
+    Method<SetBufferedLogging> m({i});
     m.Return();
   }
-  {
-    Method<NewPlugin> m({1, 2});
-    m.Return(plugin_.get());
-  }
+  Recorder::Deactivate();
 
   std::vector<serialization::Method> const methods =
-      ReadAll(test_name_ + ".journal.hex");
-  EXPECT_EQ(2, methods.size());
-  auto it = methods.begin();
-  {
-    EXPECT_TRUE(it->HasExtension(serialization::DeletePlugin::extension));
-    auto const& extension =
-        it->GetExtension(serialization::DeletePlugin::extension);
-    EXPECT_TRUE(extension.has_in());
-    EXPECT_NE(0, extension.in().plugin());
-    EXPECT_TRUE(extension.has_out());
-    EXPECT_NE(0, extension.out().plugin());
-    EXPECT_EQ(extension.in().plugin(), extension.out().plugin());
+      ReadAll(test_name_ + ".journal");
+  ASSERT_EQ(count, methods.size());
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(i,
+              methods[i].GetExtension(
+                  serialization::SetBufferedLogging::extension).in().
+                      max_severity());
   }
-  ++it;
-  {
-    EXPECT_TRUE(it->HasExtension(serialization::NewPlugin::extension));
-    auto const& extension =
-        it->GetExtension(serialization::NewPlugin::extension);
-    EXPECT_TRUE(extension.has_in());
-    EXPECT_EQ(1, extension.in().initial_time());
-    EXPECT_EQ(2, extension.in().planetarium_rotation_in_degrees());
-    EXPECT_TRUE(extension.has_return_());
-    EXPECT_NE(0, extension.return_().result());
+}
+
+// This test (a.k.a. benchmark) is only run if the --gtest_filter flag names it
+// explicitly.
+TEST_F(RecorderTest, Benchmarks) {
+  if (testing::FLAGS_gtest_filter == test_case_name_ + "." + test_name_) {
+    benchmark::RunSpecifiedBenchmarks();
   }
 }
 
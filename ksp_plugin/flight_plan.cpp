@@ -37,10 +37,7 @@ FlightPlan::FlightPlan(not_null<DiscreteTrajectory<Barycentric>*> const root,
 FlightPlan::~FlightPlan() {
   // |segments_| is empty for a mock object.
   if (!segments_.empty()) {
-    // Deleting the first fork deletes everything.
-    DiscreteTrajectory<Barycentric>* trajectory = segments_.front();
-    CHECK(!trajectory->is_root());
-    trajectory->parent()->DeleteFork(&trajectory);
+    DeleteSegments(segments_);
   }
 }
 
@@ -95,6 +92,19 @@ bool FlightPlan::ReplaceLast(Burn burn) {
       MakeNavigationManœuvre(std::move(burn), manœuvres_.back().initial_mass());
   if (manœuvre.FitsBetween(start_of_penultimate_coast(), final_time_) &&
       !manœuvre.IsSingular()) {
+    if (anomalous_segments_ <= 2 &&
+        manœuvre.initial_time() == manœuvres_.back().initial_time()) {
+      // The penultimate coast only depends on its initial state, on the initial
+      // time of the manœuvre and on the adaptive step parameters, so it doesn't
+      // need to be recomputed.  This is the common case when editing a burn.
+      // It is only correct if the penultimate coast is not anomalous, i.e., if
+      // it actually reached the initial time of the manœuvre.
+      manœuvres_.pop_back();
+      PopLastSegment();  // Last coast.
+      PopLastSegment();  // Last burn.
+      Append(std::move(manœuvre));
+      return true;
+    }
     DiscreteTrajectory<Barycentric>* recomputed_penultimate_coast =
         CoastIfReachesManœuvreInitialTime(penultimate_coast(), manœuvre);
     if (recomputed_penultimate_coast != nullptr) {
@@ -112,6 +122,16 @@ bool FlightPlan::ReplaceLast(Burn burn) {
 bool FlightPlan::SetFinalTime(Instant const& final_time) {
   if (start_of_last_coast() > final_time) {
     return false;
+  } else if (anomalous_segments_ == 0) {
+    // The last coast reached |final_time_|: keep the part of it that is before
+    // |final_time| and only integrate the remainder, if any.
+    final_time_ = final_time;
+    DiscreteTrajectory<Barycentric>& coast = last_coast();
+    coast.ForgetAfter(final_time_);
+    if (coast.last().time() < final_time_) {
+      CoastLastSegment(final_time_);
+    }
+    return true;
   } else {
     final_time_ = final_time;
     ResetLastSegment();
@@ -128,14 +148,37 @@ FlightPlan::adaptive_step_parameters() const {
 bool FlightPlan::SetAdaptiveStepParameters(
     Ephemeris<Barycentric>::AdaptiveStepParameters const&
         adaptive_step_parameters) {
+  if (adaptive_step_parameters == adaptive_step_parameters_) {
+    return true;
+  }
+
+  // Compute the segments in a new chain of forks so that, if the computation
+  // fails, the original segments may be restored without being recomputed.
   auto const original_adaptive_step_parameters = adaptive_step_parameters_;
+  int const original_anomalous_segments = anomalous_segments_;
+  std::vector<not_null<DiscreteTrajectory<Barycentric>*>> original_segments;
+  original_segments.swap(segments_);
+  not_null<DiscreteTrajectory<Barycentric>*> const first_segment =
+      original_segments.front();
+  segments_.emplace_back(
+      first_segment->parent()->NewForkWithoutCopy(
+          first_segment->Fork().time()));
   adaptive_step_parameters_ = adaptive_step_parameters;
-  if (RecomputeSegments()) {
+  anomalous_segments_ = 0;
+  FlowSegments();
+
+  if (anomalous_segments_ <= 2) {
+    DeleteSegments(original_segments);
     return true;
   } else {
-    // If the recomputation fails, leave this place as clean as we found it.
+    // If the computation fails, leave this place as clean as we found it.
+    DeleteSegments(segments_);
+    segments_.swap(original_segments);
     adaptive_step_parameters_ = original_adaptive_step_parameters;
-    CHECK(RecomputeSegments());
+    anomalous_segments_ = original_anomalous_segments;
+    for (int i = 0; i < manœuvres_.size(); ++i) {
+      manœuvres_[i].set_coasting_trajectory(segments_[2 * i]);
+    }
     return false;
   }
 }
@@ -272,6 +315,12 @@ bool FlightPlan::RecomputeSegments() {
     PopLastSegment();
   }
   ResetLastSegment();
+  FlowSegments();
+  return anomalous_segments_ <= 2;
+}
+
+void FlightPlan::FlowSegments() {
+  CHECK_EQ(1, segments_.size());
   for (auto& manœuvre : manœuvres_) {
     CoastLastSegment(manœuvre.initial_time());
     manœuvre.set_coasting_trajectory(segments_.back());
@@ -280,7 +329,6 @@ bool FlightPlan::RecomputeSegments() {
     AddSegment();
   }
   CoastLastSegment(final_time_);
-  return anomalous_segments_ <= 2;
 }
 
 void FlightPlan::BurnLastSegment(NavigationManœuvre const& manœuvre) {
@@ -353,6 +401,15 @@ void FlightPlan::PopLastSegment() {
   }
 }
 
+void FlightPlan::DeleteSegments(
+    std::vector<not_null<DiscreteTrajectory<Barycentric>*>>& segments) {
+  // Deleting the first fork deletes everything.
+  DiscreteTrajectory<Barycentric>* trajectory = segments.front();
+  CHECK(!trajectory->is_root());
+  trajectory->parent()->DeleteFork(&trajectory);
+  segments.clear();
+}
+
 DiscreteTrajectory<Barycentric>* FlightPlan::CoastIfReachesManœuvreInitialTime(
     DiscreteTrajectory<Barycentric>& coast,
     NavigationManœuvre const& manœuvre) {
@@ -118,6 +118,14 @@ class FlightPlan {
   // recomputation resulted in more than 2 anomalous segments.
   bool RecomputeSegments();
 
+  // |segments_| must contain a single, empty segment.  Flows it and adds and
+  // flows the segments for all the |manœuvres_|.
+  void FlowSegments();
+
+  // Deletes the given chain of |segments| and clears it.
+  void DeleteSegments(
+      std::vector<not_null<DiscreteTrajectory<Barycentric>*>>& segments);
+
   // Flows the last segment for the duration of |manœuvre| using its intrinsic
   // acceleration.
   void BurnLastSegment(NavigationManœuvre const& manœuvre);
@@ -166,8 +174,11 @@ class FlightPlan {
   // they are empty.
   // The contract of |Append| and |ReplaceLast| implies that
   // |anomalous_segments_| is at most 2: the penultimate coast is never
-  // anomalous.
+  // anomalous.  However, |ReplaceLast| must not rely on this, as it may be
+  // called after a recomputation has truncated the penultimate coast.
   int anomalous_segments_ = 0;
+
+  friend class FlightPlanTest;
 };
 
 }  // namespace ksp_plugin
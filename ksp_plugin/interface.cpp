@@ -3,6 +3,8 @@
 
 #include <cctype>
 #include <cstring>
+#include <limits>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -19,6 +21,8 @@
 #include "base/pull_serializer.hpp"
 #include "base/push_deserializer.hpp"
 #include "base/version.hpp"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "journal/method.hpp"
 #include "journal/profiles.hpp"
 #include "journal/recorder.hpp"
@@ -168,7 +172,8 @@ void principia__ActivateRecorder(bool const activate,
     journal::Recorder* const recorder =
         new journal::Recorder(std::experimental::filesystem::path("glog") /
                                   "Principia" / name.str(),
-                              verbose);
+                              verbose,
+                              journal::Recorder::Format::kBinary);
     journal::Recorder::Activate(recorder);
   } else if (!activate && journal::Recorder::IsActivated()) {
     journal::Recorder::Deactivate();
@@ -563,7 +568,7 @@ NavigationFrame const* principia__GetPlottingFrame(Plugin const* const plugin) {
 void principia__UpdatePrediction(Plugin const* const plugin,
                                  char const* const vessel_guid) {
   journal::Method<journal::UpdatePrediction> m({plugin, vessel_guid});
-  CHECK_NOTNULL(plugin)->UpdatePrediction(vessel_guid);
+  CHECK_NOTNULL(plugin)->UpdatePredictionAsynchronously(vessel_guid);
   return m.Return();
 }
 
@@ -632,6 +637,19 @@ void principia__RenderedPredictionApsides(Plugin const* const plugin,
 }
 
 
+void principia__SetRenderingTolerance(Plugin* const plugin,
+                                      double const angular_tolerance,
+                                      XYZ const camera_world_position) {
+  journal::Method<journal::SetRenderingTolerance> m({plugin,
+                                                     angular_tolerance,
+                                                     camera_world_position});
+  CHECK_NOTNULL(plugin)->SetRenderingTolerance(
+      angular_tolerance * Radian,
+      World::origin + Displacement<World>(
+                          ToR3Element(camera_world_position) * Metre));
+  return m.Return();
+}
+
 void principia__SetPredictionLength(Plugin* const plugin,
                                     double const t) {
   journal::Method<journal::SetPredictionLength> m({plugin, t});
@@ -864,6 +882,200 @@ void principia__DeserializePlugin(char const* const serialization,
   return m.Return();
 }
 
+// Same as |principia__SerializePlugin|, except that the serialization is
+// returned in binary form: |*chunk| is set to the next chunk and its size is
+// returned.  |*chunk| must be null on the first call and must be passed
+// unchanged to the successive calls.  It points to a buffer owned by
+// |*serializer| and is only valid until the next call.  At the end of the
+// stream, 0 is returned and |*chunk| is set to null.  There is no transfer of
+// ownership of |*chunk|.
+int principia__SerializePluginBinary(Plugin const* const plugin,
+                                     PullSerializer** const serializer,
+                                     char const** const chunk) {
+  journal::Method<journal::SerializePluginBinary> m({plugin, serializer, chunk},
+                                                    {serializer, chunk});
+  LOG(INFO) << __FUNCTION__;
+  CHECK_NOTNULL(plugin);
+  CHECK_NOTNULL(serializer);
+  CHECK_NOTNULL(chunk);
+
+  // Create and start a serializer if the caller didn't provide one.
+  if (*serializer == nullptr) {
+    CHECK(*chunk == nullptr);
+    *serializer = new PullSerializer(kChunkSize, kNumberOfChunks);
+    auto message = make_not_null_unique<serialization::Plugin>();
+    plugin->WriteToMessage(message.get());
+    (*serializer)->Start(std::move(message));
+  }
+
+  // Pull a chunk.  This releases the previous one.
+  Bytes const bytes = (*serializer)->Pull();
+
+  // If this is the end of the serialization, delete the serializer and return
+  // 0.
+  if (bytes.size == 0) {
+    TakeOwnership(serializer);
+    *chunk = nullptr;
+    return m.Return(0);
+  }
+
+  *chunk = reinterpret_cast<char const*>(bytes.data);
+  return m.Return(static_cast<int>(bytes.size));
+}
+
+// Same as |principia__DeserializePlugin|, except that |serialization| is in
+// binary form.  The data is copied into buffers owned by |*deserializer|,
+// therefore the caller may reuse |serialization| as soon as this function
+// returns.
+void principia__DeserializePluginBinary(char const* const serialization,
+                                        int const serialization_size,
+                                        PushDeserializer** const deserializer,
+                                        Plugin const** const plugin) {
+  journal::Method<journal::DeserializePluginBinary> m({serialization,
+                                                       serialization_size,
+                                                       deserializer,
+                                                       plugin},
+                                                      {deserializer, plugin});
+  LOG(INFO) << __FUNCTION__;
+  CHECK_NOTNULL(serialization);
+  CHECK_NOTNULL(deserializer);
+  CHECK_NOTNULL(plugin);
+
+  // Create and start a deserializer if the caller didn't provide one.
+  if (*deserializer == nullptr) {
+    *deserializer = new PushDeserializer(kChunkSize, kNumberOfChunks);
+    auto message = make_not_null_unique<serialization::Plugin>();
+    (*deserializer)->Start(
+        std::move(message),
+        [plugin](google::protobuf::Message const& message) {
+          *plugin = Plugin::ReadFromMessage(
+              static_cast<serialization::Plugin const&>(message)).release();
+        });
+  }
+
+  (*deserializer)->PushCopy(
+      {reinterpret_cast<std::uint8_t const*>(serialization),
+       serialization_size});
+
+  // If the data was empty, delete the deserializer.  This ensures that
+  // |*plugin| is filled.
+  if (serialization_size == 0) {
+    TakeOwnership(deserializer);
+  }
+  return m.Return();
+}
+
+// Same as |principia__SerializePluginBinary|, except that the serialization is
+// a |serialization::PluginDelta| relative to a serialization of |plugin| made
+// when its current time was |base_time|.  Its size only depends on what
+// happened since |base_time|.
+int principia__SerializePluginDelta(Plugin const* const plugin,
+                                    double const base_time,
+                                    PullSerializer** const serializer,
+                                    char const** const chunk) {
+  journal::Method<journal::SerializePluginDelta> m(
+      {plugin, base_time, serializer, chunk},
+      {serializer, chunk});
+  LOG(INFO) << __FUNCTION__;
+  CHECK_NOTNULL(plugin);
+  CHECK_NOTNULL(serializer);
+  CHECK_NOTNULL(chunk);
+
+  // Create and start a serializer if the caller didn't provide one.
+  if (*serializer == nullptr) {
+    CHECK(*chunk == nullptr);
+    *serializer = new PullSerializer(kChunkSize, kNumberOfChunks);
+    auto message = make_not_null_unique<serialization::PluginDelta>();
+    plugin->WriteDeltaToMessage(message.get(), Instant() + base_time * Second);
+    (*serializer)->Start(std::move(message));
+  }
+
+  // Pull a chunk.  This releases the previous one.
+  Bytes const bytes = (*serializer)->Pull();
+
+  // If this is the end of the serialization, delete the serializer and return
+  // 0.
+  if (bytes.size == 0) {
+    TakeOwnership(serializer);
+    *chunk = nullptr;
+    return m.Return(0);
+  }
+
+  *chunk = reinterpret_cast<char const*>(bytes.data);
+  return m.Return(static_cast<int>(bytes.size));
+}
+
+// Same as |principia__DeserializePluginBinary|, except that |serialization| is
+// a delta produced by |principia__SerializePluginDelta| for a |base_time| at
+// which the plugin was serialized to |base_serialization|, in binary form.
+// |base_serialization| is only read by the call that starts the deserializer;
+// the subsequent calls may pass a |base_serialization_size| of 0.  Returns
+// false, and leaves |*deserializer| and |*plugin| null, if
+// |base_serialization| cannot be parsed.
+bool principia__DeserializePluginDelta(
+    char const* const serialization,
+    int const serialization_size,
+    char const* const base_serialization,
+    int const base_serialization_size,
+    PushDeserializer** const deserializer,
+    Plugin const** const plugin) {
+  journal::Method<journal::DeserializePluginDelta> m({serialization,
+                                                      serialization_size,
+                                                      base_serialization,
+                                                      base_serialization_size,
+                                                      deserializer,
+                                                      plugin},
+                                                     {deserializer, plugin});
+  LOG(INFO) << __FUNCTION__;
+  CHECK_NOTNULL(serialization);
+  CHECK_NOTNULL(base_serialization);
+  CHECK_NOTNULL(deserializer);
+  CHECK_NOTNULL(plugin);
+
+  // Create and start a deserializer if the caller didn't provide one.
+  if (*deserializer == nullptr) {
+    auto const base = std::make_shared<serialization::Plugin>();
+    {
+      // The serialization of a large save may exceed the default limit of
+      // protobuf.
+      google::protobuf::io::ArrayInputStream array_stream(
+          base_serialization, base_serialization_size);
+      google::protobuf::io::CodedInputStream coded_stream(&array_stream);
+      coded_stream.SetTotalBytesLimit(std::numeric_limits<int>::max(),
+                                      std::numeric_limits<int>::max());
+      if (!base->ParseFromCodedStream(&coded_stream)) {
+        LOG(ERROR) << "Cannot parse the base serialization of "
+                   << base_serialization_size << " bytes";
+        *plugin = nullptr;
+        return m.Return(false);
+      }
+    }
+    *deserializer = new PushDeserializer(kChunkSize, kNumberOfChunks);
+    auto message = make_not_null_unique<serialization::PluginDelta>();
+    (*deserializer)->Start(
+        std::move(message),
+        [base, plugin](google::protobuf::Message const& message) {
+          // Folding the delta into the base yields the serialization of the
+          // plugin at the time of the delta.
+          Plugin::MergeDeltaIntoMessage(
+              static_cast<serialization::PluginDelta const&>(message),
+              base.get());
+          *plugin = Plugin::ReadFromMessage(*base).release();
+        });
+  }
+
+  (*deserializer)->PushCopy(
+      {reinterpret_cast<std::uint8_t const*>(serialization),
+       serialization_size});
+
+  // If the data was empty, delete the deserializer.  This ensures that
+  // |*plugin| is filled.
+  if (serialization_size == 0) {
+    TakeOwnership(deserializer);
+  }
+  return m.Return(true);
+}
+
 // Says hello, convenient for checking that calls to the DLL work.
 char const* principia__SayHello() {
   journal::Method<journal::SayHello> m;
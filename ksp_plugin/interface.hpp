@@ -47,6 +47,18 @@ class TypedIterator : public Iterator {
       std::function<Interchange(typename Container::value_type const&)> const&
           convert) const;
 
+  // Converts the elements starting at the one denoted by this iterator to some
+  // |Interchange| type using |convert| and stores them in |interchanges|, which
+  // has room for |size| elements.  Advances this iterator past the elements
+  // that were stored.  Returns the number of elements stored, which is less
+  // than |size| only if the end of the container was reached.
+  template<typename Interchange>
+  int Fill(
+      std::function<Interchange(typename Container::value_type const&)> const&
+          convert,
+      Interchange* interchanges,
+      int size);
+
   bool AtEnd() const override;
   void Increment() override;
   int Size() const override;
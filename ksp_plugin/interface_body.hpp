@@ -31,6 +31,21 @@ Interchange TypedIterator<Container>::Get(
   return convert(*iterator_);
 }
 
+template<typename Container>
+template<typename Interchange>
+int TypedIterator<Container>::Fill(
+    std::function<Interchange(typename Container::value_type const&)> const&
+        convert,
+    Interchange* const interchanges,
+    int const size) {
+  CHECK_LE(0, size);
+  int count = 0;
+  for (; count < size && iterator_ != container_.end(); ++count, ++iterator_) {
+    interchanges[count] = convert(*iterator_);
+  }
+  return count;
+}
+
 template<typename Container>
 bool TypedIterator<Container>::AtEnd() const {
   return iterator_ == container_.end();
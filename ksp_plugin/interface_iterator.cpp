@@ -41,6 +41,25 @@ XYZ principia__IteratorGetXYZ(Iterator const* const iterator) {
   }));
 }
 
+int principia__IteratorGetXYZs(Iterator* const iterator,
+                               XYZ* const xyzs,
+                               int const xyzs_size) {
+  CHECK_NOTNULL(iterator);
+  auto const typed_iterator = check_not_null(
+      dynamic_cast<TypedIterator<Positions<World>>*>(iterator));
+  int const count = typed_iterator->Fill<XYZ>(
+      [](Position<World> const& position) -> XYZ {
+        return ToXYZ((position - World::origin).coordinates() / Metre);
+      },
+      xyzs,
+      xyzs_size);
+  // The buffer is usually larger than needed.  Only the elements that were
+  // filled are journaled, so the method is constructed once their number is
+  // known.
+  journal::Method<journal::IteratorGetXYZs> m({iterator}, {xyzs, count});
+  return m.Return(count);
+}
+
 int principia__IteratorSize(Iterator const* const iterator) {
   journal::Method<journal::IteratorSize> m({iterator});
   return m.Return(CHECK_NOTNULL(iterator)->Size());
@@ -6,6 +6,7 @@
 #include <limits>
 #include <map>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 #include <set>
@@ -44,8 +45,10 @@ using integrators::DormandElMikkawyPrince1986RKN434FM;
 using integrators::McLachlanAtela1992Order5Optimal;
 using physics::BarycentricRotatingDynamicFrame;
 using physics::BodyCentredNonRotatingDynamicFrame;
+using physics::DistanceToSegment;
 using physics::DynamicFrame;
 using physics::Frenet;
+using physics::HermiteChordError;
 using physics::RotatingBody;
 using quantities::Force;
 using quantities::si::Milli;
@@ -267,12 +270,22 @@ void Plugin::AdvanceTime(Instant const& t, Angle const& planetarium_rotation) {
   bubble_->Prepare(BarycentricToWorldSun(), current_time_, t);
 
   EvolveBubble(t);
+  std::vector<not_null<Vessel*>> vessels_not_in_bubble;
   for (auto const& pair : vessels_) {
     not_null<std::unique_ptr<Vessel>> const& vessel = pair.second;
     if (!bubble_->contains(vessel.get())) {
-      vessel->AdvanceTimeNotInBubble(t);
+      vessels_not_in_bubble.push_back(vessel.get());
     }
   }
+  Vessel::AdvanceTimeNotInBubble(vessels_not_in_bubble, t);
+
+  // Drop the apsides trackers of the segments that are no longer rendered.
+  apsides_trackers_.remove_if([](ApsidesTrackerEntry const& entry) {
+    return !entry.used;
+  });
+  for (auto& entry : apsides_trackers_) {
+    entry.used = false;
+  }
 
   VLOG(1) << "Time has been advanced" << '\n'
           << "from : " << current_time_ << '\n'
@@ -340,6 +353,13 @@ void Plugin::UpdatePrediction(GUID const& vessel_guid) const {
       current_time_ + prediction_length_);
 }
 
+void Plugin::UpdatePredictionAsynchronously(GUID const& vessel_guid) const {
+  CHECK(!initializing_);
+  find_vessel_by_guid_or_die(vessel_guid)->UpdatePredictionAsynchronously(
+      current_time_ + prediction_length_,
+      &prediction_thread_pool_);
+}
+
 void Plugin::CreateFlightPlan(GUID const& vessel_guid,
                               Instant const& final_time,
                               Mass const& initial_mass) const {
@@ -358,9 +378,21 @@ Positions<World> Plugin::RenderedVesselTrajectory(
       find_vessel_by_guid_or_die(vessel_guid);
   CHECK(vessel->is_initialized());
   VLOG(1) << "Rendering a trajectory for the vessel with GUID " << vessel_guid;
-  return RenderedTrajectoryFromIterators(vessel->history().Begin(),
-                                         vessel->history().End(),
-                                         sun_world_position);
+  DiscreteTrajectory<Barycentric> const& history = vessel->history();
+  if (rendering_angular_tolerance_ == Angle()) {
+    return RenderedTrajectoryFromIterators(history.Begin(),
+                                           history.End(),
+                                           sun_world_position);
+  }
+  vessel->EnableHistoryLevelsOfDetail();
+  // Half of the tolerance is used to select the points of the history, the
+  // other half to simplify the rendering.
+  Angle const angular_tolerance = rendering_angular_tolerance_ / 2;
+  auto const points = PointsToRender(history, angular_tolerance);
+  return RenderedTrajectory(points->Begin(),
+                            points->End(),
+                            sun_world_position,
+                            angular_tolerance);
 }
 
 Positions<World> Plugin::RenderedPrediction(
@@ -379,37 +411,10 @@ Positions<World> Plugin::RenderedTrajectoryFromIterators(
     DiscreteTrajectory<Barycentric>::Iterator const& begin,
     DiscreteTrajectory<Barycentric>::Iterator const& end,
     Position<World> const& sun_world_position) const {
-  Positions<World> result;
-  auto const to_world =
-      AffineMap<Barycentric, World, Length, OrthogonalMap>(
-          sun_->current_position(current_time_),
-          sun_world_position,
-          OrthogonalMap<WorldSun, World>::Identity() * BarycentricToWorldSun());
-
-  // Compute the trajectory in the navigation frame.
-  DiscreteTrajectory<Navigation> intermediate_trajectory;
-  for (auto it = begin; it != end; ++it) {
-    intermediate_trajectory.Append(
-        it.time(),
-        plotting_frame_->ToThisFrameAtTime(it.time())(
-            it.degrees_of_freedom()));
-  }
-
-  // Render the trajectory at current time in |World|.
-  DiscreteTrajectory<Navigation>::Iterator const intermediate_end =
-      intermediate_trajectory.End();
-  auto from_navigation_frame_to_world_at_current_time =
-      to_world *
-          plotting_frame_->
-              FromThisFrameAtTime(current_time_).rigid_transformation();
-  for (auto intermediate_it = intermediate_trajectory.Begin();
-       intermediate_it != intermediate_end;
-       ++intermediate_it) {
-    result.emplace_back(from_navigation_frame_to_world_at_current_time(
-        intermediate_it.degrees_of_freedom().position()));
-  }
-  VLOG(1) << "Returning a " << result.size() << "-point trajectory";
-  return result;
+  return RenderedTrajectory(begin,
+                            end,
+                            sun_world_position,
+                            rendering_angular_tolerance_);
 }
 
 Positions<World> Plugin::RenderApsides(
@@ -432,10 +437,19 @@ Positions<World> Plugin::RenderApsides(
               std::numeric_limits<double>::quiet_NaN() * (Metre / Second),
               std::numeric_limits<double>::quiet_NaN() * (Metre / Second)})});
   }
-  return RenderedTrajectoryFromIterators(
-      apsides.Begin(), apsides.End(), sun_world_position);
+  // Each apsis is rendered, irrespective of the rendering tolerance.
+  return RenderedTrajectory(apsides.Begin(),
+                            apsides.End(),
+                            sun_world_position,
+                            /*angular_tolerance=*/Angle());
 }
 
+Plugin::ApsidesTrackerEntry::ApsidesTrackerEntry(
+    Index const celestial_index,
+    not_null<ContinuousTrajectory<Barycentric> const*> const body_trajectory)
+    : celestial_index(celestial_index),
+      tracker(body_trajectory) {}
+
 void Plugin::ComputeAndRenderApsides(
     Index const celestial_index,
     DiscreteTrajectory<Barycentric>::Iterator const& begin,
@@ -443,16 +457,51 @@ void Plugin::ComputeAndRenderApsides(
     Position<World> const& sun_world_position,
     Positions<World>& apoapsides,
     Positions<World>& periapsides) const {
+  // Look for a tracker that may be updated incrementally.
+  auto tracker_it = std::find_if(
+      apsides_trackers_.begin(),
+      apsides_trackers_.end(),
+      [celestial_index, &begin, &end](ApsidesTrackerEntry const& entry) {
+        return entry.celestial_index == celestial_index &&
+               entry.tracker.CanReuse(begin, end);
+      });
+  if (tracker_it == apsides_trackers_.end()) {
+    tracker_it = apsides_trackers_.emplace(
+        apsides_trackers_.end(),
+        celestial_index,
+        ephemeris_->trajectory(
+            FindOrDie(celestials_, celestial_index)->body()));
+  }
+  tracker_it->used = true;
+  ApsidesTracker<Barycentric>& tracker = tracker_it->tracker;
+  ephemeris_->UpdateApsides(begin, end, &tracker);
+
+  // The rendering depends on the plotting frame and on the current time, so it
+  // cannot be cached, but it is proportional to the number of apsides.
   DiscreteTrajectory<Barycentric> apoapsides_trajectory;
   DiscreteTrajectory<Barycentric> periapsides_trajectory;
-  ephemeris_->ComputeApsides(FindOrDie(celestials_, celestial_index)->body(),
-                             begin, end,
-                             apoapsides_trajectory,
-                             periapsides_trajectory);
+  for (auto it = tracker.apoapsides().Begin();
+       it != tracker.apoapsides().End();
+       ++it) {
+    apoapsides_trajectory.Append(it.time(), it.degrees_of_freedom());
+  }
+  for (auto it = tracker.periapsides().Begin();
+       it != tracker.periapsides().End();
+       ++it) {
+    periapsides_trajectory.Append(it.time(), it.degrees_of_freedom());
+  }
   apoapsides = RenderApsides(sun_world_position, apoapsides_trajectory);
   periapsides = RenderApsides(sun_world_position, periapsides_trajectory);
 }
 
+void Plugin::SetRenderingTolerance(
+    Angle const& angular_tolerance,
+    Position<World> const& camera_world_position) {
+  CHECK_LE(Angle(), angular_tolerance);
+  rendering_angular_tolerance_ = angular_tolerance;
+  camera_world_position_ = camera_world_position;
+}
+
 void Plugin::SetPredictionLength(Time const& t) {
   prediction_length_ = t;
 }
@@ -620,58 +669,7 @@ Instant Plugin::CurrentTime() const {
 void Plugin::WriteToMessage(
     not_null<serialization::Plugin*> const message) const {
   LOG(INFO) << __FUNCTION__;
-  CHECK(!initializing_);
-  ephemeris_->Prolong(current_time_);
-  std::map<not_null<Celestial const*>, Index const> celestial_to_index;
-  for (auto const& index_celestial : celestials_) {
-    celestial_to_index.emplace(index_celestial.second.get(),
-                               index_celestial.first);
-  }
-  for (auto const& index_celestial : celestials_) {
-    Index const index = index_celestial.first;
-    not_null<Celestial const*> const celestial = index_celestial.second.get();
-    auto* const celestial_message = message->add_celestial();
-    celestial_message->set_index(index);
-    if (celestial->has_parent()) {
-      Index const parent_index =
-          FindOrDie(celestial_to_index, celestial->parent());
-      celestial_message->set_parent_index(parent_index);
-    }
-  }
-  std::map<not_null<Vessel const*>, GUID const> vessel_to_guid;
-  for (auto const& guid_vessel : vessels_) {
-    std::string const& guid = guid_vessel.first;
-    not_null<Vessel*> const vessel = guid_vessel.second.get();
-    vessel_to_guid.emplace(vessel, guid);
-    auto* const vessel_message = message->add_vessel();
-    vessel_message->set_guid(guid);
-    vessel->WriteToMessage(vessel_message->mutable_vessel());
-    Index const parent_index = FindOrDie(celestial_to_index, vessel->parent());
-    vessel_message->set_parent_index(parent_index);
-    vessel_message->set_dirty(vessel->is_dirty());
-  }
-
-  ephemeris_->WriteToMessage(message->mutable_ephemeris());
-
-  history_parameters_.WriteToMessage(message->mutable_history_parameters());
-  prolongation_parameters_.WriteToMessage(
-      message->mutable_prolongation_parameters());
-  prediction_parameters_.WriteToMessage(
-      message->mutable_prediction_parameters());
-
-  bubble_->WriteToMessage(
-      [&vessel_to_guid](not_null<Vessel const*> const vessel) -> GUID {
-        return FindOrDie(vessel_to_guid, vessel);
-      },
-      message->mutable_bubble());
-
-  planetarium_rotation_.WriteToMessage(message->mutable_planetarium_rotation());
-  current_time_.WriteToMessage(message->mutable_current_time());
-  Index const sun_index = FindOrDie(celestial_to_index, sun_);
-  message->set_sun_index(sun_index);
-  plotting_frame_->WriteToMessage(message->mutable_plotting_frame());
-  LOG(INFO) << NAMED(message->SpaceUsed());
-  LOG(INFO) << NAMED(message->ByteSize());
+  WriteToMessage(message, /*base_time=*/std::experimental::nullopt);
 }
 
 not_null<std::unique_ptr<Plugin>> Plugin::ReadFromMessage(
@@ -765,6 +763,114 @@ not_null<std::unique_ptr<Plugin>> Plugin::ReadFromMessage(
   return std::move(plugin);
 }
 
+void Plugin::WriteDeltaToMessage(
+    not_null<serialization::PluginDelta*> const message,
+    Instant const& base_time) const {
+  LOG(INFO) << __FUNCTION__;
+  base_time.WriteToMessage(message->mutable_base_time());
+  WriteToMessage(message->mutable_plugin(), base_time);
+}
+
+void Plugin::MergeDeltaIntoMessage(
+    serialization::PluginDelta const& delta,
+    not_null<serialization::Plugin*> const message) {
+  LOG(INFO) << __FUNCTION__;
+  Instant const base_time = Instant::ReadFromMessage(delta.base_time());
+  CHECK_EQ(base_time, Instant::ReadFromMessage(message->current_time()))
+      << "Not the base of this delta";
+  CHECK(message->has_ephemeris()) << "Pre-Bourbaki base";
+
+  serialization::Plugin merged = delta.plugin();
+  Ephemeris<Barycentric>::MergeDeltaIntoMessage(delta.plugin().ephemeris(),
+                                                base_time,
+                                                message->mutable_ephemeris());
+  merged.mutable_ephemeris()->Swap(message->mutable_ephemeris());
+
+  // The vessels that were not in the base were created after |base_time|, so
+  // their delta is complete.
+  std::map<GUID, serialization::Vessel*> base_vessels;
+  for (auto& vessel_message : *message->mutable_vessel()) {
+    base_vessels.emplace(vessel_message.guid(),
+                         vessel_message.mutable_vessel());
+  }
+  for (auto& vessel_message : *merged.mutable_vessel()) {
+    auto const it = base_vessels.find(vessel_message.guid());
+    if (it != base_vessels.end()) {
+      serialization::Vessel* const base_vessel = it->second;
+      Vessel::MergeDeltaIntoMessage(vessel_message.vessel(),
+                                    base_time,
+                                    base_vessel);
+      vessel_message.mutable_vessel()->Swap(base_vessel);
+    }
+  }
+  message->Swap(&merged);
+}
+
+void Plugin::WriteToMessage(
+    not_null<serialization::Plugin*> const message,
+    std::experimental::optional<Instant> const& base_time) const {
+  CHECK(!initializing_);
+  ephemeris_->Prolong(current_time_);
+  std::map<not_null<Celestial const*>, Index const> celestial_to_index;
+  for (auto const& index_celestial : celestials_) {
+    celestial_to_index.emplace(index_celestial.second.get(),
+                               index_celestial.first);
+  }
+  for (auto const& index_celestial : celestials_) {
+    Index const index = index_celestial.first;
+    not_null<Celestial const*> const celestial = index_celestial.second.get();
+    auto* const celestial_message = message->add_celestial();
+    celestial_message->set_index(index);
+    if (celestial->has_parent()) {
+      Index const parent_index =
+          FindOrDie(celestial_to_index, celestial->parent());
+      celestial_message->set_parent_index(parent_index);
+    }
+  }
+  std::map<not_null<Vessel const*>, GUID const> vessel_to_guid;
+  for (auto const& guid_vessel : vessels_) {
+    std::string const& guid = guid_vessel.first;
+    not_null<Vessel*> const vessel = guid_vessel.second.get();
+    vessel_to_guid.emplace(vessel, guid);
+    auto* const vessel_message = message->add_vessel();
+    vessel_message->set_guid(guid);
+    if (base_time) {
+      vessel->WriteDeltaToMessage(vessel_message->mutable_vessel(), *base_time);
+    } else {
+      vessel->WriteToMessage(vessel_message->mutable_vessel());
+    }
+    Index const parent_index = FindOrDie(celestial_to_index, vessel->parent());
+    vessel_message->set_parent_index(parent_index);
+    vessel_message->set_dirty(vessel->is_dirty());
+  }
+
+  if (base_time) {
+    ephemeris_->WriteDeltaToMessage(message->mutable_ephemeris(), *base_time);
+  } else {
+    ephemeris_->WriteToMessage(message->mutable_ephemeris());
+  }
+
+  history_parameters_.WriteToMessage(message->mutable_history_parameters());
+  prolongation_parameters_.WriteToMessage(
+      message->mutable_prolongation_parameters());
+  prediction_parameters_.WriteToMessage(
+      message->mutable_prediction_parameters());
+
+  bubble_->WriteToMessage(
+      [&vessel_to_guid](not_null<Vessel const*> const vessel) -> GUID {
+        return FindOrDie(vessel_to_guid, vessel);
+      },
+      message->mutable_bubble());
+
+  planetarium_rotation_.WriteToMessage(message->mutable_planetarium_rotation());
+  current_time_.WriteToMessage(message->mutable_current_time());
+  Index const sun_index = FindOrDie(celestial_to_index, sun_);
+  message->set_sun_index(sun_index);
+  plotting_frame_->WriteToMessage(message->mutable_plotting_frame());
+  LOG(INFO) << NAMED(message->SpaceUsed());
+  LOG(INFO) << NAMED(message->ByteSize());
+}
+
 Plugin::Plugin(GUIDToOwnedVessel vessels,
                IndexToOwnedCelestial celestials,
                not_null<std::unique_ptr<PhysicsBubble>> bubble,
@@ -890,6 +996,158 @@ void Plugin::EvolveBubble(Instant const& t) {
   }
 }
 
+Positions<World> Plugin::RenderedTrajectory(
+    DiscreteTrajectory<Barycentric>::Iterator const& begin,
+    DiscreteTrajectory<Barycentric>::Iterator const& end,
+    Position<World> const& sun_world_position,
+    Angle const& angular_tolerance) const {
+  Positions<World> result;
+  auto const to_world =
+      AffineMap<Barycentric, World, Length, OrthogonalMap>(
+          sun_->current_position(current_time_),
+          sun_world_position,
+          OrthogonalMap<WorldSun, World>::Identity() * BarycentricToWorldSun());
+  // The trajectory is computed in the navigation frame and rendered at current
+  // time in |World|.
+  auto const from_navigation_frame_to_world_at_current_time =
+      to_world *
+          plotting_frame_->
+              FromThisFrameAtTime(current_time_).rigid_transformation();
+  auto const to_navigation_frame =
+      [this](DiscreteTrajectory<Barycentric>::Iterator const& it) {
+        return plotting_frame_->ToThisFrameAtTime(it.time())(
+            it.degrees_of_freedom());
+      };
+  auto const render =
+      [&from_navigation_frame_to_world_at_current_time, &result](
+          DegreesOfFreedom<Navigation> const& degrees_of_freedom) {
+        result.emplace_back(from_navigation_frame_to_world_at_current_time(
+            degrees_of_freedom.position()));
+      };
+
+  if (angular_tolerance == Angle()) {
+    for (auto it = begin; it != end; ++it) {
+      render(to_navigation_frame(it));
+    }
+  } else if (begin != end) {
+    double const tolerance = angular_tolerance / Radian;
+    Position<Navigation> const camera_position =
+        from_navigation_frame_to_world_at_current_time.Inverse()(
+            camera_world_position_);
+
+    // We keep the last rendered point, the last point seen, and the positions
+    // of the points skipped in between.  The last point seen is rendered as
+    // soon as the chord from the last rendered point to the current point
+    // deviates too much from the trajectory, as seen from the camera.  As for
+    // the levels of detail, the trajectory lies within |segment_error| of the
+    // polygon through the skipped points, which lies within the largest
+    // distance of these points from the chord.  If the trajectory lies within
+    // |error| of the chord, the camera is at least at |distance - error| from
+    // it.  Each skipped point is checked against each new chord, so their
+    // number is bounded to keep the cost linear in the number of points.
+    constexpr int max_skipped_points = 100;
+    auto it = begin;
+    Instant rendered_time = it.time();
+    DegreesOfFreedom<Navigation> rendered = to_navigation_frame(it);
+    render(rendered);
+    Instant previous_time = rendered_time;
+    DegreesOfFreedom<Navigation> previous = rendered;
+    std::vector<Position<Navigation>> skipped;
+    Length segment_error;
+    for (++it; it != end; ++it) {
+      Instant const current_time = it.time();
+      DegreesOfFreedom<Navigation> const current = to_navigation_frame(it);
+      Length const last_segment_error = HermiteChordError(
+          previous_time, previous, current_time, current);
+      if (previous_time == rendered_time) {
+        segment_error = last_segment_error;
+      } else {
+        skipped.push_back(previous.position());
+        segment_error = std::max(segment_error, last_segment_error);
+        Length const distance = DistanceToSegment(camera_position,
+                                                  rendered.position(),
+                                                  current.position());
+        Length const max_error = tolerance * distance / (1 + tolerance);
+        Length error = segment_error;
+        for (auto const& position : skipped) {
+          if (error > max_error) {
+            break;
+          }
+          error = std::max(error,
+                           segment_error +
+                               DistanceToSegment(position,
+                                                 rendered.position(),
+                                                 current.position()));
+        }
+        if (error > max_error || skipped.size() == max_skipped_points) {
+          render(previous);
+          rendered_time = previous_time;
+          rendered = previous;
+          skipped.clear();
+          segment_error = last_segment_error;
+        }
+      }
+      previous_time = current_time;
+      previous = current;
+    }
+    if (previous_time != rendered_time) {
+      render(previous);
+    }
+  }
+  VLOG(1) << "Returning a " << result.size() << "-point trajectory";
+  return result;
+}
+
+not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>>
+Plugin::PointsToRender(DiscreteTrajectory<Barycentric> const& trajectory,
+                       Angle const& angular_tolerance) const {
+  // |World| is centred near the active vessel, so this is roughly the length
+  // that is seen under |angular_tolerance| around the trajectories of interest.
+  Length const tolerance = angular_tolerance / Radian *
+                           (camera_world_position_ - World::origin).Norm();
+  auto points = make_not_null_unique<DiscreteTrajectory<Barycentric>>();
+  if (trajectory.Begin() == trajectory.End()) {
+    return points;
+  }
+
+  // The levels of detail bound the chord errors in |Barycentric|, but the
+  // trajectory is rendered in the |plotting_frame_|, where a long chord may be
+  // bent by the motion of the frame.  A chord that the frame bends by more than
+  // |tolerance| is replaced by the chords of the next finer level that it
+  // covers.
+  trajectory.ForEachPointOfAcceptedChords(
+      trajectory.Begin().time(),
+      trajectory.last().time(),
+      [this, tolerance](
+          Instant const& begin_time,
+          DegreesOfFreedom<Barycentric> const& begin_degrees_of_freedom,
+          Instant const& end_time,
+          DegreesOfFreedom<Barycentric> const& end_degrees_of_freedom,
+          Length const& error) {
+        if (error > tolerance) {
+          return false;
+        }
+        Length const barycentric_error =
+            HermiteChordError(begin_time,
+                              begin_degrees_of_freedom,
+                              end_time,
+                              end_degrees_of_freedom);
+        Length const navigation_error = HermiteChordError(
+            begin_time,
+            plotting_frame_->ToThisFrameAtTime(begin_time)(
+                begin_degrees_of_freedom),
+            end_time,
+            plotting_frame_->ToThisFrameAtTime(end_time)(
+                end_degrees_of_freedom));
+        return navigation_error - barycentric_error <= tolerance;
+      },
+      [&points](Instant const& time,
+                DegreesOfFreedom<Barycentric> const& degrees_of_freedom) {
+        points->Append(time, degrees_of_freedom);
+      });
+  return points;
+}
+
 Vector<double, World> Plugin::FromVesselFrenetFrame(
     Vessel const& vessel,
     Vector<double, Frenet<Navigation>> const& vector) const {
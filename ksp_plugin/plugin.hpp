@@ -1,7 +1,9 @@
 ﻿
 #pragma once
 
+#include <experimental/optional>
 #include <limits>
+#include <list>
 #include <map>
 #include <memory>
 #include <set>
@@ -10,6 +12,7 @@
 #include <vector>
 
 #include "base/monostable.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/named_quantities.hpp"
 #include "geometry/point.hpp"
 #include "gtest/gtest.h"
@@ -19,6 +22,7 @@
 #include "ksp_plugin/physics_bubble.hpp"
 #include "ksp_plugin/vessel.hpp"
 #include "integrators/ordinary_differential_equations.hpp"
+#include "physics/apsides_tracker.hpp"
 #include "physics/body.hpp"
 #include "physics/degrees_of_freedom.hpp"
 #include "physics/discrete_trajectory.hpp"
@@ -40,7 +44,9 @@ using geometry::Point;
 using geometry::Rotation;
 using integrators::FixedStepSizeIntegrator;
 using integrators::AdaptiveStepSizeIntegrator;
+using physics::ApsidesTracker;
 using physics::Body;
+using physics::ContinuousTrajectory;
 using physics::DiscreteTrajectory;
 using physics::DynamicFrame;
 using physics::Ephemeris;
@@ -184,6 +190,11 @@ class Plugin {
   // Updates the prediction for the vessel with guid |vessel_guid|.
   void UpdatePrediction(GUID const& vessel_guid) const;
 
+  // Same as |UpdatePrediction|, but the prediction is computed in the
+  // background and only becomes visible during a subsequent call to this
+  // function, see |Vessel::UpdatePredictionAsynchronously|.
+  void UpdatePredictionAsynchronously(GUID const& vessel_guid) const;
+
   virtual void CreateFlightPlan(GUID const& vessel_guid,
                                 Instant const& final_time,
                                 Mass const& initial_mass) const;
@@ -213,7 +224,8 @@ class Plugin {
 
   // A utility for |RenderedPrediction| and |RenderedVesselTrajectory|,
   // returns a |Positions| object corresponding to the trajectory defined by
-  // |begin| and |end|, as seen in the current |plotting_frame_|.
+  // |begin| and |end|, as seen in the current |plotting_frame_|, simplified
+  // according to the rendering tolerance.
   // TODO(phl): Use this directly in the interface and remove the other
   // |Rendered...|.
   virtual Positions<World> RenderedTrajectoryFromIterators(
@@ -233,6 +245,14 @@ class Plugin {
       Positions<World>& apoapsides,
       Positions<World>& periapsides) const;
 
+  // Sets the tolerance used when rendering trajectories: the rendered polygon
+  // only keeps enough points that, seen from |camera_world_position|, it
+  // deviates from the trajectory by at most |angular_tolerance|.  A zero
+  // tolerance, which is the default, renders all the points.
+  virtual void SetRenderingTolerance(
+      Angle const& angular_tolerance,
+      Position<World> const& camera_world_position);
+
   virtual void SetPredictionLength(Time const& t);
 
   virtual void SetPredictionLengthTolerance(Length const& l);
@@ -305,6 +325,24 @@ class Plugin {
   static not_null<std::unique_ptr<Plugin>> ReadFromMessage(
       serialization::Plugin const& message);
 
+  // Writes the state of this plugin relative to a serialization made by
+  // |WriteToMessage| when the current time was |base_time|.  Only the series of
+  // the ephemeris and the points of the histories appended since |base_time|
+  // are written, so the size of the delta doesn't grow with the age of the
+  // base.  The rest of the state is written in full.  Must be called after
+  // initialization.
+  virtual void WriteDeltaToMessage(
+      not_null<serialization::PluginDelta*> const message,
+      Instant const& base_time) const;
+
+  // Folds the |delta| into the |message|, which must be the base from which
+  // |delta| was written.  At exit |message| is identical to the result of
+  // |WriteToMessage| at the time of the |delta|, and may be used as the base of
+  // further deltas.
+  static void MergeDeltaIntoMessage(
+      serialization::PluginDelta const& delta,
+      not_null<serialization::Plugin*> const message);
+
  private:
   using GUIDToOwnedVessel = std::map<GUID, not_null<std::unique_ptr<Vessel>>>;
   using GUIDToUnownedVessel = std::map<GUID, not_null<Vessel*> const>;
@@ -354,10 +392,34 @@ class Plugin {
   // Evolves the trajectory of the |current_physics_bubble_|.
   void EvolveBubble(Instant const& t);
 
+  // Renders the trajectory defined by |begin| and |end| with the given
+  // |angular_tolerance|, see |SetRenderingTolerance|.  The points are converted
+  // to the |plotting_frame_| as they are traversed, without building an
+  // intermediate trajectory.
+  Positions<World> RenderedTrajectory(
+      DiscreteTrajectory<Barycentric>::Iterator const& begin,
+      DiscreteTrajectory<Barycentric>::Iterator const& end,
+      Position<World> const& sun_world_position,
+      Angle const& angular_tolerance) const;
+
+  // Returns the points of |trajectory|, which must have levels of detail, that
+  // are needed to render it with the given |angular_tolerance|, as seen from
+  // the camera, in the |plotting_frame_|.  The cost is proportional to the
+  // number of points returned, not to the length of |trajectory|.
+  not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>> PointsToRender(
+      DiscreteTrajectory<Barycentric> const& trajectory,
+      Angle const& angular_tolerance) const;
+
   Vector<double, World> FromVesselFrenetFrame(
       Vessel const& vessel,
       Vector<double, Frenet<Navigation>> const& vector) const;
 
+  // Writes the histories and the ephemeris in full if |base_time| is null, as
+  // deltas from |*base_time| otherwise.
+  void WriteToMessage(
+      not_null<serialization::Plugin*> const message,
+      std::experimental::optional<Instant> const& base_time) const;
+
   // Fill |celestials| using the |index| and |parent_index| fields found in
   // |celestial_messages| (which may be pre- or post-Bourbaki).
   template<typename T>
@@ -402,6 +464,38 @@ class Plugin {
   Ephemeris<Barycentric>::AdaptiveStepParameters prediction_parameters_;
   Time prediction_length_ = 1 * Hour;
 
+  // The thread on which the predictions are computed by
+  // |UpdatePredictionAsynchronously|.  Declared after the |ephemeris_| and the
+  // |vessels_| so that it is destroyed, and its computations completed, first.
+  mutable base::ThreadPool<bool> prediction_thread_pool_{1};
+
+  // The trackers used by |ComputeAndRenderApsides|, one per segment and
+  // celestial rendered.  They avoid recomputing the apsides of the segments
+  // that are unchanged or only extended from one call to the next, e.g., the
+  // flight plans between two edits.  A prediction, which is reforked at the
+  // last point of the history and starts with the last point of the
+  // prolongation, keeps its tracker when time advances as long as it reuses
+  // the points of the previous prediction: only its new first points and its
+  // new last points are scanned.  The trackers that were not used since the
+  // previous call to |AdvanceTime| are dropped by the next one, so there is
+  // about one tracker per segment rendered on a frame.
+  struct ApsidesTrackerEntry {
+    ApsidesTrackerEntry(
+        Index const celestial_index,
+        not_null<ContinuousTrajectory<Barycentric> const*> const
+            body_trajectory);
+
+    Index celestial_index;
+    bool used = true;
+    ApsidesTracker<Barycentric> tracker;
+  };
+  mutable std::list<ApsidesTrackerEntry> apsides_trackers_;
+
+  // The parameters for simplifying the rendered trajectories, see
+  // |SetRenderingTolerance|.
+  Angle rendering_angular_tolerance_;
+  Position<World> camera_world_position_;
+
   // Whether initialization is ongoing.
   base::Monostable initializing_;
 
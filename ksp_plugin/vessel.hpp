@@ -1,9 +1,12 @@
 ﻿
 #pragma once
 
+#include <experimental/optional>
+#include <future>
 #include <memory>
 #include <vector>
 
+#include "base/thread_pool.hpp"
 #include "ksp_plugin/celestial.hpp"
 #include "ksp_plugin/flight_plan.hpp"
 #include "ksp_plugin/part.hpp"
@@ -15,6 +18,7 @@
 
 namespace principia {
 
+using base::ThreadPool;
 using physics::DiscreteTrajectory;
 using physics::Ephemeris;
 using physics::MasslessBody;
@@ -33,7 +37,9 @@ class Vessel {
   Vessel(Vessel&&) = delete;
   Vessel& operator=(Vessel const&) = delete;
   Vessel& operator=(Vessel&&) = delete;
-  ~Vessel() = default;
+  // Waits for the completion of the computation started by
+  // |UpdatePredictionAsynchronously|, if any.
+  ~Vessel();
 
   // Constructs a vessel whose parent is initially |*parent|.  No transfer of
   // ownership.
@@ -62,6 +68,11 @@ class Vessel {
   virtual DiscreteTrajectory<Barycentric> const& prolongation() const;
   virtual DiscreteTrajectory<Barycentric> const& prediction() const;
 
+  // Enables the levels of detail of the |history()|, which are only needed for
+  // rendering.  They are built on the first call, so that the histories that
+  // are never rendered don't pay for them.  Requires |is_initialized()|.
+  virtual void EnableHistoryLevelsOfDetail();
+
   // Requires |has_flight_plan()|.
   virtual FlightPlan& flight_plan() const;
   virtual bool has_flight_plan() const;
@@ -90,6 +101,14 @@ class Vessel {
   // vessel.
   virtual void AdvanceTimeNotInBubble(Instant const& time);
 
+  // Same as calling |AdvanceTimeNotInBubble(time)| for each of the |vessels|,
+  // except that the histories which have the same parameters and the same last
+  // time are integrated together, as a single system, by one call to
+  // |Ephemeris::FlowWithFixedStep|.  The |vessels| must share an ephemeris.
+  static void AdvanceTimeNotInBubble(
+      std::vector<not_null<Vessel*>> const& vessels,
+      Instant const& time);
+
   // Advances time for a vessel in the physics bubble.  This dirties the vessel.
   virtual void AdvanceTimeInBubble(
       Instant const& time,
@@ -113,8 +132,24 @@ class Vessel {
   // Deletes the |flight_plan_|.  Performs no action unless |has_flight_plan()|.
   virtual void DeleteFlightPlan();
 
+  // Updates the prediction so that it starts at the last point of the
+  // prolongation and extends until |last_time|.  If the existing prediction
+  // is close enough to that point, its points are kept and only its tail is
+  // integrated; otherwise the prediction is recomputed in full.
   virtual void UpdatePrediction(Instant const& last_time);
 
+  // Same as |UpdatePrediction|, except that the integration is performed on
+  // one of the threads of |thread_pool| and that its result only replaces the
+  // |prediction()| during a subsequent call to this function.  Only one
+  // computation is in progress at any given time: if the previous one has not
+  // completed, this function waits for it, so that the predictions are the
+  // same irrespective of the timing of the threads, as required for replaying
+  // journals.  The computation thus overlaps with whatever the caller does
+  // between two calls, typically a frame.
+  virtual void UpdatePredictionAsynchronously(
+      Instant const& last_time,
+      not_null<ThreadPool<bool>*> const thread_pool);
+
   // The vessel must satisfy |is_initialized()|.
   virtual void WriteToMessage(
       not_null<serialization::Vessel*> const message) const;
@@ -123,16 +158,63 @@ class Vessel {
       not_null<Ephemeris<Barycentric>*> const ephemeris,
       not_null<Celestial const*> const parent);
 
+  // Same as |WriteToMessage|, but the history is written using
+  // |DiscreteTrajectory::WriteDeltaToMessage|.
+  virtual void WriteDeltaToMessage(
+      not_null<serialization::Vessel*> const message,
+      Instant const& base_time) const;
+
+  // Folds the |delta| written by |WriteDeltaToMessage| into the |message|
+  // written by |WriteToMessage| at |base_time|.
+  static void MergeDeltaIntoMessage(
+      serialization::Vessel const& delta,
+      Instant const& base_time,
+      not_null<serialization::Vessel*> const message);
+
  protected:
   // For mocking.
   Vessel();
 
  private:
+  // Writes the history in full if |base_time| is null, as a delta from
+  // |*base_time| otherwise.
+  void WriteToMessage(
+      not_null<serialization::Vessel*> const message,
+      std::experimental::optional<Instant> const& base_time) const;
+
   void AdvanceHistoryIfNeeded(Instant const& time);
+  // Appends the last point of a dirty |prolongation_| to the |history_| if the
+  // |history_| needs to be advanced to |time|, and cleans the vessel.  Returns
+  // true if the |history_| needs to be advanced to |time|.
+  bool PrepareHistoryAdvance(Instant const& time);
+  // Forks a new |prolongation_| at the last point of |history_|.
+  void ForkProlongationAtHistoryLast();
   void FlowHistory(Instant const& time);
   void FlowProlongation(Instant const& time);
   void FlowPrediction(Instant const& time);
 
+  // Appends to |trajectory| the points of |prediction_| that may be reused for
+  // a prediction starting at |point| and ending at |last_time|, if
+  // |PredictionIsCloseTo(point)|.  |trajectory| must end at the time of
+  // |point|.  The points are shared with |prediction_|, not copied.
+  void AppendReusablePrediction(
+      DiscreteTrajectory<Barycentric>::Iterator const& point,
+      Instant const& last_time,
+      not_null<DiscreteTrajectory<Barycentric>*> const trajectory) const;
+
+  // Waits for the completion of the |pending_prediction_|, if any, and makes it
+  // the |prediction_|.
+  void InstallPendingPrediction();
+  // Waits for the completion of the |pending_prediction_|, if any, and deletes
+  // it.
+  void DiscardPendingPrediction();
+
+  // Returns true if |prediction_| extends beyond the time of |point| and if, at
+  // that time, it agrees with |point| within the tolerances of the prediction
+  // integrator.
+  bool PredictionIsCloseTo(
+      DiscreteTrajectory<Barycentric>::Iterator const& point) const;
+
   MasslessBody const body_;
   Ephemeris<Barycentric>::FixedStepParameters const
       history_fixed_step_parameters_;
@@ -146,7 +228,8 @@ class Vessel {
 
   // The past and present trajectory of the body. It ends at |HistoryTime()|
   // unless |*this| was created after |HistoryTime()|, in which case it ends
-  // at |current_time_|.  It is advanced with a constant time step.
+  // at |current_time_|.  It is advanced with a constant time step.  It has
+  // levels of detail, which are used for rendering it.
   std::unique_ptr<DiscreteTrajectory<Barycentric>> history_;
 
   // A child trajectory of |*history_|. It is forked at |history_->last_time()|
@@ -157,6 +240,15 @@ class Vessel {
   // Child trajectory of |*history_|.
   DiscreteTrajectory<Barycentric>* prediction_ = nullptr;
 
+  // A root trajectory computed in the background by
+  // |UpdatePredictionAsynchronously|.  It becomes the |prediction_|, forked at
+  // |pending_prediction_fork_time_|, once |pending_prediction_completed_| is
+  // ready.  Until then it must only be accessed by the thread that computes
+  // it.  Null if no computation was started.
+  std::unique_ptr<DiscreteTrajectory<Barycentric>> pending_prediction_;
+  Instant pending_prediction_fork_time_;
+  std::future<bool> pending_prediction_completed_;
+
   std::unique_ptr<FlightPlan> flight_plan_;
   bool is_dirty_ = false;
 };
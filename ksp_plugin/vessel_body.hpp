@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "integrators/embedded_explicit_runge_kutta_nyström_integrator.hpp"
+#include "numerics/hermite3.hpp"
 #include "quantities/si.hpp"
 #include "testing_utilities/make_not_null.hpp"
 
@@ -15,6 +16,7 @@ namespace principia {
 
 using integrators::DormandElMikkawyPrince1986RKN434FM;
 using integrators::McLachlanAtela1992Order5Optimal;
+using numerics::Hermite3;
 using quantities::si::Kilogram;
 using quantities::si::Milli;
 
@@ -37,6 +39,10 @@ inline Vessel::Vessel(not_null<Celestial const*> const parent,
       prediction_adaptive_step_parameters_(
           prediction_adaptive_step_parameters) {}
 
+inline Vessel::~Vessel() {
+  DiscardPendingPrediction();
+}
+
 inline not_null<MasslessBody const*> Vessel::body() const {
   return &body_;
 }
@@ -70,6 +76,11 @@ inline DiscreteTrajectory<Barycentric> const& Vessel::prediction() const {
   return *prediction_;
 }
 
+inline void Vessel::EnableHistoryLevelsOfDetail() {
+  CHECK(is_initialized());
+  history_->EnableLevelsOfDetail();
+}
+
 inline FlightPlan& Vessel::flight_plan() const {
   CHECK(has_flight_plan());
   return *flight_plan_;
@@ -91,6 +102,13 @@ inline void Vessel::set_prediction_adaptive_step_parameters(
     Ephemeris<Barycentric>::AdaptiveStepParameters const&
         prediction_adaptive_step_parameters) {
   prediction_adaptive_step_parameters_ = prediction_adaptive_step_parameters;
+  // The existing prediction was computed with different parameters, make sure
+  // that it is not reused.
+  DiscardPendingPrediction();
+  if (is_initialized()) {
+    history_->DeleteFork(&prediction_);
+    prediction_ = history_->NewForkAtLast();
+  }
 }
 
 inline Ephemeris<Barycentric>::AdaptiveStepParameters const&
@@ -114,6 +132,60 @@ inline void Vessel::AdvanceTimeNotInBubble(Instant const& time) {
   FlowProlongation(time);
 }
 
+inline void Vessel::AdvanceTimeNotInBubble(
+    std::vector<not_null<Vessel*>> const& vessels,
+    Instant const& time) {
+  // The vessels whose histories are integrated as a single system.
+  struct Batch {
+    std::vector<not_null<Vessel*>> vessels;
+    std::vector<not_null<DiscreteTrajectory<Barycentric>*>> histories;
+  };
+  std::vector<Batch> batches;
+  for (not_null<Vessel*> const vessel : vessels) {
+    CHECK(vessel->is_initialized());
+    if (!vessel->PrepareHistoryAdvance(time)) {
+      continue;
+    }
+    auto const& parameters = vessel->history_fixed_step_parameters_;
+    Instant const& history_last_time = vessel->history_->last().time();
+    auto const it = std::find_if(
+        batches.begin(),
+        batches.end(),
+        [&parameters, &history_last_time](Batch const& batch) {
+          Vessel const& representative = *batch.vessels.front();
+          auto const& representative_parameters =
+              representative.history_fixed_step_parameters_;
+          return &representative_parameters.integrator() ==
+                     &parameters.integrator() &&
+                 representative_parameters.step() == parameters.step() &&
+                 representative.history_->last().time() == history_last_time;
+        });
+    if (it == batches.end()) {
+      batches.push_back({{vessel}, {vessel->history_.get()}});
+    } else {
+      CHECK_EQ(it->vessels.front()->ephemeris_, vessel->ephemeris_);
+      it->vessels.push_back(vessel);
+      it->histories.push_back(vessel->history_.get());
+    }
+  }
+
+  for (auto const& batch : batches) {
+    Vessel const& representative = *batch.vessels.front();
+    representative.ephemeris_->FlowWithFixedStep(
+        batch.histories,
+        Ephemeris<Barycentric>::kNoIntrinsicAccelerations,
+        time,
+        representative.history_fixed_step_parameters_);
+    for (not_null<Vessel*> const vessel : batch.vessels) {
+      vessel->ForkProlongationAtHistoryLast();
+    }
+  }
+
+  for (not_null<Vessel*> const vessel : vessels) {
+    vessel->FlowProlongation(time);
+  }
+}
+
 inline void Vessel::AdvanceTimeInBubble(
     Instant const& time,
     DegreesOfFreedom<Barycentric> const& degrees_of_freedom) {
@@ -133,6 +205,10 @@ inline Instant Vessel::ForgettableTime() const {
   Instant forgettable_time = prolongation_->Fork().time();
   forgettable_time = std::min(forgettable_time,
                               prediction_->Fork().time());
+  if (pending_prediction_ != nullptr) {
+    forgettable_time = std::min(forgettable_time,
+                                pending_prediction_fork_time_);
+  }
   if (flight_plan_ != nullptr) {
     forgettable_time = std::min(forgettable_time,
                                 flight_plan_->initial_time());
@@ -160,25 +236,92 @@ inline void Vessel::DeleteFlightPlan() {
 
 inline void Vessel::UpdatePrediction(Instant const& last_time) {
   CHECK(is_initialized());
-  history_->DeleteFork(&prediction_);
-  prediction_ = history_->NewForkAtLast();
+  InstallPendingPrediction();
   auto const prolongation_last = prolongation_->last();
+  not_null<DiscreteTrajectory<Barycentric>*> const prediction =
+      history_->NewForkAtLast();
   if (history_->last().time() != prolongation_last.time()) {
-    prediction_->Append(prolongation_last.time(),
-                        prolongation_last.degrees_of_freedom());
+    prediction->Append(prolongation_last.time(),
+                       prolongation_last.degrees_of_freedom());
   }
+  AppendReusablePrediction(prolongation_last, last_time, prediction);
+  history_->DeleteFork(&prediction_);
+  prediction_ = prediction;
   FlowPrediction(last_time);
 }
 
+inline void Vessel::UpdatePredictionAsynchronously(
+    Instant const& last_time,
+    not_null<ThreadPool<bool>*> const thread_pool) {
+  CHECK(is_initialized());
+  // Always wait for the previous computation, rather than skipping this call if
+  // it has not completed: the resulting trajectories must not depend on the
+  // timing of the threads, otherwise a journal could not be replayed.
+  InstallPendingPrediction();
+
+  // The history may be advanced while the computation is in progress, so the
+  // pending prediction is a root trajectory which is only grafted onto the
+  // history when it is installed.
+  auto const prolongation_last = prolongation_->last();
+  pending_prediction_fork_time_ = history_->last().time();
+  pending_prediction_ = std::make_unique<DiscreteTrajectory<Barycentric>>();
+  pending_prediction_->Append(prolongation_last.time(),
+                              prolongation_last.degrees_of_freedom());
+  AppendReusablePrediction(
+      prolongation_last, last_time, pending_prediction_.get());
+  if (last_time > pending_prediction_->last().time()) {
+    pending_prediction_completed_ =
+        ephemeris_->FlowWithAdaptiveStepAsynchronously(
+            pending_prediction_.get(),
+            Ephemeris<Barycentric>::kNoIntrinsicAcceleration,
+            last_time,
+            prediction_adaptive_step_parameters_,
+            FlightPlan::max_ephemeris_steps_per_frame,
+            thread_pool);
+  } else {
+    // Nothing to integrate, the new prediction is available right away.
+    InstallPendingPrediction();
+  }
+}
+
 inline void Vessel::WriteToMessage(
     not_null<serialization::Vessel*> const message) const {
+  WriteToMessage(message, /*base_time=*/std::experimental::nullopt);
+}
+
+inline void Vessel::WriteDeltaToMessage(
+    not_null<serialization::Vessel*> const message,
+    Instant const& base_time) const {
+  WriteToMessage(message, base_time);
+}
+
+inline void Vessel::MergeDeltaIntoMessage(
+    serialization::Vessel const& delta,
+    Instant const& base_time,
+    not_null<serialization::Vessel*> const message) {
+  DiscreteTrajectory<Barycentric>::MergeDeltaIntoMessage(
+      delta.history(), base_time, message->mutable_history());
+  serialization::Vessel merged = delta;
+  merged.mutable_history()->Swap(message->mutable_history());
+  message->Swap(&merged);
+}
+
+inline void Vessel::WriteToMessage(
+    not_null<serialization::Vessel*> const message,
+    std::experimental::optional<Instant> const& base_time) const {
   CHECK(is_initialized());
   body_.WriteToMessage(message->mutable_body());
   prolongation_adaptive_step_parameters_.WriteToMessage(
       message->mutable_prolongation_adaptive_step_parameters());
   history_fixed_step_parameters_.WriteToMessage(
       message->mutable_history_fixed_step_parameters());
-  history_->WriteToMessage(message->mutable_history(), {prolongation_});
+  if (base_time) {
+    history_->WriteDeltaToMessage(message->mutable_history(),
+                                  {prolongation_},
+                                  *base_time);
+  } else {
+    history_->WriteToMessage(message->mutable_history(), {prolongation_});
+  }
   prediction_->Fork().time().WriteToMessage(
       message->mutable_prediction_fork_time());
   prediction_->last().time().WriteToMessage(
@@ -277,6 +420,13 @@ inline Vessel::Vessel()
       prediction_adaptive_step_parameters_(DefaultPredictionParameters()) {}
 
 inline void Vessel::AdvanceHistoryIfNeeded(Instant const& time) {
+  if (PrepareHistoryAdvance(time)) {
+    FlowHistory(time);
+    ForkProlongationAtHistoryLast();
+  }
+}
+
+inline bool Vessel::PrepareHistoryAdvance(Instant const& time) {
   Instant const& history_last_time = history_->last().time();
   Time const& Δt = history_fixed_step_parameters_.step();
 
@@ -287,10 +437,14 @@ inline void Vessel::AdvanceHistoryIfNeeded(Instant const& time) {
                        prolongation_->last().degrees_of_freedom());
       is_dirty_ = false;
     }
-    FlowHistory(time);
-    history_->DeleteFork(&prolongation_);
-    prolongation_ = history_->NewForkAtLast();
+    return true;
   }
+  return false;
+}
+
+inline void Vessel::ForkProlongationAtHistoryLast() {
+  history_->DeleteFork(&prolongation_);
+  prolongation_ = history_->NewForkAtLast();
 }
 
 inline void Vessel::FlowHistory(Instant const& time) {
@@ -315,6 +469,44 @@ inline void Vessel::FlowProlongation(Instant const& time) {
       Ephemeris<Barycentric>::unlimited_max_ephemeris_steps);
 }
 
+inline bool Vessel::PredictionIsCloseTo(
+    DiscreteTrajectory<Barycentric>::Iterator const& point) const {
+  Instant const& time = point.time();
+  if (prediction_->last().time() <= time) {
+    return false;
+  }
+
+  // Interpolate the prediction at |time|.
+  auto const upper = prediction_->LowerBound(time);
+  Position<Barycentric> predicted_position;
+  Velocity<Barycentric> predicted_velocity;
+  if (upper.time() == time) {
+    predicted_position = upper.degrees_of_freedom().position();
+    predicted_velocity = upper.degrees_of_freedom().velocity();
+  } else {
+    if (upper == prediction_->Begin()) {
+      return false;
+    }
+    auto lower = upper;
+    --lower;
+    Hermite3<Instant, Position<Barycentric>> const approximation(
+        {lower.time(), upper.time()},
+        {lower.degrees_of_freedom().position(),
+         upper.degrees_of_freedom().position()},
+        {lower.degrees_of_freedom().velocity(),
+         upper.degrees_of_freedom().velocity()});
+    predicted_position = approximation.Evaluate(time);
+    predicted_velocity = approximation.EvaluateDerivative(time);
+  }
+
+  return (predicted_position - point.degrees_of_freedom().position()).Norm() <=
+             prediction_adaptive_step_parameters_.
+                 length_integration_tolerance() &&
+         (predicted_velocity - point.degrees_of_freedom().velocity()).Norm() <=
+             prediction_adaptive_step_parameters_.
+                 speed_integration_tolerance();
+}
+
 inline void Vessel::FlowPrediction(Instant const& time) {
   if (time > prediction_->last().time()) {
     ephemeris_->FlowWithAdaptiveStep(
@@ -326,6 +518,47 @@ inline void Vessel::FlowPrediction(Instant const& time) {
   }
 }
 
+inline void Vessel::AppendReusablePrediction(
+    DiscreteTrajectory<Barycentric>::Iterator const& point,
+    Instant const& last_time,
+    not_null<DiscreteTrajectory<Barycentric>*> const trajectory) const {
+  if (last_time <= point.time() || !PredictionIsCloseTo(point)) {
+    return;
+  }
+  // The points of the previous prediction are shared, not copied, so the cost
+  // doesn't depend on the length of the prediction.  The integration restarts
+  // from its last point.
+  trajectory->AppendSharedTail(*prediction_, point.time());
+  if (trajectory->last().time() > last_time) {
+    trajectory->ForgetAfter(last_time);
+  }
+}
+
+inline void Vessel::InstallPendingPrediction() {
+  if (pending_prediction_ == nullptr) {
+    return;
+  }
+  // The future is not valid if there was nothing to integrate.
+  if (pending_prediction_completed_.valid()) {
+    pending_prediction_completed_.get();
+  }
+  history_->DeleteFork(&prediction_);
+  prediction_ = history_->NewForkWithoutCopy(pending_prediction_fork_time_);
+  prediction_->AppendSharedTail(*pending_prediction_,
+                                pending_prediction_fork_time_);
+  pending_prediction_.reset();
+}
+
+inline void Vessel::DiscardPendingPrediction() {
+  if (pending_prediction_ == nullptr) {
+    return;
+  }
+  if (pending_prediction_completed_.valid()) {
+    pending_prediction_completed_.wait();
+  }
+  pending_prediction_.reset();
+}
+
 inline Ephemeris<Barycentric>::FixedStepParameters DefaultHistoryParameters() {
   return Ephemeris<Barycentric>::FixedStepParameters(
              McLachlanAtela1992Order5Optimal<Position<Barycentric>>(),
@@ -103,11 +103,16 @@ public enum Style {
 
       UnityEngine.GL.Color(colour);
       int size = trajectory_iterator.IteratorSize();
+      // Fetch all the points in a single call, crossing the native boundary
+      // once per trajectory instead of three times per point.  The buffer is
+      // reused from one call to the next to avoid garbage.
+      if (points_.Length < size) {
+        points_ = new XYZ[size];
+      }
+      int count = trajectory_iterator.IteratorGetXYZs(points_, size);
 
-      for (int i = 0;
-           !trajectory_iterator.IteratorAtEnd();
-           trajectory_iterator.IteratorIncrement(), ++i) {
-        Vector3d current_point = (Vector3d)trajectory_iterator.IteratorGetXYZ();
+      for (int i = 0; i < count; ++i) {
+        Vector3d current_point = (Vector3d)points_[i];
         if (previous_point.HasValue) {
           if (style == Style.FADED) {
             colour.a = (float)(4 * i + size) / (float)(5 * size);
@@ -132,6 +137,7 @@ public enum Style {
   }
 
   private static bool rendering_lines_ = false;
+  private static XYZ[] points_ = new XYZ[0];
   private static CelestialBody[] hiding_bodies_;
   private static UnityEngine.Material line_material_;
   private static UnityEngine.Material line_material {
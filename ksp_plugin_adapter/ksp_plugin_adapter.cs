@@ -20,6 +20,9 @@ public partial class PrincipiaPluginAdapter
   private const String kPrincipiaInitialState = "principia_initial_state";
   private const String kPrincipiaGravityModel = "principia_gravity_model";
   private const double kΔt = 10;
+  // The angle (in radians) by which the rendered trajectories may deviate from
+  // the actual ones, roughly a pixel of the map view.
+  private const double kRenderingAngularTolerance = 1e-3;
 
   private KSP.UI.Screens.ApplicationLauncherButton toolbar_button_;
   private bool hide_all_gui_ = false;
@@ -772,6 +775,10 @@ where is_in_physics_bubble(vessel)
       RemoveStockTrajectoriesIfNeeded(active_vessel);
 
       XYZ sun_world_position = (XYZ)Planetarium.fetch.Sun.position;
+      plugin_.SetRenderingTolerance(
+          kRenderingAngularTolerance,
+          (XYZ)ScaledSpace.ScaledToLocalSpace(
+              PlanetariumCamera.Camera.transform.position));
 
       GLLines.Draw(() => {
         GLLines.RenderAndDeleteTrajectory(
@@ -45,9 +45,14 @@ public enum NodeSource {
                                      CelestialBody celestial,
                                      MapObject.ObjectType type,
                                      NodeSource source) {
-    for (; !apsis_iterator.IteratorAtEnd();
-         apsis_iterator.IteratorIncrement()) {
-      Vector3d apsis = (Vector3d)apsis_iterator.IteratorGetXYZ();
+    int size = apsis_iterator.IteratorSize();
+    // The buffer is reused from one call to the next to avoid garbage.
+    if (apsides_.Length < size) {
+      apsides_ = new XYZ[size];
+    }
+    int count = apsis_iterator.IteratorGetXYZs(apsides_, size);
+    for (int i = 0; i < count; ++i) {
+      Vector3d apsis = (Vector3d)apsides_[i];
       MapNodeProperties node_properties;
       node_properties.object_type = type;
       node_properties.celestial = celestial;
@@ -151,6 +156,8 @@ private struct MapNodeProperties {
   private Dictionary<KSP.UI.Screens.Mapview.MapNode,
                      MapNodeProperties> properties_;
   private int pool_index_ = 0;
+  // The buffer into which the apsides are fetched, reused across calls.
+  private XYZ[] apsides_ = new XYZ[0];
 }
 
 }  // namespace ksp_plugin_adapter
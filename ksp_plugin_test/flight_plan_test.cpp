@@ -113,6 +113,20 @@ class FlightPlanTest : public testing::Test {
     return burn;
   }
 
+  bool RecomputeSegments() {
+    return flight_plan_->RecomputeSegments();
+  }
+
+  void SetAdaptiveStepParametersWithoutRecomputation(
+      Ephemeris<Barycentric>::AdaptiveStepParameters const&
+          adaptive_step_parameters) {
+    flight_plan_->adaptive_step_parameters_ = adaptive_step_parameters;
+  }
+
+  int anomalous_segments() const {
+    return flight_plan_->anomalous_segments_;
+  }
+
   Instant const t0_;
   std::unique_ptr<TestNavigationFrame> navigation_frame_;
   std::unique_ptr<Ephemeris<Barycentric>> ephemeris_;
@@ -261,6 +275,88 @@ TEST_F(FlightPlanTest, Replace) {
   EXPECT_EQ(1, flight_plan_->number_of_manœuvres());
 }
 
+TEST_F(FlightPlanTest, ReplaceAtSameTime) {
+  DiscreteTrajectory<Barycentric>::Iterator coast_begin;
+  DiscreteTrajectory<Barycentric>::Iterator coast_end;
+  DiscreteTrajectory<Barycentric>::Iterator begin;
+  DiscreteTrajectory<Barycentric>::Iterator end;
+  flight_plan_->SetFinalTime(t0_ + 42 * Second);
+  EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
+  Mass const old_final_mass = flight_plan_->GetManœuvre(0).final_mass();
+  flight_plan_->GetSegment(0, &coast_begin, &coast_end);
+
+  // The burn starts at the same time, so the first coast is not recomputed.
+  EXPECT_TRUE(flight_plan_->ReplaceLast(MakeThirdBurn()));
+  EXPECT_EQ(3, flight_plan_->number_of_segments());
+  EXPECT_GT(old_final_mass, flight_plan_->GetManœuvre(0).final_mass());
+  flight_plan_->GetSegment(0, &begin, &end);
+  EXPECT_EQ(coast_begin, begin);
+  EXPECT_EQ(coast_end, end);
+  flight_plan_->GetSegment(2, &begin, &end);
+  --end;
+  EXPECT_EQ(t0_ + 42 * Second, end.time());
+
+  // The burn starts later, so the first coast is recomputed.
+  EXPECT_TRUE(flight_plan_->ReplaceLast(MakeSecondBurn()));
+  EXPECT_EQ(3, flight_plan_->number_of_segments());
+  flight_plan_->GetSegment(0, &begin, &end);
+  --end;
+  EXPECT_EQ(MakeSecondBurn().initial_time, end.time());
+}
+
+TEST_F(FlightPlanTest, ReplaceAtSameTimeAfterTruncatedCoast) {
+  DiscreteTrajectory<Barycentric>::Iterator begin;
+  DiscreteTrajectory<Barycentric>::Iterator end;
+  flight_plan_->SetFinalTime(t0_ + 42 * Second);
+  EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
+
+  // Recompute the segments with a |max_steps| and tolerances that truncate the
+  // first coast, which makes the burn and the last coast anomalous too.
+  auto const adaptive_step_parameters =
+      flight_plan_->adaptive_step_parameters();
+  SetAdaptiveStepParametersWithoutRecomputation(
+      Ephemeris<Barycentric>::AdaptiveStepParameters(
+          DormandElMikkawyPrince1986RKN434FM<Position<Barycentric>>(),
+          /*max_steps=*/1,
+          /*length_integration_tolerance=*/1E-9 * Metre,
+          /*speed_integration_tolerance=*/1E-9 * Metre / Second));
+  EXPECT_FALSE(RecomputeSegments());
+  EXPECT_EQ(3, anomalous_segments());
+  SetAdaptiveStepParametersWithoutRecomputation(adaptive_step_parameters);
+
+  // The burn starts at the same time, but the first coast doesn't reach it, so
+  // it must be recomputed.
+  EXPECT_TRUE(flight_plan_->ReplaceLast(MakeThirdBurn()));
+  EXPECT_EQ(0, anomalous_segments());
+  EXPECT_EQ(3, flight_plan_->number_of_segments());
+  flight_plan_->GetSegment(0, &begin, &end);
+  --end;
+  EXPECT_EQ(MakeThirdBurn().initial_time, end.time());
+  flight_plan_->GetSegment(2, &begin, &end);
+  --end;
+  EXPECT_EQ(t0_ + 42 * Second, end.time());
+}
+
+TEST_F(FlightPlanTest, SetFinalTime) {
+  DiscreteTrajectory<Barycentric>::Iterator begin;
+  DiscreteTrajectory<Barycentric>::Iterator end;
+  EXPECT_TRUE(flight_plan_->SetFinalTime(t0_ + 42 * Second));
+  EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
+  EXPECT_FALSE(flight_plan_->SetFinalTime(t0_ + 1.5 * Second));
+  for (Instant const final_time :
+           {t0_ + 10 * Second, t0_ + 20 * Second, t0_ + 1.7 * Second}) {
+    EXPECT_TRUE(flight_plan_->SetFinalTime(final_time));
+    EXPECT_EQ(final_time, flight_plan_->final_time());
+    flight_plan_->GetSegment(2, &begin, &end);
+    --end;
+    EXPECT_EQ(final_time, end.time());
+    flight_plan_->GetSegment(2, &begin, &end);
+    for (auto it = begin, previous = begin; ++it != end; previous = it) {
+      EXPECT_LT(previous.time(), it.time());
+    }
+  }
+}
+
 TEST_F(FlightPlanTest, Segments) {
   flight_plan_->SetFinalTime(t0_ + 42 * Second);
   EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
@@ -298,6 +394,8 @@ TEST_F(FlightPlanTest, SetAdaptiveStepParameter) {
   --end;
   EXPECT_EQ(t0_ + 42 * Second, end.time());
 
+  DiscreteTrajectory<Barycentric>::Iterator const last_begin = begin;
+
   // Reduce |max_steps|.  This causes many segments to become truncated so the
   // call to |SetAdaptiveStepParameters| returns false and the flight plan is
   // unaffected.
@@ -310,6 +408,7 @@ TEST_F(FlightPlanTest, SetAdaptiveStepParameter) {
 
   EXPECT_EQ(5, flight_plan_->number_of_segments());
   flight_plan_->GetSegment(4, &begin, &end);
+  EXPECT_EQ(last_begin, begin);
   --end;
   EXPECT_EQ(t0_ + 42 * Second, end.time());
 
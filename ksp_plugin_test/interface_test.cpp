@@ -2,6 +2,7 @@
 #include "ksp_plugin/interface.hpp"
 
 #include <string>
+#include <vector>
 
 #include "base/not_null.hpp"
 #include "base/pull_serializer.hpp"
@@ -147,8 +148,9 @@ class InterfaceTest : public testing::Test {
   static void SetUpTestCase() {
     std::string const test_case_name =
         testing::UnitTest::GetInstance()->current_test_case()->name();
-    recorder_ = new journal::Recorder(test_case_name + ".journal.hex",
-                                      /*verbose=*/false);
+    recorder_ = new journal::Recorder(test_case_name + ".journal",
+                                      /*verbose=*/false,
+                                      journal::Recorder::Format::kBinary);
     journal::Recorder::Activate(recorder_);
   }
 
@@ -220,6 +222,8 @@ TEST_F(InterfaceDeathTest, InitGoogleLogging2) {
 }
 
 TEST_F(InterfaceDeathTest, ActivateRecorder) {
+  // The child must not inherit a recorder whose writer thread was not forked.
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
   EXPECT_DEATH({
     journal::Recorder::Deactivate();
     // Fails because the glog directory doesn't exist.
@@ -641,9 +645,78 @@ TEST_F(InterfaceTest, Iterator) {
   EXPECT_THAT(iterator, IsNull());
 }
 
+TEST_F(InterfaceTest, IteratorGetXYZs) {
+  StrictMock<MockDynamicFrame<Barycentric, Navigation>>* const
+     mock_navigation_frame =
+         new StrictMock<MockDynamicFrame<Barycentric, Navigation>>;
+  EXPECT_CALL(*plugin_,
+              FillBarycentricRotatingNavigationFrame(kCelestialIndex,
+                                                     kParentIndex,
+                                                     _))
+      .WillOnce(FillUniquePtr<2>(mock_navigation_frame));
+  NavigationFrame* navigation_frame =
+      principia__NewBarycentricRotatingNavigationFrame(plugin_.get(),
+                                                       kCelestialIndex,
+                                                       kParentIndex);
+  EXPECT_CALL(*plugin_, SetPlottingFrameConstRef(Ref(*navigation_frame)));
+  principia__SetPlottingFrame(plugin_.get(), &navigation_frame);
+
+  // Construct a test rendered trajectory.
+  Positions<World> rendered_trajectory;
+  Position<World> position =
+      World::origin + Displacement<World>({1 * SIUnit<Length>(),
+                                           2 * SIUnit<Length>(),
+                                           3 * SIUnit<Length>()});
+  rendered_trajectory.push_back(position);
+  for (int i = 1; i < kTrajectorySize; ++i) {
+    position += Displacement<World>({10 * SIUnit<Length>(),
+                                     20 * SIUnit<Length>(),
+                                     30 * SIUnit<Length>()});
+    rendered_trajectory.push_back(position);
+  }
+
+  EXPECT_CALL(*plugin_,
+              RenderedVesselTrajectory(
+                  kVesselGUID,
+                  World::origin + Displacement<World>(
+                                      {kParentPosition.x * SIUnit<Length>(),
+                                       kParentPosition.y * SIUnit<Length>(),
+                                       kParentPosition.z * SIUnit<Length>()})))
+      .WillOnce(Return(rendered_trajectory));
+  Iterator* iterator =
+      principia__RenderedVesselTrajectory(plugin_.get(),
+                                          kVesselGUID,
+                                          kParentPosition);
+
+  // Get the first few points, then ask for more points than are left.
+  std::vector<XYZ> xyzs(kTrajectorySize + 1);
+  EXPECT_EQ(3, principia__IteratorGetXYZs(iterator, &xyzs[0], 3));
+  EXPECT_FALSE(principia__IteratorAtEnd(iterator));
+  EXPECT_EQ(kTrajectorySize - 3,
+            principia__IteratorGetXYZs(iterator, &xyzs[3], kTrajectorySize));
+  EXPECT_TRUE(principia__IteratorAtEnd(iterator));
+  for (int i = 0; i < kTrajectorySize; ++i) {
+    EXPECT_EQ(1 + 10 * i, xyzs[i].x);
+    EXPECT_EQ(2 + 20 * i, xyzs[i].y);
+    EXPECT_EQ(3 + 30 * i, xyzs[i].z);
+  }
+  EXPECT_EQ(0, principia__IteratorGetXYZs(iterator, &xyzs[0], 1));
+
+  principia__IteratorDelete(&iterator);
+  EXPECT_THAT(iterator, IsNull());
+}
+
 TEST_F(InterfaceTest, PredictionGettersAndSetters) {
   EXPECT_CALL(*plugin_, SetPredictionLength(42 * Second));
   principia__SetPredictionLength(plugin_.get(), 42);
+  EXPECT_CALL(*plugin_,
+              SetRenderingTolerance(
+                  1e-3 * Radian,
+                  World::origin + Displacement<World>(
+                                      {kParentPosition.x * SIUnit<Length>(),
+                                       kParentPosition.y * SIUnit<Length>(),
+                                       kParentPosition.z * SIUnit<Length>()})));
+  principia__SetRenderingTolerance(plugin_.get(), 1e-3, kParentPosition);
   EXPECT_CALL(*plugin_, SetPredictionLengthTolerance(1729 * Metre));
   principia__SetPredictionLengthTolerance(plugin_.get(), 1729);
   EXPECT_CALL(*plugin_, SetPredictionSpeedTolerance(163 * Metre / Second));
@@ -823,6 +896,140 @@ TEST_F(InterfaceTest, DeserializePlugin) {
   principia__DeletePlugin(&plugin);
 }
 
+TEST_F(InterfaceTest, SerializePluginBinary) {
+  PullSerializer* serializer = nullptr;
+  char const* chunk = nullptr;
+  std::string const message_bytes =
+      std::string(kSerializedBoringPlugin,
+                  (sizeof(kSerializedBoringPlugin) - 1) / sizeof(char));
+  principia::serialization::Plugin message;
+  message.ParseFromString(message_bytes);
+
+  EXPECT_CALL(*plugin_, WriteToMessage(_)).WillOnce(SetArgPointee<0>(message));
+  int const size =
+      principia__SerializePluginBinary(plugin_.get(), &serializer, &chunk);
+  EXPECT_EQ(message_bytes, std::string(chunk, size));
+  EXPECT_EQ(0,
+            principia__SerializePluginBinary(plugin_.get(),
+                                             &serializer,
+                                             &chunk));
+  EXPECT_THAT(chunk, IsNull());
+  EXPECT_THAT(serializer, IsNull());
+}
+
+TEST_F(InterfaceTest, DeserializePluginBinary) {
+  PushDeserializer* deserializer = nullptr;
+  Plugin const* plugin = nullptr;
+  principia__DeserializePluginBinary(
+          kSerializedBoringPlugin,
+          (sizeof(kSerializedBoringPlugin) - 1) / sizeof(char),
+          &deserializer,
+          &plugin);
+  principia__DeserializePluginBinary(kSerializedBoringPlugin,
+                                     0,
+                                     &deserializer,
+                                     &plugin);
+  EXPECT_THAT(plugin, NotNull());
+  EXPECT_EQ(Instant(), plugin->CurrentTime());
+  principia__DeletePlugin(&plugin);
+}
+
+TEST_F(InterfaceTest, SerializePluginDelta) {
+  PullSerializer* serializer = nullptr;
+  char const* chunk = nullptr;
+  principia::serialization::PluginDelta message;
+  Instant().WriteToMessage(message.mutable_base_time());
+  message.mutable_plugin()->ParseFromString(
+      std::string(kSerializedBoringPlugin,
+                  (sizeof(kSerializedBoringPlugin) - 1) / sizeof(char)));
+  std::string const message_bytes = message.SerializeAsString();
+
+  EXPECT_CALL(*plugin_, WriteDeltaToMessage(_, Instant() + 3 * Second))
+      .WillOnce(SetArgPointee<0>(message));
+  int const size = principia__SerializePluginDelta(plugin_.get(),
+                                                   /*base_time=*/3,
+                                                   &serializer,
+                                                   &chunk);
+  EXPECT_EQ(message_bytes, std::string(chunk, size));
+  EXPECT_EQ(0,
+            principia__SerializePluginDelta(plugin_.get(),
+                                            /*base_time=*/3,
+                                            &serializer,
+                                            &chunk));
+  EXPECT_THAT(chunk, IsNull());
+  EXPECT_THAT(serializer, IsNull());
+}
+
+TEST_F(InterfaceTest, SerializeAndDeserializePluginDelta) {
+  PushDeserializer* deserializer = nullptr;
+  Plugin const* base = nullptr;
+  principia__DeserializePluginBinary(
+      kSerializedBoringPlugin,
+      (sizeof(kSerializedBoringPlugin) - 1) / sizeof(char),
+      &deserializer,
+      &base);
+  principia__DeserializePluginBinary(kSerializedBoringPlugin,
+                                     0,
+                                     &deserializer,
+                                     &base);
+  ASSERT_THAT(base, NotNull());
+
+  // A delta relative to a save made at the current time of |base|.
+  PullSerializer* serializer = nullptr;
+  char const* chunk = nullptr;
+  std::string delta;
+  for (int size = principia__SerializePluginDelta(
+           base, /*base_time=*/0, &serializer, &chunk);
+       size != 0;
+       size = principia__SerializePluginDelta(
+           base, /*base_time=*/0, &serializer, &chunk)) {
+    delta.append(chunk, size);
+  }
+  EXPECT_THAT(serializer, IsNull());
+
+  Plugin const* plugin = nullptr;
+  EXPECT_TRUE(principia__DeserializePluginDelta(
+      delta.data(),
+      static_cast<int>(delta.size()),
+      kSerializedBoringPlugin,
+      (sizeof(kSerializedBoringPlugin) - 1) / sizeof(char),
+      &deserializer,
+      &plugin));
+  EXPECT_TRUE(principia__DeserializePluginDelta(delta.data(),
+                                                0,
+                                                kSerializedBoringPlugin,
+                                                0,
+                                                &deserializer,
+                                                &plugin));
+  ASSERT_THAT(plugin, NotNull());
+  EXPECT_NE(base, plugin);
+  EXPECT_EQ(Instant(), plugin->CurrentTime());
+
+  // The plugin obtained from the base and the delta is the base.
+  principia::serialization::Plugin base_message;
+  base->WriteToMessage(&base_message);
+  principia::serialization::Plugin plugin_message;
+  plugin->WriteToMessage(&plugin_message);
+  EXPECT_EQ(base_message.SerializeAsString(),
+            plugin_message.SerializeAsString());
+
+  // A base that cannot be parsed is an error, not a crash.
+  char const truncated_base[] = "\x0a\xff";
+  Plugin const* failed_plugin = nullptr;
+  EXPECT_FALSE(principia__DeserializePluginDelta(
+      delta.data(),
+      static_cast<int>(delta.size()),
+      truncated_base,
+      (sizeof(truncated_base) - 1) / sizeof(char),
+      &deserializer,
+      &failed_plugin));
+  EXPECT_THAT(deserializer, IsNull());
+  EXPECT_THAT(failed_plugin, IsNull());
+
+  principia__DeletePlugin(&plugin);
+  principia__DeletePlugin(&base);
+}
+
 TEST_F(InterfaceDeathTest, SettersAndGetters) {
   // We use EXPECT_EXITs in this test to avoid interfering with the execution of
   // the other tests.
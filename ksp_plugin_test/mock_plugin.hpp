@@ -86,6 +86,10 @@ class MockPlugin : public Plugin {
                        DiscreteTrajectory<Barycentric>::Iterator const& end,
                        Position<World> const& sun_world_position));
 
+  MOCK_METHOD2(SetRenderingTolerance,
+               void(Angle const& angular_tolerance,
+                    Position<World> const& camera_world_position));
+
   MOCK_METHOD1(SetPredictionLength, void(Time const& t));
 
   MOCK_METHOD1(SetPredictionLengthTolerance, void(Length const& t));
@@ -173,6 +177,9 @@ class MockPlugin : public Plugin {
 
   MOCK_CONST_METHOD1(WriteToMessage,
                      void(not_null<serialization::Plugin*> const message));
+  MOCK_CONST_METHOD2(WriteDeltaToMessage,
+                     void(not_null<serialization::PluginDelta*> const message,
+                          Instant const& base_time));
 };
 
 }  // namespace ksp_plugin
@@ -21,6 +21,8 @@ class MockVessel : public Vessel {
   MOCK_CONST_METHOD0(prolongation, DiscreteTrajectory<Barycentric> const&());
   MOCK_CONST_METHOD0(prediction, DiscreteTrajectory<Barycentric> const&());
 
+  MOCK_METHOD0(EnableHistoryLevelsOfDetail, void());
+
   MOCK_CONST_METHOD0(flight_plan, FlightPlan&());
   MOCK_CONST_METHOD0(has_flight_plan, bool());
 
@@ -44,9 +46,15 @@ class MockVessel : public Vessel {
   MOCK_METHOD0(DeleteFlightPlan, void());
 
   MOCK_METHOD1(UpdatePrediction, void(Instant const& last_time));
+  MOCK_METHOD2(UpdatePredictionAsynchronously,
+               void(Instant const& last_time,
+                    not_null<ThreadPool<bool>*> const thread_pool));
 
   MOCK_CONST_METHOD1(WriteToMessage, void(
       not_null<serialization::Vessel*> const message));
+  MOCK_CONST_METHOD2(WriteDeltaToMessage, void(
+      not_null<serialization::Vessel*> const message,
+      Instant const& base_time));
 };
 
 }  // namespace ksp_plugin
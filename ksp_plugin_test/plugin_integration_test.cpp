@@ -16,6 +16,7 @@ namespace principia {
 
 using astronomy::ICRFJ2000Equator;
 using geometry::Identity;
+using geometry::InnerProduct;
 using geometry::Permutation;
 using quantities::Abs;
 using quantities::ArcTan;
@@ -28,6 +29,7 @@ using quantities::si::Hour;
 using quantities::si::Kilo;
 using quantities::si::Kilogram;
 using quantities::si::Minute;
+using quantities::si::Nano;
 using quantities::si::Radian;
 using quantities::si::AstronomicalUnit;
 using testing_utilities::AbsoluteError;
@@ -612,5 +614,127 @@ TEST_F(PluginIntegrationTest, Prediction) {
       AllOf(Gt(2 * Milli(Metre)), Lt(3 * Milli(Metre))));
 }
 
+// Checks that the rendered prediction is simplified according to the rendering
+// tolerance while staying close to the full rendering.
+TEST_F(PluginIntegrationTest, RenderingTolerance) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  Plugin plugin(Instant(), 0 * Radian);
+  plugin.InsertSun(celestial, 1 * SIUnit<GravitationalParameter>(), 1 * Metre);
+  plugin.EndInitialization();
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite, celestial));
+  plugin.SetPlottingFrame(
+      plugin.NewBodyCentredNonRotatingNavigationFrame(celestial));
+  plugin.SetVesselStateOffset(
+      satellite,
+      {Displacement<AliceSun>({1 * Metre, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>(
+           {0 * Metre / Second, 1 * Metre / Second, 0 * Metre / Second})});
+  plugin.SetPredictionLength(2 * π * Second);
+  plugin.SetPredictionLengthTolerance(1 * Nano(Metre));
+  plugin.SetPredictionSpeedTolerance(1 * Nano(Metre) / Second);
+  plugin.AdvanceTime(Instant() + 1e-10 * Second, 0 * Radian);
+  plugin.UpdatePrediction(satellite);
+  Positions<World> const full_prediction =
+      plugin.RenderedPrediction(satellite, World::origin);
+
+  Angle const angular_tolerance = 1e-3 * Radian;
+  Position<World> const camera_position =
+      World::origin + Displacement<World>({0 * Metre, 0 * Metre, 10 * Metre});
+  plugin.SetRenderingTolerance(angular_tolerance, camera_position);
+  Positions<World> const simplified_prediction =
+      plugin.RenderedPrediction(satellite, World::origin);
+  EXPECT_THAT(full_prediction.size(), Gt(300));
+  EXPECT_THAT(simplified_prediction.size(), AllOf(Ge(20), Le(40)));
+  EXPECT_EQ(full_prediction.front(), simplified_prediction.front());
+  EXPECT_EQ(full_prediction.back(), simplified_prediction.back());
+
+  // Each point of the full rendering must be close to the simplified one, as
+  // seen from the camera.
+  for (auto const& point : full_prediction) {
+    Length distance = std::numeric_limits<double>::infinity() * Metre;
+    for (int i = 1; i < simplified_prediction.size(); ++i) {
+      Displacement<World> const chord =
+          simplified_prediction[i] - simplified_prediction[i - 1];
+      Displacement<World> const to_point =
+          point - simplified_prediction[i - 1];
+      double const s = std::min(
+          std::max(InnerProduct(to_point, chord) / InnerProduct(chord, chord),
+                   0.0),
+          1.0);
+      distance = std::min(distance, (to_point - s * chord).Norm());
+    }
+    EXPECT_THAT(distance,
+                Lt(angular_tolerance / Radian *
+                   (point - camera_position).Norm()));
+  }
+
+  // A zero tolerance renders all the points.
+  plugin.SetRenderingTolerance(Angle(), camera_position);
+  EXPECT_EQ(full_prediction,
+            plugin.RenderedPrediction(satellite, World::origin));
+}
+
+// Checks that the rendered history, which is taken from its levels of detail,
+// is simplified according to the rendering tolerance while staying close to the
+// full rendering.
+TEST_F(PluginIntegrationTest, HistoryRenderingTolerance) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  Plugin plugin(Instant(), 0 * Radian);
+  plugin.InsertSun(celestial, 1 * SIUnit<GravitationalParameter>(), 1 * Metre);
+  plugin.EndInitialization();
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite, celestial));
+  plugin.SetPlottingFrame(
+      plugin.NewBodyCentredNonRotatingNavigationFrame(celestial));
+  // A circular orbit with a period of about 6283 s, i.e., about 628 steps of
+  // the history.
+  plugin.SetVesselStateOffset(
+      satellite,
+      {Displacement<AliceSun>({100 * Metre, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>(
+           {0 * Metre / Second, 0.1 * Metre / Second, 0 * Metre / Second})});
+  for (Instant t = Instant() + 10 * Second;
+       t < Instant() + 19000 * Second;
+       t += 10 * Second) {
+    plugin.AdvanceTime(t, 0 * Radian);
+    plugin.InsertOrKeepVessel(satellite, celestial);
+  }
+  Positions<World> const full_history =
+      plugin.RenderedVesselTrajectory(satellite, World::origin);
+
+  // The camera is on the axis of the orbit.
+  Angle const angular_tolerance = 1e-3 * Radian;
+  Position<World> const camera_position =
+      World::origin +
+      Displacement<World>({0 * Metre, 1000 * Metre, 0 * Metre});
+  plugin.SetRenderingTolerance(angular_tolerance, camera_position);
+  Positions<World> const simplified_history =
+      plugin.RenderedVesselTrajectory(satellite, World::origin);
+  EXPECT_THAT(full_history.size(), Gt(1800));
+  EXPECT_THAT(simplified_history.size(), Lt(full_history.size() / 4));
+  EXPECT_EQ(full_history.front(), simplified_history.front());
+  EXPECT_EQ(full_history.back(), simplified_history.back());
+
+  // Each point of the full rendering must be close to the simplified one, as
+  // seen from the camera.
+  for (auto const& point : full_history) {
+    Length distance = std::numeric_limits<double>::infinity() * Metre;
+    for (int i = 1; i < simplified_history.size(); ++i) {
+      Displacement<World> const chord =
+          simplified_history[i] - simplified_history[i - 1];
+      Displacement<World> const to_point = point - simplified_history[i - 1];
+      double const s = std::min(
+          std::max(InnerProduct(to_point, chord) / InnerProduct(chord, chord),
+                   0.0),
+          1.0);
+      distance = std::min(distance, (to_point - s * chord).Norm());
+    }
+    EXPECT_THAT(distance,
+                Lt(angular_tolerance / Radian *
+                   (point - camera_position).Norm()));
+  }
+}
+
 }  // namespace ksp_plugin
 }  // namespace principia
@@ -232,6 +232,44 @@ class PluginTest : public testing::Test {
     }
   }
 
+  // Returns an actual |Plugin|, with the major bodies of the solar system
+  // inserted using Jacobi Keplerian elements, and initialized.
+  not_null<std::unique_ptr<Plugin>> NewPluginWithAllBodies() {
+    auto plugin = make_not_null_unique<Plugin>(
+                      initial_time_,
+                      planetarium_rotation_);
+    plugin->InsertSun(SolarSystemFactory::kSun,
+                      sun_gravitational_parameter_,
+                      sun_mean_radius_);
+    for (int index = SolarSystemFactory::kSun + 1;
+         index <= SolarSystemFactory::kLastMajorBody;
+         ++index) {
+      std::string const name = SolarSystemFactory::name(index);
+      Index const parent_index = SolarSystemFactory::parent(index);
+      std::string const parent_name = SolarSystemFactory::name(parent_index);
+      RelativeDegreesOfFreedom<Barycentric> const state_vectors =
+          Identity<ICRFJ2000Equator, Barycentric>()(
+              solar_system_->initial_state(name) -
+              solar_system_->initial_state(parent_name));
+      Instant const t;
+      auto body = make_not_null_unique<MassiveBody>(
+          solar_system_->gravitational_parameter(name));
+      KeplerianElements<Barycentric> elements = KeplerOrbit<Barycentric>(
+          /*primary=*/MassiveBody(
+              solar_system_->gravitational_parameter(parent_name)),
+          /*secondary=*/*body,
+          state_vectors,
+          /*epoch=*/t).elements_at_epoch();
+      elements.semimajor_axis = std::experimental::nullopt;
+      plugin->InsertCelestialJacobiKeplerian(index,
+                                             parent_index,
+                                             elements,
+                                             std::move(body));
+    }
+    plugin->EndInitialization();
+    return plugin;
+  }
+
   // The time of the |step|th history step of |plugin_|.  |HistoryTime(0)| is
   // |initial_time_|.
   Instant HistoryTime(Instant const time, int const step) {
@@ -306,38 +344,7 @@ TEST_F(PluginTest, Serialization) {
   GUID const satellite = "satellite";
   // We need an actual |Plugin| here rather than a |TestablePlugin|, since
   // that's what |ReadFromMessage| returns.
-  auto plugin = make_not_null_unique<Plugin>(
-                    initial_time_,
-                    planetarium_rotation_);
-  plugin->InsertSun(SolarSystemFactory::kSun,
-                    sun_gravitational_parameter_,
-                    sun_mean_radius_);
-  for (int index = SolarSystemFactory::kSun + 1;
-       index <= SolarSystemFactory::kLastMajorBody;
-       ++index) {
-    std::string const name = SolarSystemFactory::name(index);
-    Index const parent_index = SolarSystemFactory::parent(index);
-    std::string const parent_name = SolarSystemFactory::name(parent_index);
-    RelativeDegreesOfFreedom<Barycentric> const state_vectors =
-        Identity<ICRFJ2000Equator, Barycentric>()(
-            solar_system_->initial_state(name) -
-            solar_system_->initial_state(parent_name));
-    Instant const t;
-    auto body = make_not_null_unique<MassiveBody>(
-        solar_system_->gravitational_parameter(name));
-    KeplerianElements<Barycentric> elements = KeplerOrbit<Barycentric>(
-        /*primary=*/MassiveBody(
-            solar_system_->gravitational_parameter(parent_name)),
-        /*secondary=*/*body,
-        state_vectors,
-        /*epoch=*/t).elements_at_epoch();
-    elements.semimajor_axis = std::experimental::nullopt;
-    plugin->InsertCelestialJacobiKeplerian(index,
-                                           parent_index,
-                                           elements,
-                                           std::move(body));
-  }
-  plugin->EndInitialization();
+  auto plugin = NewPluginWithAllBodies();
   plugin->InsertOrKeepVessel(satellite, SolarSystemFactory::kEarth);
   plugin->SetVesselStateOffset(satellite,
                                RelativeDegreesOfFreedom<AliceSun>(
@@ -406,6 +413,74 @@ TEST_F(PluginTest, Serialization) {
                     body_centred_non_rotating_dynamic_frame).centre());
 }
 
+// Merging a delta into its base yields the same serialization as writing the
+// plugin in full.
+TEST_F(PluginTest, SerializationDelta) {
+  GUID const satellite = "satellite";
+  GUID const late_satellite = "late satellite";
+  auto plugin = NewPluginWithAllBodies();
+  plugin->InsertOrKeepVessel(satellite, SolarSystemFactory::kEarth);
+  plugin->SetVesselStateOffset(satellite,
+                               RelativeDegreesOfFreedom<AliceSun>(
+                                   satellite_initial_displacement_,
+                                   satellite_initial_velocity_));
+
+  Time const shift = 1 * Second;
+  Instant const time = initial_time_ + shift;
+  plugin->AdvanceTime(time, Angle());
+  for (int step = 1; step <= 10; ++step) {
+    plugin->InsertOrKeepVessel(satellite, SolarSystemFactory::kEarth);
+    plugin->AdvanceTime(HistoryTime(time, step), Angle());
+  }
+
+  serialization::Plugin base;
+  plugin->WriteToMessage(&base);
+  Instant const base_time = plugin->CurrentTime();
+
+  // Add history points, a new vessel, and forget some of the history.
+  plugin->InsertOrKeepVessel(late_satellite, SolarSystemFactory::kEarth);
+  plugin->SetVesselStateOffset(late_satellite,
+                               RelativeDegreesOfFreedom<AliceSun>(
+                                   -satellite_initial_displacement_,
+                                   -satellite_initial_velocity_));
+  for (int step = 11; step <= 13; ++step) {
+    plugin->InsertOrKeepVessel(satellite, SolarSystemFactory::kEarth);
+    plugin->InsertOrKeepVessel(late_satellite, SolarSystemFactory::kEarth);
+    plugin->AdvanceTime(HistoryTime(time, step), Angle());
+  }
+  plugin->UpdatePrediction(satellite);
+  plugin->ForgetAllHistoriesBefore(HistoryTime(time, 2));
+
+  serialization::PluginDelta delta;
+  plugin->WriteDeltaToMessage(&delta, base_time);
+  serialization::Plugin expected;
+  plugin->WriteToMessage(&expected);
+  // The history of |satellite| is only partially written.
+  ASSERT_EQ(2, delta.plugin().vessel_size());
+  ASSERT_EQ(satellite, delta.plugin().vessel(1).guid());
+  EXPECT_LT(delta.plugin().vessel(1).vessel().history().timeline_size(),
+            expected.vessel(1).vessel().history().timeline_size());
+
+  Plugin::MergeDeltaIntoMessage(delta, &base);
+  EXPECT_EQ(expected.SerializeAsString(), base.SerializeAsString())
+      << "EXPECTED\n" << expected.DebugString()
+      << "MERGED\n" << base.DebugString();
+
+  // The merged message may be used as the base of a further delta.
+  Instant const second_base_time = plugin->CurrentTime();
+  for (int step = 14; step <= 16; ++step) {
+    plugin->InsertOrKeepVessel(satellite, SolarSystemFactory::kEarth);
+    plugin->InsertOrKeepVessel(late_satellite, SolarSystemFactory::kEarth);
+    plugin->AdvanceTime(HistoryTime(time, step), Angle());
+  }
+  serialization::PluginDelta second_delta;
+  plugin->WriteDeltaToMessage(&second_delta, second_base_time);
+  serialization::Plugin second_expected;
+  plugin->WriteToMessage(&second_expected);
+  Plugin::MergeDeltaIntoMessage(second_delta, &base);
+  EXPECT_EQ(second_expected.SerializeAsString(), base.SerializeAsString());
+}
+
 TEST_F(PluginTest, Initialization) {
   InsertAllSolarSystemBodies();
   plugin_->EndInitialization();
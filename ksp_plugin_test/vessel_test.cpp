@@ -1,13 +1,17 @@
 ﻿
 #include "ksp_plugin/vessel.hpp"
 
+#include "base/thread_pool.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "numerics/hermite3.hpp"
 #include "physics/ephemeris.hpp"
 #include "physics/solar_system.hpp"
 
 namespace principia {
 
+using base::ThreadPool;
+using numerics::Hermite3;
 using physics::Ephemeris;
 using physics::SolarSystem;
 using quantities::si::Kilo;
@@ -140,6 +144,45 @@ TEST_F(VesselTest, AdvanceTimeNotInBubble) {
   EXPECT_FALSE(vessel_->is_dirty());
 }
 
+TEST_F(VesselTest, BatchedAdvanceTimeNotInBubble) {
+  Vessel vessel2(earth_.get(),
+                 ephemeris_.get(),
+                 history_fixed_parameters_,
+                 adaptive_parameters_,
+                 adaptive_parameters_);
+  Vessel expected_vessel(earth_.get(),
+                         ephemeris_.get(),
+                         history_fixed_parameters_,
+                         adaptive_parameters_,
+                         adaptive_parameters_);
+  Vessel expected_vessel2(earth_.get(),
+                          ephemeris_.get(),
+                          history_fixed_parameters_,
+                          adaptive_parameters_,
+                          adaptive_parameters_);
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel2.CreateHistoryAndForkProlongation(t1_, d2_);
+  expected_vessel.CreateHistoryAndForkProlongation(t1_, d1_);
+  expected_vessel2.CreateHistoryAndForkProlongation(t1_, d2_);
+
+  Vessel::AdvanceTimeNotInBubble({vessel_.get(), &vessel2}, t2_);
+  expected_vessel.AdvanceTimeNotInBubble(t2_);
+  expected_vessel2.AdvanceTimeNotInBubble(t2_);
+
+  EXPECT_EQ(t2_ - 0.2 * Second, vessel_->history().last().time());
+  EXPECT_EQ(t2_ - 0.2 * Second, vessel2.history().last().time());
+  EXPECT_EQ(expected_vessel.history().last().degrees_of_freedom(),
+            vessel_->history().last().degrees_of_freedom());
+  EXPECT_EQ(expected_vessel2.history().last().degrees_of_freedom(),
+            vessel2.history().last().degrees_of_freedom());
+  EXPECT_EQ(t2_, vessel_->prolongation().last().time());
+  EXPECT_EQ(t2_, vessel2.prolongation().last().time());
+  EXPECT_EQ(expected_vessel.prolongation().last().degrees_of_freedom(),
+            vessel_->prolongation().last().degrees_of_freedom());
+  EXPECT_EQ(expected_vessel2.prolongation().last().degrees_of_freedom(),
+            vessel2.prolongation().last().degrees_of_freedom());
+}
+
 TEST_F(VesselTest, Prediction) {
   vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
   vessel_->AdvanceTimeNotInBubble(t2_);
@@ -147,6 +190,177 @@ TEST_F(VesselTest, Prediction) {
   EXPECT_LE(t3_, vessel_->prediction().last().time());
 }
 
+TEST_F(VesselTest, PredictionReuse) {
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel_->AdvanceTimeNotInBubble(t2_);
+  vessel_->UpdatePrediction(t3_);
+  auto const first_prediction_last = vessel_->prediction().last();
+  Instant const first_prediction_last_time = first_prediction_last.time();
+  DegreesOfFreedom<Barycentric> const first_prediction_last_degrees_of_freedom =
+      first_prediction_last.degrees_of_freedom();
+
+  // The vessel hasn't moved, the prediction is extended without recomputing
+  // the existing points.
+  vessel_->UpdatePrediction(t3_ + 10 * Second);
+  EXPECT_LE(t3_ + 10 * Second, vessel_->prediction().last().time());
+  auto const it = vessel_->prediction().Find(first_prediction_last_time);
+  ASSERT_TRUE(it != vessel_->prediction().End());
+  EXPECT_EQ(first_prediction_last_degrees_of_freedom,
+            it.degrees_of_freedom());
+  auto const second_prediction_last = vessel_->prediction().last();
+  Instant const second_prediction_last_time = second_prediction_last.time();
+  DegreesOfFreedom<Barycentric> const
+      second_prediction_last_degrees_of_freedom =
+          second_prediction_last.degrees_of_freedom();
+
+  // The vessel is moved away from its prediction, which is recomputed.
+  vessel_->AdvanceTimeInBubble(t3_, d3_);
+  vessel_->UpdatePrediction(t3_ + 20 * Second);
+  EXPECT_LE(t3_ + 20 * Second, vessel_->prediction().last().time());
+  auto const jt = vessel_->prediction().Find(t3_);
+  ASSERT_TRUE(jt != vessel_->prediction().End());
+  EXPECT_EQ(d3_, jt.degrees_of_freedom());
+  auto const kt = vessel_->prediction().Find(second_prediction_last_time);
+  EXPECT_TRUE(kt == vessel_->prediction().End() ||
+              kt.degrees_of_freedom() !=
+                  second_prediction_last_degrees_of_freedom);
+}
+
+TEST_F(VesselTest, PredictionReuseBetweenPoints) {
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel_->AdvanceTimeNotInBubble(t2_);
+  vessel_->UpdatePrediction(t3_ + 100 * Second);
+
+  // Returns the time halfway between the first two points of the prediction
+  // after |time|, the degrees of freedom of the prediction interpolated there,
+  // and the second of these points.
+  struct Midpoint {
+    Instant time;
+    DegreesOfFreedom<Barycentric> degrees_of_freedom;
+    Instant next_time;
+    DegreesOfFreedom<Barycentric> next_degrees_of_freedom;
+  };
+  auto const midpoint_after = [this](Instant const& time) {
+    auto const& prediction = vessel_->prediction();
+    auto lower = prediction.LowerBound(time);
+    ++lower;
+    auto upper = lower;
+    ++upper;
+    CHECK(upper != prediction.End());
+    Instant const midpoint_time =
+        lower.time() + (upper.time() - lower.time()) / 2;
+    Hermite3<Instant, Position<Barycentric>> const approximation(
+        {lower.time(), upper.time()},
+        {lower.degrees_of_freedom().position(),
+         upper.degrees_of_freedom().position()},
+        {lower.degrees_of_freedom().velocity(),
+         upper.degrees_of_freedom().velocity()});
+    return Midpoint{midpoint_time,
+                    {approximation.Evaluate(midpoint_time),
+                     approximation.EvaluateDerivative(midpoint_time)},
+                    upper.time(),
+                    upper.degrees_of_freedom()};
+  };
+  Displacement<Barycentric> const δq({1 * Metre, 0 * Metre, 0 * Metre});
+
+  // Time advances to a point between two points of the prediction.  The
+  // vessel has followed its prediction, which is interpolated and reused.
+  Midpoint const first = midpoint_after(t2_);
+  vessel_->AdvanceTimeNotInBubble(first.time);
+  vessel_->UpdatePrediction(t3_ + 200 * Second);
+  auto const start = vessel_->prediction().Find(first.time);
+  ASSERT_TRUE(start != vessel_->prediction().End());
+  EXPECT_EQ(vessel_->prolongation().last().degrees_of_freedom(),
+            start.degrees_of_freedom());
+  auto const it = vessel_->prediction().Find(first.next_time);
+  ASSERT_TRUE(it != vessel_->prediction().End());
+  EXPECT_EQ(first.next_degrees_of_freedom, it.degrees_of_freedom());
+
+  // The vessel deviates from its prediction within the tolerances, which are
+  // 1 m and 1 m/s.  The prediction is reused.
+  Midpoint const second = midpoint_after(first.next_time);
+  vessel_->AdvanceTimeInBubble(
+      second.time,
+      {second.degrees_of_freedom.position() + 0.5 * δq,
+       second.degrees_of_freedom.velocity()});
+  vessel_->UpdatePrediction(t3_ + 300 * Second);
+  auto const jt = vessel_->prediction().Find(second.next_time);
+  ASSERT_TRUE(jt != vessel_->prediction().End());
+  EXPECT_EQ(second.next_degrees_of_freedom, jt.degrees_of_freedom());
+
+  // The vessel deviates from its prediction beyond the tolerances.  The
+  // prediction is recomputed.
+  Midpoint const third = midpoint_after(second.next_time);
+  vessel_->AdvanceTimeInBubble(
+      third.time,
+      {third.degrees_of_freedom.position() + 2 * δq,
+       third.degrees_of_freedom.velocity()});
+  vessel_->UpdatePrediction(t3_ + 400 * Second);
+  auto const kt = vessel_->prediction().Find(third.next_time);
+  EXPECT_TRUE(kt == vessel_->prediction().End() ||
+              kt.degrees_of_freedom() != third.next_degrees_of_freedom);
+}
+
+TEST_F(VesselTest, AsynchronousPrediction) {
+  Vessel vessel2(earth_.get(),
+                 ephemeris_.get(),
+                 history_fixed_parameters_,
+                 adaptive_parameters_,
+                 adaptive_parameters_);
+  for (Vessel* const vessel : {vessel_.get(), &vessel2}) {
+    vessel->CreateHistoryAndForkProlongation(t1_, d1_);
+    vessel->AdvanceTimeNotInBubble(t2_);
+  }
+  vessel2.UpdatePrediction(t3_);
+
+  Instant const initial_prediction_last_time =
+      vessel_->prediction().last().time();
+  {
+    ThreadPool<bool> thread_pool(/*pool_size=*/1);
+    vessel_->UpdatePredictionAsynchronously(t3_, &thread_pool);
+    // The prediction is only replaced by a subsequent call, and the history
+    // needed by the computation may not be forgotten.
+    EXPECT_EQ(initial_prediction_last_time,
+              vessel_->prediction().last().time());
+    EXPECT_LE(vessel_->ForgettableTime(), vessel_->history().last().time());
+  }
+
+  // The destruction of the pool has completed the computation, its result is
+  // the same as that of a synchronous computation.
+  ThreadPool<bool> thread_pool(/*pool_size=*/1);
+  vessel_->UpdatePredictionAsynchronously(t3_, &thread_pool);
+  EXPECT_EQ(vessel2.prediction().Fork().time(),
+            vessel_->prediction().Fork().time());
+  EXPECT_LE(t3_, vessel_->prediction().last().time());
+  EXPECT_EQ(vessel2.prediction().last().time(),
+            vessel_->prediction().last().time());
+  EXPECT_EQ(vessel2.prediction().last().degrees_of_freedom(),
+            vessel_->prediction().last().degrees_of_freedom());
+}
+
+// The result of a computation is installed by the next call, even if it has
+// not completed by then, so that journals may be replayed deterministically.
+TEST_F(VesselTest, AsynchronousPredictionIsDeterministic) {
+  Vessel vessel2(earth_.get(),
+                 ephemeris_.get(),
+                 history_fixed_parameters_,
+                 adaptive_parameters_,
+                 adaptive_parameters_);
+  for (Vessel* const vessel : {vessel_.get(), &vessel2}) {
+    vessel->CreateHistoryAndForkProlongation(t1_, d1_);
+    vessel->AdvanceTimeNotInBubble(t2_);
+  }
+  vessel2.UpdatePrediction(t3_ + 1000 * Second);
+
+  ThreadPool<bool> thread_pool(/*pool_size=*/1);
+  vessel_->UpdatePredictionAsynchronously(t3_ + 1000 * Second, &thread_pool);
+  vessel_->UpdatePredictionAsynchronously(t3_ + 1000 * Second, &thread_pool);
+  EXPECT_EQ(vessel2.prediction().last().time(),
+            vessel_->prediction().last().time());
+  EXPECT_EQ(vessel2.prediction().last().degrees_of_freedom(),
+            vessel_->prediction().last().degrees_of_freedom());
+}
+
 TEST_F(VesselTest, FlightPlan) {
   vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
   vessel_->AdvanceTimeNotInBubble(t2_);
@@ -2,12 +2,21 @@
 #include "mathematica/integrator_plots.hpp"
 
 #include <algorithm>
+#include <cstdlib>
+#include <experimental/optional>
 #include <fstream>  // NOLINT(readability/streams)
+#include <functional>
+#include <future>
 #include <iostream>  // NOLINT(readability/streams)
+#include <map>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "astronomy/frames.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/barycentre_calculator.hpp"
 #include "glog/logging.h"
 #include "integrators/sprk_integrator.hpp"
@@ -26,6 +35,7 @@ namespace principia {
 
 using astronomy::ICRFJ2000Equator;
 using base::not_null;
+using base::ThreadPool;
 using geometry::InnerProduct;
 using geometry::BarycentreCalculator;
 using integrators::SRKNIntegrator;
@@ -137,75 +147,225 @@ std::vector<SimpleHarmonicMotionPlottedIntegrator> ReferenceMethods() {
       {INTEGRATOR(McLachlan1995SS17), 17}};
 }
 
-}  // namespace
+// The cost and the errors of one integration.  We plot the maximum errors,
+// i.e., the L∞ norms of the errors, which are accumulated as the solution is
+// scanned.  Blanes and Moan (2002), or Blanes, Casas and Ros (2001) tend to use
+// the average error (the normalized L¹ norm) instead.
+struct WorkError {
+  double evaluations = 0;
+  Length q_error;
+  Speed v_error;
+  Energy e_error;
+};
+
+// The |WorkError|s computed so far, keyed by method name and step, so that an
+// interrupted generation may be resumed.  They are stored in a text file with
+// one line per integration, the numbers being written in hexadecimal so that
+// they are read back exactly.  The first line of the file identifies the
+// |problem| and the version of this code: a file computed for another problem
+// or by another version is discarded.  |Insert| may be called concurrently.
+class WorkErrorCache {
+ public:
+  // Must be incremented whenever a change to this file affects the
+  // |WorkError|s, e.g., a change to the integration or to the error
+  // computation, so that the existing caches are discarded.
+  static int const kVersion = 1;
+
+  // |problem| must describe all the parameters that the |WorkError|s depend
+  // on, other than the method and the step.  It must fit on a single line.
+  WorkErrorCache(std::string const& filename, std::string const& problem);
+
+  std::experimental::optional<WorkError> Find(std::string const& name,
+                                              Time const& Δt) const;
+
+  void Insert(std::string const& name,
+              Time const& Δt,
+              WorkError const& work_error);
+
+ private:
+  using Key = std::pair<std::string, double>;
+
+  static Key MakeKey(std::string const& name, Time const& Δt);
+
+  mutable std::mutex lock_;
+  std::map<Key, WorkError> work_errors_;
+  std::ofstream file_;
+};
+
+WorkErrorCache::WorkErrorCache(std::string const& filename,
+                               std::string const& problem) {
+  std::string const header =
+      "version " + std::to_string(kVersion) + ": " + problem;
+  std::ifstream input(filename);
+  std::string line;
+  // |getline| sets |eofbit| if it reaches the end of the file before finding a
+  // newline.  This only happens for a last line written by an interrupted run.
+  bool ends_with_newline = true;
+  if (!std::getline(input, line) || line != header) {
+    // Either a new cache or one that is out of date.
+    if (input) {
+      LOG(INFO) << "Discarding the cached results from " << filename
+                << " which were computed for \"" << line << "\"";
+    }
+    input.close();
+    std::ofstream output(filename, std::ios::trunc);
+    output << header << std::endl;
+  } else {
+    ends_with_newline = !input.eof();
+  }
+  while (ends_with_newline && std::getline(input, line)) {
+    if (input.eof()) {
+      // Ignore the truncated last line, and terminate it before appending to
+      // the file.
+      ends_with_newline = false;
+      break;
+    }
+    std::istringstream fields(line);
+    std::string name;
+    std::string tokens[5];
+    fields >> name;
+    for (auto& token : tokens) {
+      fields >> token;
+    }
+    // Ignore a malformed line, i.e., one which has missing numbers or a
+    // number that |strtod| doesn't parse in full.
+    bool well_formed = static_cast<bool>(fields);
+    double numbers[5];
+    for (int i = 0; well_formed && i < 5; ++i) {
+      char* end;
+      numbers[i] = std::strtod(tokens[i].c_str(), &end);
+      well_formed = end != tokens[i].c_str() && *end == '\0';
+    }
+    if (!well_formed) {
+      LOG(WARNING) << "Ignoring malformed line \"" << line << "\" in "
+                   << filename;
+      continue;
+    }
+    WorkError work_error;
+    work_error.evaluations = numbers[1];
+    work_error.q_error = numbers[2] * SIUnit<Length>();
+    work_error.v_error = numbers[3] * SIUnit<Speed>();
+    work_error.e_error = numbers[4] * SIUnit<Energy>();
+    work_errors_[MakeKey(name, numbers[0] * SIUnit<Time>())] = work_error;
+  }
+  LOG(INFO) << "Read " << work_errors_.size() << " cached results from "
+            << filename;
+  file_.open(filename, std::ios::app);
+  if (!ends_with_newline) {
+    file_ << std::endl;
+  }
+  file_ << std::hexfloat;
+}
+
+std::experimental::optional<WorkError> WorkErrorCache::Find(
+    std::string const& name,
+    Time const& Δt) const {
+  std::lock_guard<std::mutex> l(lock_);
+  auto const it = work_errors_.find(MakeKey(name, Δt));
+  if (it == work_errors_.end()) {
+    return std::experimental::nullopt;
+  } else {
+    return it->second;
+  }
+}
+
+void WorkErrorCache::Insert(std::string const& name,
+                            Time const& Δt,
+                            WorkError const& work_error) {
+  std::lock_guard<std::mutex> l(lock_);
+  work_errors_[MakeKey(name, Δt)] = work_error;
+  file_ << name << " "
+        << Δt / SIUnit<Time>() << " "
+        << work_error.evaluations << " "
+        << work_error.q_error / SIUnit<Length>() << " "
+        << work_error.v_error / SIUnit<Speed>() << " "
+        << work_error.e_error / SIUnit<Energy>() << std::endl;
+}
+
+WorkErrorCache::Key WorkErrorCache::MakeKey(std::string const& name,
+                                            Time const& Δt) {
+  return {name, Δt / SIUnit<Time>()};
+}
+
+// The steps for the problems whose period is of the order of a second: 500
+// steps decreasing geometrically by |step_reduction|, starting at
+// |method.stages| seconds.
+std::vector<Time> GeometricSteps(
+    SimpleHarmonicMotionPlottedIntegrator const& method,
+    double const step_reduction) {
+  std::vector<Time> steps;
+  Time Δt = method.stages * 1 * Second;
+  for (int i = 0; i < 500; ++i, Δt /= step_reduction) {
+    steps.push_back(Δt);
+  }
+  return steps;
+}
+
+// Computes the |WorkError|s of all the |Methods()| for the steps returned by
+// |steps|, using |integrate|, and writes them as graph data to
+// |graphs_filename|.  The integrations run in parallel on all the cores, and
+// they must be independent of one another.  Their results are cached in
+// |cache_filename|, and the cached integrations are not run again.  |problem|
+// describes the parameters of |integrate|, see |WorkErrorCache|.
+void GenerateWorkErrorGraphs(
+    std::function<std::vector<Time>(
+        SimpleHarmonicMotionPlottedIntegrator const& method)> const& steps,
+    std::function<WorkError(
+        SimpleHarmonicMotionPlottedIntegrator const& method,
+        Time const& Δt)> const& integrate,
+    std::string const& problem,
+    std::string const& cache_filename,
+    std::string const& graphs_filename) {
+  std::vector<SimpleHarmonicMotionPlottedIntegrator> const methods = Methods();
+  WorkErrorCache cache(cache_filename, problem);
+  // Declared after the |cache| because the functions in its queue use it.
+  ThreadPool<WorkError> pool(ThreadPool<WorkError>::DefaultPoolSize());
+
+  std::vector<std::vector<std::future<WorkError>>> work_errors;
+  for (auto const& method : methods) {
+    work_errors.emplace_back();
+    for (Time const& Δt : steps(method)) {
+      auto const cached = cache.Find(method.name, Δt);
+      if (cached) {
+        std::promise<WorkError> promise;
+        promise.set_value(*cached);
+        work_errors.back().push_back(promise.get_future());
+      } else {
+        work_errors.back().push_back(
+            pool.Add([&cache, &integrate, &method, Δt]() {
+              WorkError const work_error = integrate(method, Δt);
+              cache.Insert(method.name, Δt, work_error);
+              return work_error;
+            }));
+      }
+    }
+  }
 
-void GenerateSimpleHarmonicMotionWorkErrorGraphs() {
-  SRKNIntegrator::Parameters<Length, Speed> parameters;
-  SRKNIntegrator::Solution<Length, Speed> solution;
-  Length const q_amplitude = 1 * Metre;
-  Speed const v_amplitude = 1 * Metre / Second;
-  AngularFrequency const ω = 1 * Radian / Second;
-  Stiffness const k = SIUnit<Stiffness>();
-  Mass const m = 1 * Kilogram;
-  double const step_reduction = 1.015;
-  parameters.initial.positions.emplace_back(q_amplitude);
-  parameters.initial.momenta.emplace_back(0 * Metre / Second);
-  parameters.initial.time = 0 * Second;
-  parameters.tmax = 50 * Second;
-  // We use dense sampling in order to compute average errors, this leads to
-  // more evaluations than reported for FSAL methods.
-  parameters.sampling_period = 1;
   std::vector<std::string> q_error_data;
   std::vector<std::string> v_error_data;
   std::vector<std::string> e_error_data;
   std::vector<std::string> names;
-  for (auto const& method : Methods()) {
-    LOG(INFO) << method.name;
-    parameters.Δt = method.stages * 1 * Second;
+  for (int m = 0; m < methods.size(); ++m) {
     std::vector<Length> q_errors;
     std::vector<Speed> v_errors;
     std::vector<Energy> e_errors;
     std::vector<double> evaluations;
-    for (int i = 0; i < 500; ++i, parameters.Δt /= step_reduction) {
-      int const number_of_evaluations =
-          method.stages *
-              static_cast<int>(std::floor(parameters.tmax / parameters.Δt));
-      LOG_IF(INFO, (i + 1) % 50 == 0) << number_of_evaluations;
-      method.integrator->SolveTrivialKineticEnergyIncrement<Length>(
-          &ComputeHarmonicOscillatorAcceleration,
-          parameters,
-          &solution);
-      std::vector<Length> q_error;
-      std::vector<Speed> v_error;
-      std::vector<Energy> e_error;
-      for (auto const& system_state : solution) {
-        q_error.emplace_back(
-            AbsoluteError(q_amplitude * Cos(ω * system_state.time.value),
-                          system_state.positions[0].value));
-        v_error.emplace_back(
-            AbsoluteError(-v_amplitude * Sin(ω * system_state.time.value),
-                          system_state.momenta[0].value));
-        e_error.emplace_back(
-            AbsoluteError(
-                0.5 * Joule,
-                (m * Pow<2>(system_state.momenta[0].value) +
-                 k * Pow<2>(system_state.positions[0].value)) / 2));
-      }
-      // We plot the maximum error, i.e., the L∞ norm of the error.
-      // Blanes and Moan (2002), or Blanes, Casas and Ros (2001) tend to use
-      // the average error (the normalized L¹ norm) instead.
-      q_errors.emplace_back(*std::max_element(q_error.begin(), q_error.end()));
-      v_errors.emplace_back(*std::max_element(v_error.begin(), v_error.end()));
-      e_errors.emplace_back(*std::max_element(e_error.begin(), e_error.end()));
-      evaluations.emplace_back(number_of_evaluations);
+    for (auto& future : work_errors[m]) {
+      WorkError const work_error = future.get();
+      q_errors.emplace_back(work_error.q_error);
+      v_errors.emplace_back(work_error.v_error);
+      e_errors.emplace_back(work_error.e_error);
+      evaluations.emplace_back(work_error.evaluations);
     }
+    LOG(INFO) << methods[m].name << ": " << evaluations.size()
+              << " integrations";
     q_error_data.emplace_back(PlottableDataset(evaluations, q_errors));
     v_error_data.emplace_back(PlottableDataset(evaluations, v_errors));
     e_error_data.emplace_back(PlottableDataset(evaluations, e_errors));
-    names.emplace_back(Escape(method.name));
+    names.emplace_back(Escape(methods[m].name));
   }
   std::ofstream file;
-  file.open("simple_harmonic_motion_graphs.generated.wl");
+  file.open(graphs_filename);
   file << Assign("qErrorData", q_error_data);
   file << Assign("vErrorData", v_error_data);
   file << Assign("eErrorData", e_error_data);
@@ -213,9 +373,67 @@ void GenerateSimpleHarmonicMotionWorkErrorGraphs() {
   file.close();
 }
 
+}  // namespace
+
+void GenerateSimpleHarmonicMotionWorkErrorGraphs() {
+  SRKNIntegrator::Parameters<Length, Speed> parameters;
+  Length const q_amplitude = 1 * Metre;
+  Speed const v_amplitude = 1 * Metre / Second;
+  AngularFrequency const ω = 1 * Radian / Second;
+  Stiffness const k = SIUnit<Stiffness>();
+  Mass const m = 1 * Kilogram;
+  double const step_reduction = 1.015;
+  parameters.initial.positions.emplace_back(q_amplitude);
+  parameters.initial.momenta.emplace_back(0 * Metre / Second);
+  parameters.initial.time = 0 * Second;
+  parameters.tmax = 50 * Second;
+  // We use dense sampling in order to compute average errors, this leads to
+  // more evaluations than reported for FSAL methods.
+  parameters.sampling_period = 1;
+  auto const steps = std::bind(GeometricSteps, _1, step_reduction);
+  auto const integrate = [k, m, parameters, q_amplitude, v_amplitude, ω](
+      SimpleHarmonicMotionPlottedIntegrator const& method,
+      Time const& Δt) {
+    SRKNIntegrator::Parameters<Length, Speed> method_parameters = parameters;
+    method_parameters.Δt = Δt;
+    SRKNIntegrator::Solution<Length, Speed> solution;
+    method.integrator->SolveTrivialKineticEnergyIncrement<Length>(
+        &ComputeHarmonicOscillatorAcceleration,
+        method_parameters,
+        &solution);
+    WorkError work_error;
+    work_error.evaluations =
+        method.stages * static_cast<int>(std::floor(parameters.tmax / Δt));
+    for (auto const& system_state : solution) {
+      work_error.q_error = std::max(
+          work_error.q_error,
+          AbsoluteError(q_amplitude * Cos(ω * system_state.time.value),
+                        system_state.positions[0].value));
+      work_error.v_error = std::max(
+          work_error.v_error,
+          AbsoluteError(-v_amplitude * Sin(ω * system_state.time.value),
+                        system_state.momenta[0].value));
+      work_error.e_error = std::max(
+          work_error.e_error,
+          AbsoluteError(0.5 * Joule,
+                        (m * Pow<2>(system_state.momenta[0].value) +
+                         k * Pow<2>(system_state.positions[0].value)) / 2));
+    }
+    return work_error;
+  };
+  std::ostringstream problem;
+  problem << "simple harmonic motion, q = " << q_amplitude
+          << ", v = " << v_amplitude << ", ω = " << ω << ", k = " << k
+          << ", m = " << m << ", tmax = " << parameters.tmax;
+  GenerateWorkErrorGraphs(steps,
+                          integrate,
+                          problem.str(),
+                          "simple_harmonic_motion_graphs.cache",
+                          "simple_harmonic_motion_graphs.generated.wl");
+}
+
 void GenerateKeplerProblemWorkErrorGraphs() {
   SRKNIntegrator::Parameters<Length, Speed> parameters;
-  SRKNIntegrator::Solution<Length, Speed> solution;
   // Semi-major axis.
   Length const a = 0.5 * Metre;
   // Velocity.
@@ -236,72 +454,56 @@ void GenerateKeplerProblemWorkErrorGraphs() {
   // We use dense sampling in order to compute average errors, this leads to
   // more evaluations than reported for FSAL methods.
   parameters.sampling_period = 1;
-  std::vector<std::string> q_error_data;
-  std::vector<std::string> v_error_data;
-  std::vector<std::string> e_error_data;
-  std::vector<std::string> names;
-  for (auto const& method : Methods()) {
-    LOG(INFO) << method.name;
-    parameters.Δt = method.stages * 1 * Second;
-    std::vector<Length> q_errors;
-    std::vector<Speed> v_errors;
-    std::vector<Energy> e_errors;
-    std::vector<double> evaluations;
-    for (int i = 0; i < 500; ++i, parameters.Δt /= step_reduction) {
-      int const number_of_evaluations =
-          method.stages *
-              static_cast<int>(std::floor(parameters.tmax / parameters.Δt));
-      LOG_IF(INFO, (i + 1) % 50 == 0) << number_of_evaluations;
-      method.integrator->SolveTrivialKineticEnergyIncrement<Length>(
-          &ComputeKeplerAcceleration,
-          parameters,
-          &solution);
-      std::vector<Length> q_error;
-      std::vector<Speed> v_error;
-      std::vector<Energy> e_error;
-      for (auto const& system_state : solution) {
-        q_error.emplace_back(
-            Sqrt(Pow<2>(system_state.positions[0].value -
-                        2 * a * Cos(ω * system_state.time.value)) +
-                 Pow<2>(system_state.positions[1].value -
-                        2 * a * Sin(ω * system_state.time.value))));
-        v_error.emplace_back(
-            Sqrt(Pow<2>(system_state.momenta[0].value -
-                        -2 * v * Sin(ω * system_state.time.value)) +
-                 Pow<2>(system_state.momenta[1].value -
-                        2 * v * Cos(ω * system_state.time.value))));
-        Length const r_actual =
-            Sqrt(Pow<2>(system_state.positions[0].value) +
-                 Pow<2>(system_state.positions[1].value));
-        Speed const v_actual =
-            Sqrt(Pow<2>(system_state.momenta[0].value) +
-                 Pow<2>(system_state.momenta[1].value)) / 2;
-        e_error.emplace_back(
-            AbsoluteError(
-                2 * (m * v * v / 2) - GravitationalConstant * m * m / (2 * a),
-                2 * (m * v_actual * v_actual / 2) -
-                    GravitationalConstant * m * m / r_actual));
-      }
-      // We plot the maximum error, i.e., the L∞ norm of the error.
-      // Blanes and Moan (2002), or Blanes, Casas and Ros (2001) tend to use
-      // the average error (the normalized L¹ norm) instead.
-      q_errors.emplace_back(*std::max_element(q_error.begin(), q_error.end()));
-      v_errors.emplace_back(*std::max_element(v_error.begin(), v_error.end()));
-      e_errors.emplace_back(*std::max_element(e_error.begin(), e_error.end()));
-      evaluations.emplace_back(number_of_evaluations);
+  auto const steps = std::bind(GeometricSteps, _1, step_reduction);
+  auto const integrate = [a, m, parameters, v, ω](
+      SimpleHarmonicMotionPlottedIntegrator const& method,
+      Time const& Δt) {
+    SRKNIntegrator::Parameters<Length, Speed> method_parameters = parameters;
+    method_parameters.Δt = Δt;
+    SRKNIntegrator::Solution<Length, Speed> solution;
+    method.integrator->SolveTrivialKineticEnergyIncrement<Length>(
+        &ComputeKeplerAcceleration,
+        method_parameters,
+        &solution);
+    WorkError work_error;
+    work_error.evaluations =
+        method.stages * static_cast<int>(std::floor(parameters.tmax / Δt));
+    for (auto const& system_state : solution) {
+      work_error.q_error = std::max(
+          work_error.q_error,
+          Sqrt(Pow<2>(system_state.positions[0].value -
+                      2 * a * Cos(ω * system_state.time.value)) +
+               Pow<2>(system_state.positions[1].value -
+                      2 * a * Sin(ω * system_state.time.value))));
+      work_error.v_error = std::max(
+          work_error.v_error,
+          Sqrt(Pow<2>(system_state.momenta[0].value -
+                      -2 * v * Sin(ω * system_state.time.value)) +
+               Pow<2>(system_state.momenta[1].value -
+                      2 * v * Cos(ω * system_state.time.value))));
+      Length const r_actual =
+          Sqrt(Pow<2>(system_state.positions[0].value) +
+               Pow<2>(system_state.positions[1].value));
+      Speed const v_actual =
+          Sqrt(Pow<2>(system_state.momenta[0].value) +
+               Pow<2>(system_state.momenta[1].value)) / 2;
+      work_error.e_error = std::max(
+          work_error.e_error,
+          AbsoluteError(
+              2 * (m * v * v / 2) - GravitationalConstant * m * m / (2 * a),
+              2 * (m * v_actual * v_actual / 2) -
+                  GravitationalConstant * m * m / r_actual));
     }
-    q_error_data.emplace_back(PlottableDataset(evaluations, q_errors));
-    v_error_data.emplace_back(PlottableDataset(evaluations, v_errors));
-    e_error_data.emplace_back(PlottableDataset(evaluations, e_errors));
-    names.emplace_back(Escape(method.name));
-  }
-  std::ofstream file;
-  file.open("kepler_problem_graphs.generated.wl");
-  file << Assign("qErrorData", q_error_data);
-  file << Assign("vErrorData", v_error_data);
-  file << Assign("eErrorData", e_error_data);
-  file << Assign("names", names);
-  file.close();
+    return work_error;
+  };
+  std::ostringstream problem;
+  problem << "Kepler problem, a = " << a << ", v = " << v << ", μ = " << μ
+          << ", ω = " << ω << ", tmax = " << parameters.tmax;
+  GenerateWorkErrorGraphs(steps,
+                          integrate,
+                          problem.str(),
+                          "kepler_problem_graphs.cache",
+                          "kepler_problem_graphs.generated.wl");
 }
 
 void GenerateSolarSystemPlanetsWorkErrorGraph() {
@@ -350,21 +552,38 @@ void GenerateSolarSystemPlanetsWorkErrorGraph() {
   SRKNIntegrator::Solution<Position<ICRFJ2000Equator>,
                            Velocity<ICRFJ2000Equator>> reference_solution;
   {
+    std::vector<SimpleHarmonicMotionPlottedIntegrator> const
+        reference_methods = ReferenceMethods();
     std::vector<
         SRKNIntegrator::Solution<
             Position<ICRFJ2000Equator>,
-            Velocity<ICRFJ2000Equator>>> reference_solutions;
+            Velocity<ICRFJ2000Equator>>> reference_solutions(
+                reference_methods.size());
     LOG(INFO) << "Computing reference solutions";
-    for (auto const& method : ReferenceMethods()) {
-      LOG(INFO) << method.name;
-      parameters.Δt = Δt_reference;
-      reference_solutions.emplace_back();
-      method.integrator->
-          SolveTrivialKineticEnergyIncrement<Position<ICRFJ2000Equator>>(
-              std::bind(ComputeGravitationalAcceleration<ICRFJ2000Equator>,
-                        _1, _2, _3, std::cref(bodies)),
-              parameters,
-              &reference_solutions.back());
+    {
+      ThreadPool<void> pool(ThreadPool<void>::DefaultPoolSize());
+      std::vector<std::future<void>> computations;
+      for (int m = 0; m < reference_methods.size(); ++m) {
+        computations.push_back(pool.Add(
+            [&bodies, m, parameters, &reference_methods,
+             &reference_solutions, Δt_reference]() {
+              auto const& method = reference_methods[m];
+              LOG(INFO) << method.name;
+              auto method_parameters = parameters;
+              method_parameters.Δt = Δt_reference;
+              method.integrator->
+                  SolveTrivialKineticEnergyIncrement<
+                      Position<ICRFJ2000Equator>>(
+                      std::bind(
+                          ComputeGravitationalAcceleration<ICRFJ2000Equator>,
+                          _1, _2, _3, std::cref(bodies)),
+                      method_parameters,
+                      &reference_solutions[m]);
+            }));
+      }
+      for (auto& computation : computations) {
+        computation.wait();
+      }
     }
     int const reference_size = reference_solutions.front().size();
     for (auto const& solution : reference_solutions) {
@@ -389,91 +608,79 @@ void GenerateSolarSystemPlanetsWorkErrorGraph() {
     }
     LOG(INFO) << "Done";
   }
-  SRKNIntegrator::Solution<Position<ICRFJ2000Equator>,
-                           Velocity<ICRFJ2000Equator>> solution;
-  std::vector<std::string> q_error_data;
-  std::vector<std::string> v_error_data;
-  std::vector<std::string> e_error_data;
-  std::vector<std::string> names;
   double const step_reduction = 1.015;
-  for (auto const& method : Methods()) {
-    LOG(INFO) << method.name;
-    parameters.Δt = method.stages * 30 * Day;
-    std::vector<Length> q_errors;
-    std::vector<Speed> v_errors;
-    std::vector<Energy> e_errors;
-    std::vector<double> evaluations;
-    for (int i = 0;
-         parameters.Δt > 0 * Second;
-         ++i,
-         parameters.Δt = Δt_reference *
-             std::floor((parameters.Δt / step_reduction) / Δt_reference)) {
-      int const number_of_evaluations =
-          method.stages *
-              static_cast<int>(std::floor(parameters.tmax / parameters.Δt));
-      LOG_IF(INFO, (i + 1) % 50 == 0) << number_of_evaluations;
-      method.integrator->
-          SolveTrivialKineticEnergyIncrement<Position<ICRFJ2000Equator>>(
-              std::bind(ComputeGravitationalAcceleration<ICRFJ2000Equator>,
-                        _1, _2, _3, std::cref(bodies)),
-              parameters,
-              &solution);
-      Length q_error;
-      Speed v_error;
-      Energy e_error;
-      for (auto const& system_state : solution) {
-        Energy energy;
-        for (int body = SolarSystemFactory::kSun;
-             body <= SolarSystemFactory::kLastMajorBody;
-             ++body) {
-          int t = static_cast<int>(
-                      std::round(system_state.time.value / Δt_reference)) - 1;
-          q_error =
-              std::max(q_error,
-                       (system_state.positions[body].value -
-                        reference_solution[t].positions[body].value).Norm());
-          v_error =
-              std::max(v_error,
-                       (system_state.momenta[body].value -
-                        reference_solution[t].momenta[body].value).Norm());
-          // Kinetic energy.
-          energy += 0.5 * bodies[body].mass() *
-                        InnerProduct(system_state.momenta[body].value,
-                                     system_state.momenta[body].value);
-        }
-        for (int b = SolarSystemFactory::kSun;
-             b <= SolarSystemFactory::kLastMajorBody;
-             ++b) {
-          for (int j = 0; j < i; ++j) {
-            // Potential energy.
-            energy -=
-                GravitationalConstant * bodies[i].mass() * bodies[j].mass() /
-                    (system_state.positions[i].value -
-                     system_state.positions[j].value).Norm();
-          }
+  auto const steps = [step_reduction, Δt_reference](
+      SimpleHarmonicMotionPlottedIntegrator const& method) {
+    std::vector<Time> steps;
+    for (Time Δt = method.stages * 30 * Day;
+         Δt > 0 * Second;
+         Δt = Δt_reference *
+                  std::floor((Δt / step_reduction) / Δt_reference)) {
+      steps.push_back(Δt);
+    }
+    return steps;
+  };
+  auto const integrate = [&bodies, initial_energy, parameters,
+                          &reference_solution, Δt_reference](
+      SimpleHarmonicMotionPlottedIntegrator const& method,
+      Time const& Δt) {
+    auto method_parameters = parameters;
+    method_parameters.Δt = Δt;
+    SRKNIntegrator::Solution<Position<ICRFJ2000Equator>,
+                             Velocity<ICRFJ2000Equator>> solution;
+    method.integrator->
+        SolveTrivialKineticEnergyIncrement<Position<ICRFJ2000Equator>>(
+            std::bind(ComputeGravitationalAcceleration<ICRFJ2000Equator>,
+                      _1, _2, _3, std::cref(bodies)),
+            method_parameters,
+            &solution);
+    WorkError work_error;
+    work_error.evaluations =
+        method.stages * static_cast<int>(std::floor(parameters.tmax / Δt));
+    for (auto const& system_state : solution) {
+      Energy energy;
+      int const t = static_cast<int>(
+                        std::round(system_state.time.value / Δt_reference)) - 1;
+      for (int b = SolarSystemFactory::kSun;
+           b <= SolarSystemFactory::kLastMajorBody;
+           ++b) {
+        work_error.q_error =
+            std::max(work_error.q_error,
+                     (system_state.positions[b].value -
+                      reference_solution[t].positions[b].value).Norm());
+        work_error.v_error =
+            std::max(work_error.v_error,
+                     (system_state.momenta[b].value -
+                      reference_solution[t].momenta[b].value).Norm());
+        // Kinetic energy.
+        energy += 0.5 * bodies[b].mass() *
+                      InnerProduct(system_state.momenta[b].value,
+                                   system_state.momenta[b].value);
+      }
+      for (int b = SolarSystemFactory::kSun;
+           b <= SolarSystemFactory::kLastMajorBody;
+           ++b) {
+        for (int j = 0; j < b; ++j) {
+          // Potential energy.
+          energy -=
+              GravitationalConstant * bodies[b].mass() * bodies[j].mass() /
+                  (system_state.positions[b].value -
+                   system_state.positions[j].value).Norm();
         }
-        e_error = std::max(e_error, AbsoluteError(initial_energy, energy));
       }
-      // We plot the maximum error, i.e., the L∞ norm of the error.
-      // Blanes and Moan (2002), or Blanes, Casas and Ros (2001) tend to use
-      // the average error (the normalized L¹ norm) instead.
-      q_errors.emplace_back(q_error);
-      v_errors.emplace_back(v_error);
-      e_errors.emplace_back(e_error);
-      evaluations.emplace_back(number_of_evaluations);
+      work_error.e_error = std::max(work_error.e_error,
+                                    AbsoluteError(initial_energy, energy));
     }
-    q_error_data.emplace_back(PlottableDataset(evaluations, q_errors));
-    v_error_data.emplace_back(PlottableDataset(evaluations, v_errors));
-    e_error_data.emplace_back(PlottableDataset(evaluations, e_errors));
-    names.emplace_back(Escape(method.name));
-  }
-  std::ofstream file;
-  file.open("planets_graphs.generated.wl");
-  file << Assign("qErrorData", q_error_data);
-  file << Assign("vErrorData", v_error_data);
-  file << Assign("eErrorData", e_error_data);
-  file << Assign("names", names);
-  file.close();
+    return work_error;
+  };
+  std::ostringstream problem;
+  problem << "solar system planets at Спутник 1 launch, tmax = "
+          << parameters.tmax << ", Δt reference = " << Δt_reference;
+  GenerateWorkErrorGraphs(steps,
+                          integrate,
+                          problem.str(),
+                          "planets_graphs.cache",
+                          "planets_graphs.generated.wl");
 }
 
 }  // namespace mathematica
@@ -39,6 +39,10 @@ class FixedVector {
   friend FixedVector<Product<L, R>, r> operator*(
       FixedMatrix<L, r, c> const& left,
       FixedVector<R, c> const& right);
+  template<typename L, typename R, int r, int c>
+  friend Product<L, R> LastElementOfProduct(
+      FixedMatrix<L, r, c> const& left,
+      FixedVector<R, c> const& right);
 };
 
 template<typename Scalar, int rows, int columns>
@@ -60,6 +64,10 @@ class FixedMatrix {
   friend FixedVector<Product<L, R>, r> operator*(
       FixedMatrix<L, r, c> const& left,
       FixedVector<R, c> const& right);
+  template<typename L, typename R, int r, int c>
+  friend Product<L, R> LastElementOfProduct(
+      FixedMatrix<L, r, c> const& left,
+      FixedVector<R, c> const& right);
 };
 
 template<typename ScalarLeft, typename ScalarRight, int rows, int columns>
@@ -67,6 +75,13 @@ FixedVector<Product<ScalarLeft, ScalarRight>, rows> operator*(
     FixedMatrix<ScalarLeft, rows, columns> const& left,
     FixedVector<ScalarRight, columns> const& right);
 
+// Returns the last element of |left * right| without computing the other ones.
+// The result is bitwise identical to that of |operator*|.
+template<typename ScalarLeft, typename ScalarRight, int rows, int columns>
+Product<ScalarLeft, ScalarRight> LastElementOfProduct(
+    FixedMatrix<ScalarLeft, rows, columns> const& left,
+    FixedVector<ScalarRight, columns> const& right);
+
 template<typename Scalar, int rows>
 class FixedStrictlyLowerTriangularMatrix {
  public:
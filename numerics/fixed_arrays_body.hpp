@@ -106,6 +106,18 @@ FixedVector<Product<ScalarLeft, ScalarRight>, rows> operator*(
   return result;
 }
 
+template<typename ScalarLeft, typename ScalarRight, int rows, int columns>
+Product<ScalarLeft, ScalarRight> LastElementOfProduct(
+    FixedMatrix<ScalarLeft, rows, columns> const& left,
+    FixedVector<ScalarRight, columns> const& right) {
+  Product<ScalarLeft, ScalarRight> result{};
+  auto const* const row = &left.data_[(rows - 1) * columns];
+  for (int j = 0; j < columns; ++j) {
+    result += row[j] * right.data_[j];
+  }
+  return result;
+}
+
 template<typename Scalar, int rows>
 constexpr FixedStrictlyLowerTriangularMatrix<Scalar, rows>::
     FixedStrictlyLowerTriangularMatrix(
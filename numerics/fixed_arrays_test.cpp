@@ -62,6 +62,7 @@ TEST_F(FixedArraysTest, Assignment) {
 
 TEST_F(FixedArraysTest, Multiplication) {
   EXPECT_EQ(v3_, m34_ * v4_);
+  EXPECT_EQ(v3_[2], LastElementOfProduct(m34_, v4_));
 }
 
 TEST_F(FixedArraysTest, VectorIndexing) {
@@ -20,6 +20,24 @@ Argument Bisect(Function f,
                 Argument const& lower_bound,
                 Argument const& upper_bound);
 
+// Same contract as |Bisect|, but uses the Illinois variant of the regula falsi,
+// which converges superlinearly for smooth functions.  A bisection step is
+// taken whenever three interpolation steps in a row fail to halve the bracket,
+// so the number of evaluations is at most about four times that of |Bisect|.
+template<typename Argument, typename Function>
+Argument Illinois(Function f,
+                  Argument const& lower_bound,
+                  Argument const& upper_bound);
+
+// Same contract as |Bisect|, but |f| returns an |std::pair| of the value of the
+// function and of its derivative, which are used to take Newton steps.  A
+// bisection step is taken whenever the Newton step would leave the bracket or
+// would not converge at least as fast as bisection.
+template<typename Argument, typename Function>
+Argument SafeguardedNewton(Function f,
+                           Argument const& lower_bound,
+                           Argument const& upper_bound);
+
 // Returns the solutions of the quadratic equation:
 //   a2 * (x - origin)^2 + a1 * (x - origin) + a0 == 0
 // The result may have 0, 1 or 2 values.
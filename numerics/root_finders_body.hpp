@@ -3,6 +3,7 @@
 
 #include "root_finders.hpp"
 
+#include <cmath>
 #include <set>
 
 #include "geometry/barycentre_calculator.hpp"
@@ -49,6 +50,136 @@ Argument Bisect(Function f,
   }
 }
 
+template<typename Argument, typename Function>
+Argument Illinois(Function f,
+                  Argument const& lower_bound,
+                  Argument const& upper_bound) {
+  using Value = decltype(f(lower_bound));
+  Value const zero{};
+  Value f_upper = f(upper_bound);
+  Value f_lower = f(lower_bound);
+  CHECK(f_lower > zero && zero > f_upper || f_lower < zero && zero < f_upper)
+      << lower_bound << ": " << f_lower << ", "
+      << upper_bound << ": " << f_upper;
+  Argument lower = lower_bound;
+  Argument upper = upper_bound;
+  // The bracket at the last step that halved it, and the number of steps since
+  // then.  The bracket doesn't change orientation, so the ratio of its widths
+  // is positive.
+  auto halved_width = upper - lower;
+  int steps_since_halving = 0;
+  // The end of the bracket that was replaced by the last step: -1 for |lower|,
+  // +1 for |upper|, 0 if the last step was a bisection.
+  int last_replaced = 0;
+  for (;;) {
+    Argument const middle =
+        Barycentre<Argument, double>({lower, upper}, {1, 1});
+    // The size of the interval has reached one ULP.
+    if (middle == lower || middle == upper) {
+      return middle;
+    }
+    Argument x = middle;
+    bool bisection = true;
+    if (steps_since_halving < 3) {
+      // The zero of the secant, which is inside the bracket since |f_lower|
+      // and |f_upper| have opposite signs, up to rounding errors.
+      Argument const secant =
+          Barycentre<Argument, Value>({lower, upper}, {f_upper, -f_lower});
+      double const position = (secant - lower) / (upper - lower);
+      if (position > 0 && position < 1) {
+        x = secant;
+        bisection = false;
+      }
+    }
+    Value const f_x = f(x);
+    if (f_x == zero) {
+      return x;
+    } else if (Sign(f_x) == Sign(f_upper)) {
+      upper = x;
+      f_upper = f_x;
+      // The Illinois modification: if the same end is retained twice in a row,
+      // halve its value so that the next secant moves towards it.
+      if (!bisection && last_replaced == 1) {
+        f_lower /= 2;
+      }
+      last_replaced = bisection ? 0 : 1;
+    } else {
+      lower = x;
+      f_lower = f_x;
+      if (!bisection && last_replaced == -1) {
+        f_upper /= 2;
+      }
+      last_replaced = bisection ? 0 : -1;
+    }
+    if ((upper - lower) / halved_width <= 0.5) {
+      halved_width = upper - lower;
+      steps_since_halving = 0;
+    } else {
+      ++steps_since_halving;
+    }
+  }
+}
+
+template<typename Argument, typename Function>
+Argument SafeguardedNewton(Function f,
+                           Argument const& lower_bound,
+                           Argument const& upper_bound) {
+  using Value = decltype(f(lower_bound).first);
+  Value const zero{};
+  auto const f_upper = f(upper_bound);
+  auto const f_lower = f(lower_bound);
+  CHECK(f_lower.first > zero && zero > f_upper.first ||
+        f_lower.first < zero && zero < f_upper.first)
+      << lower_bound << ": " << f_lower.first << ", "
+      << upper_bound << ": " << f_upper.first;
+  Sign const sign_upper(f_upper.first);
+  Argument lower = lower_bound;
+  Argument upper = upper_bound;
+  // Start from the end which has the smaller value.
+  Argument x;
+  auto f_x = f_lower;
+  if (Sign(f_lower.first) == Sign(f_lower.first + f_upper.first)) {
+    x = upper;
+    f_x = f_upper;
+  } else {
+    x = lower;
+  }
+  // The last step taken, initially twice the width of the bracket so that the
+  // first Newton step is accepted if it stays in the bracket: the test below
+  // accepts a step which is at most half of the last one.
+  auto last_step = 2 * (upper - lower);
+  for (;;) {
+    Argument const middle =
+        Barycentre<Argument, double>({lower, upper}, {1, 1});
+    // The size of the interval has reached one ULP.
+    if (middle == lower || middle == upper) {
+      return middle;
+    }
+    Argument const newton = x - f_x.first / f_x.second;
+    if (newton == x) {
+      return x;
+    }
+    // Take the Newton step if it stays in the bracket and converges at least
+    // as fast as bisection.  This is written so that a NaN, e.g., from a
+    // vanishing derivative, falls back to bisection.
+    double const position = (newton - lower) / (upper - lower);
+    double const step_ratio = (newton - x) / last_step;
+    Argument const next_x =
+        position > 0 && position < 1 && std::abs(step_ratio) <= 0.5 ? newton
+                                                                      : middle;
+    last_step = next_x - x;
+    x = next_x;
+    f_x = f(x);
+    if (f_x.first == zero) {
+      return x;
+    } else if (Sign(f_x.first) == sign_upper) {
+      upper = x;
+    } else {
+      lower = x;
+    }
+  }
+}
+
 template<typename Argument, typename Value>
 std::set<Argument> SolveQuadraticEquation(
     Argument const& origin,
@@ -53,6 +53,56 @@ TEST_F(RootFindersTest, SquareRoots) {
   }
 }
 
+// Same as above, but with superlinearly convergent methods.
+TEST_F(RootFindersTest, SquareRootsSuperlinear) {
+  Instant const t_0;
+  Instant const t_max = t_0 + 10 * Second;
+  Length const n_max = Pow<2>(t_max - t_0) * SIUnit<Acceleration>();
+  for (Length n = 1 * Metre; n < n_max; n += 1 * Metre) {
+    int illinois_evaluations = 0;
+    auto const equation = [t_0, n, &illinois_evaluations](Instant const& t) {
+      ++illinois_evaluations;
+      return Pow<2>(t - t_0) * SIUnit<Acceleration>() - n;
+    };
+    int newton_evaluations = 0;
+    auto const equation_and_derivative =
+        [t_0, n, &newton_evaluations](Instant const& t) {
+          ++newton_evaluations;
+          return std::make_pair(Pow<2>(t - t_0) * SIUnit<Acceleration>() - n,
+                                2 * (t - t_0) * SIUnit<Acceleration>());
+        };
+    EXPECT_THAT(Illinois(equation, t_0, t_max) - t_0,
+                AlmostEquals(Sqrt(n / SIUnit<Acceleration>()), 0, 1));
+    EXPECT_THAT(SafeguardedNewton(equation_and_derivative, t_0, t_max) - t_0,
+                AlmostEquals(Sqrt(n / SIUnit<Acceleration>()), 0, 1));
+    EXPECT_THAT(illinois_evaluations, AllOf(Ge(3), Le(21)));
+    EXPECT_THAT(newton_evaluations, AllOf(Ge(3), Le(10)));
+  }
+}
+
+// A function with a flat region, for which the interpolation is useless and the
+// methods must fall back to bisection.
+TEST_F(RootFindersTest, Cubic) {
+  double const root = 0.3;
+  int illinois_evaluations = 0;
+  auto const cubic = [root, &illinois_evaluations](double const x) {
+    ++illinois_evaluations;
+    return (x - root) * (x - root) * (x - root);
+  };
+  int newton_evaluations = 0;
+  auto const cubic_and_derivative = [root, &newton_evaluations](
+                                        double const x) {
+    ++newton_evaluations;
+    return std::make_pair((x - root) * (x - root) * (x - root),
+                          3 * (x - root) * (x - root));
+  };
+  EXPECT_THAT(Illinois(cubic, -1.0, 2.0), AlmostEquals(root, 0, 1));
+  EXPECT_THAT(SafeguardedNewton(cubic_and_derivative, -1.0, 2.0),
+              AlmostEquals(root, 0, 1));
+  EXPECT_THAT(illinois_evaluations, Le(200));
+  EXPECT_THAT(newton_evaluations, Le(200));
+}
+
 TEST_F(RootFindersTest, QuadraticEquations) {
   // Golden ratio.
   auto const s1 = SolveQuadraticEquation(0.0, -1.0, -1.0, 1.0);
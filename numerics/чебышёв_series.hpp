@@ -1,8 +1,10 @@
 ﻿
 #pragma once
 
+#include <array>
 #include <vector>
 
+#include "base/not_null.hpp"
 #include "geometry/named_quantities.hpp"
 #include "quantities/quantities.hpp"
 #include "serialization/numerics.pb.h"
@@ -14,6 +16,7 @@ namespace serialization {
 using ЧебышёвSeries = ChebyshevSeries;
 }  // namespace serialization
 
+using base::not_null;
 using geometry::Instant;
 using quantities::Time;
 using quantities::Variation;
@@ -21,6 +24,9 @@ using quantities::Variation;
 namespace numerics {
 namespace internal {
 
+// The number of instants that are evaluated together by |EvaluateMany|.
+int constexpr kEvaluationLanes = 4;
+
 // A helper class for implementing |Evaluate| that can be specialized for speed.
 template<typename Vector>
 class EvaluationHelper {
@@ -32,6 +38,21 @@ class EvaluationHelper {
 
   Vector EvaluateImplementation(double const scaled_t) const;
 
+  // Stores in |(*values)[first + l]| the result of
+  // |EvaluateImplementation(scaled_t[l])| for |l| in [0, count[.
+  void EvaluateLanesImplementation(
+      std::array<double, kEvaluationLanes> const& scaled_t,
+      int const first,
+      int const count,
+      not_null<std::vector<Vector>*> const values) const;
+
+  // Stores in |*value| the result of |EvaluateImplementation(scaled_t)| and in
+  // |*derivative| the derivative of the series with respect to |scaled_t|.
+  void EvaluateWithDerivativeImplementation(
+      double const scaled_t,
+      not_null<Vector*> const value,
+      not_null<Vector*> const derivative) const;
+
   Vector coefficients(int const index) const;
   int degree() const;
 
@@ -70,6 +91,20 @@ class ЧебышёвSeries {
   Vector Evaluate(Instant const& t) const;
   Variation<Vector> EvaluateDerivative(Instant const& t) const;
 
+  // Same as |Evaluate| for each element of |times|, but the recurrences for
+  // several instants are interleaved, which lets the compiler vectorize them.
+  // The results, stored in |values|, are bitwise identical to those of
+  // |Evaluate|.
+  void EvaluateMany(std::vector<Instant> const& times,
+                    not_null<std::vector<Vector>*> const values) const;
+
+  // Same as |Evaluate| and |EvaluateDerivative|, but computes both quantities
+  // in a single pass over the coefficients.  The results are bitwise identical.
+  void EvaluateWithDerivative(Instant const& t,
+                              not_null<Vector*> const value,
+                              not_null<Variation<Vector>*> const derivative)
+      const;
+
   void WriteToMessage(
       not_null<serialization::ЧебышёвSeries*> const message) const;
   static ЧебышёвSeries ReadFromMessage(
@@ -84,7 +119,22 @@ class ЧебышёвSeries {
       Instant const& t_min,
       Instant const& t_max);
 
+  // Returns the last coefficient of the Newhall approximation of the given
+  // |degree|, using only the last row of the Newhall matrix.  This is much
+  // cheaper than computing the approximation itself, and is used to estimate
+  // its error.  The result is bitwise identical to |last_coefficient| on the
+  // result of |NewhallApproximation|.
+  static Vector NewhallApproximationLastCoefficient(
+      int const degree,
+      std::vector<Vector> const& q,
+      std::vector<Variation<Vector>> const& v,
+      Instant const& t_min,
+      Instant const& t_max);
+
  private:
+  // Returns the argument of the Чебышёв polynomials corresponding to |t|.
+  double ScaledTime(Instant const& t) const;
+
   Instant t_min_;
   Instant t_max_;
   Instant t_mean_;
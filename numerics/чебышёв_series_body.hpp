@@ -1,8 +1,11 @@
 ﻿
 #include "numerics/чебышёв_series.hpp"
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
+#include "base/macros.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/r3_element.hpp"
 #include "geometry/serialization.hpp"
@@ -33,6 +36,18 @@ class EvaluationHelper<Multivector<Scalar, Frame, rank>> {
   Multivector<Scalar, Frame, rank> EvaluateImplementation(
       double const scaled_t) const;
 
+  void EvaluateLanesImplementation(
+      std::array<double, kEvaluationLanes> const& scaled_t,
+      int const first,
+      int const count,
+      not_null<std::vector<Multivector<Scalar, Frame, rank>>*> const values)
+      const;
+
+  void EvaluateWithDerivativeImplementation(
+      double const scaled_t,
+      not_null<Multivector<Scalar, Frame, rank>*> const value,
+      not_null<Multivector<Scalar, Frame, rank>*> const derivative) const;
+
   Multivector<Scalar, Frame, rank> coefficients(int const index) const;
   int degree() const;
 
@@ -41,6 +56,49 @@ class EvaluationHelper<Multivector<Scalar, Frame, rank>> {
   int degree_;
 };
 
+// The Clenshaw algorithm for a series with coefficients in R³.  This is inlined
+// in the callers so that a |degree| known at compile time may be propagated.
+FORCE_INLINE R3Element<double> ClenshawR3(
+    std::vector<R3Element<double>> const& coefficients,
+    int const degree,
+    double const scaled_t) {
+  double const two_scaled_t = scaled_t + scaled_t;
+  R3Element<double> const c_0 = coefficients[0];
+  switch (degree) {
+    case 0:
+      return c_0;
+    case 1:
+      return c_0 + scaled_t * coefficients[1];
+    default:
+      // b_degree   = c_degree.
+      R3Element<double> b_i = coefficients[degree];
+      // b_degree-1 = c_degree-1 + 2 t b_degree.
+      R3Element<double> b_j = coefficients[degree - 1] + two_scaled_t * b_i;
+      int k = degree - 3;
+      for (; k >= 1; k -= 2) {
+        // b_k+1 = c_k+1 + 2 t b_k+2 - b_k+3.
+        R3Element<double> const c_kplus1 = coefficients[k + 1];
+        b_i.x = c_kplus1.x + two_scaled_t * b_j.x - b_i.x;
+        b_i.y = c_kplus1.y + two_scaled_t * b_j.y - b_i.y;
+        b_i.z = c_kplus1.z + two_scaled_t * b_j.z - b_i.z;
+        // b_k   = c_k   + 2 t b_k+1 - b_k+2.
+        R3Element<double> const c_k = coefficients[k];
+        b_j.x = c_k.x + two_scaled_t * b_i.x - b_j.x;
+        b_j.y = c_k.y + two_scaled_t * b_i.y - b_j.y;
+        b_j.z = c_k.z + two_scaled_t * b_i.z - b_j.z;
+      }
+      if (k == 0) {
+        // b_1 = c_1 + 2 t b_2 - b_3.
+        b_i = coefficients[1] + two_scaled_t * b_j - b_i;
+        // c_0 + t b_1 - b_2.
+        return c_0 + scaled_t * b_i - b_j;
+      } else {
+        // c_0 + t b_1 - b_2.
+        return c_0 + scaled_t * b_j - b_i;
+      }
+  }
+}
+
 template<typename Vector>
 EvaluationHelper<Vector>::EvaluationHelper(
     std::vector<Vector> const& coefficients,
@@ -80,6 +138,41 @@ Vector EvaluationHelper<Vector>::EvaluateImplementation(
   }
 }
 
+template<typename Vector>
+void EvaluationHelper<Vector>::EvaluateLanesImplementation(
+    std::array<double, kEvaluationLanes> const& scaled_t,
+    int const first,
+    int const count,
+    not_null<std::vector<Vector>*> const values) const {
+  for (int l = 0; l < count; ++l) {
+    (*values)[first + l] = EvaluateImplementation(scaled_t[l]);
+  }
+}
+
+template<typename Vector>
+void EvaluationHelper<Vector>::EvaluateWithDerivativeImplementation(
+    double const scaled_t,
+    not_null<Vector*> const value,
+    not_null<Vector*> const derivative) const {
+  *value = EvaluateImplementation(scaled_t);
+  if (degree_ == 0) {
+    *derivative = Vector{};
+    return;
+  }
+
+  // The Clenshaw recurrence for the derivative, see |EvaluateDerivative|.
+  double const two_scaled_t = scaled_t + scaled_t;
+  Vector b_kplus2{};
+  Vector b_kplus1{};
+  for (int k = degree_ - 1; k >= 1; --k) {
+    Vector const b_k =
+        coefficients_[k + 1] * (k + 1) + two_scaled_t * b_kplus1 - b_kplus2;
+    b_kplus2 = b_kplus1;
+    b_kplus1 = b_k;
+  }
+  *derivative = coefficients_[1] + two_scaled_t * b_kplus1 - b_kplus2;
+}
+
 template<typename Vector>
 Vector EvaluationHelper<Vector>::coefficients(int const index) const {
   return coefficients_[index];
@@ -93,7 +186,8 @@ int EvaluationHelper<Vector>::degree() const {
 template<typename Scalar, typename Frame, int rank>
 EvaluationHelper<Multivector<Scalar, Frame, rank>>::EvaluationHelper(
     std::vector<Multivector<Scalar, Frame, rank>> const& coefficients,
-    int const degree) : degree_(degree) {
+    int const degree)
+    : degree_(degree) {
   for (auto const& coefficient : coefficients) {
     coefficients_.push_back(coefficient.coordinates() / SIUnit<Scalar>());
   }
@@ -103,44 +197,170 @@ template<typename Scalar, typename Frame, int rank>
 Multivector<Scalar, Frame, rank>
 EvaluationHelper<Multivector<Scalar, Frame, rank>>::EvaluateImplementation(
     double const scaled_t) const {
-  double const two_scaled_t = scaled_t + scaled_t;
+  // Dispatch on the degrees used by |ContinuousTrajectory| so that
+  // |ClenshawR3| is inlined with a constant degree and its recurrence fully
+  // unrolled.
+  R3Element<double> result;
+  switch (degree_) {
+    case 0: result = ClenshawR3(coefficients_, 0, scaled_t); break;
+    case 1: result = ClenshawR3(coefficients_, 1, scaled_t); break;
+    case 2: result = ClenshawR3(coefficients_, 2, scaled_t); break;
+    case 3: result = ClenshawR3(coefficients_, 3, scaled_t); break;
+    case 4: result = ClenshawR3(coefficients_, 4, scaled_t); break;
+    case 5: result = ClenshawR3(coefficients_, 5, scaled_t); break;
+    case 6: result = ClenshawR3(coefficients_, 6, scaled_t); break;
+    case 7: result = ClenshawR3(coefficients_, 7, scaled_t); break;
+    case 8: result = ClenshawR3(coefficients_, 8, scaled_t); break;
+    case 9: result = ClenshawR3(coefficients_, 9, scaled_t); break;
+    case 10: result = ClenshawR3(coefficients_, 10, scaled_t); break;
+    case 11: result = ClenshawR3(coefficients_, 11, scaled_t); break;
+    case 12: result = ClenshawR3(coefficients_, 12, scaled_t); break;
+    case 13: result = ClenshawR3(coefficients_, 13, scaled_t); break;
+    case 14: result = ClenshawR3(coefficients_, 14, scaled_t); break;
+    case 15: result = ClenshawR3(coefficients_, 15, scaled_t); break;
+    case 16: result = ClenshawR3(coefficients_, 16, scaled_t); break;
+    case 17: result = ClenshawR3(coefficients_, 17, scaled_t); break;
+    default: result = ClenshawR3(coefficients_, degree_, scaled_t); break;
+  }
+  return Multivector<double, Frame, rank>(result) * SIUnit<Scalar>();
+}
+
+template<typename Scalar, typename Frame, int rank>
+void EvaluationHelper<Multivector<Scalar, Frame, rank>>::
+EvaluateLanesImplementation(
+    std::array<double, kEvaluationLanes> const& scaled_t,
+    int const first,
+    int const count,
+    not_null<std::vector<Multivector<Scalar, Frame, rank>>*> const values)
+    const {
+  // This is the algorithm of |ClenshawR3|, with the coordinates of the |b|s
+  // stored in arrays indexed by lane.  The lanes are independent so the
+  // innermost loops may be vectorized.
+  using Lanes = std::array<double, kEvaluationLanes>;
   R3Element<double> const c_0 = coefficients_[0];
+  Lanes two_scaled_t;
+  for (int l = 0; l < kEvaluationLanes; ++l) {
+    two_scaled_t[l] = scaled_t[l] + scaled_t[l];
+  }
   switch (degree_) {
     case 0:
-      return Multivector<double, Frame, rank>(c_0) * SIUnit<Scalar>();
     case 1:
-      return Multivector<double, Frame, rank>(
-                 c_0 + scaled_t * coefficients_[1]) * SIUnit<Scalar>();
+      for (int l = 0; l < count; ++l) {
+        (*values)[first + l] = EvaluateImplementation(scaled_t[l]);
+      }
+      return;
     default:
+      Lanes b_i_x;
+      Lanes b_i_y;
+      Lanes b_i_z;
+      Lanes b_j_x;
+      Lanes b_j_y;
+      Lanes b_j_z;
       // b_degree   = c_degree.
-      R3Element<double> b_i = coefficients_[degree_];
       // b_degree-1 = c_degree-1 + 2 t b_degree.
-      R3Element<double> b_j = coefficients_[degree_ - 1] + two_scaled_t * b_i;
+      R3Element<double> const c_degree = coefficients_[degree_];
+      R3Element<double> const c_degree_minus1 = coefficients_[degree_ - 1];
+      for (int l = 0; l < kEvaluationLanes; ++l) {
+        b_i_x[l] = c_degree.x;
+        b_i_y[l] = c_degree.y;
+        b_i_z[l] = c_degree.z;
+        b_j_x[l] = c_degree_minus1.x + two_scaled_t[l] * b_i_x[l];
+        b_j_y[l] = c_degree_minus1.y + two_scaled_t[l] * b_i_y[l];
+        b_j_z[l] = c_degree_minus1.z + two_scaled_t[l] * b_i_z[l];
+      }
       int k = degree_ - 3;
       for (; k >= 1; k -= 2) {
         // b_k+1 = c_k+1 + 2 t b_k+2 - b_k+3.
         R3Element<double> const c_kplus1 = coefficients_[k + 1];
-        b_i.x = c_kplus1.x + two_scaled_t * b_j.x - b_i.x;
-        b_i.y = c_kplus1.y + two_scaled_t * b_j.y - b_i.y;
-        b_i.z = c_kplus1.z + two_scaled_t * b_j.z - b_i.z;
+        for (int l = 0; l < kEvaluationLanes; ++l) {
+          b_i_x[l] = c_kplus1.x + two_scaled_t[l] * b_j_x[l] - b_i_x[l];
+          b_i_y[l] = c_kplus1.y + two_scaled_t[l] * b_j_y[l] - b_i_y[l];
+          b_i_z[l] = c_kplus1.z + two_scaled_t[l] * b_j_z[l] - b_i_z[l];
+        }
         // b_k   = c_k   + 2 t b_k+1 - b_k+2.
         R3Element<double> const c_k = coefficients_[k];
-        b_j.x = c_k.x + two_scaled_t * b_i.x - b_j.x;
-        b_j.y = c_k.y + two_scaled_t * b_i.y - b_j.y;
-        b_j.z = c_k.z + two_scaled_t * b_i.z - b_j.z;
+        for (int l = 0; l < kEvaluationLanes; ++l) {
+          b_j_x[l] = c_k.x + two_scaled_t[l] * b_i_x[l] - b_j_x[l];
+          b_j_y[l] = c_k.y + two_scaled_t[l] * b_i_y[l] - b_j_y[l];
+          b_j_z[l] = c_k.z + two_scaled_t[l] * b_i_z[l] - b_j_z[l];
+        }
       }
       if (k == 0) {
         // b_1 = c_1 + 2 t b_2 - b_3.
-        b_i = coefficients_[1] + two_scaled_t * b_j - b_i;
+        R3Element<double> const c_1 = coefficients_[1];
+        for (int l = 0; l < kEvaluationLanes; ++l) {
+          b_i_x[l] = c_1.x + two_scaled_t[l] * b_j_x[l] - b_i_x[l];
+          b_i_y[l] = c_1.y + two_scaled_t[l] * b_j_y[l] - b_i_y[l];
+          b_i_z[l] = c_1.z + two_scaled_t[l] * b_j_z[l] - b_i_z[l];
+        }
         // c_0 + t b_1 - b_2.
-        return Multivector<double, Frame, rank>(
-                   c_0 + scaled_t * b_i - b_j) * SIUnit<Scalar>();
+        for (int l = 0; l < count; ++l) {
+          (*values)[first + l] =
+              Multivector<double, Frame, rank>(
+                  {c_0.x + scaled_t[l] * b_i_x[l] - b_j_x[l],
+                   c_0.y + scaled_t[l] * b_i_y[l] - b_j_y[l],
+                   c_0.z + scaled_t[l] * b_i_z[l] - b_j_z[l]}) *
+              SIUnit<Scalar>();
+        }
       } else {
         // c_0 + t b_1 - b_2.
-        return Multivector<double, Frame, rank>(
-                   c_0 + scaled_t * b_j - b_i) * SIUnit<Scalar>();
+        for (int l = 0; l < count; ++l) {
+          (*values)[first + l] =
+              Multivector<double, Frame, rank>(
+                  {c_0.x + scaled_t[l] * b_j_x[l] - b_i_x[l],
+                   c_0.y + scaled_t[l] * b_j_y[l] - b_i_y[l],
+                   c_0.z + scaled_t[l] * b_j_z[l] - b_i_z[l]}) *
+              SIUnit<Scalar>();
+        }
       }
+  }
+}
+
+template<typename Scalar, typename Frame, int rank>
+void EvaluationHelper<Multivector<Scalar, Frame, rank>>::
+EvaluateWithDerivativeImplementation(
+    double const scaled_t,
+    not_null<Multivector<Scalar, Frame, rank>*> const value,
+    not_null<Multivector<Scalar, Frame, rank>*> const derivative) const {
+  double const two_scaled_t = scaled_t + scaled_t;
+  R3Element<double> const c_0 = coefficients_[0];
+  if (degree_ == 0) {
+    *value = Multivector<double, Frame, rank>(c_0) * SIUnit<Scalar>();
+    *derivative = Multivector<Scalar, Frame, rank>();
+    return;
+  }
+
+  // The recurrences for the value (|b|) and for the derivative (|d|), see
+  // |ClenshawR3| and |ЧебышёвSeries::EvaluateDerivative|.  The first one is
+  // not unrolled here, but it performs the same operations.
+  R3Element<double> b_kplus2;
+  R3Element<double> b_kplus1 = coefficients_[degree_];
+  R3Element<double> d_kplus2;
+  R3Element<double> d_kplus1;
+  for (int k = degree_ - 1; k >= 1; --k) {
+    R3Element<double> const c_k = coefficients_[k];
+    R3Element<double> const c_kplus1 = coefficients_[k + 1];
+    R3Element<double> b_k;
+    if (k == degree_ - 1) {
+      b_k = c_k + two_scaled_t * b_kplus1;
+    } else {
+      b_k.x = c_k.x + two_scaled_t * b_kplus1.x - b_kplus2.x;
+      b_k.y = c_k.y + two_scaled_t * b_kplus1.y - b_kplus2.y;
+      b_k.z = c_k.z + two_scaled_t * b_kplus1.z - b_kplus2.z;
     }
+    R3Element<double> const d_k =
+        c_kplus1 * (k + 1) + two_scaled_t * d_kplus1 - d_kplus2;
+    b_kplus2 = b_kplus1;
+    b_kplus1 = b_k;
+    d_kplus2 = d_kplus1;
+    d_kplus1 = d_k;
+  }
+  // c_0 + t b_1 - b_2.
+  *value = Multivector<double, Frame, rank>(
+               c_0 + scaled_t * b_kplus1 - b_kplus2) * SIUnit<Scalar>();
+  *derivative = Multivector<double, Frame, rank>(
+                    coefficients_[1] + two_scaled_t * d_kplus1 - d_kplus2) *
+                SIUnit<Scalar>();
 }
 
 template<typename Scalar, typename Frame, int rank>
@@ -156,6 +376,34 @@ int EvaluationHelper<Multivector<Scalar, Frame, rank>>::degree() const {
   return degree_;
 }
 
+// Only supports 8 divisions for now.
+int constexpr kNewhallDivisions = 8;
+
+// Returns the vector of positions and velocities by which Newhall's matrices
+// are multiplied.
+template<typename Vector>
+FixedVector<Vector, 2 * kNewhallDivisions + 2> NewhallPositionsAndVelocities(
+    std::vector<Vector> const& q,
+    std::vector<Variation<Vector>> const& v,
+    Instant const& t_min,
+    Instant const& t_max) {
+  CHECK_EQ(kNewhallDivisions + 1, q.size());
+  CHECK_EQ(kNewhallDivisions + 1, v.size());
+
+  Time const duration_over_two = 0.5 * (t_max - t_min);
+
+  // Tricky.  The order in Newhall's matrices is such that the entries for the
+  // largest time occur first.
+  FixedVector<Vector, 2 * kNewhallDivisions + 2> qv;
+  for (int i = 0, j = 2 * kNewhallDivisions;
+       i < kNewhallDivisions + 1 && j >= 0;
+       ++i, j -= 2) {
+    qv[j] = q[i];
+    qv[j + 1] = v[i] * duration_over_two;
+  }
+  return qv;
+}
+
 }  // namespace internal
 
 template<typename Vector>
@@ -211,17 +459,7 @@ Vector ЧебышёвSeries<Vector>::last_coefficient() const {
 
 template<typename Vector>
 Vector ЧебышёвSeries<Vector>::Evaluate(Instant const& t) const {
-  double const scaled_t = (t - t_mean_) * two_over_duration_;
-  // We have to allow |scaled_t| to go slightly out of [-1, 1] because of
-  // computation errors.  But if it goes too far, something is broken.
-  // TODO(phl): This should use DCHECK but these macros don't work because the
-  // Principia projects don't define NDEBUG.
-#ifdef _DEBUG
-  CHECK_LE(scaled_t, 1.1);
-  CHECK_GE(scaled_t, -1.1);
-#endif
-
-  return helper_.EvaluateImplementation(scaled_t);
+  return helper_.EvaluateImplementation(ScaledTime(t));
 }
 
 template<typename Vector>
@@ -253,6 +491,37 @@ Variation<Vector> ЧебышёвSeries<Vector>::EvaluateDerivative(
              two_over_duration_;
 }
 
+template<typename Vector>
+void ЧебышёвSeries<Vector>::EvaluateMany(
+    std::vector<Instant> const& times,
+    not_null<std::vector<Vector>*> const values) const {
+  int const size = static_cast<int>(times.size());
+  values->resize(size);
+  // The unused lanes of the last group are evaluated at 0, which is harmless.
+  std::array<double, internal::kEvaluationLanes> scaled_t{};
+  for (int i = 0; i < size; i += internal::kEvaluationLanes) {
+    int const count = std::min(internal::kEvaluationLanes, size - i);
+    for (int l = 0; l < count; ++l) {
+      scaled_t[l] = ScaledTime(times[i + l]);
+    }
+    for (int l = count; l < internal::kEvaluationLanes; ++l) {
+      scaled_t[l] = 0;
+    }
+    helper_.EvaluateLanesImplementation(scaled_t, i, count, values);
+  }
+}
+
+template<typename Vector>
+void ЧебышёвSeries<Vector>::EvaluateWithDerivative(
+    Instant const& t,
+    not_null<Vector*> const value,
+    not_null<Variation<Vector>*> const derivative) const {
+  Vector derivative_with_respect_to_scaled_t;
+  helper_.EvaluateWithDerivativeImplementation(
+      ScaledTime(t), value, &derivative_with_respect_to_scaled_t);
+  *derivative = derivative_with_respect_to_scaled_t * two_over_duration_;
+}
+
 template<typename Vector>
 void ЧебышёвSeries<Vector>::WriteToMessage(
     not_null<serialization::ЧебышёвSeries*> const message) const {
@@ -285,6 +554,20 @@ template<typename Vector>
                        Instant::ReadFromMessage(message.t_max()));
 }
 
+template<typename Vector>
+double ЧебышёвSeries<Vector>::ScaledTime(Instant const& t) const {
+  double const scaled_t = (t - t_mean_) * two_over_duration_;
+  // We have to allow |scaled_t| to go slightly out of [-1, 1] because of
+  // computation errors.  But if it goes too far, something is broken.
+  // TODO(phl): This should use DCHECK but these macros don't work because the
+  // Principia projects don't define NDEBUG.
+#ifdef _DEBUG
+  CHECK_LE(scaled_t, 1.1);
+  CHECK_GE(scaled_t, -1.1);
+#endif
+  return scaled_t;
+}
+
 template<typename Vector>
 ЧебышёвSeries<Vector> ЧебышёвSeries<Vector>::NewhallApproximation(
     int const degree,
@@ -292,22 +575,8 @@ template<typename Vector>
     std::vector<Variation<Vector>> const& v,
     Instant const& t_min,
     Instant const& t_max) {
-  // Only supports 8 divisions for now.
-  int const kDivisions = 8;
-  CHECK_EQ(kDivisions + 1, q.size());
-  CHECK_EQ(kDivisions + 1, v.size());
-
-  Time const duration_over_two = 0.5 * (t_max - t_min);
-
-  // Tricky.  The order in Newhall's matrices is such that the entries for the
-  // largest time occur first.
-  FixedVector<Vector, 2 * kDivisions + 2> qv;
-  for (int i = 0, j = 2 * kDivisions;
-       i < kDivisions + 1 && j >= 0;
-       ++i, j -= 2) {
-    qv[j] = q[i];
-    qv[j + 1] = v[i] * duration_over_two;
-  }
+  auto const qv =
+      internal::NewhallPositionsAndVelocities(q, v, t_min, t_max);
 
   std::vector<Vector> coefficients;
   coefficients.reserve(degree);
@@ -365,5 +634,67 @@ template<typename Vector>
   return ЧебышёвSeries(coefficients, t_min, t_max);
 }
 
+template<typename Vector>
+Vector ЧебышёвSeries<Vector>::NewhallApproximationLastCoefficient(
+    int const degree,
+    std::vector<Vector> const& q,
+    std::vector<Variation<Vector>> const& v,
+    Instant const& t_min,
+    Instant const& t_max) {
+  auto const qv =
+      internal::NewhallPositionsAndVelocities(q, v, t_min, t_max);
+
+  switch (degree) {
+    case 3:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_3_divisions_8_w04, qv);
+    case 4:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_4_divisions_8_w04, qv);
+    case 5:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_5_divisions_8_w04, qv);
+    case 6:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_6_divisions_8_w04, qv);
+    case 7:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_7_divisions_8_w04, qv);
+    case 8:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_8_divisions_8_w04, qv);
+    case 9:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_9_divisions_8_w04, qv);
+    case 10:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_10_divisions_8_w04, qv);
+    case 11:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_11_divisions_8_w04, qv);
+    case 12:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_12_divisions_8_w04, qv);
+    case 13:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_13_divisions_8_w04, qv);
+    case 14:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_14_divisions_8_w04, qv);
+    case 15:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_15_divisions_8_w04, qv);
+    case 16:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_16_divisions_8_w04, qv);
+    case 17:
+      return LastElementOfProduct(
+          newhall_c_matrix_degree_17_divisions_8_w04, qv);
+    default:
+      LOG(FATAL) << "Unexpected degree " << degree;
+      base::noreturn();
+  }
+}
+
 }  // namespace numerics
 }  // namespace principia
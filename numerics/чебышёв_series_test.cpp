@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <random>
 #include <vector>
 
 #include "astronomy/frames.hpp"
@@ -20,6 +21,7 @@ namespace principia {
 using astronomy::ICRFJ2000Ecliptic;
 using geometry::Instant;
 using geometry::Vector;
+using geometry::Displacement;
 using quantities::Length;
 using quantities::Speed;
 using quantities::si::Metre;
@@ -210,6 +212,71 @@ TEST_F(ЧебышёвSeriesTest, X6Vector) {
             x6.Evaluate(t0_ + 3 * Second));
 }
 
+// Check that the batched and fused evaluations yield exactly the same results
+// as the basic ones, for all the degrees that have a specialized implementation
+// and a few more.
+TEST_F(ЧебышёвSeriesTest, EvaluateManyAndWithDerivative) {
+  using D = Displacement<ICRFJ2000Ecliptic>;
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<> coefficient_distribution(-1E9, 1E9);
+  std::uniform_real_distribution<> time_distribution(
+      (t_min_ - t0_) / Second, (t_max_ - t0_) / Second);
+  std::vector<Instant> times = {t_min_, t_max_};
+  for (int i = 0; i < 17; ++i) {
+    times.push_back(t0_ + time_distribution(random) * Second);
+  }
+
+  for (int degree = 0; degree <= 19; ++degree) {
+    std::vector<double> double_coefficients;
+    std::vector<D> displacement_coefficients;
+    for (int k = 0; k <= degree; ++k) {
+      double_coefficients.push_back(coefficient_distribution(random));
+      displacement_coefficients.push_back(
+          D({coefficient_distribution(random) * Metre,
+             coefficient_distribution(random) * Metre,
+             coefficient_distribution(random) * Metre}));
+    }
+    ЧебышёвSeries<double> const double_series(
+        double_coefficients, t_min_, t_max_);
+    ЧебышёвSeries<D> const displacement_series(
+        displacement_coefficients, t_min_, t_max_);
+
+    std::vector<double> double_values;
+    std::vector<D> displacement_values;
+    double_series.EvaluateMany(times, &double_values);
+    displacement_series.EvaluateMany(times, &displacement_values);
+    ASSERT_EQ(times.size(), double_values.size());
+    ASSERT_EQ(times.size(), displacement_values.size());
+
+    for (int i = 0; i < times.size(); ++i) {
+      Instant const& t = times[i];
+      EXPECT_EQ(double_series.Evaluate(t), double_values[i]) << degree;
+      EXPECT_EQ(displacement_series.Evaluate(t), displacement_values[i])
+          << degree;
+
+      double double_value;
+      Variation<double> double_derivative;
+      double_series.EvaluateWithDerivative(
+          t, &double_value, &double_derivative);
+      D displacement_value;
+      Variation<D> displacement_derivative;
+      displacement_series.EvaluateWithDerivative(
+          t, &displacement_value, &displacement_derivative);
+      EXPECT_EQ(double_series.Evaluate(t), double_value) << degree;
+      EXPECT_EQ(displacement_series.Evaluate(t), displacement_value) << degree;
+      if (degree == 0) {
+        EXPECT_EQ(Variation<double>(), double_derivative);
+        EXPECT_EQ(Variation<D>(), displacement_derivative);
+      } else {
+        EXPECT_EQ(double_series.EvaluateDerivative(t), double_derivative)
+            << degree;
+        EXPECT_EQ(displacement_series.EvaluateDerivative(t),
+                  displacement_derivative) << degree;
+      }
+    }
+  }
+}
+
 TEST_F(ЧебышёвSeriesDeathTest, SerializationError) {
   ЧебышёвSeries<Speed> v({1 * Metre / Second,
                           -2 * Metre / Second,
@@ -396,5 +463,23 @@ TEST_F(ЧебышёвSeriesTest, NewhallApproximation) {
                               near_speed(1.3E-12 * Metre / Second)));
 }
 
+TEST_F(ЧебышёвSeriesTest, NewhallApproximationLastCoefficient) {
+  std::vector<Length> lengths;
+  std::vector<Speed> speeds;
+  for (Instant t = t_min_; t <= t_max_; t += 0.5 * Second) {
+    lengths.push_back(0.5 * Metre + 2 * Metre *
+                      std::sin((t - t_min_) / (0.3 * Second)));
+    speeds.push_back((2 * Metre) / (0.3 * Second) *
+                     std::cos((t - t_min_) / (0.3 * Second)));
+  }
+
+  for (int degree = 3; degree <= 17; ++degree) {
+    EXPECT_EQ(ЧебышёвSeries<Length>::NewhallApproximation(
+                  degree, lengths, speeds, t_min_, t_max_).last_coefficient(),
+              ЧебышёвSeries<Length>::NewhallApproximationLastCoefficient(
+                  degree, lengths, speeds, t_min_, t_max_)) << degree;
+  }
+}
+
 }  // namespace numerics
 }  // namespace principia
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <experimental/optional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/continuous_trajectory.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "physics/discrete_trajectory.hpp"
+#include "quantities/named_quantities.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+
+using base::not_null;
+using base::ThreadPool;
+using geometry::Instant;
+using quantities::Length;
+using quantities::Square;
+using quantities::Variation;
+
+namespace physics {
+
+// Computes the apsides of a trajectory with respect to a massive body, and
+// retains them together with the state of the computation at the last point
+// scanned.  When the trajectory is extended, only the new points are scanned,
+// and when it is unchanged, nothing is computed.  The points are scanned in
+// windows of bounded size: the positions of the body at the times of the points
+// of a window are evaluated in parallel, then the apsides are found serially.
+// The nodes and the closest approaches are not computed.
+template<typename Frame>
+class ApsidesTracker {
+ public:
+  // |body_trajectory| is the trajectory of the body with respect to which the
+  // apsides are computed.  It must outlive this object.
+  explicit ApsidesTracker(
+      not_null<ContinuousTrajectory<Frame> const*> const body_trajectory);
+
+  // Updates the apsides so that they are those of the trajectory segment given
+  // by |begin| and |end|.  The apsides computed by the last call to |Update|
+  // are reused if, from one of its points |common| on, this segment starts
+  // with the points retained from the previous one, and contains the point
+  // where the previous one ended.  Only the points before |common| and after
+  // the end of the previous segment are scanned; otherwise the apsides are
+  // recomputed from scratch.  The points in between are assumed to be
+  // unchanged: this holds for a trajectory that is only appended to or
+  // forgotten before a time, or for a prediction which starts with a new point
+  // and continues with copies of the points of the previous one after it.  If
+  // |thread_pool| is not null, it is used to evaluate the body trajectory.
+  void Update(typename DiscreteTrajectory<Frame>::Iterator const& begin,
+              typename DiscreteTrajectory<Frame>::Iterator const& end,
+              ThreadPool<void>* const thread_pool);
+
+  // Computes the apsides of the trajectory segment given by |begin| and |end|
+  // with respect to the body whose trajectory is |body_trajectory|, and appends
+  // them to |apoapsides| and |periapsides|.  Nothing is retained.  If
+  // |thread_pool| is not null, it is used to evaluate the body trajectory.
+  static void ComputeApsides(
+      not_null<ContinuousTrajectory<Frame> const*> const body_trajectory,
+      typename DiscreteTrajectory<Frame>::Iterator const& begin,
+      typename DiscreteTrajectory<Frame>::Iterator const& end,
+      ThreadPool<void>* const thread_pool,
+      DiscreteTrajectory<Frame>& apoapsides,
+      DiscreteTrajectory<Frame>& periapsides);
+
+  // Returns true if calling |Update| with the segment given by |begin| and
+  // |end| would reuse the apsides computed by the last call to |Update|.
+  bool CanReuse(
+      typename DiscreteTrajectory<Frame>::Iterator const& begin,
+      typename DiscreteTrajectory<Frame>::Iterator const& end) const;
+
+  DiscreteTrajectory<Frame> const& apoapsides() const;
+  DiscreteTrajectory<Frame> const& periapsides() const;
+
+ private:
+  // A point of the trajectory with the squared distance to the body and its
+  // derivative.
+  struct Point {
+    Point(Instant const& time,
+          DegreesOfFreedom<Frame> const& degrees_of_freedom);
+
+    Instant time;
+    DegreesOfFreedom<Frame> degrees_of_freedom;
+    Square<Length> squared_distance;
+    Variation<Square<Length>> squared_distance_derivative;
+  };
+
+  // Forgets the apsides and the points scanned.
+  void Reset();
+
+  // If the segment given by |begin| and |end| may reuse the apsides computed
+  // by the last call to |Update|, sets |*common| to the first point of the
+  // segment from which it has the points of |head_|, and |*last| to the point
+  // of the segment which was the last one scanned, and returns true.  Returns
+  // false otherwise.  The first points of a prediction that were not scanned
+  // are skipped, so at most |head_size| points are tried.
+  bool FindScannedPoints(
+      typename DiscreteTrajectory<Frame>::Iterator const& begin,
+      typename DiscreteTrajectory<Frame>::Iterator const& end,
+      not_null<typename DiscreteTrajectory<Frame>::Iterator*> const common,
+      not_null<typename DiscreteTrajectory<Frame>::Iterator*> const last)
+      const;
+
+  // Makes the scanned points start with the points in [begin, common], which
+  // are scanned, instead of the points before |common|, whose apsides are
+  // dropped.  |common| must be one of the points of |head_|.
+  void Rebase(typename DiscreteTrajectory<Frame>::Iterator const& begin,
+              typename DiscreteTrajectory<Frame>::Iterator const& common,
+              ThreadPool<void>* const thread_pool);
+
+  // Appends the apsides of |from| that are at or after |time| and after the
+  // last apsis of |to| to |to|.
+  static void AppendApsidesAfter(DiscreteTrajectory<Frame> const& from,
+                                 Instant const& time,
+                                 DiscreteTrajectory<Frame>& to);
+
+  // Scans the points in [begin, end[, which follow |last_|, if any, and appends
+  // their apsides to |apoapsides| and |periapsides|.
+  void Scan(typename DiscreteTrajectory<Frame>::Iterator const& begin,
+            typename DiscreteTrajectory<Frame>::Iterator const& end,
+            ThreadPool<void>* const thread_pool,
+            DiscreteTrajectory<Frame>& apoapsides,
+            DiscreteTrajectory<Frame>& periapsides);
+
+  // Fills the squared distances of the points of |window_| in [first, last[.
+  void ComputeSquaredDistances(std::int64_t const first,
+                               std::int64_t const last);
+
+  // Appends the apsis between |previous| and |current|, if any, to
+  // |apoapsides| or |periapsides|.
+  static void AppendApsis(Point const& previous,
+                          Point const& current,
+                          DiscreteTrajectory<Frame>& apoapsides,
+                          DiscreteTrajectory<Frame>& periapsides);
+
+  // The number of points above which the body trajectory is evaluated by the
+  // thread pool.  Each task evaluates that many points, and a window has that
+  // many points per thread of the pool.
+  static std::int64_t constexpr points_per_task = 1000;
+
+  // The maximum number of points retained in |head_|.  The start of a
+  // prediction moves by a few points from one frame to the next.
+  static std::int64_t constexpr head_size = 100;
+
+  not_null<ContinuousTrajectory<Frame> const*> const body_trajectory_;
+
+  // The first points scanned by the last calls to |Update|, at most
+  // |head_size| of them, and the last point scanned.  Either both are empty or
+  // neither is.
+  std::deque<Point> head_;
+  std::experimental::optional<Point> last_;
+
+  // The points being scanned by |Scan|.  Retained so that its storage is reused
+  // from one window and one call to the next.
+  std::vector<Point> window_;
+
+  not_null<std::unique_ptr<DiscreteTrajectory<Frame>>> apoapsides_;
+  not_null<std::unique_ptr<DiscreteTrajectory<Frame>>> periapsides_;
+};
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/apsides_tracker_body.hpp"
@@ -0,0 +1,348 @@
+#pragma once
+
+#include "physics/apsides_tracker.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <set>
+#include <vector>
+
+#include "geometry/barycentre_calculator.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/sign.hpp"
+#include "glog/logging.h"
+#include "numerics/hermite3.hpp"
+
+namespace principia {
+
+using base::make_not_null_unique;
+using geometry::Barycentre;
+using geometry::InnerProduct;
+using geometry::Position;
+using geometry::Sign;
+using numerics::Hermite3;
+
+namespace physics {
+
+template<typename Frame>
+std::int64_t constexpr ApsidesTracker<Frame>::points_per_task;
+
+template<typename Frame>
+std::int64_t constexpr ApsidesTracker<Frame>::head_size;
+
+template<typename Frame>
+ApsidesTracker<Frame>::Point::Point(
+    Instant const& time,
+    DegreesOfFreedom<Frame> const& degrees_of_freedom)
+    : time(time),
+      degrees_of_freedom(degrees_of_freedom) {}
+
+template<typename Frame>
+ApsidesTracker<Frame>::ApsidesTracker(
+    not_null<ContinuousTrajectory<Frame> const*> const body_trajectory)
+    : body_trajectory_(body_trajectory),
+      apoapsides_(make_not_null_unique<DiscreteTrajectory<Frame>>()),
+      periapsides_(make_not_null_unique<DiscreteTrajectory<Frame>>()) {}
+
+template<typename Frame>
+void ApsidesTracker<Frame>::Update(
+    typename DiscreteTrajectory<Frame>::Iterator const& begin,
+    typename DiscreteTrajectory<Frame>::Iterator const& end,
+    ThreadPool<void>* const thread_pool) {
+  auto common = begin;
+  auto last = begin;
+  auto first_unscanned = begin;
+  if (FindScannedPoints(begin, end, &common, &last)) {
+    if (common != begin || head_.front().time != common.time()) {
+      Rebase(begin, common, thread_pool);
+    }
+    first_unscanned = ++last;
+  } else {
+    Reset();
+  }
+  Scan(first_unscanned, end, thread_pool, *apoapsides_, *periapsides_);
+}
+
+template<typename Frame>
+void ApsidesTracker<Frame>::ComputeApsides(
+    not_null<ContinuousTrajectory<Frame> const*> const body_trajectory,
+    typename DiscreteTrajectory<Frame>::Iterator const& begin,
+    typename DiscreteTrajectory<Frame>::Iterator const& end,
+    ThreadPool<void>* const thread_pool,
+    DiscreteTrajectory<Frame>& apoapsides,
+    DiscreteTrajectory<Frame>& periapsides) {
+  ApsidesTracker tracker(body_trajectory);
+  tracker.Scan(begin, end, thread_pool, apoapsides, periapsides);
+}
+
+template<typename Frame>
+bool ApsidesTracker<Frame>::CanReuse(
+    typename DiscreteTrajectory<Frame>::Iterator const& begin,
+    typename DiscreteTrajectory<Frame>::Iterator const& end) const {
+  auto common = begin;
+  auto last = begin;
+  return FindScannedPoints(begin, end, &common, &last);
+}
+
+template<typename Frame>
+DiscreteTrajectory<Frame> const& ApsidesTracker<Frame>::apoapsides() const {
+  return *apoapsides_;
+}
+
+template<typename Frame>
+DiscreteTrajectory<Frame> const& ApsidesTracker<Frame>::periapsides() const {
+  return *periapsides_;
+}
+
+template<typename Frame>
+void ApsidesTracker<Frame>::Reset() {
+  head_.clear();
+  last_ = std::experimental::nullopt;
+  apoapsides_ = make_not_null_unique<DiscreteTrajectory<Frame>>();
+  periapsides_ = make_not_null_unique<DiscreteTrajectory<Frame>>();
+}
+
+template<typename Frame>
+bool ApsidesTracker<Frame>::FindScannedPoints(
+    typename DiscreteTrajectory<Frame>::Iterator const& begin,
+    typename DiscreteTrajectory<Frame>::Iterator const& end,
+    not_null<typename DiscreteTrajectory<Frame>::Iterator*> const common,
+    not_null<typename DiscreteTrajectory<Frame>::Iterator*> const last) const {
+  if (!last_) {
+    return false;
+  }
+  // The first points of the segment may be new, e.g., the point where a
+  // prediction is forked and the current point of the vessel, so look for the
+  // first one from which the segment coincides with |head_|.  It must not be
+  // the last point scanned, as a segment that only shares that point with the
+  // previous one, like the prediction forked at the end of a history, reuses
+  // nothing.
+  for (auto it = begin;
+       it != end && it.time() <= head_.back().time && it.time() < last_->time;
+       ++it) {
+    auto const head_it = std::lower_bound(
+        head_.begin(),
+        head_.end(),
+        it.time(),
+        [](Point const& point, Instant const& time) {
+          return point.time < time;
+        });
+    if (head_it->time != it.time() ||
+        head_it->degrees_of_freedom != it.degrees_of_freedom()) {
+      continue;
+    }
+    auto segment_it = it;
+    auto point_it = head_it;
+    for (++segment_it, ++point_it;
+         segment_it != end && point_it != head_.end() &&
+         segment_it.time() == point_it->time &&
+         segment_it.degrees_of_freedom() == point_it->degrees_of_freedom;
+         ++segment_it, ++point_it) {}
+    if (segment_it != end && point_it != head_.end()) {
+      continue;
+    }
+
+    // Find the last point scanned, walking back from the end of the segment
+    // over the points appended since the last call.
+    auto last_scanned = end;
+    --last_scanned;
+    while (last_scanned != it && last_scanned.time() > last_->time) {
+      --last_scanned;
+    }
+    if (last_scanned.time() != last_->time ||
+        last_scanned.degrees_of_freedom() != last_->degrees_of_freedom) {
+      return false;
+    }
+    *common = it;
+    *last = last_scanned;
+    return true;
+  }
+  return false;
+}
+
+template<typename Frame>
+void ApsidesTracker<Frame>::Rebase(
+    typename DiscreteTrajectory<Frame>::Iterator const& begin,
+    typename DiscreteTrajectory<Frame>::Iterator const& common,
+    ThreadPool<void>* const thread_pool) {
+  Instant const common_time = common.time();
+  std::deque<Point> old_head;
+  old_head.swap(head_);
+  std::experimental::optional<Point> const old_last = last_;
+  last_ = std::experimental::nullopt;
+
+  // Scan the new points, which become the beginning of |head_|.  The rest of
+  // the old head follows, unless the new points don't all fit in |head_|.
+  auto apoapsides = make_not_null_unique<DiscreteTrajectory<Frame>>();
+  auto periapsides = make_not_null_unique<DiscreteTrajectory<Frame>>();
+  auto after_common = common;
+  ++after_common;
+  Scan(begin, after_common, thread_pool, *apoapsides, *periapsides);
+  if (head_.back().time == common_time) {
+    for (auto const& point : old_head) {
+      if (head_.size() == head_size) {
+        break;
+      }
+      if (point.time > common_time) {
+        head_.push_back(point);
+      }
+    }
+  }
+  last_ = old_last;
+
+  AppendApsidesAfter(*apoapsides_, common_time, *apoapsides);
+  AppendApsidesAfter(*periapsides_, common_time, *periapsides);
+  apoapsides_ = std::move(apoapsides);
+  periapsides_ = std::move(periapsides);
+}
+
+template<typename Frame>
+void ApsidesTracker<Frame>::AppendApsidesAfter(
+    DiscreteTrajectory<Frame> const& from,
+    Instant const& time,
+    DiscreteTrajectory<Frame>& to) {
+  for (auto it = from.LowerBound(time); it != from.End(); ++it) {
+    if (to.Begin() == to.End() || it.time() > to.last().time()) {
+      to.Append(it.time(), it.degrees_of_freedom());
+    }
+  }
+}
+
+template<typename Frame>
+void ApsidesTracker<Frame>::Scan(
+    typename DiscreteTrajectory<Frame>::Iterator const& begin,
+    typename DiscreteTrajectory<Frame>::Iterator const& end,
+    ThreadPool<void>* const thread_pool,
+    DiscreteTrajectory<Frame>& apoapsides,
+    DiscreteTrajectory<Frame>& periapsides) {
+  std::int64_t const window_size =
+      thread_pool == nullptr ? points_per_task
+                             : points_per_task * thread_pool->size();
+  window_.reserve(window_size);
+  auto it = begin;
+  while (it != end) {
+    window_.clear();
+    for (std::int64_t i = 0; it != end && i < window_size; ++it, ++i) {
+      window_.emplace_back(it.time(), it.degrees_of_freedom());
+    }
+
+    // Evaluating the body trajectory is the expensive part, and the points are
+    // independent from one another, so this is done in parallel over chunks of
+    // consecutive points.  Each chunk uses its own hint.
+    std::int64_t const size = window_.size();
+    if (thread_pool == nullptr || size <= points_per_task) {
+      ComputeSquaredDistances(0, size);
+    } else {
+      std::vector<std::future<void>> futures;
+      for (std::int64_t first = 0; first < size; first += points_per_task) {
+        std::int64_t const last = std::min(first + points_per_task, size);
+        futures.push_back(thread_pool->Add([this, first, last]() {
+          ComputeSquaredDistances(first, last);
+        }));
+      }
+      for (auto& future : futures) {
+        future.wait();
+      }
+    }
+
+    for (auto const& point : window_) {
+      if (last_) {
+        AppendApsis(*last_, point, apoapsides, periapsides);
+      }
+      // The head is extended as long as it has all the points scanned.
+      if (head_.size() < head_size &&
+          (!last_ || head_.back().time == last_->time)) {
+        head_.push_back(point);
+      }
+      last_ = point;
+    }
+  }
+}
+
+template<typename Frame>
+void ApsidesTracker<Frame>::ComputeSquaredDistances(
+    std::int64_t const first,
+    std::int64_t const last) {
+  typename ContinuousTrajectory<Frame>::Hint hint;
+  for (std::int64_t i = first; i < last; ++i) {
+    Point& point = window_[i];
+    DegreesOfFreedom<Frame> const body_degrees_of_freedom =
+        body_trajectory_->EvaluateDegreesOfFreedom(point.time, &hint);
+    RelativeDegreesOfFreedom<Frame> const relative =
+        point.degrees_of_freedom - body_degrees_of_freedom;
+    point.squared_distance =
+        InnerProduct(relative.displacement(), relative.displacement());
+    // This is the derivative of |squared_distance|.
+    point.squared_distance_derivative =
+        2.0 * InnerProduct(relative.displacement(), relative.velocity());
+  }
+}
+
+template<typename Frame>
+void ApsidesTracker<Frame>::AppendApsis(
+    Point const& previous,
+    Point const& current,
+    DiscreteTrajectory<Frame>& apoapsides,
+    DiscreteTrajectory<Frame>& periapsides) {
+  if (Sign(current.squared_distance_derivative) ==
+          Sign(previous.squared_distance_derivative)) {
+    return;
+  }
+
+  // The derivative of |squared_distance| changed sign.  Construct a Hermite
+  // approximation of |squared_distance| and find its extrema.
+  Hermite3<Instant, Square<Length>> const squared_distance_approximation(
+      {previous.time, current.time},
+      {previous.squared_distance, current.squared_distance},
+      {previous.squared_distance_derivative,
+       current.squared_distance_derivative});
+  std::set<Instant> const extrema =
+      squared_distance_approximation.FindExtrema();
+
+  // Now look at the extrema and check that exactly one is in the required time
+  // interval.  This is normally the case, but it can fail due to
+  // ill-conditioning.
+  Instant apsis_time;
+  int valid_extrema = 0;
+  for (auto const& extremum : extrema) {
+    if (extremum >= previous.time && extremum <= current.time) {
+      apsis_time = extremum;
+      ++valid_extrema;
+    }
+  }
+  if (valid_extrema != 1) {
+    // Something went wrong when finding the extrema of
+    // |squared_distance_approximation|. Use a linear interpolation of
+    // |squared_distance_derivative| instead.
+    apsis_time = Barycentre<Instant, Variation<Square<Length>>>(
+        {current.time, previous.time},
+        {previous.squared_distance_derivative,
+         -current.squared_distance_derivative});
+  }
+
+  // Now that we know the time of the apsis, construct a Hermite approximation
+  // of the position of the body, and use it to derive its degrees of freedom.
+  // Note that an extremum of |squared_distance_approximation| is in general not
+  // an extremum for |position_approximation|: the distance computed using the
+  // latter is a 6th-degree polynomial.  However, approximating this polynomial
+  // using a 3rd-degree polynomial would yield |squared_distance_approximation|,
+  // so we shouldn't be far from the truth.
+  Hermite3<Instant, Position<Frame>> position_approximation(
+      {previous.time, current.time},
+      {previous.degrees_of_freedom.position(),
+       current.degrees_of_freedom.position()},
+      {previous.degrees_of_freedom.velocity(),
+       current.degrees_of_freedom.velocity()});
+  DegreesOfFreedom<Frame> const apsis_degrees_of_freedom(
+      position_approximation.Evaluate(apsis_time),
+      position_approximation.EvaluateDerivative(apsis_time));
+  if (Sign(current.squared_distance_derivative).Negative()) {
+    apoapsides.Append(apsis_time, apsis_degrees_of_freedom);
+  } else {
+    periapsides.Append(apsis_time, apsis_degrees_of_freedom);
+  }
+}
+
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,271 @@
+﻿
+#include "physics/apsides_tracker.hpp"
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "base/thread_pool.hpp"
+#include "geometry/frame.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "integrators/embedded_explicit_runge_kutta_nyström_integrator.hpp"
+#include "integrators/symplectic_runge_kutta_nyström_integrator.hpp"
+#include "physics/ephemeris.hpp"
+#include "physics/massive_body.hpp"
+#include "quantities/astronomy.hpp"
+#include "quantities/constants.hpp"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+
+namespace principia {
+
+using base::ThreadPool;
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Position;
+using geometry::Velocity;
+using integrators::DormandElMikkawyPrince1986RKN434FM;
+using integrators::McLachlanAtela1992Order5Optimal;
+using quantities::astronomy::JulianYear;
+using quantities::astronomy::SolarMass;
+using quantities::constants::GravitationalConstant;
+using quantities::si::AstronomicalUnit;
+using quantities::si::Hour;
+using quantities::si::Kilo;
+using quantities::si::Metre;
+using quantities::si::Milli;
+using quantities::si::Second;
+using ::testing::ElementsAreArray;
+using ::testing::Gt;
+using ::testing::SizeIs;
+
+namespace physics {
+
+class ApsidesTrackerTest : public testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      serialization::Frame::TEST, true>;
+
+  ApsidesTrackerTest()
+      : body_(new MassiveBody(GravitationalConstant * SolarMass)),
+        ephemeris_(MakeBodies(body_),
+                   {DegreesOfFreedom<World>(World::origin, Velocity<World>())},
+                   t0_,
+                   5 * Milli(Metre),
+                   Ephemeris<World>::FixedStepParameters(
+                       McLachlanAtela1992Order5Optimal<Position<World>>(),
+                       1 * Hour)) {
+    trajectory_.Append(
+        t0_,
+        DegreesOfFreedom<World>(
+            World::origin + Displacement<World>({1 * AstronomicalUnit,
+                                                 2 * AstronomicalUnit,
+                                                 3 * AstronomicalUnit}),
+            Velocity<World>({4 * Kilo(Metre) / Second,
+                             5 * Kilo(Metre) / Second,
+                             6 * Kilo(Metre) / Second})));
+  }
+
+  static std::vector<not_null<std::unique_ptr<MassiveBody const>>> MakeBodies(
+      MassiveBody const* const body) {
+    std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+    bodies.emplace_back(std::unique_ptr<MassiveBody const>(body));
+    return bodies;
+  }
+
+  // Extends |trajectory_| until |t|.
+  void Flow(Instant const& t) {
+    ephemeris_.FlowWithAdaptiveStep(
+        &trajectory_,
+        Ephemeris<World>::kNoIntrinsicAcceleration,
+        t,
+        Ephemeris<World>::AdaptiveStepParameters(
+            DormandElMikkawyPrince1986RKN434FM<Position<World>>(),
+            std::numeric_limits<std::int64_t>::max(),
+            1E-6 * Metre,
+            1E-6 * Metre / Second),
+        Ephemeris<World>::unlimited_max_ephemeris_steps);
+  }
+
+  static std::vector<Instant> Times(
+      DiscreteTrajectory<World> const& trajectory) {
+    std::vector<Instant> times;
+    for (auto it = trajectory.Begin(); it != trajectory.End(); ++it) {
+      times.push_back(it.time());
+    }
+    return times;
+  }
+
+  Instant const t0_;
+  MassiveBody const* const body_;
+  Ephemeris<World> ephemeris_;
+  DiscreteTrajectory<World> trajectory_;
+};
+
+TEST_F(ApsidesTrackerTest, Incremental) {
+  ApsidesTracker<World> incremental(ephemeris_.trajectory(body_));
+  ThreadPool<void> thread_pool(4);
+  for (int year = 1; year <= 10; ++year) {
+    Flow(t0_ + year * JulianYear);
+    incremental.Update(trajectory_.Begin(), trajectory_.End(), &thread_pool);
+  }
+  EXPECT_THAT(trajectory_.Size(), Gt(3000));
+
+  // The apsides are the same as when the whole trajectory is scanned at once,
+  // serially.
+  ApsidesTracker<World> serial(ephemeris_.trajectory(body_));
+  serial.Update(trajectory_.Begin(), trajectory_.End(), nullptr);
+  EXPECT_THAT(Times(serial.apoapsides()), SizeIs(3));
+  EXPECT_THAT(Times(serial.periapsides()), SizeIs(3));
+  EXPECT_THAT(Times(incremental.apoapsides()),
+              ElementsAreArray(Times(serial.apoapsides())));
+  EXPECT_THAT(Times(incremental.periapsides()),
+              ElementsAreArray(Times(serial.periapsides())));
+
+  // The same, scanned at once in parallel.
+  ApsidesTracker<World> parallel(ephemeris_.trajectory(body_));
+  parallel.Update(trajectory_.Begin(), trajectory_.End(), &thread_pool);
+  EXPECT_THAT(Times(parallel.apoapsides()),
+              ElementsAreArray(Times(serial.apoapsides())));
+  EXPECT_THAT(Times(parallel.periapsides()),
+              ElementsAreArray(Times(serial.periapsides())));
+
+  // The same, with a pool small enough that the trajectory is scanned in
+  // several windows.
+  ThreadPool<void> small_thread_pool(2);
+  ApsidesTracker<World> windowed(ephemeris_.trajectory(body_));
+  windowed.Update(trajectory_.Begin(), trajectory_.End(), &small_thread_pool);
+  EXPECT_THAT(Times(windowed.apoapsides()),
+              ElementsAreArray(Times(serial.apoapsides())));
+  EXPECT_THAT(Times(windowed.periapsides()),
+              ElementsAreArray(Times(serial.periapsides())));
+
+  // They are also the same as those computed by the ephemeris.
+  DiscreteTrajectory<World> apoapsides;
+  DiscreteTrajectory<World> periapsides;
+  ephemeris_.ComputeApsides(body_,
+                            trajectory_.Begin(),
+                            trajectory_.End(),
+                            apoapsides,
+                            periapsides);
+  EXPECT_THAT(Times(apoapsides), ElementsAreArray(Times(serial.apoapsides())));
+  EXPECT_THAT(Times(periapsides),
+              ElementsAreArray(Times(serial.periapsides())));
+}
+
+TEST_F(ApsidesTrackerTest, Changes) {
+  Flow(t0_ + 10 * JulianYear);
+  ApsidesTracker<World> tracker(ephemeris_.trajectory(body_));
+  tracker.Update(trajectory_.Begin(), trajectory_.End(), nullptr);
+  EXPECT_TRUE(tracker.CanReuse(trajectory_.Begin(), trajectory_.End()));
+  auto const all_apoapsides = Times(tracker.apoapsides());
+  auto const all_periapsides = Times(tracker.periapsides());
+
+  // A shorter segment.
+  auto const middle_time = trajectory_.LowerBound(t0_ + 5 * JulianYear).time();
+  tracker.Update(trajectory_.Begin(),
+                 trajectory_.LowerBound(middle_time),
+                 nullptr);
+  for (auto const& time : Times(tracker.apoapsides())) {
+    EXPECT_LT(time, middle_time);
+  }
+  EXPECT_LT(Times(tracker.apoapsides()).size(), all_apoapsides.size());
+
+  // The full segment again, which extends the shorter one.
+  tracker.Update(trajectory_.Begin(), trajectory_.End(), nullptr);
+  EXPECT_THAT(Times(tracker.apoapsides()), ElementsAreArray(all_apoapsides));
+  EXPECT_THAT(Times(tracker.periapsides()), ElementsAreArray(all_periapsides));
+
+  // A segment that starts later, like a history that was forgotten before a
+  // time.
+  auto const second = ++trajectory_.Begin();
+  EXPECT_TRUE(tracker.CanReuse(second, trajectory_.End()));
+  tracker.Update(second, trajectory_.End(), nullptr);
+  EXPECT_TRUE(tracker.CanReuse(second, trajectory_.End()));
+  EXPECT_THAT(Times(tracker.apoapsides()), ElementsAreArray(all_apoapsides));
+
+  // A segment that starts at the same point but differs right after it, like
+  // successive predictions.  Only the points up to the first common one are
+  // scanned.
+  DiscreteTrajectory<World> moved;
+  auto it = second;
+  moved.Append(it.time(), it.degrees_of_freedom());
+  ++it;
+  moved.Append(it.time(),
+               DegreesOfFreedom<World>(it.degrees_of_freedom().position() +
+                                           Displacement<World>({1 * Metre,
+                                                                0 * Metre,
+                                                                0 * Metre}),
+                                       it.degrees_of_freedom().velocity()));
+  for (++it; it != trajectory_.End(); ++it) {
+    moved.Append(it.time(), it.degrees_of_freedom());
+  }
+  EXPECT_TRUE(tracker.CanReuse(moved.Begin(), moved.End()));
+  tracker.Update(moved.Begin(), moved.End(), nullptr);
+  EXPECT_TRUE(tracker.CanReuse(moved.Begin(), moved.End()));
+  EXPECT_THAT(Times(tracker.apoapsides()), ElementsAreArray(all_apoapsides));
+  EXPECT_THAT(Times(tracker.periapsides()), ElementsAreArray(all_periapsides));
+
+  // A segment that only shares its first point with the previous one.
+  DiscreteTrajectory<World> shifted;
+  for (auto it = second; it != trajectory_.End(); ++it) {
+    shifted.Append(
+        it.time(),
+        DegreesOfFreedom<World>(it.degrees_of_freedom().position() +
+                                    Displacement<World>({0 * Metre,
+                                                         1 * Metre,
+                                                         0 * Metre}),
+                                it.degrees_of_freedom().velocity()));
+  }
+  EXPECT_FALSE(tracker.CanReuse(shifted.Begin(), shifted.End()));
+
+  // An empty segment.
+  tracker.Update(trajectory_.End(), trajectory_.End(), nullptr);
+  EXPECT_FALSE(tracker.CanReuse(second, trajectory_.End()));
+  EXPECT_THAT(Times(tracker.apoapsides()), SizeIs(0));
+  EXPECT_THAT(Times(tracker.periapsides()), SizeIs(0));
+}
+
+TEST_F(ApsidesTrackerTest, MovingStart) {
+  Flow(t0_ + 10 * JulianYear);
+  ApsidesTracker<World> tracker(ephemeris_.trajectory(body_));
+
+  // Successive predictions, forked at the first point of |trajectory_|.  Each
+  // of them starts with a point of its own, between two points of
+  // |trajectory_|, continues with the points of |trajectory_|, and ends later
+  // than the previous one.
+  for (int frame = 1; frame <= 5; ++frame) {
+    auto const fork = trajectory_.Begin();
+    auto start = fork;
+    for (int i = 0; i < 10 * frame; ++i) {
+      ++start;
+    }
+    auto next = start;
+    ++next;
+    auto const end = trajectory_.LowerBound(t0_ + (5 + frame) * JulianYear);
+
+    DiscreteTrajectory<World> prediction;
+    prediction.Append(fork.time(), fork.degrees_of_freedom());
+    prediction.Append(start.time() + (next.time() - start.time()) / 2,
+                      start.degrees_of_freedom());
+    for (auto it = next; it != end; ++it) {
+      prediction.Append(it.time(), it.degrees_of_freedom());
+    }
+
+    EXPECT_EQ(frame > 1,
+              tracker.CanReuse(prediction.Begin(), prediction.End()));
+    tracker.Update(prediction.Begin(), prediction.End(), nullptr);
+
+    ApsidesTracker<World> scratch(ephemeris_.trajectory(body_));
+    scratch.Update(prediction.Begin(), prediction.End(), nullptr);
+    EXPECT_THAT(Times(tracker.apoapsides()),
+                ElementsAreArray(Times(scratch.apoapsides())));
+    EXPECT_THAT(Times(tracker.periapsides()),
+                ElementsAreArray(Times(scratch.periapsides())));
+    EXPECT_THAT(Times(tracker.apoapsides()), SizeIs(Gt(0)));
+  }
+}
+
+}  // namespace physics
+}  // namespace principia
@@ -41,9 +41,9 @@ RigidMotion<InertialFrame, ThisFrame>
 BarycentricRotatingDynamicFrame<InertialFrame, ThisFrame>::ToThisFrameAtTime(
     Instant const& t) const {
   DegreesOfFreedom<InertialFrame> const primary_degrees_of_freedom =
-      primary_trajectory_->EvaluateDegreesOfFreedom(t, &primary_hint_);
+      primary_trajectory_->EvaluateDegreesOfFreedom(t, /*hint=*/nullptr);
   DegreesOfFreedom<InertialFrame> const secondary_degrees_of_freedom =
-      secondary_trajectory_->EvaluateDegreesOfFreedom(t, &secondary_hint_);
+      secondary_trajectory_->EvaluateDegreesOfFreedom(t, /*hint=*/nullptr);
   DegreesOfFreedom<InertialFrame> const barycentre_degrees_of_freedom =
       Barycentre<DegreesOfFreedom<InertialFrame>, GravitationalParameter>(
           {primary_degrees_of_freedom,
@@ -86,9 +86,9 @@ GeometricAcceleration(
   auto const from_this_frame = to_this_frame.Inverse();
 
   DegreesOfFreedom<InertialFrame> const primary_degrees_of_freedom =
-      primary_trajectory_->EvaluateDegreesOfFreedom(t, &primary_hint_);
+      primary_trajectory_->EvaluateDegreesOfFreedom(t, /*hint=*/nullptr);
   DegreesOfFreedom<InertialFrame> const secondary_degrees_of_freedom =
-      secondary_trajectory_->EvaluateDegreesOfFreedom(t, &secondary_hint_);
+      secondary_trajectory_->EvaluateDegreesOfFreedom(t, /*hint=*/nullptr);
 
   // Beware, we want the angular velocity of ThisFrame as seen in the
   // InertialFrame, but pushed to ThisFrame.  Otherwise the sign is wrong.
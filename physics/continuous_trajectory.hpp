@@ -2,6 +2,7 @@
 #pragma once
 
 #include <experimental/optional>
+#include <functional>
 #include <vector>
 #include <utility>
 
@@ -57,9 +58,14 @@ class ContinuousTrajectory {
   // passed to |Append| if the trajectory is not empty.  The |time|s passed to
   // successive calls to |Append| must be equally spaced with the |step| given
   // at construction.
+  // Calls to |Append| on distinct trajectories may run concurrently.
   void Append(Instant const& time,
               DegreesOfFreedom<Frame> const& degrees_of_freedom);
 
+  // Returns true if the next call to |Append| will compute a new series, which
+  // is much more expensive than merely recording the point.
+  bool next_append_fits() const;
+
   // Removes all data for times strictly greater than |time|.  |time| must
   // either be greater that |t_max()| or be a value returned by a previous call
   // to |t_max()|.  The |degrees_of_freedom| must be the ones originally passed
@@ -73,7 +79,9 @@ class ContinuousTrajectory {
   // Evaluates the trajectory at the given |time|, which must be in
   // [t_min(), t_max()].  The |hint| may be used to speed up evaluation
   // in increasing time order.  It may be a nullptr (in which case no speed-up
-  // takes place).
+  // takes place, but the series to evaluate is still found in constant time).
+  // These functions do not modify the trajectory: they may be called
+  // concurrently, provided that the threads don't share |Hint| objects.
   Position<Frame> EvaluatePosition(Instant const& time,
                                    Hint* const hint) const;
   Velocity<Frame> EvaluateVelocity(Instant const& time,
@@ -87,6 +95,21 @@ class ContinuousTrajectory {
   static not_null<std::unique_ptr<ContinuousTrajectory>> ReadFromMessage(
       serialization::ContinuousTrajectory const& message);
 
+  // Same as |WriteToMessage|, except that only the series that end after
+  // |base_time| are written.  The others are expected to be found in a
+  // serialization of this trajectory made at |base_time|.
+  void WriteDeltaToMessage(
+      not_null<serialization::ContinuousTrajectory*> const message,
+      Instant const& base_time) const;
+
+  // Folds the |delta| written by |WriteDeltaToMessage| into the |message|
+  // written by |WriteToMessage| at |base_time|.  At exit |message| is identical
+  // to the result of |WriteToMessage| at the time of the |delta|.
+  static void MergeDeltaIntoMessage(
+      serialization::ContinuousTrajectory const& delta,
+      Instant const& base_time,
+      not_null<serialization::ContinuousTrajectory*> const message);
+
   // The only thing that clients may do with |Hint| objects is to
   // default-initialize them.
   class Hint {
@@ -105,11 +128,14 @@ class ContinuousTrajectory {
   // Computes the best Newhall approximation based on the desired tolerance.
   // Adjust the |degree_| and other member variables to stay within the
   // tolerance while minimizing the computational cost and avoiding numerical
-  // instabilities.
+  // instabilities.  |newhall_error_estimate| returns the error estimate of the
+  // approximation of the given degree; the degrees are searched using it, and
+  // only the approximation of the selected degree is computed.
   void ComputeBestNewhallApproximation(
       Instant const& time,
       std::vector<Displacement<Frame>> const& q,
       std::vector<Velocity<Frame>> const& v,
+      std::function<Length(int const degree)> const& newhall_error_estimate,
       ЧебышёвSeries<Displacement<Frame>> (*newhall_approximation)(
           int const degree,
           std::vector<Displacement<Frame>> const& q,
@@ -117,9 +143,16 @@ class ContinuousTrajectory {
           Instant const& t_min,
           Instant const& t_max));
 
+  // Writes the series starting at |first_series| and all the other data.
+  void WriteToMessage(
+      not_null<serialization::ContinuousTrajectory*> const message,
+      typename std::vector<ЧебышёвSeries<Displacement<Frame>>>::const_iterator
+          first_series) const;
+
   // Returns an iterator to the series applicable for the given |time|, or
   // |begin()| if |time| is before the first series or |end()| if |time| is
-  // after the last series.  Time complexity is O(N Log N).
+  // after the last series.  Since the series all cover |kDivisions| steps, the
+  // index of the series is computed from |time|, and time complexity is O(1).
   typename std::vector<ЧебышёвSeries<Displacement<Frame>>>::const_iterator
   FindSeriesForInstant(Instant const& time) const;
 
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <vector>
 
@@ -80,11 +81,12 @@ void ContinuousTrajectory<Frame>::Append(
     first_time_ = time;
   }
 
-  if (last_points_.size() == kDivisions) {
-    // These vectors are static to avoid deallocation/reallocation each time we
-    // go through this code path.
-    static std::vector<Displacement<Frame>> q(kDivisions + 1);
-    static std::vector<Velocity<Frame>> v(kDivisions + 1);
+  if (next_append_fits()) {
+    // These vectors are thread-local to avoid deallocation/reallocation each
+    // time we go through this code path, while allowing distinct trajectories
+    // to be appended to concurrently.
+    thread_local std::vector<Displacement<Frame>> q(kDivisions + 1);
+    thread_local std::vector<Velocity<Frame>> v(kDivisions + 1);
     q.clear();
     v.clear();
 
@@ -96,8 +98,18 @@ void ContinuousTrajectory<Frame>::Append(
     q.push_back(degrees_of_freedom.position() - Frame::origin);
     v.push_back(degrees_of_freedom.velocity());
 
+    // The errors are estimated from the last coefficients only, so that the
+    // search for the best degree doesn't have to compute approximations that
+    // it will then discard.
+    Instant const t_min = last_points_.cbegin()->first;
     ComputeBestNewhallApproximation(
-        time, q, v, &ЧебышёвSeries<Displacement<Frame>>::NewhallApproximation);
+        time, q, v,
+        [&t_min, &time](int const degree) {
+          return ЧебышёвSeries<Displacement<Frame>>::
+                     NewhallApproximationLastCoefficient(
+                         degree, q, v, t_min, time).Norm();
+        },
+        &ЧебышёвSeries<Displacement<Frame>>::NewhallApproximation);
 
     // Wipe-out the points that have just been incorporated in a series.
     last_points_.clear();
@@ -109,6 +121,11 @@ void ContinuousTrajectory<Frame>::Append(
   last_points_.emplace_back(time, degrees_of_freedom);
 }
 
+template<typename Frame>
+bool ContinuousTrajectory<Frame>::next_append_fits() const {
+  return last_points_.size() == kDivisions;
+}
+
 template<typename Frame>
 void ContinuousTrajectory<Frame>::ForgetAfter(
     Instant const & time,
@@ -186,50 +203,27 @@ DegreesOfFreedom<Frame> ContinuousTrajectory<Frame>::EvaluateDegreesOfFreedom(
     Hint* const hint) const {
   CHECK_LE(t_min(), time);
   CHECK_GE(t_max(), time);
+  typename std::vector<ЧебышёвSeries<Displacement<Frame>>>::const_iterator it;
   if (MayUseHint(time, hint)) {
-    ЧебышёвSeries<Displacement<Frame>> const& series = series_[hint->index_];
-    return DegreesOfFreedom<Frame>(series.Evaluate(time) + Frame::origin,
-                                   series.EvaluateDerivative(time));
+    it = series_.cbegin() + hint->index_;
   } else {
-    auto const it = FindSeriesForInstant(time);
+    it = FindSeriesForInstant(time);
     CHECK(it != series_.end());
     if (hint != nullptr) {
       hint->index_ = it - series_.cbegin();
     }
-    return DegreesOfFreedom<Frame>(it->Evaluate(time) + Frame::origin,
-                                   it->EvaluateDerivative(time));
   }
+  Displacement<Frame> displacement;
+  Velocity<Frame> velocity;
+  it->EvaluateWithDerivative(time, &displacement, &velocity);
+  return DegreesOfFreedom<Frame>(displacement + Frame::origin, velocity);
 }
 
 template<typename Frame>
 void ContinuousTrajectory<Frame>::WriteToMessage(
       not_null<serialization::ContinuousTrajectory*> const message) const {
   LOG(INFO) << __FUNCTION__;
-  step_.WriteToMessage(message->mutable_step());
-  tolerance_.WriteToMessage(message->mutable_tolerance());
-  adjusted_tolerance_.WriteToMessage(message->mutable_adjusted_tolerance());
-  message->set_is_unstable(is_unstable_);
-  message->set_degree(degree_);
-  message->set_degree_age(degree_age_);
-  for (auto const& s : series_) {
-    s.WriteToMessage(message->add_series());
-  }
-  if (first_time_) {
-    first_time_->WriteToMessage(message->mutable_first_time());
-  }
-  for (auto const& l : last_points_) {
-    Instant const& instant = l.first;
-    DegreesOfFreedom<Frame> degrees_of_freedom = l.second;
-    not_null<
-        serialization::ContinuousTrajectory::InstantaneousDegreesOfFreedom*>
-        const instantaneous_degrees_of_freedom = message->add_last_point();
-    instant.WriteToMessage(instantaneous_degrees_of_freedom->mutable_instant());
-    degrees_of_freedom.WriteToMessage(
-        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
-  }
-  LOG(INFO) << NAMED(this);
-  LOG(INFO) << NAMED(message->SpaceUsed());
-  LOG(INFO) << NAMED(message->ByteSize());
+  WriteToMessage(message, series_.cbegin());
 }
 
 template<typename Frame>
@@ -261,6 +255,80 @@ ContinuousTrajectory<Frame>::ReadFromMessage(
   return continuous_trajectory;
 }
 
+template<typename Frame>
+void ContinuousTrajectory<Frame>::WriteDeltaToMessage(
+      not_null<serialization::ContinuousTrajectory*> const message,
+      Instant const& base_time) const {
+  LOG(INFO) << __FUNCTION__;
+  auto const first_series = std::upper_bound(
+      series_.cbegin(),
+      series_.cend(),
+      base_time,
+      [](Instant const& base_time,
+         ЧебышёвSeries<Displacement<Frame>> const& series) {
+        return base_time < series.t_max();
+      });
+  WriteToMessage(message, first_series);
+}
+
+template<typename Frame>
+void ContinuousTrajectory<Frame>::MergeDeltaIntoMessage(
+    serialization::ContinuousTrajectory const& delta,
+    Instant const& base_time,
+    not_null<serialization::ContinuousTrajectory*> const message) {
+  // The base series that were not forgotten since |base_time| are kept.  Like
+  // |ForgetBefore|, this retains the series that end at or after the first
+  // time.
+  serialization::ContinuousTrajectory merged = delta;
+  google::protobuf::RepeatedPtrField<serialization::ChebyshevSeries> series;
+  if (delta.has_first_time()) {
+    Instant const first_time = Instant::ReadFromMessage(delta.first_time());
+    for (auto& base_series : *message->mutable_series()) {
+      Instant const t_max = Instant::ReadFromMessage(base_series.t_max());
+      if (first_time <= t_max && t_max <= base_time) {
+        series.Add()->Swap(&base_series);
+      }
+    }
+  }
+  for (auto& delta_series : *merged.mutable_series()) {
+    series.Add()->Swap(&delta_series);
+  }
+  merged.mutable_series()->Swap(&series);
+  message->Swap(&merged);
+}
+
+template<typename Frame>
+void ContinuousTrajectory<Frame>::WriteToMessage(
+      not_null<serialization::ContinuousTrajectory*> const message,
+      typename std::vector<ЧебышёвSeries<Displacement<Frame>>>::const_iterator
+          const first_series) const {
+  step_.WriteToMessage(message->mutable_step());
+  tolerance_.WriteToMessage(message->mutable_tolerance());
+  adjusted_tolerance_.WriteToMessage(message->mutable_adjusted_tolerance());
+  message->set_is_unstable(is_unstable_);
+  message->set_degree(degree_);
+  message->set_degree_age(degree_age_);
+  for (auto it = first_series; it != series_.cend(); ++it) {
+    it->WriteToMessage(message->add_series());
+  }
+  if (first_time_) {
+    first_time_->WriteToMessage(message->mutable_first_time());
+  }
+  for (auto const& l : last_points_) {
+    Instant const& instant = l.first;
+    DegreesOfFreedom<Frame> degrees_of_freedom = l.second;
+    not_null<
+        serialization::ContinuousTrajectory::InstantaneousDegreesOfFreedom*>
+        const instantaneous_degrees_of_freedom = message->add_last_point();
+    instant.WriteToMessage(instantaneous_degrees_of_freedom->mutable_instant());
+    degrees_of_freedom.WriteToMessage(
+        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
+  }
+  LOG(INFO) << NAMED(this);
+  LOG(INFO) << NAMED(message->SpaceUsed());
+  LOG(INFO) << NAMED(message->ByteSize());
+}
+
 template<typename Frame>
 ContinuousTrajectory<Frame>::Hint::Hint()
     : index_(std::numeric_limits<int>::max()) {}
@@ -273,6 +341,7 @@ void ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
     Instant const& time,
     std::vector<Displacement<Frame>> const& q,
     std::vector<Velocity<Frame>> const& v,
+    std::function<Length(int const degree)> const& newhall_error_estimate,
     ЧебышёвSeries<Displacement<Frame>> (*newhall_approximation)(
         int const degree,
         std::vector<Displacement<Frame>> const& q,
@@ -292,13 +361,9 @@ void ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
     degree_age_ = 0;
   }
 
-  // Compute the approximation with the current degree.
-  series_.push_back(
-      newhall_approximation(degree_, q, v, last_points_.cbegin()->first, time));
-
-  // Estimate the error.  For initializing |previous_error_estimate|, any value
-  // greater than |error_estimate| will do.
-  Length error_estimate = series_.back().last_coefficient().Norm();
+  // Estimate the error with the current degree.  For initializing
+  // |previous_error_estimate|, any value greater than |error_estimate| will do.
+  Length error_estimate = newhall_error_estimate(degree_);
   Length previous_error_estimate = error_estimate + error_estimate;
 
   // If we are in the zone of numerical instabilities and we exceeded the
@@ -326,13 +391,14 @@ void ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
     ++degree_;
     VLOG(1) << "Increasing degree for " << this << " to " <<degree_
             << " because error estimate was " << error_estimate;
-    series_.back() =
-        newhall_approximation(
-            degree_, q, v, last_points_.cbegin()->first, time);
     previous_error_estimate = error_estimate;
-    error_estimate = series_.back().last_coefficient().Norm();
+    error_estimate = newhall_error_estimate(degree_);
   }
 
+  // Compute the approximation with the last degree that we tried.
+  series_.push_back(
+      newhall_approximation(degree_, q, v, last_points_.cbegin()->first, time));
+
   // If we have entered the zone of numerical instability, go back to the
   // point where the error was decreasing and nudge the tolerance since we
   // won't be able to reliably do better than that.
@@ -363,16 +429,32 @@ void ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
 template<typename Frame>
 typename std::vector<ЧебышёвSeries<Displacement<Frame>>>::const_iterator
 ContinuousTrajectory<Frame>::FindSeriesForInstant(Instant const& time) const {
-  // Need to use |lower_bound|, not |upper_bound|, because it allows
-  // heterogeneous arguments.  This returns the first series |s| such that
-  // |time <= s.t_max()|.
-  auto const it = std::lower_bound(
-                      series_.begin(), series_.end(), time,
-                      [](ЧебышёвSeries<Displacement<Frame>> const& left,
-                         Instant const& right) {
-                        return left.t_max() < right;
-                      });
-  return it;
+  // This returns the first series |s| such that |time <= s.t_max()|, like
+  // |std::lower_bound| would.
+  if (series_.empty() || time > series_.back().t_max()) {
+    return series_.end();
+  }
+  if (time <= series_.front().t_max()) {
+    return series_.begin();
+  }
+
+  // The series are consecutive and each of them spans |kDivisions| steps, so
+  // we can estimate the index from the time.  Because the times passed to
+  // |Append| are only equally spaced up to rounding, the estimate may be off
+  // by one near the boundaries of the series; the loops below fix it.
+  int const last_index = static_cast<int>(series_.size()) - 1;
+  double const estimated_index =
+      std::floor((time - series_.front().t_min()) / (kDivisions * step_));
+  int index = static_cast<int>(
+      std::min(std::max(estimated_index, 0.0),
+               static_cast<double>(last_index)));
+  while (index > 0 && time <= series_[index - 1].t_max()) {
+    --index;
+  }
+  while (index < last_index && time > series_[index].t_max()) {
+    ++index;
+  }
+  return series_.begin() + index;
 }
 
 template<typename Frame>
@@ -1,6 +1,8 @@
 ﻿
 #include "physics/continuous_trajectory.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <deque>
 #include <functional>
 #include <limits>
@@ -52,9 +54,15 @@ class ContinuousTrajectoryTest : public testing::Test {
       std::vector<Velocity<World>> const& v,
       Instant const& t_min,
       Instant const& t_max) {
+    return ЧебышёвSeries<Displacement<World>>({Displacement<World>()},
+                                              t_min,
+                                              t_max);
+  }
+
+  static Length SimulatedNewhallErrorEstimate(int const degree) {
     Displacement<World> const error_estimate = error_estimates_->front();
     error_estimates_->pop_front();
-    return ЧебышёвSeries<Displacement<World>>({error_estimate}, t_min, t_max);
+    return error_estimate.Norm();
   }
 
   void FillTrajectory(
@@ -81,7 +89,9 @@ class ContinuousTrajectoryTest : public testing::Test {
     std::vector<Displacement<World>> const q;
     std::vector<Velocity<World>> const v;
     trajectory_->ComputeBestNewhallApproximation(
-        t, q, v, &SimulatedNewhallApproximation);
+        t, q, v,
+        &SimulatedNewhallErrorEstimate,
+        &SimulatedNewhallApproximation);
   }
 
   int degree() const {
@@ -100,6 +110,15 @@ class ContinuousTrajectoryTest : public testing::Test {
     trajectory_->degree_age_ = std::numeric_limits<int>::max();
   }
 
+  std::vector<ЧебышёвSeries<Displacement<World>>> const& series() const {
+    return trajectory_->series_;
+  }
+
+  int FindSeriesIndexForInstant(Instant const& time) const {
+    return trajectory_->FindSeriesForInstant(time) -
+           trajectory_->series_.cbegin();
+  }
+
   static std::deque<Displacement<World>>* error_estimates_;
   std::unique_ptr<ContinuousTrajectory<World>> trajectory_;
 };
@@ -376,6 +395,66 @@ TEST_F(ContinuousTrajectoryTest, Io) {
   trajectory_->ForgetBefore(trajectory_->t_max() + kStep);
 }
 
+// Check that the series found for an instant is the first one whose |t_max| is
+// not before that instant, even though the times are affected by rounding.
+TEST_F(ContinuousTrajectoryTest, FindSeriesForInstant) {
+  int const kNumberOfSteps = 1000;
+  Time const kStep = 0.1 * Second;
+  Instant const t0;
+
+  auto position_function =
+      [t0](Instant const t) {
+        return World::origin +
+            Displacement<World>({(t - t0) * 3 * Metre / Second,
+                                 (t - t0) * 5 * Metre / Second,
+                                 (t - t0) * (-2) * Metre / Second});
+      };
+  auto velocity_function =
+      [t0](Instant const t) {
+        return Velocity<World>({3 * Metre / Second,
+                                5 * Metre / Second,
+                                -2 * Metre / Second});
+      };
+
+  trajectory_ = std::make_unique<ContinuousTrajectory<World>>(
+                    kStep,
+                    0.1 * Metre /*tolerance*/);
+  FillTrajectory(kNumberOfSteps, kStep, position_function, velocity_function);
+  trajectory_->ForgetBefore(t0 + 10.05 * Second);
+
+  auto const next_after = [t0](Instant const& t, double const direction) {
+    return t0 + std::nextafter((t - t0) / Second, direction) * Second;
+  };
+  std::vector<Instant> times;
+  for (auto const& s : series()) {
+    times.push_back(s.t_min());
+    times.push_back(next_after(s.t_min(), 0));
+    times.push_back(next_after(s.t_min(), kNumberOfSteps));
+    times.push_back(s.t_min() + (s.t_max() - s.t_min()) / 2);
+    times.push_back(s.t_max());
+    times.push_back(next_after(s.t_max(), 0));
+    times.push_back(next_after(s.t_max(), kNumberOfSteps));
+  }
+  for (Instant const& time : times) {
+    int const expected_index =
+        std::lower_bound(series().begin(), series().end(), time,
+                         [](ЧебышёвSeries<Displacement<World>> const& left,
+                            Instant const& right) {
+                           return left.t_max() < right;
+                         }) - series().begin();
+    EXPECT_EQ(expected_index, FindSeriesIndexForInstant(time)) << time;
+  }
+
+  // The evaluation doesn't depend on the use of a hint.
+  ContinuousTrajectory<World>::Hint hint;
+  for (Instant time = trajectory_->t_min();
+       time <= trajectory_->t_max();
+       time += kStep / 7) {
+    EXPECT_EQ(trajectory_->EvaluateDegreesOfFreedom(time, &hint),
+              trajectory_->EvaluateDegreesOfFreedom(time, /*hint=*/nullptr));
+  }
+}
+
 TEST_F(ContinuousTrajectoryTest, Serialization) {
   int const kNumberOfSteps = 20;
   int const kNumberOfSubsteps = 50;
@@ -1,9 +1,9 @@
 ﻿
 #pragma once
 
+#include <deque>
 #include <functional>
 #include <list>
-#include <map>
 #include <memory>
 #include <vector>
 
@@ -11,6 +11,7 @@
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
 #include "physics/degrees_of_freedom.hpp"
+#include "physics/discrete_trajectory_timeline.hpp"
 #include "physics/forkable.hpp"
 #include "quantities/named_quantities.hpp"
 #include "serialization/physics.pb.h"
@@ -35,7 +36,7 @@ namespace internal {
 template<typename Frame>
 struct ForkableTraits<DiscreteTrajectory<Frame>> {
   using TimelineConstIterator =
-      typename std::map<Instant, DegreesOfFreedom<Frame>>::const_iterator;
+      typename DiscreteTrajectoryTimeline<Frame>::const_iterator;
   static Instant const& time(TimelineConstIterator const it);
 };
 
@@ -58,7 +59,7 @@ template<typename Frame>
 class DiscreteTrajectory
     : public Forkable<DiscreteTrajectory<Frame>,
                       internal::DiscreteTrajectoryIterator<Frame>> {
-  using Timeline = std::map<Instant, DegreesOfFreedom<Frame>>;
+  using Timeline = internal::DiscreteTrajectoryTimeline<Frame>;
   using TimelineConstIterator =
       typename Forkable<
           DiscreteTrajectory<Frame>,
@@ -114,6 +115,15 @@ class DiscreteTrajectory
   void Append(Instant const& time,
               DegreesOfFreedom<Frame> const& degrees_of_freedom);
 
+  // Appends the points of |other| that are (strictly) after |time|.  |time|
+  // must be at or after the last time of this trajectory and at or after the
+  // fork time of |other|, if any.  The points are shared with |other| until one
+  // of the trajectories modifies them, so the cost is proportional to the
+  // number of points of the timeline of this trajectory and to the number of
+  // chunks appended, not to the number of points appended.  This trajectory
+  // must not have forks or levels of detail.
+  void AppendSharedTail(DiscreteTrajectory const& other, Instant const& time);
+
   // Removes all data for times (strictly) greater than |time|, as well as all
   // child trajectories forked at times (strictly) greater than |time|.  |time|
   // must be at or after the fork time, if any.
@@ -124,6 +134,52 @@ class DiscreteTrajectory
   // |time|.  This trajectory must be a root.
   void ForgetBefore(Instant const& time);
 
+  // Starts maintaining levels of detail for this trajectory, which must be a
+  // root.  Level 0 has all the points of the trajectory, and each level has
+  // every other point of the level below it, so that level k has a stride of
+  // 2^k.  Each point of a level carries a bound of the distance between the
+  // trajectory and the chord from the previous point of that level.  The levels
+  // are updated incrementally by |Append|, |ForgetAfter| and |ForgetBefore|, at
+  // an amortized cost of O(1) per point.  They are not serialized.
+  void EnableLevelsOfDetail();
+  bool levels_of_detail_enabled() const;
+
+  // Calls |action| on points of this trajectory in [begin_time, end_time]
+  // chosen so that the trajectory, interpolated using the velocities, stays
+  // within |tolerance| of the polygon going through them.  The first and last
+  // points of the trajectory in [begin_time, end_time] are always included.
+  // The points are taken from the coarsest levels of detail that meet the
+  // |tolerance|, so the cost is proportional to the number of points returned
+  // (times the number of levels), not to the length of the trajectory.  The
+  // levels of detail must be enabled.
+  void ForEachPointWithinTolerance(
+      Instant const& begin_time,
+      Instant const& end_time,
+      Length const& tolerance,
+      std::function<void(Instant const& time,
+                         DegreesOfFreedom<Frame> const& degrees_of_freedom)>
+          const& action) const;
+
+  // Same as above, except that a chord of a level of detail is used if
+  // |accept_chord| returns true for it, instead of if its error is within a
+  // tolerance.  |accept_chord| is given the ends of the chord and the bound of
+  // the distance between the trajectory and the chord.  When a chord is not
+  // accepted, the chords of the next finer level that it covers are considered
+  // instead.  The chords of level 0 are always used.
+  using ChordPredicate = std::function<bool(
+      Instant const& begin_time,
+      DegreesOfFreedom<Frame> const& begin_degrees_of_freedom,
+      Instant const& end_time,
+      DegreesOfFreedom<Frame> const& end_degrees_of_freedom,
+      Length const& error)>;
+  void ForEachPointOfAcceptedChords(
+      Instant const& begin_time,
+      Instant const& end_time,
+      ChordPredicate const& accept_chord,
+      std::function<void(Instant const& time,
+                         DegreesOfFreedom<Frame> const& degrees_of_freedom)>
+          const& action) const;
+
   // This trajectory must be a root.  Only the given |forks| are serialized.
   // They must be descended from this trajectory.  The pointers in |forks| may
   // be null at entry.
@@ -140,6 +196,23 @@ class DiscreteTrajectory
       serialization::DiscreteTrajectory const& message,
       std::vector<DiscreteTrajectory<Frame>**> const& forks);
 
+  // Same as |WriteToMessage|, except that the only points of the timeline of
+  // this trajectory that are written are the first one and the ones after
+  // |base_time|.  The others are expected to be found in a serialization of
+  // this trajectory made at |base_time|.  The |forks| are written in full.
+  void WriteDeltaToMessage(
+      not_null<serialization::DiscreteTrajectory*> const message,
+      std::vector<DiscreteTrajectory<Frame>*> const& forks,
+      Instant const& base_time) const;
+
+  // Folds the |delta| written by |WriteDeltaToMessage| into the |message|
+  // written by |WriteToMessage| at |base_time|.  At exit |message| is identical
+  // to the result of |WriteToMessage| at the time of the |delta|.
+  static void MergeDeltaIntoMessage(
+      serialization::DiscreteTrajectory const& delta,
+      Instant const& base_time,
+      not_null<serialization::DiscreteTrajectory*> const message);
+
  protected:
   // The API inherited from Forkable.
   not_null<DiscreteTrajectory*> that() override;
@@ -162,8 +235,66 @@ class DiscreteTrajectory
       serialization::DiscreteTrajectory const& message,
       std::vector<DiscreteTrajectory<Frame>**> const& forks);
 
+  // Writes the points of the timeline in [begin, end[.
+  void WriteTimelineToMessage(
+      TimelineConstIterator const begin,
+      TimelineConstIterator const end,
+      not_null<serialization::DiscreteTrajectory*> const message) const;
+
+  struct LevelOfDetailPoint {
+    TimelineConstIterator it;
+    // A bound of the distance between the trajectory and the chord from the
+    // previous point of the same level to this one.  Zero for the first point.
+    Length error;
+  };
+  using LevelOfDetail = std::deque<LevelOfDetailPoint>;
+
+  // Adds |it|, which must be the last point of |timeline_|, to the levels of
+  // detail, promoting it to the coarser levels as needed.
+  void AppendToLevelsOfDetail(TimelineConstIterator const it);
+
+  // Removes from the levels of detail the points of |timeline_| that are
+  // (strictly) after or before |time|, respectively.  Must be called before
+  // these points are erased from |timeline_|.
+  void ForgetAfterInLevelsOfDetail(Instant const& time);
+  void ForgetBeforeInLevelsOfDetail(Instant const& time);
+
+  // Restores the invariants of the levels of detail after points have been
+  // erased from |timeline_|: all levels start with the first point of the
+  // timeline, and the errors of their first chords are up to date.
+  void RestoreLevelsOfDetail();
+
+  // Returns a bound of the distance between the trajectory and the chord from
+  // |finer[first]| to |finer[last]|.
+  static Length ChordError(LevelOfDetail const& finer,
+                           int const first,
+                           int const last);
+
+  // Returns the index of the first point of |level| (strictly) after |time|.
+  static int UpperBound(LevelOfDetail const& level, Instant const& time);
+
+  // Calls |action| on the end of the chord of level |k| that ends at |index| if
+  // that chord is accepted by |accept_chord|, and recurses on the chords of
+  // level k - 1 that it covers otherwise.  Only the points in
+  // ]first_time, end_time] are considered.
+  void ForEachPointOfAcceptedChord(
+      int const k,
+      int const index,
+      Instant const& first_time,
+      Instant const& end_time,
+      ChordPredicate const& accept_chord,
+      std::function<void(Instant const& time,
+                         DegreesOfFreedom<Frame> const& degrees_of_freedom)>
+          const& action) const;
+
   Timeline timeline_;
 
+  // Empty if the levels of detail are not enabled.  Otherwise, the first level
+  // has all the points of |timeline_|, and each level is a subsequence of the
+  // previous one, with at most one point after the last point of the next
+  // level.
+  std::vector<LevelOfDetail> levels_of_detail_;
+
   OnDestroyCallback on_destroy_;
 
   template<typename, typename>
@@ -176,6 +307,22 @@ class DiscreteTrajectory
   friend struct std::pair;
 };
 
+// An upper bound of the distance between the chord from |degrees_of_freedom1|
+// to |degrees_of_freedom2| and the cubic Hermite interpolant between them,
+// which approximates the trajectory over [t1, t2].  Used for simplifying
+// trajectories, both in the levels of detail and for rendering.
+template<typename Frame>
+Length HermiteChordError(Instant const& t1,
+                         DegreesOfFreedom<Frame> const& degrees_of_freedom1,
+                         Instant const& t2,
+                         DegreesOfFreedom<Frame> const& degrees_of_freedom2);
+
+// The distance between |point| and the segment [q1, q2].
+template<typename Frame>
+Length DistanceToSegment(Position<Frame> const& point,
+                         Position<Frame> const& q1,
+                         Position<Frame> const& q2);
+
 }  // namespace physics
 }  // namespace principia
 
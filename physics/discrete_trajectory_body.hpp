@@ -4,8 +4,9 @@
 #include "physics/discrete_trajectory.hpp"
 
 #include <algorithm>
+#include <deque>
+#include <iterator>
 #include <list>
-#include <map>
 #include <vector>
 
 #include "geometry/named_quantities.hpp"
@@ -14,7 +15,9 @@
 namespace principia {
 
 using base::make_not_null_unique;
+using geometry::InnerProduct;
 using geometry::Instant;
+using quantities::Time;
 
 namespace physics {
 namespace internal {
@@ -86,9 +89,12 @@ DiscreteTrajectory<Frame>::NewForkWithCopy(Instant const& time) {
 
   auto const fork = this->NewFork(timeline_it);
 
-  // Copy the tail of the trajectory in the child object.
-  if (timeline_it != timeline_.end()) {
-    fork->timeline_.insert(++timeline_it, timeline_.end());
+  // Share the tail of the trajectory with the child object.  The points are
+  // only copied when one of the timelines modifies them.
+  if (timeline_it == timeline_.end()) {
+    fork->timeline_.SharePool(timeline_);
+  } else {
+    fork->timeline_.AssignTail(timeline_, std::next(timeline_it));
   }
   return fork;
 }
@@ -102,18 +108,19 @@ DiscreteTrajectory<Frame>::NewForkWithoutCopy(Instant const& time) {
         (!this->is_root() && time == this->Fork().time()))
       << "NewForkWithoutCopy at nonexistent time " << time;
 
-  return this->NewFork(timeline_it);
+  auto const fork = this->NewFork(timeline_it);
+  fork->timeline_.SharePool(timeline_);
+  return fork;
 }
 
 template<typename Frame>
 not_null<DiscreteTrajectory<Frame>*>
 DiscreteTrajectory<Frame>::NewForkAtLast() {
   auto end = timeline_.end();
-  if (timeline_.empty()) {
-    return this->NewFork(end);
-  } else {
-    return this->NewFork(--end);
-  }
+  auto const fork = timeline_.empty() ? this->NewFork(end)
+                                      : this->NewFork(--end);
+  fork->timeline_.SharePool(timeline_);
+  return fork;
 }
 
 template<typename Frame>
@@ -124,9 +131,7 @@ DiscreteTrajectory<Frame>::DetachFork() {
   // Insert a new point in the timeline for the fork time.  It should go at the
   // beginning of the timeline.
   auto const fork_it = this->Fork();
-  auto const begin_it = timeline_.emplace_hint(
-      timeline_.begin(), fork_it.time(), fork_it.degrees_of_freedom());
-  CHECK(begin_it == timeline_.begin());
+  timeline_.push_front(fork_it.time(), fork_it.degrees_of_freedom());
 
   // Detach this trajectory and tell the caller that it owns the pieces.
   return this->DetachForkWithCopiedBegin();
@@ -140,17 +145,51 @@ void DiscreteTrajectory<Frame>::Append(
        << "Append at " << time << " which is before fork time "
        << this->Fork().time();
 
-  if (!timeline_.empty() && timeline_.cbegin()->first == time) {
+  if (!timeline_.empty() && timeline_.front().first == time) {
     LOG(WARNING) << "Append at existing time " << time
                  << ", time range = [" << this->Begin().time() << ", "
                  << last().time() << "]";
     return;
   }
-  auto it = timeline_.emplace_hint(timeline_.end(),
-                                   time,
-                                   degrees_of_freedom);
-  // Decrementing |end()| is much faster than incrementing |it|.  Don't ask.
-  CHECK(--timeline_.end() == it) << "Append out of order at " << time;
+  if (!timeline_.empty() && timeline_.back().first == time) {
+    // Appending at the last time is a no-op.
+    return;
+  }
+  CHECK(timeline_.empty() || timeline_.back().first < time)
+      << "Append out of order at " << time;
+  timeline_.push_back(time, degrees_of_freedom);
+  if (!levels_of_detail_.empty()) {
+    AppendToLevelsOfDetail(--timeline_.end());
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::AppendSharedTail(
+    DiscreteTrajectory const& other,
+    Instant const& time) {
+  CHECK(other.is_root() || time >= other.Fork().time())
+      << "AppendSharedTail at " << time << " which is before fork time "
+      << other.Fork().time();
+  CHECK(this->is_root() || time >= this->Fork().time())
+      << "AppendSharedTail at " << time << " which is before fork time "
+      << this->Fork().time();
+  CHECK(timeline_.empty() || timeline_.back().first <= time)
+      << "AppendSharedTail out of order at " << time;
+  CHECK(levels_of_detail_.empty());
+
+  auto const first = other.timeline_.upper_bound(time);
+  if (first == other.timeline_.end()) {
+    return;
+  }
+  // The timeline must be empty to share the chunks of |other|, so its points
+  // are put back in front of the shared ones.
+  std::vector<typename Timeline::value_type> const points(timeline_.begin(),
+                                                          timeline_.end());
+  timeline_.erase(timeline_.begin(), timeline_.end());
+  timeline_.AssignTail(other.timeline_, first);
+  for (auto it = points.rbegin(); it != points.rend(); ++it) {
+    timeline_.push_front(it->first, it->second);
+  }
 }
 
 template<typename Frame>
@@ -161,7 +200,13 @@ void DiscreteTrajectory<Frame>::ForgetAfter(Instant const& time) {
   // entry and all the entries that follow it.  This preserves any entry with
   // time == |time|.
   auto const it = timeline_.upper_bound(time);
+  if (!levels_of_detail_.empty()) {
+    ForgetAfterInLevelsOfDetail(time);
+  }
   timeline_.erase(it, timeline_.end());
+  if (!levels_of_detail_.empty()) {
+    RestoreLevelsOfDetail();
+  }
 }
 
 template<typename Frame>
@@ -171,7 +216,86 @@ void DiscreteTrajectory<Frame>::ForgetBefore(Instant const& time) {
   // Get an iterator denoting the first entry with time >= |time|.  Remove all
   // the entries that precede it.  This preserves any entry with time == |time|.
   auto it = timeline_.lower_bound(time);
+  if (!levels_of_detail_.empty()) {
+    ForgetBeforeInLevelsOfDetail(time);
+  }
   timeline_.erase(timeline_.begin(), it);
+  if (!levels_of_detail_.empty()) {
+    RestoreLevelsOfDetail();
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::EnableLevelsOfDetail() {
+  CHECK(this->is_root());
+  if (!levels_of_detail_.empty()) {
+    return;
+  }
+  levels_of_detail_.emplace_back();
+  for (auto it = timeline_.begin(); it != timeline_.end(); ++it) {
+    AppendToLevelsOfDetail(it);
+  }
+}
+
+template<typename Frame>
+bool DiscreteTrajectory<Frame>::levels_of_detail_enabled() const {
+  return !levels_of_detail_.empty();
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::ForEachPointWithinTolerance(
+    Instant const& begin_time,
+    Instant const& end_time,
+    Length const& tolerance,
+    std::function<void(Instant const& time,
+                       DegreesOfFreedom<Frame> const& degrees_of_freedom)>
+        const& action) const {
+  ForEachPointOfAcceptedChords(
+      begin_time,
+      end_time,
+      [&tolerance](Instant const& begin_time,
+                   DegreesOfFreedom<Frame> const& begin_degrees_of_freedom,
+                   Instant const& end_time,
+                   DegreesOfFreedom<Frame> const& end_degrees_of_freedom,
+                   Length const& error) {
+        return error <= tolerance;
+      },
+      action);
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::ForEachPointOfAcceptedChords(
+    Instant const& begin_time,
+    Instant const& end_time,
+    ChordPredicate const& accept_chord,
+    std::function<void(Instant const& time,
+                       DegreesOfFreedom<Frame> const& degrees_of_freedom)>
+        const& action) const {
+  CHECK(!levels_of_detail_.empty()) << "Levels of detail are not enabled";
+  auto const first = timeline_.lower_bound(begin_time);
+  if (first == timeline_.end() || first->first > end_time) {
+    return;
+  }
+  Instant const& first_time = first->first;
+  action(first_time, first->second);
+
+  // The chords of the coarsest level cover the trajectory up to its last
+  // point.  Beyond that point, the chords of each finer level cover the
+  // trajectory up to the last point of that level.
+  int const coarsest = levels_of_detail_.size() - 1;
+  for (int k = coarsest; k >= 0; --k) {
+    LevelOfDetail const& level = levels_of_detail_[k];
+    Instant const& covered_time =
+        k == coarsest ? first_time
+                      : std::max(first_time,
+                                 levels_of_detail_[k + 1].back().it->first);
+    for (int index = std::max(UpperBound(level, covered_time), 1);
+         index < level.size() && level[index - 1].it->first < end_time;
+         ++index) {
+      ForEachPointOfAcceptedChord(
+          k, index, first_time, end_time, accept_chord, action);
+    }
+  }
 }
 
 template<typename Frame>
@@ -210,6 +334,65 @@ DiscreteTrajectory<Frame>::ReadFromMessage(
   return trajectory;
 }
 
+template<typename Frame>
+void DiscreteTrajectory<Frame>::WriteDeltaToMessage(
+    not_null<serialization::DiscreteTrajectory*> const message,
+    std::vector<DiscreteTrajectory<Frame>*> const& forks,
+    Instant const& base_time) const {
+  LOG(INFO) << __FUNCTION__;
+  CHECK(this->is_root());
+
+  std::vector<DiscreteTrajectory<Frame>*> mutable_forks = forks;
+  Forkable<DiscreteTrajectory, Iterator>::WriteSubTreeToMessage(message,
+                                                                mutable_forks);
+  CHECK(std::all_of(mutable_forks.begin(),
+                    mutable_forks.end(),
+                    [](DiscreteTrajectory<Frame>* const fork) {
+                      return fork == nullptr;
+                    }));
+
+  // The first point is always written so that |MergeDeltaIntoMessage| may
+  // drop the points that were forgotten since |base_time|.
+  auto const first_after_base_time = timeline_.upper_bound(base_time);
+  if (first_after_base_time != timeline_.begin()) {
+    WriteTimelineToMessage(timeline_.begin(),
+                           std::next(timeline_.begin()),
+                           message);
+  }
+  WriteTimelineToMessage(first_after_base_time, timeline_.end(), message);
+
+  LOG(INFO) << NAMED(this);
+  LOG(INFO) << NAMED(message->ByteSize());
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::MergeDeltaIntoMessage(
+    serialization::DiscreteTrajectory const& delta,
+    Instant const& base_time,
+    not_null<serialization::DiscreteTrajectory*> const message) {
+  serialization::DiscreteTrajectory merged = delta;
+  google::protobuf::RepeatedPtrField<
+      serialization::DiscreteTrajectory::InstantaneousDegreesOfFreedom>
+      timeline;
+  if (delta.timeline_size() > 0) {
+    Instant const first_time =
+        Instant::ReadFromMessage(delta.timeline(0).instant());
+    for (auto& point : *message->mutable_timeline()) {
+      Instant const time = Instant::ReadFromMessage(point.instant());
+      if (first_time <= time && time <= base_time) {
+        timeline.Add()->Swap(&point);
+      }
+    }
+    for (auto& point : *merged.mutable_timeline()) {
+      if (Instant::ReadFromMessage(point.instant()) > base_time) {
+        timeline.Add()->Swap(&point);
+      }
+    }
+  }
+  merged.mutable_timeline()->Swap(&timeline);
+  message->Swap(&merged);
+}
+
 template<typename Frame>
 not_null<DiscreteTrajectory<Frame>*> DiscreteTrajectory<Frame>::that() {
   return this;
@@ -255,14 +438,7 @@ void DiscreteTrajectory<Frame>::WriteSubTreeToMessage(
     not_null<serialization::DiscreteTrajectory*> const message,
     std::vector<DiscreteTrajectory<Frame>*>& forks) const {
   Forkable<DiscreteTrajectory, Iterator>::WriteSubTreeToMessage(message, forks);
-  for (auto const& pair : timeline_) {
-    Instant const& instant = pair.first;
-    DegreesOfFreedom<Frame> const& degrees_of_freedom = pair.second;
-    auto const instantaneous_degrees_of_freedom = message->add_timeline();
-    instant.WriteToMessage(instantaneous_degrees_of_freedom->mutable_instant());
-    degrees_of_freedom.WriteToMessage(
-        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
-  }
+  WriteTimelineToMessage(timeline_.begin(), timeline_.end(), message);
 }
 
 template<typename Frame>
@@ -280,5 +456,210 @@ void DiscreteTrajectory<Frame>::FillSubTreeFromMessage(
                                                                  forks);
 }
 
+template<typename Frame>
+void DiscreteTrajectory<Frame>::AppendToLevelsOfDetail(
+    TimelineConstIterator const it) {
+  LevelOfDetail& finest = levels_of_detail_.front();
+  // A point that is already in the levels of detail must not be added again,
+  // otherwise it would yield a chord of zero duration.
+  if (!finest.empty() && finest.back().it->first == it->first) {
+    return;
+  }
+  DCHECK(finest.empty() || finest.back().it->first < it->first)
+      << "Out of order point at " << it->first << " in the levels of detail";
+  finest.push_back(
+      {it,
+       finest.empty()
+           ? Length()
+           : HermiteChordError(finest.back().it->first,
+                               finest.back().it->second,
+                               it->first,
+                               it->second)});
+  for (int k = 1;; ++k) {
+    if (k == levels_of_detail_.size()) {
+      // Create a coarser level once the finer one has two chords.
+      if (levels_of_detail_[k - 1].size() < 3) {
+        break;
+      }
+      levels_of_detail_.emplace_back();
+      levels_of_detail_[k].push_back({levels_of_detail_[k - 1].front().it,
+                                      Length()});
+    }
+    LevelOfDetail const& finer = levels_of_detail_[k - 1];
+    LevelOfDetail& coarser = levels_of_detail_[k];
+    int const finer_size = finer.size();
+    // Before |it| was appended, |finer| had at most one point after the last
+    // point of |coarser|.  If it had one, |it| is promoted.
+    if (finer[finer_size - 2].it == coarser.back().it) {
+      break;
+    }
+    DCHECK(finer[finer_size - 3].it == coarser.back().it);
+    coarser.push_back(
+        {it, ChordError(finer, finer_size - 3, finer_size - 1)});
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::ForgetAfterInLevelsOfDetail(
+    Instant const& time) {
+  for (auto& level : levels_of_detail_) {
+    while (!level.empty() && level.back().it->first > time) {
+      level.pop_back();
+    }
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::ForgetBeforeInLevelsOfDetail(
+    Instant const& time) {
+  for (auto& level : levels_of_detail_) {
+    while (!level.empty() && level.front().it->first < time) {
+      level.pop_front();
+    }
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::RestoreLevelsOfDetail() {
+  if (timeline_.empty()) {
+    levels_of_detail_.resize(1);
+    return;
+  }
+  auto const first = timeline_.begin();
+  for (int k = 0; k < levels_of_detail_.size(); ++k) {
+    LevelOfDetail& level = levels_of_detail_[k];
+    if (level.empty() || level.front().it != first) {
+      level.push_front({first, Length()});
+    } else {
+      level.front().error = Length();
+    }
+    // The first chord may now start at a different point.  Note that the
+    // errors of level 0 only depend on consecutive points of the timeline.
+    if (k > 0 && level.size() > 1) {
+      LevelOfDetail const& finer = levels_of_detail_[k - 1];
+      level[1].error =
+          ChordError(finer, 0, UpperBound(finer, level[1].it->first) - 1);
+    }
+  }
+}
+
+template<typename Frame>
+Length DiscreteTrajectory<Frame>::ChordError(LevelOfDetail const& finer,
+                                             int const first,
+                                             int const last) {
+  // The trajectory is within the error of each finer chord from that chord,
+  // and the finer chords are within the largest distance of their ends from
+  // the coarse chord.
+  Position<Frame> const& q_first = finer[first].it->second.position();
+  Position<Frame> const& q_last = finer[last].it->second.position();
+  Length max_distance;
+  Length max_error;
+  for (int i = first + 1; i <= last; ++i) {
+    max_error = std::max(max_error, finer[i].error);
+    if (i < last) {
+      max_distance = std::max(
+          max_distance,
+          DistanceToSegment(finer[i].it->second.position(), q_first, q_last));
+    }
+  }
+  return max_distance + max_error;
+}
+
+template<typename Frame>
+int DiscreteTrajectory<Frame>::UpperBound(LevelOfDetail const& level,
+                                          Instant const& time) {
+  return std::upper_bound(level.begin(),
+                          level.end(),
+                          time,
+                          [](Instant const& time,
+                             LevelOfDetailPoint const& point) {
+                            return time < point.it->first;
+                          }) -
+         level.begin();
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::ForEachPointOfAcceptedChord(
+    int const k,
+    int const index,
+    Instant const& first_time,
+    Instant const& end_time,
+    ChordPredicate const& accept_chord,
+    std::function<void(Instant const& time,
+                       DegreesOfFreedom<Frame> const& degrees_of_freedom)>
+        const& action) const {
+  LevelOfDetail const& level = levels_of_detail_[k];
+  Instant const& chord_begin = level[index - 1].it->first;
+  LevelOfDetailPoint const& chord_end = level[index];
+  if (chord_end.it->first <= first_time || chord_begin >= end_time) {
+    return;
+  }
+  if (chord_begin >= first_time && chord_end.it->first <= end_time &&
+      (k == 0 || accept_chord(chord_begin,
+                              level[index - 1].it->second,
+                              chord_end.it->first,
+                              chord_end.it->second,
+                              chord_end.error))) {
+    action(chord_end.it->first, chord_end.it->second);
+    return;
+  }
+  if (k == 0) {
+    return;
+  }
+  LevelOfDetail const& finer = levels_of_detail_[k - 1];
+  for (int i = UpperBound(finer, chord_begin);
+       i < finer.size() && finer[i - 1].it->first < chord_end.it->first;
+       ++i) {
+    ForEachPointOfAcceptedChord(
+        k - 1, i, first_time, end_time, accept_chord, action);
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::WriteTimelineToMessage(
+    TimelineConstIterator const begin,
+    TimelineConstIterator const end,
+    not_null<serialization::DiscreteTrajectory*> const message) const {
+  for (auto it = begin; it != end; ++it) {
+    Instant const& instant = it->first;
+    DegreesOfFreedom<Frame> const& degrees_of_freedom = it->second;
+    auto const instantaneous_degrees_of_freedom = message->add_timeline();
+    instant.WriteToMessage(instantaneous_degrees_of_freedom->mutable_instant());
+    degrees_of_freedom.WriteToMessage(
+        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
+  }
+}
+
+template<typename Frame>
+Length HermiteChordError(Instant const& t1,
+                         DegreesOfFreedom<Frame> const& degrees_of_freedom1,
+                         Instant const& t2,
+                         DegreesOfFreedom<Frame> const& degrees_of_freedom2) {
+  Time const Δt = t2 - t1;
+  Displacement<Frame> const Δq =
+      degrees_of_freedom2.position() - degrees_of_freedom1.position();
+  // With s = (t - t1) / Δt, the interpolant deviates from the chord by
+  //   s (1 - s) [(1 - s) (v1 Δt - Δq) - s (v2 Δt - Δq)],
+  // whose norm is at most 4/27 (|v1 Δt - Δq| + |v2 Δt - Δq|).
+  return 4.0 / 27.0 * ((degrees_of_freedom1.velocity() * Δt - Δq).Norm() +
+                       (degrees_of_freedom2.velocity() * Δt - Δq).Norm());
+}
+
+template<typename Frame>
+Length DistanceToSegment(Position<Frame> const& point,
+                         Position<Frame> const& q1,
+                         Position<Frame> const& q2) {
+  Displacement<Frame> const chord = q2 - q1;
+  Displacement<Frame> const q1_to_point = point - q1;
+  if (chord == Displacement<Frame>()) {
+    return q1_to_point.Norm();
+  }
+  double const s = std::min(std::max(InnerProduct(q1_to_point, chord) /
+                                         InnerProduct(chord, chord),
+                                     0.0),
+                            1.0);
+  return (q1_to_point - s * chord).Norm();
+}
+
 }  // namespace physics
 }  // namespace principia
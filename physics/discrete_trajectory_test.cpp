@@ -14,20 +14,27 @@
 #include "geometry/r3_element.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "quantities/elementary_functions.hpp"
 #include "quantities/quantities.hpp"
 #include "quantities/si.hpp"
 
 namespace principia {
 
 using geometry::Frame;
+using geometry::InnerProduct;
 using geometry::Instant;
 using geometry::Point;
 using geometry::R3Element;
 using geometry::Vector;
+using quantities::Cos;
 using quantities::Length;
+using quantities::Sin;
 using quantities::Speed;
 using quantities::SIUnit;
+using quantities::Time;
 using quantities::si::Metre;
+using quantities::si::Milli;
+using quantities::si::Radian;
 using quantities::si::Second;
 using ::std::placeholders::_1;
 using ::std::placeholders::_2;
@@ -112,6 +119,82 @@ class DiscreteTrajectoryTest : public testing::Test {
     return result;
   }
 
+  // Appends to |trajectory| the points of a circular orbit of radius 1 m and
+  // period 2π s, every |step| over [begin_time, end_time[.
+  void AppendCircle(Instant const& begin_time,
+                    Instant const& end_time,
+                    Time const& step,
+                    not_null<DiscreteTrajectory<World>*> const trajectory) {
+    for (Instant t = begin_time; t < end_time; t += step) {
+      auto const θ = (t - t0_) * Radian / Second;
+      trajectory->Append(
+          t,
+          DegreesOfFreedom<World>(
+              World::origin +
+                  Displacement<World>({Cos(θ) * Metre,
+                                       Sin(θ) * Metre,
+                                       0 * Metre}),
+              Velocity<World>({-Sin(θ) * Metre / Second,
+                               Cos(θ) * Metre / Second,
+                               0 * Metre / Second})));
+    }
+  }
+
+  // Returns the times of the points returned by |ForEachPointWithinTolerance|,
+  // after checking that they include the first and last points of |trajectory|
+  // in [begin_time, end_time], and that all the points of |trajectory| in that
+  // interval are within |tolerance| of the polygon.
+  std::vector<Instant> PointsWithinTolerance(
+      DiscreteTrajectory<World> const& trajectory,
+      Instant const& begin_time,
+      Instant const& end_time,
+      Length const& tolerance) const {
+    std::vector<Instant> times;
+    std::vector<Position<World>> positions;
+    trajectory.ForEachPointWithinTolerance(
+        begin_time,
+        end_time,
+        tolerance,
+        [&times, &positions](Instant const& time,
+                             DegreesOfFreedom<World> const& degrees_of_freedom) {
+          times.push_back(time);
+          positions.push_back(degrees_of_freedom.position());
+        });
+
+    int chord = 0;
+    bool first = true;
+    for (auto it = trajectory.Begin(); it != trajectory.End(); ++it) {
+      if (it.time() < begin_time || it.time() > end_time) {
+        continue;
+      }
+      EXPECT_LT(chord + 1, times.size());
+      if (chord + 1 >= times.size()) {
+        break;
+      }
+      if (first) {
+        EXPECT_EQ(times.front(), it.time());
+        first = false;
+      }
+      Displacement<World> const chord_displacement =
+          positions[chord + 1] - positions[chord];
+      Displacement<World> const to_point =
+          it.degrees_of_freedom().position() - positions[chord];
+      double const s = std::min(std::max(InnerProduct(to_point,
+                                                      chord_displacement) /
+                                             InnerProduct(chord_displacement,
+                                                          chord_displacement),
+                                         0.0),
+                                1.0);
+      EXPECT_LE((to_point - s * chord_displacement).Norm(), tolerance)
+          << it.time();
+      if (it.time() == times[chord + 1]) {
+        ++chord;
+      }
+    }
+    EXPECT_EQ(times.size() - 1, chord);
+    return times;
+  }
+
   Position<World> q1_, q2_, q3_, q4_;
   Velocity<World> p1_, p2_, p3_, p4_;
   DegreesOfFreedom<World> d1_, d2_, d3_, d4_;
@@ -522,6 +605,37 @@ TEST_F(DiscreteTrajectoryTest, AppendSuccess) {
   EXPECT_THAT(times, ElementsAre(t1_, t2_, t3_));
 }
 
+TEST_F(DiscreteTrajectoryTest, AppendSharedTail) {
+  Instant const t5 = t4_ + 10 * Second;
+  massive_trajectory_->Append(t1_, d1_);
+  massive_trajectory_->Append(t2_, d2_);
+  massive_trajectory_->Append(t3_, d3_);
+  massive_trajectory_->Append(t4_, d4_);
+  massless_trajectory_->Append(t1_, d1_);
+  massless_trajectory_->AppendSharedTail(*massive_trajectory_, t2_);
+  EXPECT_THAT(Positions(*massless_trajectory_),
+              ElementsAre(testing::Pair(t1_, q1_),
+                          testing::Pair(t3_, q3_),
+                          testing::Pair(t4_, q4_)));
+
+  // The trajectories may be changed independently.
+  massive_trajectory_->ForgetAfter(t3_);
+  massless_trajectory_->Append(t5, d1_);
+  EXPECT_THAT(Times(*massive_trajectory_), ElementsAre(t1_, t2_, t3_));
+  EXPECT_THAT(Times(*massless_trajectory_), ElementsAre(t1_, t3_, t4_, t5));
+
+  // A fork.
+  not_null<DiscreteTrajectory<World>*> const fork =
+      massive_trajectory_->NewForkWithoutCopy(t2_);
+  fork->AppendSharedTail(*massless_trajectory_, t2_);
+  EXPECT_THAT(Positions(*fork),
+              ElementsAre(testing::Pair(t1_, q1_),
+                          testing::Pair(t2_, q2_),
+                          testing::Pair(t3_, q3_),
+                          testing::Pair(t4_, q4_),
+                          testing::Pair(t5, q1_)));
+}
+
 TEST_F(DiscreteTrajectoryTest, ForgetAfter) {
   massive_trajectory_->Append(t1_, d1_);
   massive_trajectory_->Append(t2_, d2_);
@@ -797,5 +911,137 @@ TEST_F(DiscreteTrajectoryTest, IteratorSuccess) {
   EXPECT_TRUE(it == fork->End());
 }
 
+TEST_F(DiscreteTrajectoryTest, LevelsOfDetail) {
+  Time const step = 10 * Milli(Second);
+  Instant const t_end = t0_ + 100 * Second;
+  Length const tolerance = 1 * Milli(Metre);
+
+  massive_trajectory_->EnableLevelsOfDetail();
+  EXPECT_TRUE(massive_trajectory_->levels_of_detail_enabled());
+  EXPECT_FALSE(massless_trajectory_->levels_of_detail_enabled());
+  AppendCircle(t0_, t_end, step, massive_trajectory_.get());
+  AppendCircle(t0_, t_end, step, massless_trajectory_.get());
+  massless_trajectory_->EnableLevelsOfDetail();
+
+  // The sagitta of a chord of angle α is about α²/8, so chords spanning 8 steps
+  // would meet the tolerance.  However, the error bounds accumulate the errors
+  // of the finer levels, so we get chords spanning 4 steps.
+  std::vector<Instant> const times =
+      PointsWithinTolerance(*massive_trajectory_, t0_, t_end, tolerance);
+  EXPECT_EQ(2502, times.size());
+  EXPECT_EQ(times,
+            PointsWithinTolerance(*massless_trajectory_, t0_, t_end, tolerance));
+
+  // A partial range.
+  EXPECT_EQ(252,
+            PointsWithinTolerance(*massive_trajectory_,
+                                  t0_ + 12.345 * Second,
+                                  t0_ + 22.345 * Second,
+                                  tolerance).size());
+
+  // A tolerance that is met by all the chords.  Only the chords that straddle
+  // the ends of the range need to be refined.
+  EXPECT_EQ(8,
+            PointsWithinTolerance(*massive_trajectory_,
+                                  t0_ + 12.005 * Second,
+                                  t0_ + 13.005 * Second,
+                                  1 * Metre).size());
+
+  // A tolerance that is not met by any chord.
+  EXPECT_EQ(100,
+            PointsWithinTolerance(*massive_trajectory_,
+                                  t0_ + 12.005 * Second,
+                                  t0_ + 13.005 * Second,
+                                  0 * Metre).size());
+}
+
+TEST_F(DiscreteTrajectoryTest, LevelsOfDetailAcceptedChords) {
+  Time const step = 10 * Milli(Second);
+  Instant const t_end = t0_ + 100 * Second;
+
+  massive_trajectory_->EnableLevelsOfDetail();
+  AppendCircle(t0_, t_end, step, massive_trajectory_.get());
+
+  // The chords spanning more than 4 steps are rejected, so the finer levels
+  // are used for them.  The error bound of the coarse chords is large, but the
+  // accepted ones are short and meet it.
+  std::vector<Instant> times;
+  massive_trajectory_->ForEachPointOfAcceptedChords(
+      t0_,
+      t_end,
+      [step](Instant const& begin_time,
+             DegreesOfFreedom<World> const& begin_degrees_of_freedom,
+             Instant const& end_time,
+             DegreesOfFreedom<World> const& end_degrees_of_freedom,
+             Length const& error) {
+        bool const accepted = end_time - begin_time < 4.5 * step;
+        if (accepted) {
+          EXPECT_LT(error, 1 * Metre);
+        }
+        return accepted;
+      },
+      [&times](Instant const& time,
+               DegreesOfFreedom<World> const& degrees_of_freedom) {
+        times.push_back(time);
+      });
+  EXPECT_EQ(2502, times.size());
+  for (int i = 1; i < times.size(); ++i) {
+    EXPECT_LT(times[i] - times[i - 1], 4.5 * step);
+  }
+}
+
+TEST_F(DiscreteTrajectoryTest, LevelsOfDetailAppendAtLastTime) {
+  massive_trajectory_->EnableLevelsOfDetail();
+  massive_trajectory_->Append(t1_, d1_);
+  massive_trajectory_->Append(t2_, d2_);
+  massive_trajectory_->Append(t3_, d3_);
+  // Appending at the last time must not add a second point at |t3_| to the
+  // levels of detail.
+  massive_trajectory_->Append(t3_, d3_);
+  EXPECT_EQ(3, massive_trajectory_->Size());
+  EXPECT_THAT(PointsWithinTolerance(*massive_trajectory_,
+                                    t1_,
+                                    t3_,
+                                    /*tolerance=*/0 * Metre),
+              ElementsAre(t1_, t2_, t3_));
+}
+
+TEST_F(DiscreteTrajectoryTest, LevelsOfDetailForget) {
+  Time const step = 10 * Milli(Second);
+  Length const tolerance = 1 * Milli(Metre);
+
+  massive_trajectory_->EnableLevelsOfDetail();
+  AppendCircle(t0_, t0_ + 100 * Second, step, massive_trajectory_.get());
+  massive_trajectory_->ForgetBefore(t0_ + 33.333 * Second);
+  massive_trajectory_->ForgetAfter(t0_ + 77.777 * Second);
+  PointsWithinTolerance(*massive_trajectory_,
+                        t0_,
+                        t0_ + 100 * Second,
+                        tolerance);
+
+  // Append after forgetting.
+  AppendCircle(t0_ + 77.78 * Second,
+               t0_ + 200 * Second,
+               step,
+               massive_trajectory_.get());
+  std::vector<Instant> const times =
+      PointsWithinTolerance(*massive_trajectory_,
+                            t0_,
+                            t0_ + 200 * Second,
+                            tolerance);
+  EXPECT_EQ(massive_trajectory_->Begin().time(), times.front());
+  EXPECT_EQ(massive_trajectory_->last().time(), times.back());
+
+  // Forget everything and start again.
+  massive_trajectory_->ForgetBefore(t0_ + 1000 * Second);
+  EXPECT_EQ(0, massive_trajectory_->Size());
+  AppendCircle(t0_, t0_ + 10 * Second, step, massive_trajectory_.get());
+  EXPECT_EQ(251,
+            PointsWithinTolerance(*massive_trajectory_,
+                                  t0_,
+                                  t0_ + 10 * Second,
+                                  tolerance).size());
+}
+
 }  // namespace physics
 }  // namespace principia
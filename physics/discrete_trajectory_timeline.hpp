@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "base/macros.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/degrees_of_freedom.hpp"
+
+namespace principia {
+
+using geometry::Instant;
+
+namespace physics {
+namespace internal {
+
+template<typename Frame>
+class DiscreteTrajectoryTimeline;
+
+// A pool of the chunks that store the points of |DiscreteTrajectoryTimeline|s.
+// All the timelines of a tree of forks use the same pool, so that the storage
+// of a fork that is deleted, or of points that are forgotten, is recycled for
+// other forks without going through the allocator.  The functions of this class
+// may be called concurrently.
+template<typename Frame>
+class DiscreteTrajectoryChunkPool {
+ public:
+  using Chunk = std::vector<std::pair<Instant, DegreesOfFreedom<Frame>>>;
+
+  // Returns an empty chunk with a capacity of at least |capacity| elements,
+  // recycled if possible.
+  std::shared_ptr<Chunk> Allocate(std::int64_t const capacity);
+
+  // Recycles |chunk| unless it is shared with another timeline.
+  void Release(std::shared_ptr<Chunk> chunk);
+
+ private:
+  // The number of chunks kept for recycling; the others are freed.
+  static int constexpr max_free_chunks = 64;
+
+  std::mutex lock_;
+  std::vector<std::shared_ptr<Chunk>> free_chunks_ GUARDED_BY(lock_);
+};
+
+// A random-access iterator in a |DiscreteTrajectoryTimeline|.  Like an iterator
+// of an |std::map|, it remains valid when points are added to or erased from
+// the timeline, except of course if the point that it denotes is erased, and
+// the past-the-end iterator remains past-the-end when points are appended.
+template<typename Frame>
+class DiscreteTrajectoryTimelineIterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = std::pair<Instant, DegreesOfFreedom<Frame>>;
+  using difference_type = std::int64_t;
+  using pointer = value_type const*;
+  using reference = value_type const&;
+
+  DiscreteTrajectoryTimelineIterator() = default;
+
+  reference operator*() const;
+  pointer operator->() const;
+  reference operator[](difference_type const n) const;
+
+  DiscreteTrajectoryTimelineIterator& operator++();
+  DiscreteTrajectoryTimelineIterator& operator--();
+  DiscreteTrajectoryTimelineIterator operator++(int);  // NOLINT
+  DiscreteTrajectoryTimelineIterator operator--(int);  // NOLINT
+
+  DiscreteTrajectoryTimelineIterator& operator+=(difference_type const n);
+  DiscreteTrajectoryTimelineIterator& operator-=(difference_type const n);
+  DiscreteTrajectoryTimelineIterator operator+(difference_type const n) const;
+  DiscreteTrajectoryTimelineIterator operator-(difference_type const n) const;
+  difference_type operator-(
+      DiscreteTrajectoryTimelineIterator const& right) const;
+
+  bool operator==(DiscreteTrajectoryTimelineIterator const& right) const;
+  bool operator!=(DiscreteTrajectoryTimelineIterator const& right) const;
+  bool operator<(DiscreteTrajectoryTimelineIterator const& right) const;
+  bool operator>(DiscreteTrajectoryTimelineIterator const& right) const;
+  bool operator<=(DiscreteTrajectoryTimelineIterator const& right) const;
+  bool operator>=(DiscreteTrajectoryTimelineIterator const& right) const;
+
+ private:
+  DiscreteTrajectoryTimelineIterator(
+      DiscreteTrajectoryTimeline<Frame> const* timeline,
+      std::int64_t const index);
+
+  // The index of the point denoted by this iterator in the timeline, or the
+  // end index of the timeline if this iterator is past-the-end.
+  std::int64_t index() const;
+
+  // The value of |index_| for a past-the-end iterator.  It is not the end
+  // index of the timeline, as that changes when points are appended.
+  static std::int64_t constexpr past_the_end =
+      std::numeric_limits<std::int64_t>::max();
+
+  DiscreteTrajectoryTimeline<Frame> const* timeline_ = nullptr;
+  std::int64_t index_ = past_the_end;
+
+  friend class DiscreteTrajectoryTimeline<Frame>;
+};
+
+// The storage for the points of a |DiscreteTrajectory|, sorted by increasing
+// time.  The points are stored contiguously in fixed-size chunks, which makes
+// appending cheap and iterating cache-friendly.  Each point has an index which
+// doesn't change during its lifetime, which is what makes the iterators stable.
+// Points may only be added at either end of the timeline, and erased from
+// either end.  The chunks come from a |DiscreteTrajectoryChunkPool| and may be
+// shared with other timelines, in which case they are copied before being
+// modified.  Because of this, references to the points (but not iterators) may
+// be invalidated when the timeline is modified.
+template<typename Frame>
+class DiscreteTrajectoryTimeline {
+ public:
+  using value_type = std::pair<Instant, DegreesOfFreedom<Frame>>;
+  using const_iterator = DiscreteTrajectoryTimelineIterator<Frame>;
+
+  DiscreteTrajectoryTimeline() = default;
+  ~DiscreteTrajectoryTimeline();
+
+  DiscreteTrajectoryTimeline(DiscreteTrajectoryTimeline const&) = delete;
+  DiscreteTrajectoryTimeline(DiscreteTrajectoryTimeline&&) = delete;
+  DiscreteTrajectoryTimeline& operator=(
+      DiscreteTrajectoryTimeline const&) = delete;
+  DiscreteTrajectoryTimeline& operator=(DiscreteTrajectoryTimeline&&) = delete;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+  bool empty() const;
+  std::int64_t size() const;
+
+  // The timeline must not be empty.
+  value_type const& front() const;
+  value_type const& back() const;
+
+  // Same semantics as the functions of |std::map|.  These functions exploit the
+  // fact that the points of a trajectory are nearly evenly spaced in time: they
+  // start by interpolating the index of |time| between the first and the last
+  // points, and their cost is logarithmic in the distance between that guess
+  // and the actual index.
+  const_iterator find(Instant const& time) const;
+  const_iterator lower_bound(Instant const& time) const;
+  const_iterator upper_bound(Instant const& time) const;
+
+  // |time| must be (strictly) after the last time of the timeline.
+  void push_back(Instant const& time,
+                 DegreesOfFreedom<Frame> const& degrees_of_freedom);
+
+  // |time| must be (strictly) before the first time of the timeline.
+  void push_front(Instant const& time,
+                  DegreesOfFreedom<Frame> const& degrees_of_freedom);
+
+  // Erases the points in [first, last[.  Either |first| must be |begin()| or
+  // |last| must be |end()|.
+  void erase(const_iterator const first, const_iterator const last);
+
+  // From now on, this timeline takes its chunks from the same pool as |other|.
+  // Used for the timelines of the forks of a tree.
+  void SharePool(DiscreteTrajectoryTimeline const& other);
+
+  // This timeline must be empty.  Makes it contain the points of |other| from
+  // |first| on, and share its pool.  The chunks are shared with |other| until
+  // one of the timelines modifies them, so the cost is proportional to the
+  // number of chunks, not to the number of points.
+  void AssignTail(DiscreteTrajectoryTimeline const& other,
+                  const_iterator const first);
+
+ private:
+  using Chunk = typename DiscreteTrajectoryChunkPool<Frame>::Chunk;
+
+  // A chunk and a pointer to its elements, which saves an indirection when
+  // accessing the points.  The pointer is stable because a chunk never grows
+  // beyond the capacity that it was allocated with.
+  struct ChunkHandle {
+    std::shared_ptr<Chunk> chunk;
+    value_type* data;
+  };
+
+  // The point at the given |index|, which must be in [begin_index_,
+  // end_index_[.
+  value_type const& at(std::int64_t const index) const;
+
+  // Returns an iterator for the given |index|, which must be in [begin_index_,
+  // end_index_].
+  const_iterator MakeIterator(std::int64_t const index) const;
+
+  // Erases all the points and resets the chunks.
+  void Clear();
+
+  // Returns the pool, creating it if needed.
+  DiscreteTrajectoryChunkPool<Frame>& pool() const;
+
+  // Ensures that the chunk of |handle| is not shared with another timeline, by
+  // copying it if needed, so that it may be modified.
+  void Unshare(ChunkHandle& handle);
+
+  // Releases the chunks in [first, last[ to the pool and erases them.
+  void ReleaseChunks(
+      typename std::vector<ChunkHandle>::iterator first,
+      typename std::vector<ChunkHandle>::iterator last);
+
+  static std::int64_t constexpr chunk_size = 256;
+
+  // Null until this timeline first needs a chunk or shares its pool.
+  mutable std::shared_ptr<DiscreteTrajectoryChunkPool<Frame>> pool_;
+
+  // All the chunks but the last one have exactly |chunk_size| elements.  The
+  // elements of the first chunk that are before |begin_index_| are dead, they
+  // have been erased or are placeholders for future calls to |push_front|.
+  // The chunks are never null and the last one is never empty.  A chunk that is
+  // shared with another timeline is never modified.
+  std::vector<ChunkHandle> chunks_;
+  // The index of the first element of |chunks_.front()|.
+  std::int64_t chunks_begin_index_ = 0;
+  // The indices of the first point of the timeline and of the point after the
+  // last one.
+  std::int64_t begin_index_ = 0;
+  std::int64_t end_index_ = 0;
+
+  friend class DiscreteTrajectoryTimelineIterator<Frame>;
+};
+
+}  // namespace internal
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/discrete_trajectory_timeline_body.hpp"
@@ -0,0 +1,492 @@
+#pragma once
+
+#include "physics/discrete_trajectory_timeline.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace physics {
+namespace internal {
+
+template<typename Frame>
+int constexpr DiscreteTrajectoryChunkPool<Frame>::max_free_chunks;
+
+template<typename Frame>
+std::shared_ptr<typename DiscreteTrajectoryChunkPool<Frame>::Chunk>
+DiscreteTrajectoryChunkPool<Frame>::Allocate(std::int64_t const capacity) {
+  std::shared_ptr<Chunk> chunk;
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    if (!free_chunks_.empty()) {
+      chunk = std::move(free_chunks_.back());
+      free_chunks_.pop_back();
+    }
+  }
+  if (chunk == nullptr) {
+    chunk = std::make_shared<Chunk>();
+  }
+  chunk->reserve(capacity);
+  return chunk;
+}
+
+template<typename Frame>
+void DiscreteTrajectoryChunkPool<Frame>::Release(std::shared_ptr<Chunk> chunk) {
+  if (chunk.use_count() > 1) {
+    return;
+  }
+  chunk->clear();
+  std::lock_guard<std::mutex> l(lock_);
+  if (free_chunks_.size() < max_free_chunks) {
+    free_chunks_.push_back(std::move(chunk));
+  }
+}
+
+template<typename Frame>
+std::int64_t constexpr DiscreteTrajectoryTimelineIterator<Frame>::past_the_end;
+
+template<typename Frame>
+typename DiscreteTrajectoryTimelineIterator<Frame>::reference
+DiscreteTrajectoryTimelineIterator<Frame>::operator*() const {
+  DCHECK_NE(past_the_end, index_);
+  return timeline_->at(index_);
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimelineIterator<Frame>::pointer
+DiscreteTrajectoryTimelineIterator<Frame>::operator->() const {
+  return &**this;
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimelineIterator<Frame>::reference
+DiscreteTrajectoryTimelineIterator<Frame>::operator[](
+    difference_type const n) const {
+  return *(*this + n);
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>&
+DiscreteTrajectoryTimelineIterator<Frame>::operator++() {
+  DCHECK_NE(past_the_end, index_);
+  ++index_;
+  if (index_ == timeline_->end_index_) {
+    index_ = past_the_end;
+  }
+  return *this;
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>&
+DiscreteTrajectoryTimelineIterator<Frame>::operator--() {
+  index_ = index() - 1;
+  DCHECK_LE(timeline_->begin_index_, index_);
+  return *this;
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>
+DiscreteTrajectoryTimelineIterator<Frame>::operator++(int) {  // NOLINT
+  DiscreteTrajectoryTimelineIterator const result = *this;
+  ++*this;
+  return result;
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>
+DiscreteTrajectoryTimelineIterator<Frame>::operator--(int) {  // NOLINT
+  DiscreteTrajectoryTimelineIterator const result = *this;
+  --*this;
+  return result;
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>&
+DiscreteTrajectoryTimelineIterator<Frame>::operator+=(
+    difference_type const n) {
+  *this = timeline_->MakeIterator(index() + n);
+  return *this;
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>&
+DiscreteTrajectoryTimelineIterator<Frame>::operator-=(
+    difference_type const n) {
+  return *this += -n;
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>
+DiscreteTrajectoryTimelineIterator<Frame>::operator+(
+    difference_type const n) const {
+  DiscreteTrajectoryTimelineIterator result = *this;
+  return result += n;
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>
+DiscreteTrajectoryTimelineIterator<Frame>::operator-(
+    difference_type const n) const {
+  DiscreteTrajectoryTimelineIterator result = *this;
+  return result -= n;
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimelineIterator<Frame>::difference_type
+DiscreteTrajectoryTimelineIterator<Frame>::operator-(
+    DiscreteTrajectoryTimelineIterator const& right) const {
+  DCHECK_EQ(timeline_, right.timeline_);
+  return index() - right.index();
+}
+
+template<typename Frame>
+bool DiscreteTrajectoryTimelineIterator<Frame>::operator==(
+    DiscreteTrajectoryTimelineIterator const& right) const {
+  return timeline_ == right.timeline_ && index_ == right.index_;
+}
+
+template<typename Frame>
+bool DiscreteTrajectoryTimelineIterator<Frame>::operator!=(
+    DiscreteTrajectoryTimelineIterator const& right) const {
+  return !(*this == right);
+}
+
+template<typename Frame>
+bool DiscreteTrajectoryTimelineIterator<Frame>::operator<(
+    DiscreteTrajectoryTimelineIterator const& right) const {
+  return *this - right < 0;
+}
+
+template<typename Frame>
+bool DiscreteTrajectoryTimelineIterator<Frame>::operator>(
+    DiscreteTrajectoryTimelineIterator const& right) const {
+  return right < *this;
+}
+
+template<typename Frame>
+bool DiscreteTrajectoryTimelineIterator<Frame>::operator<=(
+    DiscreteTrajectoryTimelineIterator const& right) const {
+  return !(right < *this);
+}
+
+template<typename Frame>
+bool DiscreteTrajectoryTimelineIterator<Frame>::operator>=(
+    DiscreteTrajectoryTimelineIterator const& right) const {
+  return !(*this < right);
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>::DiscreteTrajectoryTimelineIterator(
+    DiscreteTrajectoryTimeline<Frame> const* const timeline,
+    std::int64_t const index)
+    : timeline_(timeline),
+      index_(index) {}
+
+template<typename Frame>
+std::int64_t DiscreteTrajectoryTimelineIterator<Frame>::index() const {
+  return index_ == past_the_end ? timeline_->end_index_ : index_;
+}
+
+template<typename Frame>
+std::int64_t constexpr DiscreteTrajectoryTimeline<Frame>::chunk_size;
+
+template<typename Frame>
+DiscreteTrajectoryTimeline<Frame>::~DiscreteTrajectoryTimeline() {
+  ReleaseChunks(chunks_.begin(), chunks_.end());
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimeline<Frame>::const_iterator
+DiscreteTrajectoryTimeline<Frame>::begin() const {
+  return MakeIterator(begin_index_);
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimeline<Frame>::const_iterator
+DiscreteTrajectoryTimeline<Frame>::end() const {
+  return MakeIterator(end_index_);
+}
+
+template<typename Frame>
+bool DiscreteTrajectoryTimeline<Frame>::empty() const {
+  return begin_index_ == end_index_;
+}
+
+template<typename Frame>
+std::int64_t DiscreteTrajectoryTimeline<Frame>::size() const {
+  return end_index_ - begin_index_;
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimeline<Frame>::value_type const&
+DiscreteTrajectoryTimeline<Frame>::front() const {
+  DCHECK(!empty());
+  return at(begin_index_);
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimeline<Frame>::value_type const&
+DiscreteTrajectoryTimeline<Frame>::back() const {
+  DCHECK(!empty());
+  return at(end_index_ - 1);
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimeline<Frame>::const_iterator
+DiscreteTrajectoryTimeline<Frame>::find(Instant const& time) const {
+  auto const it = lower_bound(time);
+  if (it != end() && it->first == time) {
+    return it;
+  } else {
+    return end();
+  }
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimeline<Frame>::const_iterator
+DiscreteTrajectoryTimeline<Frame>::lower_bound(Instant const& time) const {
+  if (empty() || time <= front().first) {
+    return begin();
+  }
+  if (time > back().first) {
+    return end();
+  }
+
+  // Here the timeline has at least two points and the result is in
+  // ]begin_index_, end_index_[.  Guess its index assuming that the points are
+  // evenly spaced.
+  double const fraction =
+      (time - front().first) / (back().first - front().first);
+  std::int64_t const guess = std::min(
+      std::max(begin_index_ +
+                   static_cast<std::int64_t>(fraction * (size() - 1)),
+               begin_index_ + 1),
+      end_index_ - 1);
+
+  // Gallop away from the guess to find |lower| and |upper| such that
+  //   at(lower).first < time <= at(upper).first.
+  std::int64_t lower;
+  std::int64_t upper;
+  if (at(guess).first < time) {
+    lower = guess;
+    for (std::int64_t step = 1;; step *= 2) {
+      upper = lower + step;
+      if (upper >= end_index_ - 1) {
+        upper = end_index_ - 1;
+        break;
+      }
+      if (at(upper).first >= time) {
+        break;
+      }
+      lower = upper;
+    }
+  } else {
+    upper = guess;
+    for (std::int64_t step = 1;; step *= 2) {
+      lower = upper - step;
+      if (lower <= begin_index_) {
+        lower = begin_index_;
+        break;
+      }
+      if (at(lower).first < time) {
+        break;
+      }
+      upper = lower;
+    }
+  }
+
+  // Bisect, maintaining the above inequalities.
+  while (upper - lower > 1) {
+    std::int64_t const middle = lower + (upper - lower) / 2;
+    if (at(middle).first < time) {
+      lower = middle;
+    } else {
+      upper = middle;
+    }
+  }
+  return MakeIterator(upper);
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimeline<Frame>::const_iterator
+DiscreteTrajectoryTimeline<Frame>::upper_bound(Instant const& time) const {
+  auto it = lower_bound(time);
+  if (it != end() && it->first == time) {
+    ++it;
+  }
+  return it;
+}
+
+template<typename Frame>
+void DiscreteTrajectoryTimeline<Frame>::push_back(
+    Instant const& time,
+    DegreesOfFreedom<Frame> const& degrees_of_freedom) {
+  DCHECK(empty() || back().first < time);
+  // All the chunks are full if and only if the next point starts a new one.
+  if ((end_index_ - chunks_begin_index_) % chunk_size == 0) {
+    auto chunk = pool().Allocate(chunk_size);
+    chunk->emplace_back(time, degrees_of_freedom);
+    chunks_.push_back(ChunkHandle{chunk, chunk->data()});
+  } else {
+    Unshare(chunks_.back());
+    chunks_.back().chunk->emplace_back(time, degrees_of_freedom);
+  }
+  ++end_index_;
+}
+
+template<typename Frame>
+void DiscreteTrajectoryTimeline<Frame>::push_front(
+    Instant const& time,
+    DegreesOfFreedom<Frame> const& degrees_of_freedom) {
+  if (empty()) {
+    push_back(time, degrees_of_freedom);
+    return;
+  }
+  CHECK_LT(time, front().first);
+  if (begin_index_ == chunks_begin_index_) {
+    // Prepend a full chunk of placeholders.  This is rare enough that we don't
+    // care about the waste.
+    auto chunk = pool().Allocate(chunk_size);
+    chunk->assign(chunk_size, value_type(time, degrees_of_freedom));
+    chunks_.insert(chunks_.begin(), ChunkHandle{chunk, chunk->data()});
+    chunks_begin_index_ -= chunk_size;
+  } else {
+    Unshare(chunks_.front());
+  }
+  --begin_index_;
+  std::int64_t const offset = begin_index_ - chunks_begin_index_;
+  chunks_.front().data[offset] = value_type(time, degrees_of_freedom);
+}
+
+template<typename Frame>
+void DiscreteTrajectoryTimeline<Frame>::erase(const_iterator const first,
+                                              const_iterator const last) {
+  DCHECK_EQ(this, first.timeline_);
+  DCHECK_EQ(this, last.timeline_);
+  std::int64_t const first_index = first.index();
+  std::int64_t const last_index = last.index();
+  CHECK_LE(first_index, last_index);
+  if (first_index == last_index) {
+    return;
+  }
+  if (first_index == begin_index_ && last_index == end_index_) {
+    Clear();
+  } else if (last_index == end_index_) {
+    // Drop the chunks that only contain erased points and truncate the new
+    // last chunk.
+    std::int64_t const last_offset = first_index - 1 - chunks_begin_index_;
+    ReleaseChunks(chunks_.begin() + last_offset / chunk_size + 1,
+                  chunks_.end());
+    auto& last_chunk = chunks_.back();
+    if (last_chunk.chunk->size() != last_offset % chunk_size + 1) {
+      Unshare(last_chunk);
+      last_chunk.chunk->erase(
+          last_chunk.chunk->begin() + last_offset % chunk_size + 1,
+          last_chunk.chunk->end());
+    }
+    end_index_ = first_index;
+  } else {
+    CHECK_EQ(begin_index_, first_index);
+    // Drop the chunks that only contain erased points.  The erased points of
+    // the new first chunk become dead.
+    std::int64_t const dropped_chunks =
+        (last_index - chunks_begin_index_) / chunk_size;
+    ReleaseChunks(chunks_.begin(), chunks_.begin() + dropped_chunks);
+    chunks_begin_index_ += dropped_chunks * chunk_size;
+    begin_index_ = last_index;
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectoryTimeline<Frame>::SharePool(
+    DiscreteTrajectoryTimeline const& other) {
+  other.pool();
+  pool_ = other.pool_;
+}
+
+template<typename Frame>
+void DiscreteTrajectoryTimeline<Frame>::AssignTail(
+    DiscreteTrajectoryTimeline const& other,
+    const_iterator const first) {
+  CHECK(empty());
+  DCHECK_EQ(&other, first.timeline_);
+  SharePool(other);
+  std::int64_t const first_index = first.index();
+  if (first_index == other.end_index_) {
+    return;
+  }
+  ReleaseChunks(chunks_.begin(), chunks_.end());
+  // Use the same indices as |other| so that the chunks line up.  The points of
+  // the first chunk that precede |first| are dead in this timeline.
+  std::int64_t const first_chunk =
+      (first_index - other.chunks_begin_index_) / chunk_size;
+  chunks_.assign(other.chunks_.begin() + first_chunk, other.chunks_.end());
+  chunks_begin_index_ = other.chunks_begin_index_ + first_chunk * chunk_size;
+  begin_index_ = first_index;
+  end_index_ = other.end_index_;
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimeline<Frame>::value_type const&
+DiscreteTrajectoryTimeline<Frame>::at(std::int64_t const index) const {
+  DCHECK_LE(begin_index_, index);
+  DCHECK_LT(index, end_index_);
+  std::int64_t const offset = index - chunks_begin_index_;
+  return chunks_[offset / chunk_size].data[offset % chunk_size];
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimeline<Frame>::const_iterator
+DiscreteTrajectoryTimeline<Frame>::MakeIterator(
+    std::int64_t const index) const {
+  DCHECK_LE(begin_index_, index);
+  DCHECK_LE(index, end_index_);
+  return const_iterator(
+      this, index == end_index_ ? const_iterator::past_the_end : index);
+}
+
+template<typename Frame>
+void DiscreteTrajectoryTimeline<Frame>::Clear() {
+  // The next point will be appended at |end_index_|.
+  ReleaseChunks(chunks_.begin(), chunks_.end());
+  chunks_begin_index_ = end_index_;
+  begin_index_ = end_index_;
+}
+
+template<typename Frame>
+DiscreteTrajectoryChunkPool<Frame>&
+DiscreteTrajectoryTimeline<Frame>::pool() const {
+  if (pool_ == nullptr) {
+    pool_ = std::make_shared<DiscreteTrajectoryChunkPool<Frame>>();
+  }
+  return *pool_;
+}
+
+template<typename Frame>
+void DiscreteTrajectoryTimeline<Frame>::Unshare(
+    ChunkHandle& handle) {
+  if (handle.chunk.use_count() > 1) {
+    auto copy = pool().Allocate(chunk_size);
+    copy->assign(handle.chunk->begin(), handle.chunk->end());
+    handle = ChunkHandle{copy, copy->data()};
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectoryTimeline<Frame>::ReleaseChunks(
+    typename std::vector<ChunkHandle>::iterator const first,
+    typename std::vector<ChunkHandle>::iterator const last) {
+  for (auto it = first; it != last; ++it) {
+    pool().Release(std::move(it->chunk));
+  }
+  chunks_.erase(first, last);
+}
+
+}  // namespace internal
+}  // namespace physics
+}  // namespace principia
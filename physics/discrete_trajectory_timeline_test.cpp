@@ -0,0 +1,233 @@
+#include "physics/discrete_trajectory_timeline.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include "geometry/frame.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+
+namespace principia {
+
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Velocity;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+namespace physics {
+namespace internal {
+
+class DiscreteTrajectoryTimelineTest : public testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      serialization::Frame::TEST1, true>;
+  using Timeline = DiscreteTrajectoryTimeline<World>;
+
+  // The degrees of freedom at index |i|, so that we can check that the points
+  // are not mixed up.
+  static DegreesOfFreedom<World> MakeDegreesOfFreedom(int const i) {
+    return DegreesOfFreedom<World>(
+        World::origin + Displacement<World>({i * Metre, 0 * Metre, 0 * Metre}),
+        Velocity<World>());
+  }
+
+  // Appends points at times t0_ + f(i) s for i in [begin, end[.
+  template<typename F>
+  void Fill(int const begin, int const end, F f) {
+    for (int i = begin; i < end; ++i) {
+      timeline_.push_back(t0_ + f(i) * Second, MakeDegreesOfFreedom(i));
+    }
+  }
+
+  static double Linear(int const i) {
+    return i;
+  }
+
+  static double Quadratic(int const i) {
+    return i * i;
+  }
+
+  Instant const t0_;
+  Timeline timeline_;
+};
+
+TEST_F(DiscreteTrajectoryTimelineTest, Empty) {
+  EXPECT_TRUE(timeline_.empty());
+  EXPECT_EQ(0, timeline_.size());
+  EXPECT_EQ(timeline_.begin(), timeline_.end());
+  EXPECT_EQ(timeline_.end(), timeline_.find(t0_));
+  EXPECT_EQ(timeline_.end(), timeline_.lower_bound(t0_));
+  EXPECT_EQ(timeline_.end(), timeline_.upper_bound(t0_));
+}
+
+TEST_F(DiscreteTrajectoryTimelineTest, Iterate) {
+  Fill(0, 1000, &Linear);
+  EXPECT_FALSE(timeline_.empty());
+  EXPECT_EQ(1000, timeline_.size());
+  EXPECT_EQ(t0_, timeline_.front().first);
+  EXPECT_EQ(t0_ + 999 * Second, timeline_.back().first);
+  EXPECT_EQ(1000, std::distance(timeline_.begin(), timeline_.end()));
+
+  int i = 0;
+  for (auto it = timeline_.begin(); it != timeline_.end(); ++it, ++i) {
+    EXPECT_EQ(t0_ + i * Second, it->first);
+    EXPECT_EQ(MakeDegreesOfFreedom(i), it->second);
+  }
+  EXPECT_EQ(1000, i);
+  for (auto it = timeline_.end(); it != timeline_.begin();) {
+    --it, --i;
+    EXPECT_EQ(t0_ + i * Second, it->first);
+  }
+  EXPECT_EQ(0, i);
+
+  auto it = timeline_.begin();
+  it += 300;
+  EXPECT_EQ(t0_ + 300 * Second, it->first);
+  EXPECT_EQ(t0_ + 600 * Second, it[300].first);
+  EXPECT_EQ(timeline_.end(), it + 700);
+  EXPECT_EQ(-300, timeline_.begin() - it);
+  EXPECT_LT(timeline_.begin(), it);
+  EXPECT_LT(it, timeline_.end());
+}
+
+TEST_F(DiscreteTrajectoryTimelineTest, Find) {
+  for (auto const f : {&Linear, &Quadratic}) {
+    Timeline timeline;
+    for (int i = 0; i < 1000; ++i) {
+      timeline.push_back(t0_ + f(i) * Second, MakeDegreesOfFreedom(i));
+    }
+    for (int i = 0; i < 1000; ++i) {
+      Instant const t = t0_ + f(i) * Second;
+      Instant const t_minus = t0_ + (f(i) - 0.5) * Second;
+      Instant const t_plus = t0_ + (f(i) + 0.5) * Second;
+      EXPECT_EQ(i, timeline.find(t) - timeline.begin());
+      EXPECT_EQ(timeline.end(), timeline.find(t_plus));
+      EXPECT_EQ(i, timeline.lower_bound(t) - timeline.begin());
+      EXPECT_EQ(i, timeline.lower_bound(t_minus) - timeline.begin());
+      EXPECT_EQ(i + 1, timeline.upper_bound(t) - timeline.begin());
+      EXPECT_EQ(i + 1, timeline.upper_bound(t_plus) - timeline.begin());
+    }
+    EXPECT_EQ(timeline.end(), timeline.upper_bound(t0_ + f(999) * Second));
+    EXPECT_EQ(timeline.end(), timeline.lower_bound(t0_ + f(1000) * Second));
+  }
+}
+
+TEST_F(DiscreteTrajectoryTimelineTest, EndIsStable) {
+  auto const end = timeline_.end();
+  Fill(0, 10, &Linear);
+  EXPECT_EQ(end, timeline_.end());
+  auto const last = --timeline_.end();
+  Fill(10, 500, &Linear);
+  EXPECT_EQ(end, timeline_.end());
+  EXPECT_EQ(t0_ + 9 * Second, last->first);
+  EXPECT_EQ(t0_ + 10 * Second, std::next(last)->first);
+}
+
+TEST_F(DiscreteTrajectoryTimelineTest, Erase) {
+  Fill(0, 1000, &Linear);
+  auto const it300 = timeline_.find(t0_ + 300 * Second);
+  auto const it600 = timeline_.find(t0_ + 600 * Second);
+
+  timeline_.erase(timeline_.upper_bound(t0_ + 700 * Second), timeline_.end());
+  EXPECT_EQ(701, timeline_.size());
+  EXPECT_EQ(t0_ + 700 * Second, timeline_.back().first);
+  timeline_.erase(timeline_.begin(), timeline_.lower_bound(t0_ + 299 * Second));
+  EXPECT_EQ(402, timeline_.size());
+  EXPECT_EQ(t0_ + 299 * Second, timeline_.front().first);
+  EXPECT_EQ(t0_ + 300 * Second, it300->first);
+  EXPECT_EQ(t0_ + 600 * Second, it600->first);
+  EXPECT_EQ(it600, timeline_.find(t0_ + 600 * Second));
+  EXPECT_EQ(300, it600 - it300);
+
+  Fill(701, 1200, &Linear);
+  EXPECT_EQ(901, timeline_.size());
+  EXPECT_EQ(MakeDegreesOfFreedom(1199), timeline_.back().second);
+
+  timeline_.erase(timeline_.begin(), timeline_.end());
+  EXPECT_TRUE(timeline_.empty());
+  Fill(0, 3, &Linear);
+  EXPECT_EQ(3, timeline_.size());
+  EXPECT_EQ(t0_, timeline_.begin()->first);
+}
+
+TEST_F(DiscreteTrajectoryTimelineTest, PushFront) {
+  Fill(1, 600, &Linear);
+  auto const it1 = timeline_.begin();
+  auto const it500 = timeline_.find(t0_ + 500 * Second);
+  timeline_.push_front(t0_, MakeDegreesOfFreedom(0));
+  EXPECT_EQ(600, timeline_.size());
+  EXPECT_EQ(t0_, timeline_.begin()->first);
+  EXPECT_EQ(std::next(timeline_.begin()), it1);
+  EXPECT_EQ(t0_ + 1 * Second, it1->first);
+  EXPECT_EQ(t0_ + 500 * Second, it500->first);
+  EXPECT_EQ(timeline_.begin(), timeline_.find(t0_));
+
+  // Push in a dead element of the first chunk.
+  timeline_.erase(timeline_.begin(), it1 + 10);
+  timeline_.push_front(t0_ + 5 * Second, MakeDegreesOfFreedom(5));
+  EXPECT_EQ(590, timeline_.size());
+  EXPECT_EQ(MakeDegreesOfFreedom(5), timeline_.front().second);
+  EXPECT_EQ(t0_ + 11 * Second, std::next(timeline_.begin())->first);
+}
+
+TEST_F(DiscreteTrajectoryTimelineTest, AssignTail) {
+  Fill(0, 1000, &Linear);
+  Timeline tail;
+  tail.AssignTail(timeline_, timeline_.find(t0_ + 300 * Second));
+  EXPECT_EQ(700, tail.size());
+  EXPECT_EQ(t0_ + 300 * Second, tail.front().first);
+  EXPECT_EQ(MakeDegreesOfFreedom(999), tail.back().second);
+  auto const it500 = tail.find(t0_ + 500 * Second);
+  EXPECT_EQ(MakeDegreesOfFreedom(500), it500->second);
+
+  // Modifying one of the timelines doesn't affect the other.
+  timeline_.erase(timeline_.find(t0_ + 600 * Second), timeline_.end());
+  timeline_.push_back(t0_ + 1000 * Second, MakeDegreesOfFreedom(-1));
+  tail.push_back(t0_ + 1000 * Second, MakeDegreesOfFreedom(1000));
+  tail.push_front(t0_ + 299.5 * Second, MakeDegreesOfFreedom(-2));
+  EXPECT_EQ(601, timeline_.size());
+  EXPECT_EQ(MakeDegreesOfFreedom(-1), timeline_.back().second);
+  EXPECT_EQ(MakeDegreesOfFreedom(299),
+            timeline_.find(t0_ + 299 * Second)->second);
+  EXPECT_EQ(702, tail.size());
+  EXPECT_EQ(MakeDegreesOfFreedom(-2), tail.front().second);
+  EXPECT_EQ(MakeDegreesOfFreedom(500), it500->second);
+  EXPECT_EQ(MakeDegreesOfFreedom(999), tail.find(t0_ + 999 * Second)->second);
+  EXPECT_EQ(MakeDegreesOfFreedom(1000), tail.back().second);
+
+  timeline_.erase(timeline_.begin(), timeline_.end());
+  int i = 300;
+  for (auto it = std::next(tail.begin()); it != tail.end(); ++it, ++i) {
+    EXPECT_EQ(t0_ + i * Second, it->first);
+    EXPECT_EQ(MakeDegreesOfFreedom(i), it->second);
+  }
+  EXPECT_EQ(1001, i);
+
+  // The tail of an empty range is empty.
+  Timeline empty_tail;
+  empty_tail.AssignTail(tail, tail.end());
+  EXPECT_TRUE(empty_tail.empty());
+  empty_tail.push_back(t0_, MakeDegreesOfFreedom(0));
+  EXPECT_EQ(1, empty_tail.size());
+}
+
+TEST_F(DiscreteTrajectoryTimelineTest, SharePool) {
+  // The chunk freed by one timeline is reused by another one.
+  Fill(0, 10, &Linear);
+  Timeline other;
+  other.SharePool(timeline_);
+  Instant const& first_time = timeline_.front().first;
+  timeline_.erase(timeline_.begin(), timeline_.end());
+  other.push_back(t0_, MakeDegreesOfFreedom(0));
+  EXPECT_EQ(&first_time, &other.front().first);
+}
+
+}  // namespace internal
+}  // namespace physics
+}  // namespace principia
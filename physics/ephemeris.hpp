@@ -1,34 +1,71 @@
 ﻿
 #pragma once
 
+#include <experimental/optional>
 #include <functional>
+#include <future>
 #include <limits>
 #include <map>
 #include <memory>
+#include <shared_mutex>
+#include <utility>
 #include <vector>
 
 #include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
 #include "google/protobuf/repeated_field.h"
 #include "integrators/ordinary_differential_equations.hpp"
+#include "physics/apsides_tracker.hpp"
 #include "physics/continuous_trajectory.hpp"
 #include "physics/discrete_trajectory.hpp"
 #include "physics/massive_body.hpp"
 #include "physics/oblate_body.hpp"
+#include "quantities/named_quantities.hpp"
 #include "serialization/ksp_plugin.pb.h"
 #include "serialization/physics.pb.h"
 
 namespace principia {
 
+using base::ThreadPool;
 using geometry::Position;
 using geometry::Vector;
 using integrators::AdaptiveStepSizeIntegrator;
 using integrators::FixedStepSizeIntegrator;
 using integrators::SpecialSecondOrderDifferentialEquation;
+using quantities::Variation;
 
 namespace physics {
 
+namespace internal {
+
+// A structure-of-arrays representation of the spherical bodies of an
+// |Ephemeris|, used for computing their mutual accelerations.  All the
+// quantities are in SI units.  |μ| is filled when the bodies are added, the
+// other vectors are overwritten each time the accelerations are computed.
+struct SphericalBodiesArrays {
+  std::vector<double> μ;
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> z;
+  std::vector<double> ax;
+  std::vector<double> ay;
+  std::vector<double> az;
+};
+
+// Computes the mutual accelerations of the spherical bodies whose coordinates
+// and gravitational parameters are given by |arrays|, and adds them to the
+// accelerations in |arrays|.  This is equivalent to calling
+// |Ephemeris::ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies|
+// with |body1_is_oblate| and |body2_is_oblate| false for all the bodies, and it
+// yields bitwise identical results, but where SSE2 is available it processes
+// the interactions of two bodies |b1| and |b1 + 1| at a time.
+void ComputeGravitationalAccelerationsBetweenSphericalBodies(
+    not_null<SphericalBodiesArrays*> const arrays);
+
+}  // namespace internal
+
 template<typename Frame>
 class Ephemeris {
   static_assert(Frame::is_inertial, "Frame must be inertial");
@@ -66,6 +103,10 @@ class Ephemeris {
     void set_speed_integration_tolerance(
         Speed const& speed_integration_tolerance);
 
+    // Returns true if integrating with |*this| and with |right| yields the
+    // same trajectories.
+    bool operator==(AdaptiveStepParameters const& right) const;
+
     void WriteToMessage(
         not_null<serialization::Ephemeris::AdaptiveStepParameters*> const
             message) const;
@@ -88,6 +129,7 @@ class Ephemeris {
         FixedStepSizeIntegrator<NewtonianMotionEquation> const& integrator,
         Time const& step);
 
+    FixedStepSizeIntegrator<NewtonianMotionEquation> const& integrator() const;
     Time const& step() const;
 
     void WriteToMessage(
@@ -154,6 +196,40 @@ class Ephemeris {
       AdaptiveStepParameters const& parameters,
       std::int64_t const max_ephemeris_steps);
 
+  // Integrates the |trajectories| followed by massless bodies in the
+  // gravitational potential described by |*this| in parallel, using the
+  // threads of |thread_pool|.  The elements of |trajectories|,
+  // |intrinsic_accelerations| and |parameters| correspond to one another.  The
+  // |trajectories| must be distinct and none of them may be an ancestor of
+  // another.  Each trajectory is integrated as if by |FlowWithAdaptiveStep|,
+  // except that the ephemeris is prolonged only once, before the integrations
+  // start, and by at most |max_ephemeris_steps|.  Returns a vector whose
+  // elements are true if and only if the corresponding trajectory was
+  // integrated until |t|.
+  virtual std::vector<bool> FlowWithAdaptiveStepInParallel(
+      std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+      IntrinsicAccelerations const& intrinsic_accelerations,
+      Instant const& t,
+      std::vector<AdaptiveStepParameters> const& parameters,
+      std::int64_t const max_ephemeris_steps,
+      not_null<ThreadPool<bool>*> const thread_pool);
+
+  // Same as |FlowWithAdaptiveStep|, except that only the prolongation of the
+  // ephemeris takes place on the calling thread: the integration of the
+  // |trajectory| is performed by one of the threads of |thread_pool|, and the
+  // returned future yields the result of |FlowWithAdaptiveStep|.  The
+  // |trajectory| must not be accessed by the caller until the future is ready.
+  // The ephemeris may be prolonged while the integration is in progress, but
+  // it must not be destroyed nor forgotten after the last time of the
+  // |trajectory|.
+  virtual std::future<bool> FlowWithAdaptiveStepAsynchronously(
+      not_null<DiscreteTrajectory<Frame>*> const trajectory,
+      IntrinsicAcceleration intrinsic_acceleration,
+      Instant const& t,
+      AdaptiveStepParameters const& parameters,
+      std::int64_t const max_ephemeris_steps,
+      not_null<ThreadPool<bool>*> const thread_pool);
+
   // Integrates, until at most |t|, the |trajectories| followed by massless
   // bodies in the gravitational potential described by |*this|.  If
   // |t > t_max()|, calls |Prolong(t)| beforehand.
@@ -195,6 +271,45 @@ class Ephemeris {
       DiscreteTrajectory<Frame>& apoapsides,
       DiscreteTrajectory<Frame>& periapsides);
 
+  // Same as |ComputeApsides|, but incremental: the apsides are retained by the
+  // |tracker|, which must have been constructed with the |trajectory| of a body
+  // of this object, and only the points that were not scanned by the previous
+  // update of the |tracker| are scanned.
+  virtual void UpdateApsides(
+      typename DiscreteTrajectory<Frame>::Iterator const begin,
+      typename DiscreteTrajectory<Frame>::Iterator const end,
+      not_null<ApsidesTracker<Frame>*> const tracker);
+
+  // The degrees of freedom of the given |body| at the time at which an
+  // |EventFunction| is evaluated.
+  using BodyDegreesOfFreedom = std::function<DegreesOfFreedom<Frame>(
+      not_null<MassiveBody const*> const body)>;
+
+  // A function of time whose zeroes are events, e.g., eclipse contacts,
+  // closest approaches or sphere of influence transitions.  It is evaluated at
+  // time |t| from the |degrees_of_freedom| of the bodies it depends upon, and
+  // returns its value and its time derivative.  The value is dimensionless;
+  // callers are responsible for the scaling.
+  using EventFunction = std::function<std::pair<double, Variation<double>>(
+      Instant const& t,
+      BodyDegreesOfFreedom const& degrees_of_freedom)>;
+
+  // Returns, for each element of |event_functions|, the times at which it
+  // vanishes in [t_min, t_max], in increasing order.  This interval must be
+  // within [this->t_min(), this->t_max()].  All the functions are sampled in a
+  // single pass at every step of the fixed-step integration, i.e., every
+  // |step| from |this->t_min()|, and at |t_max|; a change of sign between two
+  // samples, or of the cubic Hermite interpolant built from the values and
+  // derivatives at the samples, brackets an event, which is then located by
+  // |SafeguardedNewton|.  At any given time the degrees of freedom of a body
+  // are evaluated at most once, however many functions depend on them.
+  // Events that are closer than |step| and not detected by the Hermite
+  // interpolant may be missed.
+  virtual std::vector<std::vector<Instant>> FindEvents(
+      Instant const& t_min,
+      Instant const& t_max,
+      std::vector<EventFunction> const& event_functions) const;
+
   // Returns the index of the given body in the serialization produced by
   // |WriteToMessage| and read by the |Read...| functions.  This index is not
   // suitable for other uses.
@@ -209,6 +324,19 @@ class Ephemeris {
   static not_null<std::unique_ptr<Ephemeris>> ReadFromMessage(
       serialization::Ephemeris const& message);
 
+  // Same as |WriteToMessage|, but the trajectories are written using
+  // |ContinuousTrajectory::WriteDeltaToMessage|.
+  virtual void WriteDeltaToMessage(
+      not_null<serialization::Ephemeris*> const message,
+      Instant const& base_time) const;
+
+  // Folds the |delta| written by |WriteDeltaToMessage| into the |message|
+  // written by |WriteToMessage| at |base_time|.
+  static void MergeDeltaIntoMessage(
+      serialization::Ephemeris const& delta,
+      Instant const& base_time,
+      not_null<serialization::Ephemeris*> const message);
+
   // Compatibility method for construction an ephemeris from pre-Bourbaki data.
   static std::unique_ptr<Ephemeris> ReadFromPreBourbakiMessages(
       google::protobuf::RepeatedPtrField<
@@ -222,8 +350,30 @@ class Ephemeris {
   Ephemeris();
 
  private:
+  // Writes the trajectories in full if |base_time| is null, as deltas from
+  // |*base_time| otherwise.
+  void WriteToMessage(
+      not_null<serialization::Ephemeris*> const message,
+      std::experimental::optional<Instant> const& base_time) const;
+
   void AppendMassiveBodiesState(
       typename NewtonianMotionEquation::SystemState const& state);
+  // Returns the time until which |trajectory| may be integrated if the
+  // ephemeris is to be prolonged by at most |max_ephemeris_steps|.
+  Instant FlowFinalTime(DiscreteTrajectory<Frame> const& trajectory,
+                        Instant const& t,
+                        std::int64_t const max_ephemeris_steps) const;
+
+  // Integrates |trajectory| until |t_final|, which must be at most |t_max()|.
+  // Does not modify the ephemeris, and may therefore be called concurrently
+  // for distinct trajectories, or concurrently with |Prolong|.  Returns the
+  // outcome of the integration.
+  integrators::TerminationCondition FlowWithAdaptiveStepWithoutProlonging(
+      not_null<DiscreteTrajectory<Frame>*> const trajectory,
+      IntrinsicAcceleration const& intrinsic_acceleration,
+      Instant const& t_final,
+      AdaptiveStepParameters const& parameters) const;
+
   static void AppendMasslessBodiesState(
       typename NewtonianMotionEquation::SystemState const& state,
       std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories);
@@ -258,11 +408,11 @@ class Ephemeris {
       not_null<typename ContinuousTrajectory<Frame>::Hint*> const hint1) const;
 
   // Computes the accelerations between all the massive bodies in |bodies_|.
+  // Uses |spherical_bodies_arrays_| as scratch space.
   void ComputeMassiveBodiesGravitationalAccelerations(
       Instant const& t,
       std::vector<Position<Frame>> const& positions,
-      not_null<std::vector<Vector<Acceleration, Frame>>*> const
-          accelerations) const;
+      not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations);
 
   // Computes the acceleration exerted by the massive bodies in |bodies_| on
   // massless bodies.  The massless bodies are at the given |positions|.  The
@@ -329,7 +479,33 @@ class Ephemeris {
   int number_of_oblate_bodies_ = 0;
   int number_of_spherical_bodies_ = 0;
 
+  // The elements of the vectors correspond to those of |spherical_bodies_|.
+  internal::SphericalBodiesArrays spherical_bodies_arrays_;
+
   NewtonianMotionEquation massive_bodies_equation_;
+
+  // The integration of the |massive_bodies_equation_|, resumed by |Prolong|.
+  // Its state is the same as |last_state_|.  Null until the first call to
+  // |Prolong|, and reset whenever |last_state_| is changed other than by the
+  // integration.
+  std::unique_ptr<
+      typename FixedStepSizeIntegrator<NewtonianMotionEquation>::Instance>
+      instance_;
+
+  // Used to compute in parallel the series of the |trajectories_| when a block
+  // of divisions is complete, and to evaluate them in parallel when computing
+  // apsides.  Shared by all the ephemerides.  Null if there is no point in
+  // using threads.
+  ThreadPool<void>* fitting_thread_pool_ = nullptr;
+
+  // Taken exclusively when the |trajectories_| are modified, and shared when
+  // they are read by |FlowWithAdaptiveStepWithoutProlonging|, which may run
+  // concurrently with the modifications (see
+  // |FlowWithAdaptiveStepAsynchronously|).  The other reads take place on the
+  // thread that does the modifications and need no locking.
+  mutable std::shared_timed_mutex lock_;
+
+  friend class EphemerisTest;
 };
 
 }  // namespace physics
@@ -4,17 +4,27 @@
 #include "physics/ephemeris.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
+#include <future>
 #include <limits>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
+#include <utility>
 #include <vector>
 
 #include "base/macros.hpp"
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+#include <emmintrin.h>
+#endif
+
 #include "base/map_util.hpp"
 #include "base/not_null.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/r3_element.hpp"
 #include "numerics/hermite3.hpp"
+#include "numerics/root_finders.hpp"
 #include "physics/continuous_trajectory.hpp"
 #include "quantities/elementary_functions.hpp"
 #include "quantities/named_quantities.hpp"
@@ -30,6 +40,7 @@ using geometry::R3Element;
 using integrators::AdaptiveStepSize;
 using integrators::IntegrationProblem;
 using numerics::Hermite3;
+using numerics::SafeguardedNewton;
 using quantities::Abs;
 using quantities::Exponentiation;
 using quantities::Quotient;
@@ -42,6 +53,131 @@ using ::std::placeholders::_3;
 
 namespace physics {
 
+namespace internal {
+
+// The thread pool shared by all the ephemerides to fit their series and to
+// evaluate their trajectories in parallel.  Its threads are joined at exit.
+inline ThreadPool<void>& FittingThreadPool() {
+  static ThreadPool<void> thread_pool(ThreadPool<void>::DefaultPoolSize());
+  return thread_pool;
+}
+
+// Computes the mutual accelerations of the spherical bodies |b1| and |b2| of
+// |arrays|, adds the one on |b2| to the accelerations of |arrays| and subtracts
+// the one on |b1| from |ax1|, |ay1| and |az1|.  The operations are exactly
+// those of |ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies|, in
+// the same order.
+FORCE_INLINE void ComputeGravitationalAccelerationsBetweenTwoSphericalBodies(
+    not_null<SphericalBodiesArrays*> const arrays,
+    int const b1,
+    int const b2,
+    not_null<double*> const ax1,
+    not_null<double*> const ay1,
+    not_null<double*> const az1) {
+  double const Δx = arrays->x[b1] - arrays->x[b2];
+  double const Δy = arrays->y[b1] - arrays->y[b2];
+  double const Δz = arrays->z[b1] - arrays->z[b2];
+
+  double const Δq_squared = Δx * Δx + Δy * Δy + Δz * Δz;
+  double const one_over_Δq_cubed =
+      std::sqrt(Δq_squared) / (Δq_squared * Δq_squared);
+
+  double const μ1_over_Δq_cubed = arrays->μ[b1] * one_over_Δq_cubed;
+  arrays->ax[b2] += Δx * μ1_over_Δq_cubed;
+  arrays->ay[b2] += Δy * μ1_over_Δq_cubed;
+  arrays->az[b2] += Δz * μ1_over_Δq_cubed;
+
+  // Lex. III.
+  double const μ2_over_Δq_cubed = arrays->μ[b2] * one_over_Δq_cubed;
+  *ax1 -= Δx * μ2_over_Δq_cubed;
+  *ay1 -= Δy * μ2_over_Δq_cubed;
+  *az1 -= Δz * μ2_over_Δq_cubed;
+}
+
+inline void ComputeGravitationalAccelerationsBetweenSphericalBodies(
+    not_null<SphericalBodiesArrays*> const arrays) {
+  int const size = static_cast<int>(arrays->μ.size());
+  int b1 = 0;
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+  // The reactions on a body are subtracted from its acceleration in the order
+  // of |b2|, so this is a chain of dependent operations.  To overlap them, the
+  // two lanes of the SSE2 registers hold the bodies |b1| and |b1 + 1|, and
+  // each of them accumulates its reactions in the same order as the scalar
+  // code.  The SSE2 square root and division are correctly rounded, so the
+  // results are the same bits.
+  double const* const μ = arrays->μ.data();
+  double const* const x = arrays->x.data();
+  double const* const y = arrays->y.data();
+  double const* const z = arrays->z.data();
+  double* const ax = arrays->ax.data();
+  double* const ay = arrays->ay.data();
+  double* const az = arrays->az.data();
+  for (; b1 + 1 < size; b1 += 2) {
+    // The interaction between |b1| and |b1 + 1| comes first for both of them.
+    double ax1 = ax[b1];
+    double ay1 = ay[b1];
+    double az1 = az[b1];
+    ComputeGravitationalAccelerationsBetweenTwoSphericalBodies(
+        arrays, b1, b1 + 1, &ax1, &ay1, &az1);
+
+    __m128d const μ1 = _mm_loadu_pd(&μ[b1]);
+    __m128d const x1 = _mm_loadu_pd(&x[b1]);
+    __m128d const y1 = _mm_loadu_pd(&y[b1]);
+    __m128d const z1 = _mm_loadu_pd(&z[b1]);
+    __m128d a1x = _mm_setr_pd(ax1, ax[b1 + 1]);
+    __m128d a1y = _mm_setr_pd(ay1, ay[b1 + 1]);
+    __m128d a1z = _mm_setr_pd(az1, az[b1 + 1]);
+    for (int b2 = b1 + 2; b2 < size; ++b2) {
+      __m128d const Δx = _mm_sub_pd(x1, _mm_set1_pd(x[b2]));
+      __m128d const Δy = _mm_sub_pd(y1, _mm_set1_pd(y[b2]));
+      __m128d const Δz = _mm_sub_pd(z1, _mm_set1_pd(z[b2]));
+
+      __m128d const Δq_squared = _mm_add_pd(
+          _mm_add_pd(_mm_mul_pd(Δx, Δx), _mm_mul_pd(Δy, Δy)),
+          _mm_mul_pd(Δz, Δz));
+      __m128d const one_over_Δq_cubed =
+          _mm_div_pd(_mm_sqrt_pd(Δq_squared),
+                     _mm_mul_pd(Δq_squared, Δq_squared));
+
+      // The acceleration on |b2| receives the effect of |b1| first.
+      __m128d const μ1_over_Δq_cubed = _mm_mul_pd(μ1, one_over_Δq_cubed);
+      __m128d const a2x = _mm_mul_pd(Δx, μ1_over_Δq_cubed);
+      __m128d const a2y = _mm_mul_pd(Δy, μ1_over_Δq_cubed);
+      __m128d const a2z = _mm_mul_pd(Δz, μ1_over_Δq_cubed);
+      ax[b2] = (ax[b2] + _mm_cvtsd_f64(a2x)) +
+               _mm_cvtsd_f64(_mm_unpackhi_pd(a2x, a2x));
+      ay[b2] = (ay[b2] + _mm_cvtsd_f64(a2y)) +
+               _mm_cvtsd_f64(_mm_unpackhi_pd(a2y, a2y));
+      az[b2] = (az[b2] + _mm_cvtsd_f64(a2z)) +
+               _mm_cvtsd_f64(_mm_unpackhi_pd(a2z, a2z));
+
+      __m128d const μ2_over_Δq_cubed =
+          _mm_mul_pd(_mm_set1_pd(μ[b2]), one_over_Δq_cubed);
+      a1x = _mm_sub_pd(a1x, _mm_mul_pd(Δx, μ2_over_Δq_cubed));
+      a1y = _mm_sub_pd(a1y, _mm_mul_pd(Δy, μ2_over_Δq_cubed));
+      a1z = _mm_sub_pd(a1z, _mm_mul_pd(Δz, μ2_over_Δq_cubed));
+    }
+    _mm_storeu_pd(&ax[b1], a1x);
+    _mm_storeu_pd(&ay[b1], a1y);
+    _mm_storeu_pd(&az[b1], a1z);
+  }
+#endif
+  for (; b1 < size; ++b1) {
+    double ax1 = arrays->ax[b1];
+    double ay1 = arrays->ay[b1];
+    double az1 = arrays->az[b1];
+    for (int b2 = b1 + 1; b2 < size; ++b2) {
+      ComputeGravitationalAccelerationsBetweenTwoSphericalBodies(
+          arrays, b1, b2, &ax1, &ay1, &az1);
+    }
+    arrays->ax[b1] = ax1;
+    arrays->ay[b1] = ay1;
+    arrays->az[b1] = az1;
+  }
+}
+
+}  // namespace internal
+
 namespace {  // TODO(egg): this should be a named namespace (internal)
 
 Time const kMaxTimeBetweenIntermediateStates = 180 * Day;
@@ -90,6 +226,13 @@ class DummyIntegrator
     LOG(FATAL) << "dummy";
   }
 
+  not_null<std::unique_ptr<typename FixedStepSizeIntegrator<ODE>::Instance>>
+  NewInstance(IntegrationProblem<ODE> const& problem,
+              Time const& step) const override {
+    LOG(FATAL) << "dummy";
+    base::noreturn();
+  }
+
   static DummyIntegrator const& Instance() {
     static DummyIntegrator const instance;
     return instance;
@@ -142,6 +285,18 @@ void Ephemeris<Frame>::AdaptiveStepParameters::set_speed_integration_tolerance(
   speed_integration_tolerance_ = speed_integration_tolerance;
 }
 
+template<typename Frame>
+bool Ephemeris<Frame>::AdaptiveStepParameters::operator==(
+    AdaptiveStepParameters const& right) const {
+  // The integrators are static objects returned by a factory, so they may be
+  // compared by address.
+  return integrator_ == right.integrator_ &&
+         max_steps_ == right.max_steps_ &&
+         length_integration_tolerance_ ==
+             right.length_integration_tolerance_ &&
+         speed_integration_tolerance_ == right.speed_integration_tolerance_;
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AdaptiveStepParameters::WriteToMessage(
     not_null<serialization::Ephemeris::AdaptiveStepParameters*> const message)
@@ -175,6 +330,13 @@ Ephemeris<Frame>::FixedStepParameters::FixedStepParameters(
   CHECK_LT(Time(), step);
 }
 
+template<typename Frame>
+inline FixedStepSizeIntegrator<
+    typename Ephemeris<Frame>::NewtonianMotionEquation> const&
+Ephemeris<Frame>::FixedStepParameters::integrator() const {
+  return *integrator_;
+}
+
 template<typename Frame>
 inline Time const& Ephemeris<Frame>::FixedStepParameters::step() const {
   return step_;
@@ -248,13 +410,30 @@ Ephemeris<Frame>::Ephemeris(
       trajectories_.push_back(trajectory);
       last_state_.positions.push_back(degrees_of_freedom.position());
       last_state_.velocities.push_back(degrees_of_freedom.velocity());
+      spherical_bodies_arrays_.μ.push_back(
+          spherical_bodies_.back()->gravitational_parameter() /
+          SIUnit<GravitationalParameter>());
       ++number_of_spherical_bodies_;
     }
   }
 
+  for (auto* const coordinates : {&spherical_bodies_arrays_.x,
+                                  &spherical_bodies_arrays_.y,
+                                  &spherical_bodies_arrays_.z,
+                                  &spherical_bodies_arrays_.ax,
+                                  &spherical_bodies_arrays_.ay,
+                                  &spherical_bodies_arrays_.az}) {
+    coordinates->resize(number_of_spherical_bodies_);
+  }
+
   massive_bodies_equation_.compute_acceleration =
       std::bind(&Ephemeris::ComputeMassiveBodiesGravitationalAccelerations,
                 this, _1, _2, _3);
+
+  if (std::min<std::int64_t>(ThreadPool<void>::DefaultPoolSize(),
+                             trajectories_.size()) > 1) {
+    fitting_thread_pool_ = &internal::FittingThreadPool();
+  }
 }
 
 template<typename Frame>
@@ -320,6 +499,7 @@ void Ephemeris<Frame>::ForgetAfter(Instant const & t) {
   }
   CHECK_LE(t, it->time.value);
 
+  std::unique_lock<std::shared_timed_mutex> l(lock_);
   int index = 0;
   for (auto const& trajectory : trajectories_) {
     trajectory->ForgetAfter(
@@ -330,10 +510,12 @@ void Ephemeris<Frame>::ForgetAfter(Instant const & t) {
   }
   last_state_ = *it;
   intermediate_states_.erase(it, intermediate_states_.end());
+  instance_.reset();
 }
 
 template<typename Frame>
 void Ephemeris<Frame>::ForgetBefore(Instant const& t) {
+  std::unique_lock<std::shared_timed_mutex> l(lock_);
   for (auto& pair : bodies_to_trajectories_) {
     ContinuousTrajectory<Frame>& trajectory = *pair.second;
     trajectory.ForgetBefore(t);
@@ -342,31 +524,53 @@ void Ephemeris<Frame>::ForgetBefore(Instant const& t) {
 
 template<typename Frame>
 void Ephemeris<Frame>::Prolong(Instant const& t) {
-  IntegrationProblem<NewtonianMotionEquation> problem;
-  problem.equation = massive_bodies_equation_;
-  problem.append_state =
-      std::bind(&Ephemeris::AppendMassiveBodiesState, this, _1);
+  if (instance_ == nullptr) {
+    IntegrationProblem<NewtonianMotionEquation> problem;
+    problem.equation = massive_bodies_equation_;
+    problem.append_state =
+        std::bind(&Ephemeris::AppendMassiveBodiesState, this, _1);
+    problem.initial_state = &last_state_;
+    instance_ =
+        parameters_.integrator_->NewInstance(problem, parameters_.step_);
+  }
 
   // Note that |t| may be before the last time that we integrated and still
   // after |t_max()|.  In this case we want to make sure that the integrator
   // makes progress.
-  problem.initial_state = &last_state_;
+  Instant t_final;
   if (t <= last_state_.time.value) {
-    problem.t_final = last_state_.time.value + parameters_.step_;
+    t_final = last_state_.time.value + parameters_.step_;
   } else {
-    problem.t_final = t;
+    t_final = t;
   }
 
   // Perform the integration.  Note that we may have to iterate until |t_max()|
   // actually reaches |t| because the last series may not be fully determined
-  // after the first integration.
-  while (t_max() < t) {
-    parameters_.integrator_->Solve(problem, parameters_.step_);
-    // Here |problem.initial_state| still points at |last_state_|, which is the
-    // state at the end of the previous call to |Solve|.  It is therefore the
-    // right initial state for the next call to |Solve|, if any.
-    problem.t_final += parameters_.step_;
-  }
+  // after the first integration.  The |instance_| resumes from the state at the
+  // end of the previous call to |Solve|, without reallocating its workspace.
+  // The integrator is called with its concrete type and with lambdas, which
+  // may be inlined in its loop.
+  auto const compute_acceleration =
+      [this](Instant const& t,
+             std::vector<Position<Frame>> const& positions,
+             not_null<std::vector<Vector<Acceleration, Frame>>*> const
+                 accelerations) {
+        ComputeMassiveBodiesGravitationalAccelerations(
+            t, positions, accelerations);
+      };
+  auto const append_state =
+      [this](typename NewtonianMotionEquation::SystemState const& state) {
+        AppendMassiveBodiesState(state);
+      };
+  parameters_.integrator_->Visit(
+      [this, &t, &t_final, &compute_acceleration, &append_state](
+          auto const& integrator) {
+        while (t_max() < t) {
+          integrator.Solve(
+              *instance_, t_final, compute_acceleration, append_state);
+          t_final += parameters_.step_;
+        }
+      });
 }
 
 template<typename Frame>
@@ -376,57 +580,11 @@ bool Ephemeris<Frame>::FlowWithAdaptiveStep(
     Instant const& t,
     AdaptiveStepParameters const& parameters,
     std::int64_t const max_ephemeris_steps) {
-  std::vector<not_null<DiscreteTrajectory<Frame>*>> const trajectories =
-      {trajectory};
-  std::vector<IntrinsicAcceleration> const intrinsic_accelerations =
-      {std::move(intrinsic_acceleration)};
-  // The |min| is here to prevent us from spending too much time computing the
-  // ephemeris.  The |max| is here to ensure that we always try to integrate
-  // forward.  We use |last_state_.time.value| because this is always finite,
-  // contrary to |t_max()|, which is -∞ when |empty()|.
-  Instant const t_final =
-      std::min(std::max(last_state_.time.value +
-                            max_ephemeris_steps * parameters_.step(),
-                        trajectory->last().time() + parameters_.step()),
-               t);
+  Instant const t_final = FlowFinalTime(*trajectory, t, max_ephemeris_steps);
   Prolong(t_final);
 
-  std::vector<typename ContinuousTrajectory<Frame>::Hint> hints(bodies_.size());
-  NewtonianMotionEquation massless_body_equation;
-  massless_body_equation.compute_acceleration =
-      std::bind(&Ephemeris::ComputeMasslessBodiesTotalAccelerations,
-                this,
-                std::cref(intrinsic_accelerations), _1, _2, _3, &hints);
-
-  typename NewtonianMotionEquation::SystemState initial_state;
-  auto const trajectory_last = trajectory->last();
-  auto const last_degrees_of_freedom = trajectory_last.degrees_of_freedom();
-  initial_state.time = trajectory_last.time();
-  initial_state.positions.push_back(last_degrees_of_freedom.position());
-  initial_state.velocities.push_back(last_degrees_of_freedom.velocity());
-
-  IntegrationProblem<NewtonianMotionEquation> problem;
-  problem.equation = massless_body_equation;
-  problem.append_state =
-      std::bind(&Ephemeris::AppendMasslessBodiesState,
-                _1, std::cref(trajectories));
-  problem.t_final = t_final;
-  problem.initial_state = &initial_state;
-
-  AdaptiveStepSize<NewtonianMotionEquation> step_size;
-  step_size.first_time_step = problem.t_final - initial_state.time.value;
-  CHECK_GT(step_size.first_time_step, 0 * Second)
-      << "Flow back to the future: " << problem.t_final
-      << " <= " << initial_state.time.value;
-  step_size.safety_factor = 0.9;
-  step_size.tolerance_to_error_ratio =
-      std::bind(&Ephemeris<Frame>::ToleranceToErrorRatio,
-                std::cref(parameters.length_integration_tolerance_),
-                std::cref(parameters.speed_integration_tolerance_),
-                _1, _2);
-  step_size.max_steps = parameters.max_steps_;
-
-  auto const outcome = parameters.integrator_->Solve(problem, step_size);
+  auto const outcome = FlowWithAdaptiveStepWithoutProlonging(
+      trajectory, intrinsic_acceleration, t_final, parameters);
   // TODO(egg): when we have events in trajectories, we should add a singularity
   // event at the end if the outcome indicates a singularity
   // (|VanishingStepSize|).  We should not have an event on the trajectory if
@@ -435,6 +593,73 @@ bool Ephemeris<Frame>::FlowWithAdaptiveStep(
   return outcome == integrators::TerminationCondition::Done && t_final == t;
 }
 
+template<typename Frame>
+std::vector<bool> Ephemeris<Frame>::FlowWithAdaptiveStepInParallel(
+    std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+    IntrinsicAccelerations const& intrinsic_accelerations,
+    Instant const& t,
+    std::vector<AdaptiveStepParameters> const& parameters,
+    std::int64_t const max_ephemeris_steps,
+    not_null<ThreadPool<bool>*> const thread_pool) {
+  CHECK_EQ(trajectories.size(), intrinsic_accelerations.size());
+  CHECK_EQ(trajectories.size(), parameters.size());
+
+  // The final times must all be computed before prolonging, since they depend
+  // on the current state of the ephemeris.
+  std::vector<Instant> t_finals;
+  Instant t_prolong = last_state_.time.value;
+  for (auto const& trajectory : trajectories) {
+    t_finals.push_back(FlowFinalTime(*trajectory, t, max_ephemeris_steps));
+    t_prolong = std::max(t_prolong, t_finals.back());
+  }
+  Prolong(t_prolong);
+
+  // From now on the ephemeris is only read, so the integrations may proceed
+  // concurrently.  Each of them has its own hints.
+  std::vector<std::future<bool>> futures;
+  for (int i = 0; i < trajectories.size(); ++i) {
+    futures.push_back(thread_pool->Add(
+        [this, i, &t, &trajectories, &intrinsic_accelerations, &parameters,
+         &t_finals]() {
+          auto const outcome = FlowWithAdaptiveStepWithoutProlonging(
+              trajectories[i],
+              intrinsic_accelerations[i],
+              t_finals[i],
+              parameters[i]);
+          return outcome == integrators::TerminationCondition::Done &&
+                 t_finals[i] == t;
+        }));
+  }
+
+  std::vector<bool> reached_final_time;
+  for (auto& future : futures) {
+    reached_final_time.push_back(future.get());
+  }
+  return reached_final_time;
+}
+
+template<typename Frame>
+std::future<bool> Ephemeris<Frame>::FlowWithAdaptiveStepAsynchronously(
+    not_null<DiscreteTrajectory<Frame>*> const trajectory,
+    IntrinsicAcceleration intrinsic_acceleration,
+    Instant const& t,
+    AdaptiveStepParameters const& parameters,
+    std::int64_t const max_ephemeris_steps,
+    not_null<ThreadPool<bool>*> const thread_pool) {
+  Instant const t_final = FlowFinalTime(*trajectory, t, max_ephemeris_steps);
+  Prolong(t_final);
+
+  // The arguments are captured by copy since the caller doesn't wait for the
+  // integration to complete.
+  return thread_pool->Add(
+      [this, trajectory, intrinsic_acceleration, t, t_final, parameters]() {
+        auto const outcome = FlowWithAdaptiveStepWithoutProlonging(
+            trajectory, intrinsic_acceleration, t_final, parameters);
+        return outcome == integrators::TerminationCondition::Done &&
+               t_final == t;
+      });
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::FlowWithFixedStep(
     std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
@@ -447,11 +672,15 @@ void Ephemeris<Frame>::FlowWithFixedStep(
   }
 
   std::vector<typename ContinuousTrajectory<Frame>::Hint> hints(bodies_.size());
-  NewtonianMotionEquation massless_body_equation;
-  massless_body_equation.compute_acceleration =
-      std::bind(&Ephemeris::ComputeMasslessBodiesTotalAccelerations,
-                this,
-                std::cref(intrinsic_accelerations), _1, _2, _3, &hints);
+  auto const compute_acceleration =
+      [this, &intrinsic_accelerations, &hints](
+          Instant const& t,
+          std::vector<Position<Frame>> const& positions,
+          not_null<std::vector<Vector<Acceleration, Frame>>*> const
+              accelerations) {
+        ComputeMasslessBodiesTotalAccelerations(
+            intrinsic_accelerations, t, positions, accelerations, &hints);
+      };
 
   typename NewtonianMotionEquation::SystemState initial_state;
   for (auto const& trajectory : trajectories) {
@@ -464,24 +693,34 @@ void Ephemeris<Frame>::FlowWithFixedStep(
   }
 
   IntegrationProblem<NewtonianMotionEquation> problem;
-  problem.equation = massless_body_equation;
+  problem.t_final = t;
+  problem.initial_state = &initial_state;
 
 #if defined(WE_LOVE_228)
   typename NewtonianMotionEquation::SystemState last_state;
-  problem.append_state =
+  auto const append_state =
       [&last_state](
           typename NewtonianMotionEquation::SystemState const& state) {
         last_state = state;
       };
 #else
-  problem.append_state =
-      std::bind(&Ephemeris::AppendMasslessBodiesState,
-                _1, std::cref(trajectories));
+  auto const append_state =
+      [&trajectories](
+          typename NewtonianMotionEquation::SystemState const& state) {
+        AppendMasslessBodiesState(state, trajectories);
+      };
 #endif
-  problem.t_final = t;
-  problem.initial_state = &initial_state;
 
-  parameters.integrator_->Solve(problem, parameters.step_);
+  // The integrator is called with its concrete type and with lambdas, which
+  // may be inlined in its loop.
+  parameters.integrator_->Visit(
+      [&problem, &parameters, &compute_acceleration, &append_state](
+          auto const& integrator) {
+        integrator.Solve(problem,
+                         parameters.step_,
+                         compute_acceleration,
+                         append_state);
+      });
 
 #if defined(WE_LOVE_228)
   // The |positions| are empty if and only if |append_state| was never called;
@@ -599,98 +838,131 @@ void Ephemeris<Frame>::ComputeApsides(
     typename DiscreteTrajectory<Frame>::Iterator const end,
     DiscreteTrajectory<Frame>& apoapsides,
     DiscreteTrajectory<Frame>& periapsides) {
-  not_null<ContinuousTrajectory<Frame> const*> const body_trajectory =
-      trajectory(body);
-  typename ContinuousTrajectory<Frame>::Hint hint;
-
-  std::experimental::optional<Instant> previous_time;
-  std::experimental::optional<DegreesOfFreedom<Frame>>
-      previous_degrees_of_freedom;
-  std::experimental::optional<Square<Length>> previous_squared_distance;
-  std::experimental::optional<Variation<Square<Length>>>
-      previous_squared_distance_derivative;
-
-  for (auto it = begin; it != end; ++it) {
-    Instant const time = it.time();
-    DegreesOfFreedom<Frame> const degrees_of_freedom = it.degrees_of_freedom();
-    DegreesOfFreedom<Frame> const body_degrees_of_freedom =
-        body_trajectory->EvaluateDegreesOfFreedom(time, &hint);
-    RelativeDegreesOfFreedom<Frame> const relative =
-        degrees_of_freedom - body_degrees_of_freedom;
-    Square<Length> const squared_distance =
-        InnerProduct(relative.displacement(), relative.displacement());
-    // This is the derivative of |squared_distance|.
-    Variation<Square<Length>> const squared_distance_derivative =
-        2.0 * InnerProduct(relative.displacement(), relative.velocity());
-
-    if (previous_squared_distance_derivative &&
-        Sign(squared_distance_derivative) !=
-            Sign(*previous_squared_distance_derivative)) {
-      CHECK(previous_time &&
-            previous_degrees_of_freedom &&
-            previous_squared_distance);
-
-      // The derivative of |squared_distance| changed sign.  Construct a Hermite
-      // approximation of |squared_distance| and find its extrema.
-      Hermite3<Instant, Square<Length>> const
-          squared_distance_approximation(
-              {*previous_time, time},
-              {*previous_squared_distance, squared_distance},
-              {*previous_squared_distance_derivative,
-               squared_distance_derivative});
-      std::set<Instant> const extrema =
-          squared_distance_approximation.FindExtrema();
-
-      // Now look at the extrema and check that exactly one is in the required
-      // time interval.  This is normally the case, but it can fail due to
-      // ill-conditioning.
-      Instant apsis_time;
-      int valid_extrema = 0;
-      for (auto const& extremum : extrema) {
-        if (extremum >= *previous_time && extremum <= time) {
-          apsis_time = extremum;
-          ++valid_extrema;
-        }
-      }
-      if (valid_extrema != 1) {
-        // Something went wrong when finding the extrema of
-        // |squared_distance_approximation|. Use a linear interpolation of
-        // |squared_distance_derivative| instead.
-        apsis_time = Barycentre<Instant, Variation<Square<Length>>>(
-            {time, *previous_time},
-            {*previous_squared_distance_derivative,
-             -squared_distance_derivative});
+  ApsidesTracker<Frame>::ComputeApsides(trajectory(body),
+                                        begin,
+                                        end,
+                                        fitting_thread_pool_,
+                                        apoapsides,
+                                        periapsides);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::UpdateApsides(
+    typename DiscreteTrajectory<Frame>::Iterator const begin,
+    typename DiscreteTrajectory<Frame>::Iterator const end,
+    not_null<ApsidesTracker<Frame>*> const tracker) {
+  tracker->Update(begin, end, fitting_thread_pool_);
+}
+
+template<typename Frame>
+std::vector<std::vector<Instant>> Ephemeris<Frame>::FindEvents(
+    Instant const& t_min,
+    Instant const& t_max,
+    std::vector<EventFunction> const& event_functions) const {
+  Instant const ephemeris_t_min = this->t_min();
+  CHECK_LE(ephemeris_t_min, t_min);
+  CHECK_LE(t_min, t_max);
+  CHECK_LE(t_max, this->t_max());
+
+  using Value = std::pair<double, Variation<double>>;
+
+  // The degrees of freedom of the bodies at |cache_time|, indexed like
+  // |unowned_bodies_|, computed on demand.  The hints are shared by the
+  // sampling and by the root finding, which both proceed by increasing times,
+  // roughly.
+  std::vector<typename ContinuousTrajectory<Frame>::Hint> hints(
+      unowned_bodies_.size());
+  std::vector<std::experimental::optional<DegreesOfFreedom<Frame>>>
+      cache(unowned_bodies_.size());
+  std::experimental::optional<Instant> cache_time;
+  auto const evaluate = [this, &cache, &cache_time, &hints](
+      EventFunction const& event_function,
+      Instant const& t) -> Value {
+    if (cache_time != t) {
+      for (auto& degrees_of_freedom : cache) {
+        degrees_of_freedom = std::experimental::nullopt;
       }
+      cache_time = t;
+    }
+    return event_function(
+        t,
+        [this, &cache, &hints, &t](not_null<MassiveBody const*> const body) {
+          int const index = FindOrDie(unowned_bodies_indices_, body);
+          auto& degrees_of_freedom = cache[index];
+          if (!degrees_of_freedom) {
+            degrees_of_freedom = trajectory(body)->EvaluateDegreesOfFreedom(
+                t, &hints[index]);
+          }
+          return *degrees_of_freedom;
+        });
+  };
+
+  std::vector<std::vector<Instant>> events(event_functions.size());
+  std::vector<Value> previous_values;
+  Instant previous_time = t_min;
+  for (auto const& event_function : event_functions) {
+    previous_values.push_back(evaluate(event_function, t_min));
+    if (previous_values.back().first == 0) {
+      events[previous_values.size() - 1].push_back(t_min);
+    }
+  }
 
-      // Now that we know the time of the apsis, construct a Hermite
-      // approximation of the position of the body, and use it to derive its
-      // degrees of freedom.  Note that an extremum of
-      // |squared_distance_approximation| is in general not an extremum for
-      // |position_approximation|: the distance computed using the latter is a
-      // 6th-degree polynomial.  However, approximating this polynomial using a
-      // 3rd-degree polynomial would yield |squared_distance_approximation|, so
-      // we shouldn't be far from the truth.
-      Hermite3<Instant, Position<Frame>> position_approximation(
-          {*previous_time, time},
-          {previous_degrees_of_freedom->position(),
-           degrees_of_freedom.position()},
-          {previous_degrees_of_freedom->velocity(),
-           degrees_of_freedom.velocity()});
-      DegreesOfFreedom<Frame> const apsis_degrees_of_freedom(
-          position_approximation.Evaluate(apsis_time),
-          position_approximation.EvaluateDerivative(apsis_time));
-      if (Sign(squared_distance_derivative).Negative()) {
-        apoapsides.Append(apsis_time, apsis_degrees_of_freedom);
+  // The samples are the times of the integration steps, which are |step| apart
+  // from the beginning of the ephemeris, followed by |t_max|.
+  Time const& step = parameters_.step_;
+  std::int64_t node = std::floor((t_min - ephemeris_t_min) / step) + 1;
+  std::vector<Value> values(event_functions.size());
+  while (previous_time < t_max) {
+    Instant const time = std::min(ephemeris_t_min + node * step, t_max);
+    ++node;
+    if (time <= previous_time) {
+      continue;
+    }
+    for (int i = 0; i < event_functions.size(); ++i) {
+      values[i] = evaluate(event_functions[i], time);
+    }
+    for (int i = 0; i < event_functions.size(); ++i) {
+      EventFunction const& event_function = event_functions[i];
+      auto const f = [&evaluate, &event_function](Instant const& t) {
+        return evaluate(event_function, t);
+      };
+      Value const& previous_value = previous_values[i];
+      Value const& value = values[i];
+      if (value.first == 0) {
+        events[i].push_back(time);
+      } else if (previous_value.first == 0) {
+        // An event at |previous_time|, already recorded.
+      } else if (Sign(previous_value.first) != Sign(value.first)) {
+        events[i].push_back(SafeguardedNewton(f, previous_time, time));
       } else {
-        periapsides.Append(apsis_time, apsis_degrees_of_freedom);
+        // No change of sign between the samples.  There may still be two
+        // events between them if the function has an extremum of the opposite
+        // sign: look for it on the Hermite interpolant.
+        Hermite3<Instant, double> const interpolant(
+            {previous_time, time},
+            {previous_value.first, value.first},
+            {previous_value.second, value.second});
+        for (Instant const& extremum : interpolant.FindExtrema()) {
+          if (extremum <= previous_time || extremum >= time ||
+              Sign(interpolant.Evaluate(extremum)) ==
+                  Sign(value.first)) {
+            continue;
+          }
+          double const extremal_value = f(extremum).first;
+          if (extremal_value == 0) {
+            events[i].push_back(extremum);
+          } else if (Sign(extremal_value) != Sign(value.first)) {
+            events[i].push_back(SafeguardedNewton(f, previous_time, extremum));
+            events[i].push_back(SafeguardedNewton(f, extremum, time));
+          }
+          break;
+        }
       }
     }
-
     previous_time = time;
-    previous_degrees_of_freedom = degrees_of_freedom;
-    previous_squared_distance = squared_distance;
-    previous_squared_distance_derivative = squared_distance_derivative;
+    std::swap(previous_values, values);
   }
+  return events;
 }
 
 template<typename Frame>
@@ -709,6 +981,38 @@ template<typename Frame>
 void Ephemeris<Frame>::WriteToMessage(
     not_null<serialization::Ephemeris*> const message) const {
   LOG(INFO) << __FUNCTION__;
+  WriteToMessage(message, /*base_time=*/std::experimental::nullopt);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::WriteDeltaToMessage(
+    not_null<serialization::Ephemeris*> const message,
+    Instant const& base_time) const {
+  LOG(INFO) << __FUNCTION__;
+  WriteToMessage(message, base_time);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::MergeDeltaIntoMessage(
+    serialization::Ephemeris const& delta,
+    Instant const& base_time,
+    not_null<serialization::Ephemeris*> const message) {
+  CHECK_EQ(delta.trajectory_size(), message->trajectory_size());
+  serialization::Ephemeris merged = delta;
+  for (int i = 0; i < merged.trajectory_size(); ++i) {
+    ContinuousTrajectory<Frame>::MergeDeltaIntoMessage(
+        delta.trajectory(i),
+        base_time,
+        message->mutable_trajectory(i));
+    merged.mutable_trajectory(i)->Swap(message->mutable_trajectory(i));
+  }
+  message->Swap(&merged);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::WriteToMessage(
+    not_null<serialization::Ephemeris*> const message,
+    std::experimental::optional<Instant> const& base_time) const {
   // The bodies are serialized in the order in which they were given at
   // construction.
   for (auto const& unowned_body : unowned_bodies_) {
@@ -717,7 +1021,11 @@ void Ephemeris<Frame>::WriteToMessage(
   // The trajectories are serialized in the order resulting from the separation
   // between oblate and spherical bodies.
   for (auto const& trajectory : trajectories_) {
-    trajectory->WriteToMessage(message->add_trajectory());
+    if (base_time) {
+      trajectory->WriteDeltaToMessage(message->add_trajectory(), *base_time);
+    } else {
+      trajectory->WriteToMessage(message->add_trajectory());
+    }
   }
   parameters_.WriteToMessage(message->mutable_fixed_step_parameters());
   fitting_tolerance_.WriteToMessage(message->mutable_fitting_tolerance());
@@ -875,19 +1183,40 @@ Ephemeris<Frame>::Ephemeris()
 template<typename Frame>
 void Ephemeris<Frame>::AppendMassiveBodiesState(
     typename NewtonianMotionEquation::SystemState const& state) {
+  std::unique_lock<std::shared_timed_mutex> l(lock_);
   last_state_ = state;
-  int index = 0;
-  for (auto& trajectory : trajectories_) {
-    trajectory->Append(
-        state.time.value,
-        DegreesOfFreedom<Frame>(state.positions[index].value,
-                                state.velocities[index].value));
-    ++index;
+  CHECK(!trajectories_.empty());
+  // The trajectories are appended to in lockstep, so they all compute their
+  // series at the same time.  When they do, the fitting is expensive enough
+  // that it is worth doing it in parallel.
+  if (fitting_thread_pool_ != nullptr &&
+      trajectories_.front()->next_append_fits()) {
+    std::vector<std::future<void>> futures;
+    futures.reserve(trajectories_.size());
+    for (int index = 0; index < trajectories_.size(); ++index) {
+      futures.push_back(fitting_thread_pool_->Add([this, index, &state]() {
+        trajectories_[index]->Append(
+            state.time.value,
+            DegreesOfFreedom<Frame>(state.positions[index].value,
+                                    state.velocities[index].value));
+      }));
+    }
+    for (auto& future : futures) {
+      future.get();
+    }
+  } else {
+    int index = 0;
+    for (auto& trajectory : trajectories_) {
+      trajectory->Append(
+          state.time.value,
+          DegreesOfFreedom<Frame>(state.positions[index].value,
+                                  state.velocities[index].value));
+      ++index;
+    }
   }
 
   // Record an intermediate state if we haven't done so for too long and this
   // time is a |t_max|.
-  CHECK(!trajectories_.empty());
   Instant const t_max = trajectories_.front()->t_max();
   if (t_max == state.time.value) {
     Instant const t_last_intermediate_state =
@@ -901,6 +1230,95 @@ void Ephemeris<Frame>::AppendMassiveBodiesState(
   }
 }
 
+template<typename Frame>
+Instant Ephemeris<Frame>::FlowFinalTime(
+    DiscreteTrajectory<Frame> const& trajectory,
+    Instant const& t,
+    std::int64_t const max_ephemeris_steps) const {
+  // The |min| is here to prevent us from spending too much time computing the
+  // ephemeris.  The |max| is here to ensure that we always try to integrate
+  // forward.  We use |last_state_.time.value| because this is always finite,
+  // contrary to |t_max()|, which is -∞ when |empty()|.
+  return std::min(std::max(last_state_.time.value +
+                               max_ephemeris_steps * parameters_.step(),
+                           trajectory.last().time() + parameters_.step()),
+                  t);
+}
+
+template<typename Frame>
+integrators::TerminationCondition
+Ephemeris<Frame>::FlowWithAdaptiveStepWithoutProlonging(
+    not_null<DiscreteTrajectory<Frame>*> const trajectory,
+    IntrinsicAcceleration const& intrinsic_acceleration,
+    Instant const& t_final,
+    AdaptiveStepParameters const& parameters) const {
+  std::vector<not_null<DiscreteTrajectory<Frame>*>> const trajectories =
+      {trajectory};
+  std::vector<IntrinsicAcceleration> const intrinsic_accelerations =
+      {intrinsic_acceleration};
+
+  std::vector<typename ContinuousTrajectory<Frame>::Hint> hints(bodies_.size());
+  auto const compute_acceleration =
+      [this, &intrinsic_accelerations, &hints](
+          Instant const& t,
+          std::vector<Position<Frame>> const& positions,
+          not_null<std::vector<Vector<Acceleration, Frame>>*> const
+              accelerations) {
+        // The lock is uncontended unless this integration is asynchronous.
+        std::shared_lock<std::shared_timed_mutex> l(lock_);
+        ComputeMasslessBodiesTotalAccelerations(
+            intrinsic_accelerations, t, positions, accelerations, &hints);
+      };
+  auto const append_state =
+      [&trajectories](
+          typename NewtonianMotionEquation::SystemState const& state) {
+        AppendMasslessBodiesState(state, trajectories);
+      };
+  auto const tolerance_to_error_ratio =
+      [&parameters](
+          Time const& current_step_size,
+          typename NewtonianMotionEquation::SystemStateError const& error) {
+        return ToleranceToErrorRatio(parameters.length_integration_tolerance_,
+                                     parameters.speed_integration_tolerance_,
+                                     current_step_size,
+                                     error);
+      };
+
+  typename NewtonianMotionEquation::SystemState initial_state;
+  auto const trajectory_last = trajectory->last();
+  auto const last_degrees_of_freedom = trajectory_last.degrees_of_freedom();
+  initial_state.time = trajectory_last.time();
+  initial_state.positions.push_back(last_degrees_of_freedom.position());
+  initial_state.velocities.push_back(last_degrees_of_freedom.velocity());
+
+  IntegrationProblem<NewtonianMotionEquation> problem;
+  problem.t_final = t_final;
+  problem.initial_state = &initial_state;
+
+  AdaptiveStepSize<NewtonianMotionEquation> step_size;
+  step_size.first_time_step = problem.t_final - initial_state.time.value;
+  CHECK_GT(step_size.first_time_step, 0 * Second)
+      << "Flow back to the future: " << problem.t_final
+      << " <= " << initial_state.time.value;
+  step_size.safety_factor = 0.9;
+  step_size.max_steps = parameters.max_steps_;
+
+  // The integrator is called with its concrete type and with the lambdas above,
+  // which may be inlined in its loop.
+  return parameters.integrator_->Visit(
+      [&problem,
+       &step_size,
+       &compute_acceleration,
+       &append_state,
+       &tolerance_to_error_ratio](auto const& integrator) {
+        return integrator.Solve(problem,
+                                step_size,
+                                compute_acceleration,
+                                append_state,
+                                tolerance_to_error_ratio);
+      });
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AppendMasslessBodiesState(
     typename NewtonianMotionEquation::SystemState const& state,
@@ -1040,8 +1458,7 @@ template<typename Frame>
 void Ephemeris<Frame>::ComputeMassiveBodiesGravitationalAccelerations(
     Instant const& t,
     std::vector<Position<Frame>> const& positions,
-    not_null<std::vector<Vector<Acceleration, Frame>>*> const
-        accelerations) const {
+    not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations) {
   accelerations->assign(accelerations->size(), Vector<Acceleration, Frame>());
 
   for (std::size_t b1 = 0; b1 < number_of_oblate_bodies_; ++b1) {
@@ -1066,22 +1483,28 @@ void Ephemeris<Frame>::ComputeMassiveBodiesGravitationalAccelerations(
         positions,
         accelerations);
   }
-  for (std::size_t b1 = number_of_oblate_bodies_;
-       b1 < number_of_oblate_bodies_ +
-            number_of_spherical_bodies_;
-       ++b1) {
-    MassiveBody const& body1 =
-        *spherical_bodies_[b1 - number_of_oblate_bodies_];
-    ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies<
-        false /*body1_is_oblate*/,
-        false /*body2_is_oblate*/>(
-        body1, b1,
-        spherical_bodies_ /*bodies2*/,
-        number_of_oblate_bodies_ /*b2_begin*/,
-        number_of_oblate_bodies_ +
-            number_of_spherical_bodies_ /*b2_end*/,
-        positions,
-        accelerations);
+
+  // The interactions between spherical bodies are computed in SI units on a
+  // structure-of-arrays representation.  The conversions are exact.
+  internal::SphericalBodiesArrays& arrays = spherical_bodies_arrays_;
+  for (int b = 0; b < number_of_spherical_bodies_; ++b) {
+    R3Element<Length> const q =
+        (positions[number_of_oblate_bodies_ + b] - Frame::origin).coordinates();
+    R3Element<Acceleration> const a =
+        (*accelerations)[number_of_oblate_bodies_ + b].coordinates();
+    arrays.x[b] = q.x / SIUnit<Length>();
+    arrays.y[b] = q.y / SIUnit<Length>();
+    arrays.z[b] = q.z / SIUnit<Length>();
+    arrays.ax[b] = a.x / SIUnit<Acceleration>();
+    arrays.ay[b] = a.y / SIUnit<Acceleration>();
+    arrays.az[b] = a.z / SIUnit<Acceleration>();
+  }
+  internal::ComputeGravitationalAccelerationsBetweenSphericalBodies(&arrays);
+  for (int b = 0; b < number_of_spherical_bodies_; ++b) {
+    (*accelerations)[number_of_oblate_bodies_ + b] =
+        Vector<Acceleration, Frame>({arrays.ax[b] * SIUnit<Acceleration>(),
+                                     arrays.ay[b] * SIUnit<Acceleration>(),
+                                     arrays.az[b] * SIUnit<Acceleration>()});
   }
 }
 
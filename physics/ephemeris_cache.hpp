@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <experimental/filesystem>
+#include <memory>
+
+#include "base/not_null.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/ephemeris.hpp"
+#include "physics/solar_system.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+
+using base::not_null;
+using geometry::Instant;
+using quantities::Length;
+
+namespace physics {
+
+// A persistent cache for the ephemerides constructed from a |SolarSystem|.  The
+// cache is a binary file which holds a header followed by the serialized
+// |Ephemeris| and by the deltas appended each time it was prolonged.  The
+// deltas are folded into a single record when the cache is read and when there
+// are too many of them.  The header contains a fingerprint of the gravity
+// model, the initial state, the fitting tolerance and the integration
+// parameters, so that a file produced for a different configuration is never
+// used.
+template<typename Frame>
+class EphemerisCache {
+ public:
+  // Uses the file at |path| to cache the ephemerides constructed with the
+  // given |fitting_tolerance| and |parameters|.  The file doesn't need to
+  // exist.
+  EphemerisCache(
+      std::experimental::filesystem::path const& path,
+      Length const& fitting_tolerance,
+      typename Ephemeris<Frame>::FixedStepParameters const& parameters);
+
+  // Returns an ephemeris for the |solar_system|.  If the file holds an
+  // ephemeris with the same fingerprint, that ephemeris is returned and covers
+  // the time interval that was cached.  Otherwise, the ephemeris is constructed
+  // by |solar_system->MakeEphemeris| and written to the file.
+  not_null<std::unique_ptr<Ephemeris<Frame>>> MakeEphemeris(
+      not_null<SolarSystem<Frame>*> const solar_system);
+
+  // Prolongs the |ephemeris|, which must have been returned by |MakeEphemeris|,
+  // up to at least |t|.  If this extends the ephemeris beyond the end of the
+  // cache, the series computed since then are appended to the file.
+  void Prolong(Instant const& t,
+               not_null<Ephemeris<Frame>*> const ephemeris);
+
+  // The end of the time interval covered by the file.  Only meaningful after
+  // |MakeEphemeris| has been called.
+  Instant const& cached_t_max() const;
+
+ private:
+  // Returns the ephemeris stored in the file if it has the right fingerprint,
+  // null otherwise.
+  std::unique_ptr<Ephemeris<Frame>> Read();
+
+  // Writes the |ephemeris| to the file, replacing its previous contents.
+  void Write(Ephemeris<Frame> const& ephemeris);
+
+  // Appends to the file the part of the |ephemeris| that follows
+  // |cached_t_max_|, or rewrites the file if it has too many records.
+  void Append(Ephemeris<Frame> const& ephemeris);
+
+  std::experimental::filesystem::path const path_;
+  Length const fitting_tolerance_;
+  typename Ephemeris<Frame>::FixedStepParameters const parameters_;
+
+  // Set by |MakeEphemeris|.
+  std::uint64_t fingerprint_ = 0;
+  Instant cached_t_max_;
+  // The size of the valid part of the file, and the number of records in it.
+  std::uint64_t cached_size_ = 0;
+  int cached_records_ = 0;
+};
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/ephemeris_cache_body.hpp"
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "physics/ephemeris_cache.hpp"
+
+#include <fstream>
+#include <limits>
+#include <string>
+#include <system_error>
+
+#include "base/fingerprint2011.hpp"
+#include "glog/logging.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "quantities/si.hpp"
+#include "serialization/physics.pb.h"
+
+namespace principia {
+
+using base::Fingerprint2011;
+using base::FingerprintCat2011;
+using quantities::si::Second;
+
+namespace physics {
+
+namespace internal {
+
+// The header at the beginning of a cache file.  It is written in the native
+// byte order: the fingerprint is not portable anyway.
+struct EphemerisCacheHeader {
+  std::uint64_t magic;
+  std::uint64_t version;
+  std::uint64_t fingerprint;
+};
+
+// The header of each record that follows the |EphemerisCacheHeader|.  The first
+// record holds the serialized |Ephemeris|, the next ones hold the deltas
+// written by |Ephemeris::WriteDeltaToMessage| each time the cache was extended.
+struct EphemerisCacheRecordHeader {
+  // The size of the serialized message that follows the record header.
+  std::uint64_t size;
+  // The |base_time| of the delta, in seconds since |Instant()|.  Unused for
+  // the first record.
+  double base_time;
+};
+
+// "PrcpEphm".
+std::uint64_t constexpr kEphemerisCacheMagic = 0x6D68704570637250;
+
+// Must be incremented when the layout of the file changes in an incompatible
+// way.
+std::uint64_t constexpr kEphemerisCacheVersion = 2;
+
+// Reading a cache merges each delta into a copy of the whole ephemeris, so the
+// cache is rewritten as a single record when it would have more records than
+// this.
+int constexpr kEphemerisCacheMaxRecords = 16;
+
+}  // namespace internal
+
+template<typename Frame>
+EphemerisCache<Frame>::EphemerisCache(
+    std::experimental::filesystem::path const& path,
+    Length const& fitting_tolerance,
+    typename Ephemeris<Frame>::FixedStepParameters const& parameters)
+    : path_(path),
+      fitting_tolerance_(fitting_tolerance),
+      parameters_(parameters) {}
+
+template<typename Frame>
+not_null<std::unique_ptr<Ephemeris<Frame>>>
+EphemerisCache<Frame>::MakeEphemeris(
+    not_null<SolarSystem<Frame>*> const solar_system) {
+  // The integration parameters are part of the fingerprint since they affect
+  // the trajectories.
+  serialization::Ephemeris::FixedStepParameters parameters_message;
+  parameters_.WriteToMessage(&parameters_message);
+  serialization::Quantity fitting_tolerance_message;
+  fitting_tolerance_.WriteToMessage(&fitting_tolerance_message);
+  fingerprint_ = solar_system->fingerprint();
+  for (std::string const& bytes :
+           {parameters_message.SerializeAsString(),
+            fitting_tolerance_message.SerializeAsString()}) {
+    fingerprint_ = FingerprintCat2011(
+                       fingerprint_,
+                       Fingerprint2011(bytes.c_str(), bytes.size()));
+  }
+
+  std::unique_ptr<Ephemeris<Frame>> ephemeris = Read();
+  if (ephemeris == nullptr) {
+    ephemeris = solar_system->MakeEphemeris(fitting_tolerance_, parameters_);
+    Write(*ephemeris);
+  } else {
+    cached_t_max_ = ephemeris->t_max();
+    // Fold the deltas so that the next reads don't have to merge them.
+    if (cached_records_ > 1) {
+      Write(*ephemeris);
+    }
+  }
+  return std::move(ephemeris);
+}
+
+template<typename Frame>
+void EphemerisCache<Frame>::Prolong(
+    Instant const& t,
+    not_null<Ephemeris<Frame>*> const ephemeris) {
+  ephemeris->Prolong(t);
+  if (ephemeris->t_max() > cached_t_max_) {
+    Append(*ephemeris);
+  }
+}
+
+template<typename Frame>
+Instant const& EphemerisCache<Frame>::cached_t_max() const {
+  return cached_t_max_;
+}
+
+template<typename Frame>
+std::unique_ptr<Ephemeris<Frame>> EphemerisCache<Frame>::Read() {
+  std::ifstream stream(path_, std::ios::binary | std::ios::ate);
+  if (!stream.good()) {
+    LOG(INFO) << "No ephemeris cache at " << path_;
+    return nullptr;
+  }
+  std::uint64_t const file_size = stream.tellg();
+  stream.seekg(0);
+
+  internal::EphemerisCacheHeader header;
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!stream.good() ||
+      header.magic != internal::kEphemerisCacheMagic ||
+      header.version != internal::kEphemerisCacheVersion) {
+    LOG(WARNING) << "Ignoring ephemeris cache " << path_
+                 << " because it is corrupted";
+    return nullptr;
+  }
+  if (header.fingerprint != fingerprint_) {
+    LOG(INFO) << "Ignoring ephemeris cache " << path_
+              << " because it was produced for a different configuration";
+    return nullptr;
+  }
+
+  // Fold the deltas into the first record.  A record that is truncated or
+  // cannot be parsed, e.g., because the process died while appending it, ends
+  // the cache.
+  serialization::Ephemeris message;
+  std::uint64_t size = sizeof(header);
+  int records = 0;
+  for (;;) {
+    internal::EphemerisCacheRecordHeader record_header;
+    if (file_size - size < sizeof(record_header)) {
+      break;
+    }
+    stream.read(reinterpret_cast<char*>(&record_header), sizeof(record_header));
+    if (!stream.good() ||
+        record_header.size > file_size - size - sizeof(record_header)) {
+      break;
+    }
+    std::string bytes(record_header.size, '\0');
+    stream.read(&bytes[0], record_header.size);
+    google::protobuf::io::ArrayInputStream array_stream(
+        bytes.data(), static_cast<int>(bytes.size()));
+    google::protobuf::io::CodedInputStream coded_stream(&array_stream);
+    coded_stream.SetTotalBytesLimit(std::numeric_limits<int>::max(),
+                                    std::numeric_limits<int>::max());
+    serialization::Ephemeris record;
+    if (!stream.good() || !record.ParseFromCodedStream(&coded_stream)) {
+      break;
+    }
+    if (records == 0) {
+      message.Swap(&record);
+    } else {
+      Ephemeris<Frame>::MergeDeltaIntoMessage(
+          record,
+          /*base_time=*/Instant() + record_header.base_time * Second,
+          &message);
+    }
+    ++records;
+    size += sizeof(record_header) + record_header.size;
+  }
+  if (records == 0) {
+    LOG(WARNING) << "Ignoring ephemeris cache " << path_
+                 << " because it cannot be parsed";
+    return nullptr;
+  }
+  if (size != file_size) {
+    LOG(WARNING) << "Ignoring the last " << file_size - size
+                 << " bytes of ephemeris cache " << path_;
+  }
+  cached_size_ = size;
+  cached_records_ = records;
+  LOG(INFO) << "Read ephemeris cache " << path_ << " of " << size
+            << " bytes in " << records << " records";
+  return Ephemeris<Frame>::ReadFromMessage(message);
+}
+
+template<typename Frame>
+void EphemerisCache<Frame>::Write(Ephemeris<Frame> const& ephemeris) {
+  serialization::Ephemeris message;
+  ephemeris.WriteToMessage(&message);
+  std::string const bytes = message.SerializeAsString();
+  internal::EphemerisCacheHeader const header = {
+      internal::kEphemerisCacheMagic,
+      internal::kEphemerisCacheVersion,
+      fingerprint_};
+  internal::EphemerisCacheRecordHeader const record_header = {
+      bytes.size(), /*base_time=*/0};
+
+  // Write to a temporary file and rename it, so that a crash never leaves a
+  // truncated cache behind.
+  std::experimental::filesystem::path temporary_path = path_;
+  temporary_path += ".tmp";
+  {
+    std::ofstream stream(temporary_path, std::ios::binary | std::ios::trunc);
+    CHECK(stream.good()) << temporary_path;
+    stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<char const*>(&record_header),
+                 sizeof(record_header));
+    stream.write(bytes.data(), bytes.size());
+    CHECK(stream.good()) << temporary_path;
+  }
+  std::experimental::filesystem::rename(temporary_path, path_);
+  cached_size_ = sizeof(header) + sizeof(record_header) + bytes.size();
+  cached_records_ = 1;
+  cached_t_max_ = ephemeris.t_max();
+  LOG(INFO) << "Wrote ephemeris cache " << path_ << " of " << bytes.size()
+            << " bytes up to " << cached_t_max_;
+}
+
+template<typename Frame>
+void EphemerisCache<Frame>::Append(Ephemeris<Frame> const& ephemeris) {
+  // If the file went away or was shortened behind our back, there is nothing
+  // to append to.
+  std::error_code error;
+  std::uint64_t const file_size =
+      std::experimental::filesystem::file_size(path_, error);
+  if (error || file_size < cached_size_ ||
+      cached_records_ >= internal::kEphemerisCacheMaxRecords) {
+    Write(ephemeris);
+    return;
+  }
+  // Drop the bytes that follow the last valid record, if any, so that the new
+  // record is readable.
+  if (file_size > cached_size_) {
+    std::experimental::filesystem::resize_file(path_, cached_size_);
+  }
+
+  serialization::Ephemeris message;
+  ephemeris.WriteDeltaToMessage(&message, /*base_time=*/cached_t_max_);
+  std::string const bytes = message.SerializeAsString();
+  internal::EphemerisCacheRecordHeader const record_header = {
+      bytes.size(), /*base_time=*/(cached_t_max_ - Instant()) / Second};
+  {
+    std::ofstream stream(path_, std::ios::binary | std::ios::app);
+    CHECK(stream.good()) << path_;
+    stream.write(reinterpret_cast<char const*>(&record_header),
+                 sizeof(record_header));
+    stream.write(bytes.data(), bytes.size());
+    CHECK(stream.good()) << path_;
+  }
+  cached_size_ += sizeof(record_header) + bytes.size();
+  ++cached_records_;
+  cached_t_max_ = ephemeris.t_max();
+  LOG(INFO) << "Appended " << bytes.size() << " bytes to ephemeris cache "
+            << path_ << " up to " << cached_t_max_;
+}
+
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,263 @@
+#include "physics/ephemeris_cache.hpp"
+
+#include <cstdint>
+#include <experimental/filesystem>
+#include <fstream>
+#include <string>
+
+#include "astronomy/frames.hpp"
+#include "geometry/named_quantities.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "integrators/symplectic_runge_kutta_nyström_integrator.hpp"
+#include "physics/ephemeris.hpp"
+#include "physics/solar_system.hpp"
+#include "quantities/si.hpp"
+
+namespace principia {
+
+using astronomy::ICRFJ2000Equator;
+using geometry::Position;
+using integrators::McLachlanAtela1992Order4Optimal;
+using quantities::si::Milli;
+using quantities::si::Metre;
+using quantities::si::Second;
+using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::Le;
+using ::testing::Lt;
+
+namespace physics {
+
+class EphemerisCacheTest : public ::testing::Test {
+ protected:
+  EphemerisCacheTest()
+      : path_(std::string(testing::UnitTest::GetInstance()->
+                              current_test_info()->name()) +
+              ".ephemeris"),
+        parameters_(McLachlanAtela1992Order4Optimal<
+                        Position<ICRFJ2000Equator>>(),
+                    /*step=*/10 * Milli(Second)) {
+    solar_system_.Initialize(
+        SOLUTION_DIR / "astronomy" / "gravity_model_two_bodies_test.proto.txt",
+        SOLUTION_DIR / "astronomy" / "initial_state_two_bodies_test.proto.txt");
+    std::experimental::filesystem::remove(path_);
+    t_final_ = solar_system_.epoch() + 10 * Second;
+  }
+
+  ~EphemerisCacheTest() override {
+    std::experimental::filesystem::remove(path_);
+  }
+
+  // Checks that the trajectories of |actual| and |expected| are bitwise
+  // identical.
+  void ExpectSameTrajectories(Ephemeris<ICRFJ2000Equator> const& actual,
+                              Ephemeris<ICRFJ2000Equator> const& expected) {
+    EXPECT_EQ(expected.t_min(), actual.t_min());
+    EXPECT_EQ(expected.t_max(), actual.t_max());
+    for (int i = 0; i < expected.bodies().size(); ++i) {
+      auto const& actual_trajectory = *actual.trajectory(actual.bodies()[i]);
+      auto const& expected_trajectory =
+          *expected.trajectory(expected.bodies()[i]);
+      for (Instant t = expected.t_min();
+           t < expected.t_max();
+           t += 0.1 * Second) {
+        EXPECT_EQ(expected_trajectory.EvaluateDegreesOfFreedom(t, nullptr),
+                  actual_trajectory.EvaluateDegreesOfFreedom(t, nullptr));
+      }
+    }
+  }
+
+  // Returns the number of records in the file at |path_|.
+  int Records() const {
+    std::ifstream stream(path_, std::ios::binary);
+    internal::EphemerisCacheHeader header;
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    int records = 0;
+    for (;;) {
+      internal::EphemerisCacheRecordHeader record_header;
+      stream.read(reinterpret_cast<char*>(&record_header),
+                  sizeof(record_header));
+      if (!stream.good()) {
+        return records;
+      }
+      stream.seekg(record_header.size, std::ios::cur);
+      ++records;
+    }
+  }
+
+  std::experimental::filesystem::path const path_;
+  Ephemeris<ICRFJ2000Equator>::FixedStepParameters const parameters_;
+  SolarSystem<ICRFJ2000Equator> solar_system_;
+  Instant t_final_;
+};
+
+TEST_F(EphemerisCacheTest, RoundTrip) {
+  auto const expected = solar_system_.MakeEphemeris(
+                            /*fitting_tolerance=*/1 * Milli(Metre),
+                            parameters_);
+  expected->Prolong(t_final_);
+  {
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    EXPECT_TRUE(std::experimental::filesystem::exists(path_));
+    EXPECT_THAT(ephemeris->t_max(), Lt(t_final_));
+    cache.Prolong(t_final_, ephemeris.get());
+    EXPECT_EQ(ephemeris->t_max(), cache.cached_t_max());
+    ExpectSameTrajectories(*ephemeris, *expected);
+  }
+  {
+    // A new cache reads the file and doesn't need to integrate.
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    ExpectSameTrajectories(*ephemeris, *expected);
+
+    // Prolonging from the cached state gives the same result as integrating
+    // without the cache.
+    expected->Prolong(t_final_ + 5 * Second);
+    cache.Prolong(t_final_ + 5 * Second, ephemeris.get());
+    ExpectSameTrajectories(*ephemeris, *expected);
+    EXPECT_EQ(ephemeris->t_max(), cache.cached_t_max());
+  }
+}
+
+TEST_F(EphemerisCacheTest, Append) {
+  auto const expected = solar_system_.MakeEphemeris(
+                            /*fitting_tolerance=*/1 * Milli(Metre),
+                            parameters_);
+  expected->Prolong(t_final_ + 10 * Second);
+  std::string prefix;
+  Instant t_max;
+  {
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    cache.Prolong(t_final_, ephemeris.get());
+    t_max = ephemeris->t_max();
+    std::uintmax_t const size = std::experimental::filesystem::file_size(path_);
+    {
+      std::ifstream stream(path_, std::ios::binary);
+      prefix.resize(size);
+      stream.read(&prefix[0], size);
+    }
+
+    // Prolonging appends to the file and leaves the beginning untouched.
+    cache.Prolong(t_final_ + 5 * Second, ephemeris.get());
+    cache.Prolong(t_final_ + 10 * Second, ephemeris.get());
+    EXPECT_THAT(size, Lt(std::experimental::filesystem::file_size(path_)));
+    std::string actual_prefix(size, '\0');
+    {
+      std::ifstream stream(path_, std::ios::binary);
+      stream.read(&actual_prefix[0], size);
+    }
+    EXPECT_EQ(prefix, actual_prefix);
+  }
+  // The initial ephemeris and one delta per prolongation.
+  EXPECT_EQ(4, Records());
+
+  // Simulate a crash while appending the last delta: the previous records are
+  // still used, and appending after the truncated record works.
+  std::experimental::filesystem::resize_file(
+      path_, std::experimental::filesystem::file_size(path_) - 1);
+  {
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    EXPECT_THAT(ephemeris->t_max(), Lt(t_final_ + 10 * Second));
+    EXPECT_THAT(t_max, Lt(ephemeris->t_max()));
+    cache.Prolong(t_final_ + 10 * Second, ephemeris.get());
+    ExpectSameTrajectories(*ephemeris, *expected);
+  }
+  {
+    // All the deltas are read back.
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    ExpectSameTrajectories(*ephemeris, *expected);
+  }
+}
+
+TEST_F(EphemerisCacheTest, Compaction) {
+  Instant t = t_final_;
+  {
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    // Each prolongation appends a record, until there are too many of them.
+    for (int i = 0; i < internal::kEphemerisCacheMaxRecords + 2; ++i) {
+      t += 1 * Second;
+      cache.Prolong(t, ephemeris.get());
+      EXPECT_EQ(ephemeris->t_max(), cache.cached_t_max());
+      EXPECT_THAT(Records(), Le(internal::kEphemerisCacheMaxRecords));
+    }
+    EXPECT_THAT(Records(), Gt(1));
+  }
+  auto const expected = solar_system_.MakeEphemeris(
+                            /*fitting_tolerance=*/1 * Milli(Metre),
+                            parameters_);
+  expected->Prolong(t);
+  {
+    // Reading the cache folds the deltas into a single record.
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    ExpectSameTrajectories(*ephemeris, *expected);
+    EXPECT_EQ(1, Records());
+  }
+  {
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    ExpectSameTrajectories(*ephemeris, *expected);
+  }
+}
+
+TEST_F(EphemerisCacheTest, Invalidation) {
+  {
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    cache.Prolong(t_final_, ephemeris.get());
+  }
+  {
+    // A different fitting tolerance.
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/2 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    EXPECT_THAT(ephemeris->t_max(), Lt(t_final_));
+  }
+  {
+    // A different solar system.  Note that the cache was overwritten by the
+    // previous block.
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/2 * Milli(Metre), parameters_);
+    auto ephemeris = cache.MakeEphemeris(&solar_system_);
+    cache.Prolong(t_final_, ephemeris.get());
+    solar_system_.RemoveMassiveBody("Small");
+    ephemeris = cache.MakeEphemeris(&solar_system_);
+    EXPECT_THAT(ephemeris->t_max(), Eq(cache.cached_t_max()));
+    EXPECT_THAT(ephemeris->t_max(), Lt(t_final_));
+  }
+}
+
+TEST_F(EphemerisCacheTest, Corruption) {
+  {
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    cache.Prolong(t_final_, ephemeris.get());
+  }
+  std::experimental::filesystem::resize_file(
+      path_, std::experimental::filesystem::file_size(path_) - 1);
+  {
+    EphemerisCache<ICRFJ2000Equator> cache(
+        path_, /*fitting_tolerance=*/1 * Milli(Metre), parameters_);
+    auto const ephemeris = cache.MakeEphemeris(&solar_system_);
+    EXPECT_THAT(ephemeris->t_max(), Lt(t_final_));
+  }
+}
+
+}  // namespace physics
+}  // namespace principia
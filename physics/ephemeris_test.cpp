@@ -32,18 +32,26 @@ namespace principia {
 using astronomy::ICRFJ2000Equator;
 using astronomy::kSolarSystemBarycentreEquator;
 using geometry::Barycentre;
+using geometry::InnerProduct;
+using geometry::Vector;
 using integrators::DormandElMikkawyPrince1986RKN434FM;
 using integrators::McLachlanAtela1992Order5Optimal;
 using quantities::Abs;
+using quantities::Angle;
+using quantities::AngularFrequency;
+using quantities::ArcCos;
 using quantities::ArcTan;
 using quantities::Area;
+using quantities::Cos;
 using quantities::Pow;
+using quantities::Sin;
 using quantities::Sqrt;
 using quantities::astronomy::JulianYear;
 using quantities::astronomy::LunarDistance;
 using quantities::astronomy::SolarMass;
 using quantities::constants::GravitationalConstant;
 using quantities::si::AstronomicalUnit;
+using quantities::si::Day;
 using quantities::si::Kilo;
 using quantities::si::Kilogram;
 using quantities::si::Metre;
@@ -51,6 +59,7 @@ using quantities::si::Milli;
 using quantities::si::Minute;
 using quantities::si::Radian;
 using quantities::si::Second;
+using testing_utilities::AbsoluteError;
 using testing_utilities::AlmostEquals;
 using testing_utilities::RelativeError;
 using testing_utilities::SolarSystemFactory;
@@ -137,6 +146,55 @@ class EphemerisTest : public testing::Test {
     initial_state->emplace_back(q2, v2);
   }
 
+  // Computes the accelerations between the massive bodies of |ephemeris| using
+  // |ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies| for all
+  // pairs of bodies.
+  static void ComputeMassiveBodiesGravitationalAccelerationsPairwise(
+      Ephemeris<ICRFJ2000Equator> const& ephemeris,
+      std::vector<Position<ICRFJ2000Equator>> const& positions,
+      not_null<std::vector<Vector<Acceleration, ICRFJ2000Equator>>*> const
+          accelerations) {
+    int const oblate = ephemeris.number_of_oblate_bodies_;
+    int const all = oblate + ephemeris.number_of_spherical_bodies_;
+    accelerations->assign(all, Vector<Acceleration, ICRFJ2000Equator>());
+    for (int b1 = 0; b1 < oblate; ++b1) {
+      MassiveBody const& body1 = *ephemeris.oblate_bodies_[b1];
+      Ephemeris<ICRFJ2000Equator>::
+          ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies<
+              /*body1_is_oblate=*/true, /*body2_is_oblate=*/true>(
+              body1, b1, ephemeris.oblate_bodies_, 0, oblate,
+              positions, accelerations);
+      Ephemeris<ICRFJ2000Equator>::
+          ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies<
+              /*body1_is_oblate=*/true, /*body2_is_oblate=*/false>(
+              body1, b1, ephemeris.spherical_bodies_, oblate, all,
+              positions, accelerations);
+    }
+    for (int b1 = oblate; b1 < all; ++b1) {
+      MassiveBody const& body1 = *ephemeris.spherical_bodies_[b1 - oblate];
+      Ephemeris<ICRFJ2000Equator>::
+          ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies<
+              /*body1_is_oblate=*/false, /*body2_is_oblate=*/false>(
+              body1, b1, ephemeris.spherical_bodies_, oblate, all,
+              positions, accelerations);
+    }
+  }
+
+  static void ComputeMassiveBodiesGravitationalAccelerations(
+      not_null<Ephemeris<ICRFJ2000Equator>*> const ephemeris,
+      Instant const& t,
+      std::vector<Position<ICRFJ2000Equator>> const& positions,
+      not_null<std::vector<Vector<Acceleration, ICRFJ2000Equator>>*> const
+          accelerations) {
+    ephemeris->ComputeMassiveBodiesGravitationalAccelerations(
+        t, positions, accelerations);
+  }
+
+  static std::vector<not_null<ContinuousTrajectory<ICRFJ2000Equator>*>> const&
+  trajectories(Ephemeris<ICRFJ2000Equator> const& ephemeris) {
+    return ephemeris.trajectories_;
+  }
+
   SolarSystem<ICRFJ2000Equator> solar_system_;
   Instant t0_;
 };
@@ -236,6 +294,102 @@ TEST_F(EphemerisTest, EarthMoon) {
   EXPECT_THAT(Abs(moon_positions[100].coordinates().x), Lt(2 * Metre));
 }
 
+// Find events on the Earth-Moon system, where the Moon has a circular orbit
+// starting along the y axis.
+TEST_F(EphemerisTest, FindEvents) {
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
+  Position<ICRFJ2000Equator> centre_of_mass;
+  Time period;
+  SetUpEarthMoonSystem(&bodies, &initial_state, &centre_of_mass, &period);
+
+  MassiveBody const* const earth = bodies[0].get();
+  MassiveBody const* const moon = bodies[1].get();
+  Length const earth_moon_distance =
+      (initial_state[1].position() - initial_state[0].position()).Norm();
+
+  Ephemeris<ICRFJ2000Equator>
+      ephemeris(
+          std::move(bodies),
+          initial_state,
+          t0_,
+          5 * Milli(Metre),
+          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+              period / 100));
+
+  ephemeris.Prolong(t0_ + 2 * period);
+
+  // The projection of the Earth-Moon displacement on the given direction,
+  // divided by the Earth-Moon distance.
+  auto const projection = [earth, earth_moon_distance, moon](
+      Vector<double, ICRFJ2000Equator> const& direction) {
+    return [direction, earth, earth_moon_distance, moon](
+        Instant const& t,
+        Ephemeris<ICRFJ2000Equator>::BodyDegreesOfFreedom const&
+            degrees_of_freedom) {
+      RelativeDegreesOfFreedom<ICRFJ2000Equator> const earth_moon =
+          degrees_of_freedom(moon) - degrees_of_freedom(earth);
+      return std::make_pair(
+          InnerProduct(earth_moon.displacement(), direction) /
+              earth_moon_distance,
+          InnerProduct(earth_moon.velocity(), direction) /
+              earth_moon_distance);
+    };
+  };
+
+  // The direction of the Moon at |period / 200|, which is between two nodes
+  // of the series.
+  AngularFrequency const ω = 2 * π * Radian / period;
+  Angle const φ = ω * period / 200;
+  Vector<double, ICRFJ2000Equator> const moon_direction(
+      {Sin(φ), Cos(φ), 0});
+  // The Moon is within this angle of |moon_direction| for a small fraction of
+  // the interval between two nodes.
+  double const cos_θ = 0.9999;
+  Angle const θ = ArcCos(cos_θ);
+  auto const near_moon_direction =
+      [cos_θ, moon_direction, projection](
+          Instant const& t,
+          Ephemeris<ICRFJ2000Equator>::BodyDegreesOfFreedom const&
+              degrees_of_freedom) {
+        auto const value =
+            projection(moon_direction)(t, degrees_of_freedom);
+        return std::make_pair(value.first - cos_θ, value.second);
+      };
+
+  auto const events = ephemeris.FindEvents(
+      t0_ + period / 8,
+      t0_ + 15 * period / 8,
+      {projection(Vector<double, ICRFJ2000Equator>({1, 0, 0})),
+       projection(Vector<double, ICRFJ2000Equator>({0, 1, 0})),
+       near_moon_direction});
+  ASSERT_EQ(3, events.size());
+
+  // The x coordinate vanishes every half period.
+  ASSERT_EQ(3, events[0].size());
+  for (int i = 0; i < events[0].size(); ++i) {
+    EXPECT_THAT(AbsoluteError(t0_ + (i + 1) * period / 2, events[0][i]),
+                Lt(5 * Milli(Second)));
+  }
+
+  // The y coordinate vanishes every half period, a quarter period out of phase.
+  ASSERT_EQ(4, events[1].size());
+  for (int i = 0; i < events[1].size(); ++i) {
+    EXPECT_THAT(AbsoluteError(t0_ + (2 * i + 1) * period / 4, events[1][i]),
+                Lt(5 * Milli(Second)));
+  }
+
+  // The Moon enters and leaves the vicinity of |moon_direction| once, between
+  // two samples.  The event function has a nearly double root, so the times
+  // are less accurate.
+  ASSERT_EQ(2, events[2].size());
+  EXPECT_THAT(AbsoluteError(t0_ + period + (φ - θ) / ω, events[2][0]),
+              Lt(1 * Second));
+  EXPECT_THAT(AbsoluteError(t0_ + period + (φ + θ) / ω, events[2][1]),
+              Lt(1 * Second));
+}
+
 // Test the behavior of ForgetAfter and ForgetBefore on the Earth-Moon system.
 TEST_F(EphemerisTest, Forget) {
   std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
@@ -610,6 +764,88 @@ TEST_F(EphemerisTest, EarthTwoProbes) {
               Eq(q_probe2));
 }
 
+// The Earth, the Moon and a number of massless probes flowed in parallel.  The
+// result must be the same as if they had been flowed one at a time.
+TEST_F(EphemerisTest, EarthMoonManyProbesInParallel) {
+  int const kNumberOfProbes = 17;
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
+  Position<ICRFJ2000Equator> centre_of_mass;
+  Time period;
+  SetUpEarthMoonSystem(&bodies, &initial_state, &centre_of_mass, &period);
+
+  MassiveBody const* const earth = bodies[0].get();
+  Position<ICRFJ2000Equator> const earth_position =
+      initial_state[0].position();
+  Velocity<ICRFJ2000Equator> const earth_velocity =
+      initial_state[0].velocity();
+
+  Ephemeris<ICRFJ2000Equator>
+      ephemeris(
+          std::move(bodies),
+          initial_state,
+          t0_,
+          5 * Milli(Metre),
+          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+              period / 100));
+  Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters const parameters(
+      DormandElMikkawyPrince1986RKN434FM<Position<ICRFJ2000Equator>>(),
+      /*max_steps=*/std::numeric_limits<std::int64_t>::max(),
+      1E-3 * Metre,
+      1E-6 * Metre / Second);
+
+  // Probes on circular orbits around the Earth, at various distances.
+  std::vector<DiscreteTrajectory<ICRFJ2000Equator>> parallel_trajectories(
+      kNumberOfProbes);
+  std::vector<DiscreteTrajectory<ICRFJ2000Equator>> sequential_trajectories(
+      kNumberOfProbes);
+  for (int i = 0; i < kNumberOfProbes; ++i) {
+    Length const distance = (i + 1) * 1E7 * Metre;
+    Speed const speed = Sqrt(earth->gravitational_parameter() / distance);
+    DegreesOfFreedom<ICRFJ2000Equator> const degrees_of_freedom(
+        earth_position + Vector<Length, ICRFJ2000Equator>(
+                             {0 * Metre, distance, 0 * Metre}),
+        earth_velocity + Velocity<ICRFJ2000Equator>(
+                             {speed, 0 * Metre / Second, 0 * Metre / Second}));
+    parallel_trajectories[i].Append(t0_, degrees_of_freedom);
+    sequential_trajectories[i].Append(t0_, degrees_of_freedom);
+  }
+
+  std::vector<not_null<DiscreteTrajectory<ICRFJ2000Equator>*>> trajectories;
+  for (auto& trajectory : parallel_trajectories) {
+    trajectories.push_back(&trajectory);
+  }
+  ThreadPool<bool> thread_pool(4);
+  std::vector<bool> const reached_final_time =
+      ephemeris.FlowWithAdaptiveStepInParallel(
+          trajectories,
+          Ephemeris<ICRFJ2000Equator>::IntrinsicAccelerations(
+              kNumberOfProbes,
+              Ephemeris<ICRFJ2000Equator>::kNoIntrinsicAcceleration),
+          t0_ + period / 10,
+          std::vector<Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters>(
+              kNumberOfProbes, parameters),
+          Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps,
+          &thread_pool);
+  EXPECT_THAT(reached_final_time,
+              Eq(std::vector<bool>(kNumberOfProbes, true)));
+
+  for (int i = 0; i < kNumberOfProbes; ++i) {
+    EXPECT_TRUE(ephemeris.FlowWithAdaptiveStep(
+        &sequential_trajectories[i],
+        Ephemeris<ICRFJ2000Equator>::kNoIntrinsicAcceleration,
+        t0_ + period / 10,
+        parameters,
+        Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps));
+    EXPECT_THAT(parallel_trajectories[i].Size(),
+                Eq(sequential_trajectories[i].Size()));
+    EXPECT_THAT(parallel_trajectories[i].last().time(), Eq(t0_ + period / 10));
+    EXPECT_THAT(parallel_trajectories[i].last().degrees_of_freedom(),
+                Eq(sequential_trajectories[i].last().degrees_of_freedom()));
+  }
+}
+
 TEST_F(EphemerisTest, Спутник1ToСпутник2) {
   auto const at_спутник_1_launch =
       SolarSystemFactory::AtСпутник1Launch(
@@ -1065,6 +1301,40 @@ TEST_F(EphemerisTest, ComputeGravitationalAccelerationMassiveBody) {
               AlmostEquals(expected_acceleration3, 0, 4));
 }
 
+// Checks that the structure-of-arrays computation of the accelerations between
+// spherical bodies gives the same bits as the pairwise computation.
+TEST_F(EphemerisTest, ComputeMassiveBodiesGravitationalAccelerations) {
+  // The spherical bodies are processed two at a time, so check both an odd (23)
+  // and an even (22) number of them.
+  for (bool const remove_eris : {false, true}) {
+    if (remove_eris) {
+      solar_system_.RemoveMassiveBody("Eris");
+    }
+    auto const ephemeris = solar_system_.MakeEphemeris(
+        /*fitting_tolerance=*/5 * Milli(Metre),
+        Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+            McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+            /*step=*/45 * Minute));
+    ephemeris->Prolong(t0_ + 1 * JulianYear);
+
+    for (Instant t = t0_; t < t0_ + 1 * JulianYear; t += 10 * Day) {
+      std::vector<Position<ICRFJ2000Equator>> positions;
+      for (auto const trajectory : trajectories(*ephemeris)) {
+        positions.push_back(trajectory->EvaluatePosition(t, /*hint=*/nullptr));
+      }
+      std::vector<Vector<Acceleration, ICRFJ2000Equator>>
+          expected_accelerations;
+      ComputeMassiveBodiesGravitationalAccelerationsPairwise(
+          *ephemeris, positions, &expected_accelerations);
+      std::vector<Vector<Acceleration, ICRFJ2000Equator>> actual_accelerations(
+          positions.size());
+      ComputeMassiveBodiesGravitationalAccelerations(
+          ephemeris.get(), t, positions, &actual_accelerations);
+      EXPECT_THAT(actual_accelerations, Eq(expected_accelerations));
+    }
+  }
+}
+
 TEST_F(EphemerisTest, ComputeApsides) {
   Instant const t0;
   GravitationalParameter const μ = GravitationalConstant * SolarMass;
@@ -4,11 +4,16 @@
 #include <experimental/optional>
 #include <ostream>
 #include <string>
+#include <vector>
 
+#include "geometry/rotation.hpp"
 #include "physics/body.hpp"
 #include "physics/degrees_of_freedom.hpp"
 
 namespace principia {
+
+using geometry::Rotation;
+
 namespace physics {
 
 template<typename Frame>
@@ -29,6 +34,20 @@ template<typename Frame>
 std::ostream& operator<<(std::ostream& out,
                          KeplerianElements<Frame> const& elements);
 
+// Returns the eccentric anomaly E at which an elliptic orbit with the given
+// |eccentricity| e has the given |mean_anomaly| M, i.e., the solution of
+// Kepler's equation E - e sin E = M.  |eccentricity| must be in [0, 1[.  The
+// equation is solved by Halley's method, safeguarded by a bracket of the
+// solution, starting from |initial_guess| if it is given, from Danby's starter
+// otherwise.  If this doesn't converge in a few iterations, the bracket is
+// refined by |numerics::Bisect|.  In all cases the result has the accuracy of
+// bisection.
+Angle EllipticEccentricAnomaly(
+    double const eccentricity,
+    Angle const& mean_anomaly,
+    std::experimental::optional<Angle> const& initial_guess =
+        std::experimental::nullopt);
+
 template<typename Frame>
 class KeplerOrbit {
   static_assert(Frame::is_inertial, "Frame must be inertial");
@@ -48,10 +67,28 @@ class KeplerOrbit {
   // The |DegreesOfFreedom| of the secondary minus those of the primary.
   RelativeDegreesOfFreedom<Frame> StateVectors(Instant const& t) const;
 
+  // Same as above for each of the |times|.  This is faster than separate calls
+  // because the quantities which are independent from time are only computed
+  // once, and because, if the |times| are close to one another, each solution
+  // of Kepler's equation is used as a starting point for the next one.
+  std::vector<RelativeDegreesOfFreedom<Frame>> StateVectors(
+      std::vector<Instant> const& times) const;
+
   // All |optional|s are filled in the result.
   KeplerianElements<Frame> const& elements_at_epoch() const;
 
  private:
+  Angle MeanAnomaly(Instant const& t) const;
+
+  // The rotation from the frame where the orbit is in the xy plane and its
+  // periapsis on the x axis.
+  Rotation<Frame, Frame> FromOrbitPlane() const;
+
+  // The state vectors of an elliptic orbit at the given |eccentric_anomaly|.
+  RelativeDegreesOfFreedom<Frame> EllipticStateVectors(
+      Angle const& eccentric_anomaly,
+      Rotation<Frame, Frame> const& from_orbit_plane) const;
+
   GravitationalParameter const gravitational_parameter_;
   KeplerianElements<Frame> elements_at_epoch_;
   Instant const epoch_;
@@ -3,7 +3,11 @@
 
 #include "physics/kepler_orbit.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <string>
+#include <vector>
 
 #include "geometry/rotation.hpp"
 #include "numerics/root_finders.hpp"
@@ -19,6 +23,7 @@ using geometry::Normalize;
 using geometry::OrientedAngleBetween;
 using geometry::Wedge;
 using numerics::Bisect;
+using quantities::Abs;
 using quantities::ArcCos;
 using quantities::Cbrt;
 using quantities::DebugString;
@@ -31,6 +36,81 @@ using quantities::Time;
 
 namespace physics {
 
+inline Angle EllipticEccentricAnomaly(
+    double const eccentricity,
+    Angle const& mean_anomaly,
+    std::experimental::optional<Angle> const& initial_guess) {
+  CHECK_LE(0, eccentricity);
+  CHECK_LT(eccentricity, 1);
+  double const e = eccentricity;
+  if (e == 0) {
+    return mean_anomaly;
+  }
+
+  // The equation is invariant if 2π is added to both E and M, so we solve it
+  // for M in [-π, π].
+  Angle const offset =
+      std::nearbyint(mean_anomaly / (2 * π * Radian)) * 2 * π * Radian;
+  Angle const M = mean_anomaly - offset;
+  if (M == 0 * Radian) {
+    return offset;
+  }
+
+  // The residual is increasing, negative at |lower| and positive at |upper|.
+  auto const residual = [e, M](Angle const& E) -> Angle {
+    return E - e * Sin(E) * Radian - M;
+  };
+  Angle lower = M - e * Radian;
+  Angle upper = M + e * Radian;
+
+  Angle E;
+  if (initial_guess) {
+    E = std::min(std::max(*initial_guess - offset, lower), upper);
+  } else {
+    // Danby's starter, see Danby (1987), The solution of Kepler's equation.
+    E = M + (M > 0 * Radian ? 0.85 : -0.85) * e * Radian;
+  }
+
+  // With a good starter Halley's method converges in three or four iterations,
+  // plus one to detect convergence.
+  constexpr int max_iterations = 8;
+  double const tolerance = std::numeric_limits<double>::epsilon();
+  for (int i = 0; i < max_iterations; ++i) {
+    double const e_sin_E = e * Sin(E);
+    double const e_cos_E = e * Cos(E);
+    Angle const f = E - e_sin_E * Radian - M;
+    if (f == 0 * Radian) {
+      return E + offset;
+    } else if (f < 0 * Radian) {
+      lower = E;
+    } else {
+      upper = E;
+    }
+    // Halley's step for the residual f, whose derivatives are f′ = 1 - e cos E
+    // and f″ = e sin E.  Note that f′ ≥ 1 - e > 0.
+    double const f1 = 1 - e_cos_E;
+    Angle E_next = E - f / (f1 - f / Radian * e_sin_E / (2 * f1));
+    if (!(lower < E_next && E_next < upper)) {
+      // The step left the bracket, or was not finite.  Bisect instead.
+      E_next = lower + (upper - lower) / 2;
+    }
+    if (Abs(E_next - E) <= tolerance * Abs(E_next)) {
+      return E_next + offset;
+    }
+    E = E_next;
+  }
+
+  // This only happens if the iteration is stuck within a few ULPs of the
+  // solution, where the residual is dominated by rounding errors.
+  Angle const f_lower = residual(lower);
+  Angle const f_upper = residual(upper);
+  if (f_lower < 0 * Radian && f_upper > 0 * Radian) {
+    return Bisect(residual, lower, upper) + offset;
+  }
+  // Because of rounding errors, one end of the bracket is a root.
+  return (Abs(f_lower) < Abs(f_upper) ? lower : upper) + offset;
+}
+
 template<typename Frame>
 std::string DebugString(KeplerianElements<Frame> const& elements) {
   std::string result = "{";
@@ -157,54 +237,12 @@ KeplerOrbit<Frame>::KeplerOrbit(
 template<typename Frame>
 RelativeDegreesOfFreedom<Frame>
 KeplerOrbit<Frame>::StateVectors(Instant const& t) const {
-  GravitationalParameter const& μ = gravitational_parameter_;
   double const& eccentricity = elements_at_epoch_.eccentricity;
-  Length const& a = *elements_at_epoch_.semimajor_axis;
-  Angle const& i = elements_at_epoch_.inclination;
-  Angle const& Ω = elements_at_epoch_.longitude_of_ascending_node;
-  Angle const& ω = elements_at_epoch_.argument_of_periapsis;
-  Angle const mean_anomaly =
-      elements_at_epoch_.mean_anomaly +
-      *elements_at_epoch_.mean_motion * (t - epoch_);
   if (eccentricity < 1) {
     // Elliptic case.
-    auto const kepler_equation =
-        [eccentricity, mean_anomaly](Angle const& eccentric_anomaly) -> Angle {
-          return mean_anomaly -
-                     (eccentric_anomaly -
-                      eccentricity * Sin(eccentric_anomaly) * Radian);
-        };
-    Angle const eccentric_anomaly =
-        eccentricity == 0
-            ? mean_anomaly
-            : Bisect(kepler_equation,
-                     mean_anomaly - eccentricity * Radian,
-                     mean_anomaly + eccentricity * Radian);
-    Angle const true_anomaly =
-       2 * ArcTan(Sqrt(1 + eccentricity) * Sin(eccentric_anomaly / 2),
-                  Sqrt(1 - eccentricity) * Cos(eccentric_anomaly / 2));
-    Bivector<double, Frame> const x({1, 0, 0});
-    Bivector<double, Frame> const y({0, 1, 0});
-    Bivector<double, Frame> const z({0, 0, 1});
-    // It would be nice to have a local frame, rather than make this a rotation
-    // Frame -> Frame.
-    // TODO(egg): Constructor for |Rotation| using Euler angles.
-    Rotation<Frame, Frame> const from_orbit_plane =
-        (Rotation<Frame, Frame>(Ω, z) *
-         Rotation<Frame, Frame>(i, x) *
-         Rotation<Frame, Frame>(ω, z));
-    Length const distance = a * (1 - eccentricity * Cos(eccentric_anomaly));
-    Displacement<Frame> const r =
-        distance * from_orbit_plane(Vector<double, Frame>({Cos(true_anomaly),
-                                                           Sin(true_anomaly),
-                                                           0}));
-    Velocity<Frame> const v =
-        Sqrt(μ * a) / distance *
-        from_orbit_plane(Vector<double, Frame>(
-            {-Sin(eccentric_anomaly),
-             Sqrt(1 - Pow<2>(eccentricity)) * Cos(eccentric_anomaly),
-             0}));
-    return {r, v};
+    return EllipticStateVectors(
+        EllipticEccentricAnomaly(eccentricity, MeanAnomaly(t)),
+        FromOrbitPlane());
   } else if (eccentricity == 1) {
     // Parabolic case.
     LOG(FATAL) << "not yet implemented";
@@ -216,10 +254,97 @@ KeplerOrbit<Frame>::StateVectors(Instant const& t) const {
   }
 }
 
+template<typename Frame>
+std::vector<RelativeDegreesOfFreedom<Frame>>
+KeplerOrbit<Frame>::StateVectors(std::vector<Instant> const& times) const {
+  double const& eccentricity = elements_at_epoch_.eccentricity;
+  if (eccentricity >= 1) {
+    // Parabolic and hyperbolic cases.
+    LOG(FATAL) << "not yet implemented";
+    base::noreturn();
+  }
+
+  // Beyond this change of the mean anomaly, a linear extrapolation of the
+  // eccentric anomaly is not a better starting point than Danby's starter.
+  Angle const max_extrapolation = 0.1 * Radian;
+
+  Rotation<Frame, Frame> const from_orbit_plane = FromOrbitPlane();
+  std::vector<RelativeDegreesOfFreedom<Frame>> state_vectors;
+  state_vectors.reserve(times.size());
+  std::experimental::optional<Angle> previous_mean_anomaly;
+  Angle previous_eccentric_anomaly;
+  for (Instant const& t : times) {
+    Angle const mean_anomaly = MeanAnomaly(t);
+    std::experimental::optional<Angle> initial_guess;
+    if (previous_mean_anomaly) {
+      // dE/dM = 1 / (1 - e cos E).
+      Angle const Δmean_anomaly = mean_anomaly - *previous_mean_anomaly;
+      if (Abs(Δmean_anomaly) <= max_extrapolation) {
+        initial_guess =
+            previous_eccentric_anomaly +
+            Δmean_anomaly /
+                (1 - eccentricity * Cos(previous_eccentric_anomaly));
+      }
+    }
+    Angle const eccentric_anomaly =
+        EllipticEccentricAnomaly(eccentricity, mean_anomaly, initial_guess);
+    state_vectors.push_back(
+        EllipticStateVectors(eccentric_anomaly, from_orbit_plane));
+    previous_mean_anomaly = mean_anomaly;
+    previous_eccentric_anomaly = eccentric_anomaly;
+  }
+  return state_vectors;
+}
+
 template<typename Frame>
 KeplerianElements<Frame> const& KeplerOrbit<Frame>::elements_at_epoch() const {
   return elements_at_epoch_;
 }
 
+template<typename Frame>
+Angle KeplerOrbit<Frame>::MeanAnomaly(Instant const& t) const {
+  return elements_at_epoch_.mean_anomaly +
+         *elements_at_epoch_.mean_motion * (t - epoch_);
+}
+
+template<typename Frame>
+Rotation<Frame, Frame> KeplerOrbit<Frame>::FromOrbitPlane() const {
+  Angle const& i = elements_at_epoch_.inclination;
+  Angle const& Ω = elements_at_epoch_.longitude_of_ascending_node;
+  Angle const& ω = elements_at_epoch_.argument_of_periapsis;
+  Bivector<double, Frame> const x({1, 0, 0});
+  Bivector<double, Frame> const z({0, 0, 1});
+  // It would be nice to have a local frame, rather than make this a rotation
+  // Frame -> Frame.
+  // TODO(egg): Constructor for |Rotation| using Euler angles.
+  return Rotation<Frame, Frame>(Ω, z) *
+         Rotation<Frame, Frame>(i, x) *
+         Rotation<Frame, Frame>(ω, z);
+}
+
+template<typename Frame>
+RelativeDegreesOfFreedom<Frame> KeplerOrbit<Frame>::EllipticStateVectors(
+    Angle const& eccentric_anomaly,
+    Rotation<Frame, Frame> const& from_orbit_plane) const {
+  GravitationalParameter const& μ = gravitational_parameter_;
+  double const& eccentricity = elements_at_epoch_.eccentricity;
+  Length const& a = *elements_at_epoch_.semimajor_axis;
+  Angle const true_anomaly =
+     2 * ArcTan(Sqrt(1 + eccentricity) * Sin(eccentric_anomaly / 2),
+                Sqrt(1 - eccentricity) * Cos(eccentric_anomaly / 2));
+  Length const distance = a * (1 - eccentricity * Cos(eccentric_anomaly));
+  Displacement<Frame> const r =
+      distance * from_orbit_plane(Vector<double, Frame>({Cos(true_anomaly),
+                                                         Sin(true_anomaly),
+                                                         0}));
+  Velocity<Frame> const v =
+      Sqrt(μ * a) / distance *
+      from_orbit_plane(Vector<double, Frame>(
+          {-Sin(eccentric_anomaly),
+           Sqrt(1 - Pow<2>(eccentricity)) * Cos(eccentric_anomaly),
+           0}));
+  return {r, v};
+}
+
 }  // namespace physics
 }  // namespace principia
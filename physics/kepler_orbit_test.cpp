@@ -1,11 +1,14 @@
 ﻿
 #include "physics/kepler_orbit.hpp"
 
+#include <vector>
+
 #include "astronomy/frames.hpp"
 #include "geometry/epoch.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "mathematica/mathematica.hpp"
+#include "numerics/root_finders.hpp"
 #include "physics/solar_system.hpp"
 #include "testing_utilities/almost_equals.hpp"
 
@@ -13,13 +16,16 @@ namespace principia {
 
 using astronomy::ICRFJ2000Equator;
 using geometry::JulianDate;
+using numerics::Bisect;
 using quantities::si::Degree;
 using quantities::si::Kilo;
 using quantities::si::Metre;
 using quantities::si::Milli;
+using quantities::si::Radian;
 using testing_utilities::AlmostEquals;
 using ::testing::AllOf;
 using ::testing::Gt;
+using ::testing::Le;
 using ::testing::Lt;
 
 namespace physics {
@@ -78,6 +84,22 @@ TEST_F(KeplerOrbitTest, EarthMoon) {
   elements.argument_of_periapsis       = 3.551364385683149E+02 * Degree;
   elements.mean_anomaly                = 2.963020996150547E+02 * Degree;
   KeplerOrbit<ICRFJ2000Equator> moon_orbit(*earth, *moon, elements, date);
+  // The expected ULPs below were obtained when Kepler's equation was solved by
+  // bisection.  They still hold because the eccentric anomaly at |date| is the
+  // same to the bit.
+  {
+    double const e = elements.eccentricity;
+    Angle const mean_anomaly = elements.mean_anomaly;
+    auto const kepler_equation =
+        [e, mean_anomaly](Angle const& eccentric_anomaly) -> Angle {
+          return mean_anomaly -
+                     (eccentric_anomaly - e * Sin(eccentric_anomaly) * Radian);
+        };
+    EXPECT_EQ(Bisect(kepler_equation,
+                     mean_anomaly - e * Radian,
+                     mean_anomaly + e * Radian),
+              EllipticEccentricAnomaly(e, mean_anomaly));
+  }
   Displacement<ICRFJ2000Equator> const expected_displacement(
       { 1.177367562036580E+05 * Kilo(Metre),
        -3.419908628150604E+05 * Kilo(Metre),
@@ -126,5 +148,76 @@ TEST_F(KeplerOrbitTest, EarthMoon) {
               AlmostEquals(moon_orbit.elements_at_epoch().mean_anomaly, 6));
 }
 
+// Checks that the solutions of Kepler's equation agree with those computed by
+// bisection, including for mean anomalies outside of [-π, π].
+TEST_F(KeplerOrbitTest, EllipticEccentricAnomaly) {
+  struct Case {
+    double eccentricity;
+    std::int64_t max_ulps;
+  };
+  for (Case const& c : {Case{0.01, 1},
+                        Case{0.5, 2},
+                        Case{0.9, 6},
+                        Case{0.99, 4},
+                        Case{0.999999, 10}}) {
+    double const e = c.eccentricity;
+    for (int i = -1000; i <= 1000; ++i) {
+      Angle const mean_anomaly = i * 0.01 * Radian;
+      auto const kepler_equation =
+          [e, mean_anomaly](Angle const& eccentric_anomaly) -> Angle {
+            return mean_anomaly -
+                       (eccentric_anomaly -
+                        e * Sin(eccentric_anomaly) * Radian);
+          };
+      Angle const bisection = Bisect(kepler_equation,
+                                     mean_anomaly - e * Radian,
+                                     mean_anomaly + e * Radian);
+      EXPECT_THAT(EllipticEccentricAnomaly(e, mean_anomaly),
+                  AlmostEquals(bisection, 0, c.max_ulps))
+          << e << " " << mean_anomaly;
+      // A poor initial guess doesn't affect the accuracy.
+      EXPECT_THAT(
+          EllipticEccentricAnomaly(e, mean_anomaly, bisection + 1 * Radian),
+          AlmostEquals(bisection, 0, c.max_ulps))
+          << e << " " << mean_anomaly;
+    }
+  }
+  EXPECT_EQ(3 * Radian, EllipticEccentricAnomaly(0, 3 * Radian));
+}
+
+// Checks that the batched computation of the state vectors agrees with the
+// individual ones.
+TEST_F(KeplerOrbitTest, BatchedStateVectors) {
+  MassiveBody const primary(1 * SIUnit<GravitationalParameter>());
+  MasslessBody const secondary;
+  KeplerianElements<ICRFJ2000Equator> elements;
+  elements.eccentricity                = 0.9;
+  elements.semimajor_axis              = 1 * Metre;
+  elements.inclination                 = 10 * Degree;
+  elements.longitude_of_ascending_node = 20 * Degree;
+  elements.argument_of_periapsis       = 30 * Degree;
+  elements.mean_anomaly                = 40 * Degree;
+  KeplerOrbit<ICRFJ2000Equator> const orbit(
+      primary, secondary, elements, Instant());
+
+  // The times are closely spaced at the beginning and widely spaced at the
+  // end, so both ways of starting the iteration are exercised.
+  std::vector<Instant> times;
+  for (int i = 0; i < 100; ++i) {
+    times.push_back(Instant() + i * i * 0.01 * Second);
+  }
+  std::vector<RelativeDegreesOfFreedom<ICRFJ2000Equator>> const
+      state_vectors = orbit.StateVectors(times);
+  ASSERT_EQ(times.size(), state_vectors.size());
+  for (int i = 0; i < times.size(); ++i) {
+    RelativeDegreesOfFreedom<ICRFJ2000Equator> const expected =
+        orbit.StateVectors(times[i]);
+    EXPECT_THAT(state_vectors[i].displacement(),
+                AlmostEquals(expected.displacement(), 0, 2)) << i;
+    EXPECT_THAT(state_vectors[i].velocity(),
+                AlmostEquals(expected.velocity(), 0, 2)) << i;
+  }
+}
+
 }  // namespace physics
 }  // namespace principia
@@ -36,6 +36,18 @@ class MockEphemeris : public Ephemeris<Frame> {
                intrinsic_acceleration,
            Instant const& t,
            AdaptiveStepParameters const& parameters));
+  MOCK_METHOD6_T(
+      FlowWithAdaptiveStepInParallel,
+      std::vector<bool>(
+          std::vector<not_null<DiscreteTrajectory<Frame>*>> const&
+              trajectories,
+          typename Ephemeris<Frame>::IntrinsicAccelerations const&
+              intrinsic_accelerations,
+          Instant const& t,
+          std::vector<typename Ephemeris<Frame>::AdaptiveStepParameters> const&
+              parameters,
+          std::int64_t const max_ephemeris_steps,
+          not_null<ThreadPool<bool>*> const thread_pool));
   MOCK_METHOD4_T(
       FlowWithFixedStep,
       void(std::vector<not_null<DiscreteTrajectory<Frame>*>> const&
@@ -73,6 +85,9 @@ class MockEphemeris : public Ephemeris<Frame> {
 
   MOCK_CONST_METHOD1_T(WriteToMessage,
                        void(not_null<serialization::Ephemeris*> const message));
+  MOCK_CONST_METHOD2_T(WriteDeltaToMessage,
+                       void(not_null<serialization::Ephemeris*> const message,
+                            Instant const& base_time));
 };
 
 }  // namespace physics
@@ -1,6 +1,7 @@
 ﻿
 #pragma once
 
+#include <cstdint>
 #include <experimental/filesystem>
 #include <map>
 #include <string>
@@ -32,6 +33,11 @@ class SolarSystem {
       Length const& fitting_tolerance,
       typename Ephemeris<Frame>::FixedStepParameters const& parameters);
 
+  // A fingerprint of the gravity model and of the initial state.  Two objects
+  // with the same fingerprint produce the same ephemeris for the same
+  // parameters.
+  std::uint64_t fingerprint() const;
+
   // The time origin for the initial state.
   Instant const& epoch() const;
 
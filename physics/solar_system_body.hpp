@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "astronomy/frames.hpp"
+#include "base/fingerprint2011.hpp"
 #include "geometry/epoch.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
@@ -27,6 +28,8 @@
 
 namespace principia {
 
+using base::Fingerprint2011;
+using base::FingerprintCat2011;
 using geometry::Bivector;
 using geometry::Instant;
 using geometry::JulianDate;
@@ -113,6 +116,29 @@ std::unique_ptr<Ephemeris<Frame>> SolarSystem<Frame>::MakeEphemeris(
                                             parameters);
 }
 
+template<typename Frame>
+std::uint64_t SolarSystem<Frame>::fingerprint() const {
+  // Use the maps, not the protocol buffers, as the former reflect the effect of
+  // |RemoveMassiveBody|.
+  auto fingerprint_cat = [](std::uint64_t const fingerprint,
+                            std::string const& bytes) {
+    return FingerprintCat2011(fingerprint,
+                              Fingerprint2011(bytes.c_str(), bytes.size()));
+  };
+  serialization::Point epoch;
+  epoch_.WriteToMessage(&epoch);
+  std::uint64_t fingerprint = fingerprint_cat(0, epoch.SerializeAsString());
+  for (auto const& pair : gravity_model_map_) {
+    fingerprint =
+        fingerprint_cat(fingerprint, pair.second->SerializeAsString());
+  }
+  for (auto const& pair : initial_state_map_) {
+    fingerprint =
+        fingerprint_cat(fingerprint, pair.second->SerializeAsString());
+  }
+  return fingerprint;
+}
+
 template<typename Frame>
 Instant const& SolarSystem<Frame>::epoch() const {
   return epoch_;
@@ -189,12 +189,27 @@ void JournalProtoProcessor::ProcessRepeatedMessageField(
       << descriptor->full_name() << " is missing a (size) option";
   size_member_name_[descriptor] = options.GetExtension(serialization::size);
   field_cs_type_[descriptor] = message_type_name + "[]";
-  field_cxx_type_[descriptor] = message_type_name + " const*";
+  if (Contains(out_, descriptor)) {
+    // An out repeated field is a buffer allocated by the caller and filled by
+    // the callee.
+    CHECK(!Contains(in_out_, descriptor))
+        << descriptor->full_name()
+        << " is a repeated field and cannot be in-out";
+    field_cs_marshal_[descriptor] = "[Out]";
+    field_cxx_type_[descriptor] = message_type_name + "*";
+    // The buffer may be empty when replaying.
+    field_cxx_arguments_fn_[descriptor] =
+        [](std::string const& identifier) -> std::vector<std::string> {
+          return {identifier + ".data()", identifier + ".size()"};
+        };
+  } else {
+    field_cxx_type_[descriptor] = message_type_name + " const*";
+    field_cxx_arguments_fn_[descriptor] =
+        [](std::string const& identifier) -> std::vector<std::string> {
+          return {"&" + identifier + "[0]", identifier + ".size()"};
+        };
+  }
 
-  field_cxx_arguments_fn_[descriptor] =
-      [](std::string const& identifier) -> std::vector<std::string> {
-        return {"&" + identifier + "[0]", identifier + ".size()"};
-      };
   field_cxx_assignment_fn_[descriptor] =
       [this, descriptor, message_type_name](
           std::string const& prefix, std::string const& expr) {
@@ -390,14 +405,26 @@ void JournalProtoProcessor::ProcessRequiredUint32Field(
 
 void JournalProtoProcessor::ProcessSingleStringField(
     FieldDescriptor const* descriptor) {
-  field_cs_marshal_[descriptor] =
-      Contains(out_, descriptor) ? "[MarshalAs(UnmanagedType.CustomMarshaler, "
-                                   "MarshalTypeRef = typeof(OutUTF8Marshaler))]"
-                                 : "[MarshalAs(UnmanagedType.CustomMarshaler, "
-                                   "MarshalTypeRef = typeof(InUTF8Marshaler))]";
-  field_cs_type_[descriptor] = "String";
-  field_cxx_type_[descriptor] = "char const*";
   FieldOptions const& options = descriptor->options();
+  if (descriptor->type() == FieldDescriptor::TYPE_BYTES) {
+    // Binary data is not null-terminated and cannot go through the UTF-8
+    // marshalers, so it is passed as an array together with its size.
+    CHECK(!Contains(out_, descriptor))
+        << descriptor->full_name() << " is a bytes field and cannot be out";
+    CHECK(options.HasExtension(serialization::size))
+        << descriptor->full_name() << " is a bytes field and must have a size";
+    field_cs_marshal_[descriptor] = "";
+    field_cs_type_[descriptor] = "byte[]";
+  } else {
+    field_cs_marshal_[descriptor] =
+        Contains(out_, descriptor)
+            ? "[MarshalAs(UnmanagedType.CustomMarshaler, "
+              "MarshalTypeRef = typeof(OutUTF8Marshaler))]"
+            : "[MarshalAs(UnmanagedType.CustomMarshaler, "
+              "MarshalTypeRef = typeof(InUTF8Marshaler))]";
+    field_cs_type_[descriptor] = "String";
+  }
+  field_cxx_type_[descriptor] = "char const*";
   if (options.HasExtension(serialization::size)) {
     size_member_name_[descriptor] = options.GetExtension(serialization::size);
 
@@ -479,6 +506,7 @@ void JournalProtoProcessor::ProcessRequiredField(
     case FieldDescriptor::TYPE_MESSAGE:
       ProcessRequiredMessageField(descriptor);
       break;
+    case FieldDescriptor::TYPE_BYTES:
     case FieldDescriptor::TYPE_STRING:
       ProcessSingleStringField(descriptor);
       break;
@@ -636,7 +664,13 @@ void JournalProtoProcessor::ProcessInOut(
       std::copy(field_arguments.begin(), field_arguments.end(),
                 std::back_inserter(cxx_run_arguments_[descriptor]));
 
-      if (Contains(out_, field_descriptor)) {
+      if (Contains(out_, field_descriptor) && field_descriptor->is_repeated()) {
+        // Allocate a buffer with the capacity that was used when recording.
+        cxx_run_body_prolog_[descriptor] +=
+            "  std::vector<" + field_descriptor->message_type()->name() +
+            "> " + run_local_variable + "(" + ToLower(name) + "." +
+            field_descriptor_name + "_size());\n";
+      } else if (Contains(out_, field_descriptor)) {
         cxx_run_body_prolog_[descriptor] +=
             "  " + field_cxx_type_[field_descriptor] + " " +
             run_local_variable + ";\n";